@@ -0,0 +1,259 @@
+#pragma once
+
+#include "Set.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+namespace container {
+
+// ============================================================================
+/// @brief Bump allocator handing out block storage from large memory regions
+///        backed by huge pages when the system provides them.
+///
+/// Regions are obtained with mmap(MAP_HUGETLB). When no huge page is
+/// reserved on the system, a regular mapping advised with MADV_HUGEPAGE
+/// (transparent huge pages) is used instead. On non-Linux systems regions
+/// come from the aligned operator new. Memory is only given back to the
+/// system when the arena is destroyed.
+// ============================================================================
+class HugePageArena
+{
+public:
+    /// @brief Size of a huge page on x86-64 and AArch64 Linux
+    static constexpr size_t HugePageSize = size_t(2) << 20;
+
+    /// @brief Construct an empty arena (no memory is mapped yet)
+    /// @param region_bytes Minimum size of each mapped region
+    explicit HugePageArena(size_t region_bytes = HugePageSize)
+        : m_region_bytes(round_up(region_bytes, HugePageSize))
+    {}
+
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+
+    /// @brief Unmap all regions
+    ~HugePageArena()
+    {
+        for (const auto& region : m_regions)
+        {
+#if defined(__linux__)
+            ::munmap(region.base, region.size);
+#else
+            ::operator delete(region.base, std::align_val_t{HugePageSize});
+#endif
+        }
+    }
+
+    /// @brief Carve bytes out of the current region, mapping a new one if needed
+    /// @param bytes Number of bytes to allocate
+    /// @param alignment Required alignment (power of two, at most HugePageSize)
+    /// @return Pointer to uninitialized memory
+    /// @throw std::bad_alloc if the system refuses a new region
+    [[nodiscard]] std::byte* allocate(size_t bytes, size_t alignment)
+    {
+        assert(std::has_single_bit(alignment) && alignment <= HugePageSize);
+        size_t offset = round_up(m_offset, alignment);
+        if (m_regions.empty() || offset + bytes > m_regions.back().size)
+        {
+            map_region(round_up(std::max(bytes, m_region_bytes), HugePageSize));
+            offset = 0u;
+        }
+        m_offset = offset + bytes;
+        return m_regions.back().base + offset;
+    }
+
+    /// @brief Total number of bytes mapped by the arena
+    [[nodiscard]] size_t mapped_bytes() const noexcept
+    {
+        size_t total = 0u;
+        for (const auto& region : m_regions)
+        {
+            total += region.size;
+        }
+        return total;
+    }
+
+    /// @brief Check if at least one region is backed by reserved huge pages
+    [[nodiscard]] bool uses_huge_pages() const noexcept
+    {
+        return m_huge_pages;
+    }
+
+private:
+    struct Region
+    {
+        std::byte* base;
+        size_t size;
+    };
+
+    [[nodiscard]] static constexpr size_t round_up(size_t value, size_t alignment) noexcept
+    {
+        return (value + alignment - 1u) & ~(alignment - 1u);
+    }
+
+    void map_region(size_t size)
+    {
+        m_regions.reserve(m_regions.size() + 1u);
+#if defined(__linux__)
+        void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED)
+        {
+            m_huge_pages = true;
+        }
+        else
+        {
+            base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            ::madvise(base, size, MADV_HUGEPAGE);
+        }
+#else
+        void* base = ::operator new(size, std::align_val_t{HugePageSize});
+#endif
+        m_regions.push_back({static_cast<std::byte*>(base), size});
+    }
+
+    std::vector<Region> m_regions;  ///< Mapped regions (the last one is being carved)
+    size_t m_region_bytes;          ///< Minimum size of a new region
+    size_t m_offset = 0u;           ///< Bytes already used in the last region
+    bool m_huge_pages = false;      ///< MAP_HUGETLB succeeded at least once
+};
+
+// ============================================================================
+/// @brief Shared free-list recycling blocks across containers.
+///
+/// Containers constructed with a pool take their blocks from it and give
+/// them back (emptied) when they shrink or are destroyed, instead of calling
+/// new/delete for every block. A pool can be shared by any number of Set and
+/// Collection of the same T and N, from several threads. The pool must
+/// outlive the containers using it.
+///
+/// @tparam T Element type
+/// @tparam N Log2 of block size
+///
+/// @code
+/// BlockPool<Particle, 8> pool;                 // Or BlockPool<...>(BlockPool<...>::Mode::HugePages)
+/// for (frame...) {
+///     Set<Particle, 8> particles(pool);        // Blocks come from the pool
+///     ...
+/// }                                            // Blocks go back to the pool
+/// auto stats = pool.stats();                   // stats.hits, stats.misses
+/// @endcode
+// ============================================================================
+template<typename T, size_t N>
+class BlockPool : public detail::BlockProvider<T, N>
+{
+public:
+    using block_type = detail::Block<T, N>;
+
+    /// @brief Where the storage of new blocks comes from
+    enum class Mode
+    {
+        Heap,      ///< Aligned operator new, one allocation per block
+        HugePages  ///< Carved out of a HugePageArena owned by the pool
+    };
+
+    /// @brief Pool counters
+    struct Stats
+    {
+        size_t hits = 0u;      ///< Blocks served from the free-list
+        size_t misses = 0u;    ///< Blocks that had to be created
+        size_t released = 0u;  ///< Blocks given back by containers
+        size_t cached = 0u;    ///< Blocks currently waiting in the free-list
+    };
+
+    /// @brief Construct an empty pool
+    /// @param mode Storage source for new blocks
+    explicit BlockPool(Mode mode = Mode::Heap)
+        : m_mode(mode)
+    {}
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    /// @brief Get a block, recycled if possible
+    /// @return An empty block with allocated storage
+    [[nodiscard]] std::unique_ptr<block_type> acquire() override
+    {
+        std::scoped_lock lock(m_mutex);
+        if (!m_free.empty())
+        {
+            auto block = std::move(m_free.back());
+            m_free.pop_back();
+            ++m_stats.hits;
+            return block;
+        }
+
+        ++m_stats.misses;
+        if (m_mode == Mode::HugePages)
+        {
+            return std::make_unique<block_type>(
+                m_arena.allocate(block_type::Capacity * sizeof(T), alignof(T)));
+        }
+        return std::make_unique<block_type>(false);
+    }
+
+    /// @brief Give a block back to the pool (its elements are destroyed)
+    /// @param block Block to recycle
+    void release(std::unique_ptr<block_type> block) override
+    {
+        block->clear();
+        std::scoped_lock lock(m_mutex);
+        m_free.push_back(std::move(block));
+        ++m_stats.released;
+    }
+
+    /// @brief Destroy the cached blocks, keeping at most keep of them
+    /// @param keep Number of blocks to keep in the free-list
+    /// @note In HugePages mode the arena memory is only returned to the
+    ///       system when the pool is destroyed.
+    void trim(size_t keep = 0u)
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_free.size() > keep)
+        {
+            m_free.resize(keep);
+        }
+    }
+
+    /// @brief Get a snapshot of the pool counters
+    [[nodiscard]] Stats stats() const
+    {
+        std::scoped_lock lock(m_mutex);
+        Stats stats = m_stats;
+        stats.cached = m_free.size();
+        return stats;
+    }
+
+    /// @brief Get the storage mode given at construction
+    [[nodiscard]] Mode mode() const noexcept
+    {
+        return m_mode;
+    }
+
+    /// @brief Get the arena used in HugePages mode
+    [[nodiscard]] const HugePageArena& arena() const noexcept
+    {
+        return m_arena;
+    }
+
+private:
+    // Declared first: blocks referencing arena memory must die before it
+    HugePageArena m_arena;                             ///< Storage for HugePages mode
+    Mode m_mode;                                       ///< Storage source for new blocks
+    mutable std::mutex m_mutex;                        ///< Protects the free-list and stats
+    std::vector<std::unique_ptr<block_type>> m_free;   ///< Empty blocks ready for reuse
+    Stats m_stats;                                     ///< Counters (cached is computed)
+};
+
+} // namespace container
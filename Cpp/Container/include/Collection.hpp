@@ -2,6 +2,8 @@
 
 #include "Set.hpp"
 
+#include <chrono>
+
 namespace container {
 
 // ============================================================================
@@ -18,7 +20,7 @@ namespace container {
 /// - Holes allowed: indices remain stable after removal
 /// - Iterator automatically skips holes
 ///
-/// @tparam T Element type (must be default_initializable and copyable)
+/// @tparam T Element type (must be movable)
 /// @tparam N Log2 of block size (default 4 = 16 elements per block)
 ///
 /// @code
@@ -31,13 +33,15 @@ namespace container {
 /// @endcode
 // ============================================================================
 template<typename T, size_t N = 4>
-    requires std::default_initializable<T> && std::copyable<T>
+    requires std::movable<T>
 class Collection : public detail::ContainerBase<T, N>
 {
     using Base = detail::ContainerBase<T, N>;
+    using typename Base::block_type;
     using Base::m_blocks;
     using Base::m_stored_elements;
     using Base::BlockCapacity;
+    using Base::WordSlots;
 
     /// @brief Sentinel value for uninitialized bounds
     static constexpr size_t INVALID_INDEX = static_cast<size_t>(-1);
@@ -69,8 +73,7 @@ public:
 
         iterator& operator++()
         {
-            ++m_pos;
-            skip_holes();
+            advance();
             return *this;
         }
 
@@ -92,12 +95,31 @@ public:
         }
 
     private:
+        /// @brief Jump to the first occupied slot at or after m_pos, skipping
+        ///        empty words and blocks
         void skip_holes()
         {
-            while (m_pos < m_end && !m_container->occupied(m_pos))
+            m_pos = m_container->find_occupied(m_pos, m_end);
+        }
+
+        /// @brief Move to the next occupied slot. The occupancy word is read
+        ///        again each time: the loop body may have removed the next
+        ///        elements of the word.
+        void advance()
+        {
+            ++m_pos;
+            if ((m_pos & (WordSlots - 1u)) != 0u)
             {
-                ++m_pos;
+                const size_t bits = m_container->occupancy_word(m_pos);
+                if (bits != 0u)
+                {
+                    m_pos = (m_pos & ~(WordSlots - 1u)) + static_cast<size_t>(std::countr_zero(bits));
+                    m_pos = std::min(m_pos, m_end);
+                    return;
+                }
+                m_pos = (m_pos | (WordSlots - 1u)) + 1u;
             }
+            skip_holes();
         }
 
         Collection* m_container = nullptr;
@@ -127,8 +149,7 @@ public:
 
         const_iterator& operator++()
         {
-            ++m_pos;
-            skip_holes();
+            advance();
             return *this;
         }
 
@@ -150,12 +171,31 @@ public:
         }
 
     private:
+        /// @brief Jump to the first occupied slot at or after m_pos, skipping
+        ///        empty words and blocks
         void skip_holes()
         {
-            while (m_pos < m_end && !m_container->occupied(m_pos))
+            m_pos = m_container->find_occupied(m_pos, m_end);
+        }
+
+        /// @brief Move to the next occupied slot. The occupancy word is read
+        ///        again each time: the loop body may have removed the next
+        ///        elements of the word.
+        void advance()
+        {
+            ++m_pos;
+            if ((m_pos & (WordSlots - 1u)) != 0u)
             {
-                ++m_pos;
+                const size_t bits = m_container->occupancy_word(m_pos);
+                if (bits != 0u)
+                {
+                    m_pos = (m_pos & ~(WordSlots - 1u)) + static_cast<size_t>(std::countr_zero(bits));
+                    m_pos = std::min(m_pos, m_end);
+                    return;
+                }
+                m_pos = (m_pos | (WordSlots - 1u)) + 1u;
             }
+            skip_holes();
         }
 
         const Collection* m_container = nullptr;
@@ -174,6 +214,29 @@ public:
     /// @param reserve_elements Number of elements to reserve space for
     explicit Collection(size_t reserve_elements) : Base(reserve_elements) {}
 
+    /// @brief Construct with blocks taken from (and given back to) a shared pool
+    /// @param pool Block pool, must outlive the container
+    /// @param reserve_elements Number of elements to reserve space for
+    explicit Collection(BlockPool<T, N>& pool, size_t reserve_elements = 0u)
+        : Base(reserve_elements, &pool)
+    {}
+
+    /// @brief Move constructor (the source is left empty)
+    Collection(Collection&& other) noexcept
+        : Base(std::move(other)),
+          m_begin(std::exchange(other.m_begin, INVALID_INDEX)),
+          m_end(std::exchange(other.m_end, 0u))
+    {}
+
+    /// @brief Move assignment (the source is left empty)
+    Collection& operator=(Collection&& other) noexcept
+    {
+        Base::operator=(std::move(other));
+        m_begin = std::exchange(other.m_begin, INVALID_INDEX);
+        m_end = std::exchange(other.m_end, 0u);
+        return *this;
+    }
+
     /// @brief Construct from initializer list
     /// @param init Elements to insert (sequentially from index 0)
     Collection(std::initializer_list<T> init) : Base(init.size())
@@ -222,6 +285,25 @@ public:
         return *this;
     }
 
+    /// @brief Append element at the end by moving it
+    /// @param elem Element to append
+    /// @return Reference to this container
+    Collection& operator+=(T&& elem)
+    {
+        insert_impl(m_end, std::move(elem));
+        return *this;
+    }
+
+    /// @brief Construct an element in place at the end
+    /// @param args Arguments forwarded to the constructor of T
+    /// @return Reference to the new element
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    T& emplace_back(Args&&... args)
+    {
+        return insert_impl(m_end, std::forward<Args>(args)...);
+    }
+
     /// @brief Append multiple elements from initializer list
     /// @param init Elements to append
     /// @return Reference to this container
@@ -242,6 +324,25 @@ public:
         insert_impl(index, elem);
     }
 
+    /// @brief Insert element at specific index by moving it
+    /// @param index Position to insert at
+    /// @param elem Element to insert
+    void insert(size_t index, T&& elem)
+    {
+        insert_impl(index, std::move(elem));
+    }
+
+    /// @brief Construct an element in place at a specific index
+    /// @param index Position to insert at (an existing element is replaced)
+    /// @param args Arguments forwarded to the constructor of T
+    /// @return Reference to the new element
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    T& emplace(size_t index, Args&&... args)
+    {
+        return insert_impl(index, std::forward<Args>(args)...);
+    }
+
     /// @brief Remove element at index (creates a hole)
     /// @param index Index of element to remove
     void remove(size_t index)
@@ -259,34 +360,47 @@ public:
             return;  // Already empty
         }
 
-        m_blocks[bid]->clear_occupied(sid);
-        --m_stored_elements;
+        this->mark_empty(bid, sid);
+
+        // Reset if empty
+        if (m_stored_elements == 0u)
+        {
+            m_begin = INVALID_INDEX;
+            m_end = 0u;
+            return;
+        }
 
         // Update bounds
         if (index == m_begin)
         {
-            // Find next occupied slot
-            while (m_begin < m_end && !this->occupied(m_begin))
-            {
-                ++m_begin;
-            }
+            m_begin = this->find_occupied(m_begin, m_end);
         }
 
         if (index + 1u == m_end)
         {
-            // Find previous occupied slot
-            while (m_end > 0u && !this->occupied(m_end - 1u))
-            {
-                --m_end;
-            }
+            m_end = this->find_last_occupied(m_begin, m_end) + 1u;
         }
+    }
 
-        // Reset if empty
-        if (m_stored_elements == 0u)
-        {
-            m_begin = INVALID_INDEX;
-            m_end = 0u;
-        }
+    /// @brief Apply a function to every element, skipping holes a bitfield
+    ///        word at a time and empty blocks at once
+    /// @param fn Function called as fn(T&) or fn(index, T&)
+    ///
+    /// @code
+    /// col.for_each_occupied([](size_t index, Node& node) { ... });
+    /// @endcode
+    template<typename Function>
+    void for_each_occupied(Function fn)
+    {
+        for_each_occupied_impl(*this, fn);
+    }
+
+    /// @brief Apply a function to every element (const version)
+    /// @param fn Function called as fn(const T&) or fn(index, const T&)
+    template<typename Function>
+    void for_each_occupied(Function fn) const
+    {
+        for_each_occupied_impl(*this, fn);
     }
 
     /// @brief Clear all elements
@@ -297,6 +411,83 @@ public:
         m_end = 0u;
     }
 
+    // ========================================================================
+    // Compaction
+    // ========================================================================
+
+    /// @brief Move elements out of the sparsest blocks into the densest ones
+    /// @param max_moves Maximum number of elements to move in this call
+    /// @return Remap table: {old_index, new_index} of every moved element, in
+    ///         the order of the moves
+    ///
+    /// After heavy churn, live elements can be spread over many nearly empty
+    /// blocks. Each call evacuates the sparsest blocks first (they free a
+    /// block for the fewest moves) into the free slots of the densest ones,
+    /// and releases the storage of the blocks it empties (to the pool, if
+    /// any). Calling it every frame with a small budget spreads the work: it
+    /// does nothing once the elements fit in as few blocks as possible.
+    ///
+    /// Moved elements change index: references held elsewhere must be
+    /// updated from the remap table (SlotMap::compact() does it for handles).
+    /// The destination slots are tagged as pending.
+    ///
+    /// @code
+    /// for (auto [from, to] : col.compact(256)) { owners[to] = owners[from]; }
+    /// @endcode
+    ///
+    /// @note The storage of a mapped container belongs to the file: emptied
+    ///       blocks keep it.
+    std::vector<std::pair<size_t, size_t>> compact(size_t max_moves = static_cast<size_t>(-1))
+    {
+        return compact_impl([max_moves](size_t moves) { return moves < max_moves; });
+    }
+
+    /// @brief Compact for at most a given duration
+    /// @param budget Time after which the call stops moving elements (the
+    ///        clock is read every 64 moves, so it may be slightly exceeded)
+    /// @return Remap table, see compact(size_t)
+    template<typename Rep, typename Period>
+    std::vector<std::pair<size_t, size_t>> compact(std::chrono::duration<Rep, Period> budget)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        return compact_impl([deadline](size_t moves)
+        {
+            return (moves % 64u) != 0u || std::chrono::steady_clock::now() < deadline;
+        });
+    }
+
+    /// @brief Fragmentation metrics, see fragmentation()
+    struct Fragmentation
+    {
+        size_t allocated_blocks = 0u;   ///< Blocks owning element storage
+        size_t used_blocks = 0u;        ///< Blocks holding at least one element
+        size_t min_blocks = 0u;         ///< Blocks needed if elements were dense
+        size_t wasted_bytes = 0u;       ///< Element storage not holding elements
+        std::vector<size_t> occupancy;  ///< Number of elements in each block
+    };
+
+    /// @brief Measure how sparse the blocks are
+    /// @return Occupancy of every block and memory that compact() plus
+    ///         shrink_to_fit() could give back
+    [[nodiscard]] Fragmentation fragmentation() const
+    {
+        Fragmentation stats;
+        stats.min_blocks = (m_stored_elements + BlockCapacity - 1u) >> N;
+        stats.occupancy.reserve(m_blocks.size());
+        for (const auto& block : m_blocks)
+        {
+            const size_t occupation = block->occupation();
+            stats.occupancy.push_back(occupation);
+            stats.used_blocks += (occupation != 0u) ? 1u : 0u;
+            if (block->is_allocated())
+            {
+                ++stats.allocated_blocks;
+                stats.wasted_bytes += (BlockCapacity - occupation) * sizeof(T);
+            }
+        }
+        return stats;
+    }
+
     // ========================================================================
     // Capacity
     // ========================================================================
@@ -406,6 +597,17 @@ public:
     [[nodiscard]] const_iterator cend() const { return end(); }
 
 private:
+    /// @brief Find the bounds of the elements of a mapped file
+    [[nodiscard]] const char* adopt_mapped_blocks() override
+    {
+        if (!this->empty())
+        {
+            m_begin = this->find_occupied(0u, this->capacity());
+            m_end = this->find_last_occupied(0u, this->capacity()) + 1u;
+        }
+        return nullptr;
+    }
+
     /// @brief Check if access to index is valid
     /// @throw std::out_of_range if invalid
     void check_access(size_t index) const
@@ -422,38 +624,150 @@ private:
         }
     }
 
-    /// @brief Implementation of insert
-    void insert_impl(size_t index, const T& elem)
+    /// @brief Implementation of for_each_occupied (const and non-const)
+    template<typename Self, typename Function>
+    static void for_each_occupied_impl(Self& self, Function& fn)
     {
-        const size_t bid = detail::block_index<N>(index);
-        const size_t sid = detail::sub_index<N>(index);
-
-        // Ensure we have space
-        if (bid >= m_blocks.size())
+        const size_t used_blocks = std::min(self.m_blocks.size(), (self.m_end + BlockCapacity - 1u) >> N);
+        for (size_t bid = 0u; bid < used_blocks; ++bid)
         {
-            this->allocate_blocks(bid + 1u - m_blocks.size());
+            auto& block = *self.m_blocks[bid];
+            block.for_each_occupied_slot([&block, &fn, bid](size_t sid)
+            {
+                if constexpr (std::is_invocable_v<Function&, size_t, decltype(block[sid])>)
+                {
+                    fn((bid << N) + sid, block[sid]);
+                }
+                else
+                {
+                    fn(block[sid]);
+                }
+            });
         }
+    }
 
-        // Insert element
-        (*m_blocks[bid])[sid] = elem;
-
-        if (!m_blocks[bid]->is_occupied(sid))
+    /// @brief Implementation of compact
+    /// @param may_move Called as may_move(moves_done) before each move,
+    ///        returns false to stop
+    template<typename Budget>
+    std::vector<std::pair<size_t, size_t>> compact_impl(Budget may_move)
+    {
+        // Used blocks from the sparsest to the densest. On equal occupancy the
+        // last blocks are evacuated first, so that shrink_to_fit() can drop them.
+        // Occupations are small integers: counting sort.
+        std::vector<size_t> occupations(m_blocks.size());
+        std::vector<size_t> first_of(BlockCapacity + 2u, 0u);
+        for (size_t bid = 0u; bid < m_blocks.size(); ++bid)
+        {
+            occupations[bid] = m_blocks[bid]->occupation();
+            ++first_of[occupations[bid] + 1u];
+        }
+        for (size_t occupation = 1u; occupation < first_of.size(); ++occupation)
+        {
+            first_of[occupation] += first_of[occupation - 1u];
+        }
+        const size_t empty_blocks = first_of[1];
+        std::vector<std::pair<size_t, size_t>> blocks(m_blocks.size() - empty_blocks);  // {occupation, bid}
+        for (size_t bid = m_blocks.size(); bid-- > 0u;)
         {
-            m_blocks[bid]->set_occupied(sid);
-            ++m_stored_elements;
+            if (occupations[bid] != 0u)
+            {
+                blocks[first_of[occupations[bid]]++ - empty_blocks] = {occupations[bid], bid};
+            }
+        }
 
-            // Update bounds
-            if (index >= m_end)
+        std::vector<std::pair<size_t, size_t>> remap;
+        size_t src = 0u;
+        size_t dst = blocks.size();
+        size_t src_slot = 0u;
+        size_t dst_slot = 0u;
+        while (src + 1u < dst && may_move(remap.size()))
+        {
+            if (blocks[dst - 1u].first == BlockCapacity)
             {
-                m_end = index + 1u;
+                --dst;
+                dst_slot = 0u;
+                continue;
             }
-            if (index < m_begin || m_begin == INVALID_INDEX)
+
+            block_type& from = *m_blocks[blocks[src].second];
+            block_type& to = *m_blocks[blocks[dst - 1u].second];
+            src_slot = from.next_occupied(src_slot);
+            dst_slot = to.next_free(dst_slot);
+            to.emplace(dst_slot, std::move(from[src_slot]));
+            from.erase(src_slot);
+            to.tag_as_pending(dst_slot);
+            remap.emplace_back((blocks[src].second << N) + src_slot, (blocks[dst - 1u].second << N) + dst_slot);
+            ++blocks[dst - 1u].first;
+
+            if (--blocks[src].first == 0u)
             {
-                m_begin = index;
+                release_storage(blocks[src].second);
+                ++src;
+                src_slot = 0u;
             }
         }
 
+        // Free slots of the destination blocks may lie past the last element
+        if (!remap.empty())
+        {
+            m_begin = this->find_occupied(0u, this->capacity());
+            m_end = this->find_last_occupied(0u, this->capacity()) + 1u;
+        }
+        return remap;
+    }
+
+    /// @brief Give the storage of an empty block back (to the pool, if any),
+    ///        leaving an unallocated block in its place. insert_impl() takes
+    ///        new storage for it through acquire_block().
+    void release_storage(size_t bid)
+    {
+        if (!this->is_mapped())
+        {
+            this->release_block(std::move(m_blocks[bid]));
+            m_blocks[bid] = std::make_unique<block_type>(true);
+        }
+    }
+
+    /// @brief Implementation of insert
+    template<typename... Args>
+    T& insert_impl(size_t index, Args&&... args)
+    {
+        const size_t bid = detail::block_index<N>(index);
+        const size_t sid = detail::sub_index<N>(index);
+
+        // Ensure we have space. A block emptied by compact() has no storage:
+        // replace it like a new block, never through Block's own allocation.
+        this->ensure_capacity(index);
+        if (!m_blocks[bid]->is_allocated())
+        {
+            m_blocks[bid] = this->acquire_block();
+        }
+
+        // Replace an existing element, or construct in the empty slot
+        if (m_blocks[bid]->is_occupied(sid))
+        {
+            T& slot = (*m_blocks[bid])[sid];
+            detail::assign_from(slot, std::forward<Args>(args)...);
+            m_blocks[bid]->tag_as_pending(sid);
+            return slot;
+        }
+
+        T& slot = m_blocks[bid]->emplace(sid, std::forward<Args>(args)...);
+        ++m_stored_elements;
+
+        // Update bounds
+        if (index >= m_end)
+        {
+            m_end = index + 1u;
+        }
+        if (index < m_begin || m_begin == INVALID_INDEX)
+        {
+            m_begin = index;
+        }
+
         m_blocks[bid]->tag_as_pending(sid);
+        return slot;
     }
 
     size_t m_begin = INVALID_INDEX;  ///< Index of first occupied element
@@ -0,0 +1,422 @@
+#pragma once
+
+#include "Set.hpp"
+
+#include <atomic>
+
+namespace container {
+
+namespace detail {
+
+// ============================================================================
+/// @brief Block of 2^N elements filled concurrently.
+///
+/// Same layout as Block (raw storage plus occupancy bitfield) but the
+/// bitfield is atomic: a slot is published with a release fetch_or once its
+/// element is fully constructed, so readers observing the bit with acquire
+/// see a complete object. Slots are handed out by the owner (ConcurrentSet),
+/// never by the block itself.
+///
+/// @tparam T Element type
+/// @tparam N Log2 of block size
+// ============================================================================
+template<typename T, size_t N>
+class ConcurrentBlock
+{
+public:
+    /// @brief Number of elements this block can hold
+    static constexpr size_t Capacity = BlockSize<N>;
+
+private:
+    using bitfield_type = Bitfield<N>;
+
+public:
+    /// @brief Allocate the (uninitialized) storage
+    ConcurrentBlock()
+        : m_data(static_cast<std::byte*>(
+              ::operator new(Capacity * sizeof(T), std::align_val_t{alignof(T)})))
+    {}
+
+    ConcurrentBlock(const ConcurrentBlock&) = delete;
+    ConcurrentBlock& operator=(const ConcurrentBlock&) = delete;
+
+    /// @brief Destroy the published elements and release the storage
+    ~ConcurrentBlock()
+    {
+        clear();
+        ::operator delete(m_data, std::align_val_t{alignof(T)});
+    }
+
+    /// @brief Destroy the published elements (not thread-safe)
+    void clear() noexcept
+    {
+        for (size_t word = 0u; word < bitfield_type::NumWords; ++word)
+        {
+            const size_t bits = m_occupied[word].exchange(0u, std::memory_order_acquire);
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                bitfield_type::for_each_bit(word, bits, [this](size_t i) { std::destroy_at(slot(i)); });
+            }
+        }
+    }
+
+    /// @brief Pointer to the storage of a slot (the element may not exist yet)
+    /// @param i Index within block
+    [[nodiscard]] T* slot(size_t i) const noexcept
+    {
+        assert(i < Capacity);
+        return std::launder(reinterpret_cast<T*>(m_data)) + i;
+    }
+
+    /// @brief Mark a constructed element as visible to other threads
+    /// @param i Index within block
+    void publish(size_t i) noexcept
+    {
+        publish_range(i, i + 1u);
+    }
+
+    /// @brief Mark the constructed elements [first, last) as visible
+    void publish_range(size_t first, size_t last) noexcept
+    {
+        bitfield_type::for_each_word(first, last, [this](size_t word, size_t mask)
+        {
+            m_occupied[word].fetch_or(mask, std::memory_order_release);
+        });
+    }
+
+    /// @brief Check if the element of a slot has been published
+    /// @param i Index within block
+    [[nodiscard]] bool is_occupied(size_t i) const noexcept
+    {
+        assert(i < Capacity);
+        return (m_occupied[i / BitsPerWord].load(std::memory_order_acquire) &
+                (1ull << (i % BitsPerWord))) != 0u;
+    }
+
+    /// @brief Call fn(i) for every published slot i, in increasing order
+    template<typename Function>
+    void for_each_occupied_slot(Function&& fn) const
+    {
+        for (size_t word = 0u; word < bitfield_type::NumWords; ++word)
+        {
+            bitfield_type::for_each_bit(word, m_occupied[word].load(std::memory_order_acquire), fn);
+        }
+    }
+
+private:
+    std::byte* m_data;                                          ///< Uninitialized element storage
+    std::atomic<size_t> m_occupied[bitfield_type::NumWords]{};  ///< Published slots (Bitfield layout)
+};
+
+} // namespace detail
+
+// ============================================================================
+/// @brief Append-only Set that several threads can fill at the same time.
+///
+/// Each append claims its slot with a single atomic fetch_add on the size,
+/// then constructs the element in place without any lock. Blocks are
+/// installed with a compare-and-swap in a segmented directory (segment k
+/// holds 2^k blocks) and are never moved or reallocated, so references to
+/// elements stay valid while other threads keep appending.
+///
+/// An element can be read by another thread once occupied(index) returns
+/// true (or after joining the producer threads).
+///
+/// Key properties:
+/// - Lock-free O(1) append from any number of threads
+/// - O(1) access by index, stable references
+/// - No removal: clear() is the only way to destroy elements and must not
+///   run concurrently with anything else
+///
+/// @tparam T Element type (must be movable)
+/// @tparam N Log2 of block size (default 4 = 16 elements per block)
+///
+/// @code
+/// ConcurrentSet<Hit, 10> hits;
+/// std::vector<std::jthread> producers;
+/// for (int t = 0; t < 8; ++t) {
+///     producers.emplace_back([&hits] { hits.emplace_back(trace()); });
+/// }
+/// @endcode
+// ============================================================================
+template<typename T, size_t N = 4>
+    requires std::movable<T>
+class ConcurrentSet
+{
+    using block_type = detail::ConcurrentBlock<T, N>;
+    static constexpr size_t BlockCapacity = detail::BlockSize<N>;
+
+    /// @brief Number of directory segments: enough for any size_t index
+    static constexpr size_t MaxSegments = detail::BitsPerWord - N;
+
+public:
+    /// @brief Default constructor (empty container)
+    ConcurrentSet() = default;
+
+    ConcurrentSet(const ConcurrentSet&) = delete;
+    ConcurrentSet& operator=(const ConcurrentSet&) = delete;
+
+    /// @brief Destroy all elements and blocks
+    ~ConcurrentSet()
+    {
+        for (size_t seg = 0u; seg < MaxSegments; ++seg)
+        {
+            std::atomic<block_type*>* segment = m_segments[seg].load(std::memory_order_acquire);
+            if (segment == nullptr)
+            {
+                continue;
+            }
+            for (size_t i = 0u; i < (size_t(1) << seg); ++i)
+            {
+                delete segment[i].load(std::memory_order_acquire);
+            }
+            delete[] segment;
+        }
+    }
+
+    // ========================================================================
+    // Modifiers (thread-safe)
+    // ========================================================================
+
+    /// @brief Append a single element
+    /// @param elem Element to append
+    /// @return Reference to this container
+    ConcurrentSet& operator+=(const T& elem)
+    {
+        emplace_back(elem);
+        return *this;
+    }
+
+    /// @brief Append a single element by moving it
+    /// @param elem Element to append
+    /// @return Reference to this container
+    ConcurrentSet& operator+=(T&& elem)
+    {
+        emplace_back(std::move(elem));
+        return *this;
+    }
+
+    /// @brief Construct an element in place at the end
+    /// @param args Arguments forwarded to the constructor of T
+    /// @return Reference to the new element (stable until clear())
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    T& emplace_back(Args&&... args)
+    {
+        const size_t index = m_claimed.fetch_add(1u, std::memory_order_relaxed);
+        const size_t sid = detail::sub_index<N>(index);
+        block_type& block = get_block(detail::block_index<N>(index), sid == 0u);
+
+        T* elem = std::construct_at(block.slot(sid), std::forward<Args>(args)...);
+        block.publish(sid);
+        return *elem;
+    }
+
+    /// @brief Append multiple elements with a single atomic claim
+    /// @param data Elements to append (contiguous in the container)
+    /// @return Index of the first appended element
+    size_t append(std::span<const T> data)
+    {
+        const size_t first = m_claimed.fetch_add(data.size(), std::memory_order_relaxed);
+        size_t index = first;
+        auto src = data.begin();
+        while (src != data.end())
+        {
+            const size_t sid = detail::sub_index<N>(index);
+            const size_t chunk = std::min(static_cast<size_t>(data.end() - src), BlockCapacity - sid);
+            block_type& block = get_block(detail::block_index<N>(index), sid == 0u);
+
+            std::uninitialized_copy_n(src, chunk, block.slot(sid));
+            block.publish_range(sid, sid + chunk);
+            src += static_cast<std::ptrdiff_t>(chunk);
+            index += chunk;
+        }
+        return first;
+    }
+
+    // ========================================================================
+    // Element Access
+    // ========================================================================
+
+    /// @brief Access element without bounds checking
+    /// @param index Element index (must be published, see occupied())
+    [[nodiscard]] T& operator[](size_t index)
+    {
+        return *block_at(detail::block_index<N>(index))->slot(detail::sub_index<N>(index));
+    }
+
+    /// @brief Access element without bounds checking (const)
+    [[nodiscard]] const T& operator[](size_t index) const
+    {
+        return *block_at(detail::block_index<N>(index))->slot(detail::sub_index<N>(index));
+    }
+
+    /// @brief Access element with bounds and publication checking
+    /// @throw std::out_of_range if the element does not exist (yet)
+    [[nodiscard]] T& at(size_t index)
+    {
+        check_access(index);
+        return (*this)[index];
+    }
+
+    /// @brief Access element with bounds and publication checking (const)
+    [[nodiscard]] const T& at(size_t index) const
+    {
+        check_access(index);
+        return (*this)[index];
+    }
+
+    /// @brief Check if the element at index is fully constructed and visible
+    /// @param index Element index
+    [[nodiscard]] bool occupied(size_t index) const noexcept
+    {
+        if (index >= size())
+        {
+            return false;
+        }
+        const block_type* block = block_at(detail::block_index<N>(index));
+        return block != nullptr && block->is_occupied(detail::sub_index<N>(index));
+    }
+
+    /// @brief Apply a function to every published element, in index order
+    /// @param fn Function called as fn(T&)
+    template<typename Function>
+    void for_each(Function fn)
+    {
+        const size_t num_blocks = (size() + BlockCapacity - 1u) >> N;
+        for (size_t bid = 0u; bid < num_blocks; ++bid)
+        {
+            block_type* block = block_at(bid);
+            if (block != nullptr)
+            {
+                block->for_each_occupied_slot([block, &fn](size_t sid) { fn(*block->slot(sid)); });
+            }
+        }
+    }
+
+    // ========================================================================
+    // Capacity
+    // ========================================================================
+
+    /// @brief Get number of claimed slots (elements appended or being appended)
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_claimed.load(std::memory_order_acquire);
+    }
+
+    /// @brief Check if container is empty
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0u;
+    }
+
+    /// @brief Boolean conversion (true if not empty)
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+        return !empty();
+    }
+
+    /// @brief Get number of allocated blocks
+    [[nodiscard]] size_t block_count() const noexcept
+    {
+        return m_allocated_blocks.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Destroy all elements, keeping the blocks (not thread-safe)
+    void clear()
+    {
+        const size_t num_blocks = (size() + BlockCapacity - 1u) >> N;
+        for (size_t bid = 0u; bid < num_blocks; ++bid)
+        {
+            if (block_type* block = block_at(bid))
+            {
+                block->clear();
+            }
+        }
+        m_claimed.store(0u, std::memory_order_release);
+    }
+
+private:
+    /// @brief Locate a block in the directory: segment k holds the blocks
+    ///        [2^k - 1, 2^(k+1) - 1)
+    /// @return {segment, offset within segment}
+    [[nodiscard]] static constexpr std::pair<size_t, size_t> locate(size_t bid) noexcept
+    {
+        const size_t segment = static_cast<size_t>(std::bit_width(bid + 1u)) - 1u;
+        return {segment, bid + 1u - (size_t(1) << segment)};
+    }
+
+    /// @brief Get an existing block, nullptr if not allocated yet
+    [[nodiscard]] block_type* block_at(size_t bid) const noexcept
+    {
+        const auto [segment, offset] = locate(bid);
+        std::atomic<block_type*>* blocks = m_segments[segment].load(std::memory_order_acquire);
+        return (blocks == nullptr) ? nullptr : blocks[offset].load(std::memory_order_acquire);
+    }
+
+    /// @brief Get a block, installing it if needed
+    /// @param bid Block index
+    /// @param prepare_next Also install the following block, so that the
+    ///        threads that will soon claim it do not race to allocate it
+    block_type& get_block(size_t bid, bool prepare_next)
+    {
+        block_type& block = install_block(bid);
+        if (prepare_next)
+        {
+            install_block(bid + 1u);
+        }
+        return block;
+    }
+
+    /// @brief Install a block with compare-and-swap (the loser frees its copy)
+    block_type& install_block(size_t bid)
+    {
+        const auto [segment, offset] = locate(bid);
+        std::atomic<block_type*>* blocks = m_segments[segment].load(std::memory_order_acquire);
+        if (blocks == nullptr)
+        {
+            auto* fresh = new std::atomic<block_type*>[size_t(1) << segment]();
+            if (m_segments[segment].compare_exchange_strong(blocks, fresh, std::memory_order_acq_rel))
+            {
+                blocks = fresh;
+            }
+            else
+            {
+                delete[] fresh;
+            }
+        }
+
+        block_type* block = blocks[offset].load(std::memory_order_acquire);
+        if (block == nullptr)
+        {
+            auto* fresh = new block_type();
+            if (blocks[offset].compare_exchange_strong(block, fresh, std::memory_order_acq_rel))
+            {
+                block = fresh;
+                m_allocated_blocks.fetch_add(1u, std::memory_order_relaxed);
+            }
+            else
+            {
+                delete fresh;
+            }
+        }
+        return *block;
+    }
+
+    /// @brief Check if access to index is valid
+    /// @throw std::out_of_range if invalid
+    void check_access(size_t index) const
+    {
+        if (!occupied(index))
+        {
+            throw std::out_of_range("ConcurrentSet::at - index " + std::to_string(index) +
+                                    " is not available (size=" + std::to_string(size()) + ")");
+        }
+    }
+
+    std::atomic<std::atomic<block_type*>*> m_segments[MaxSegments]{};  ///< Block directory
+    std::atomic<size_t> m_claimed{0u};                                 ///< Claimed slots
+    std::atomic<size_t> m_allocated_blocks{0u};                        ///< Installed blocks
+};
+
+} // namespace container
@@ -0,0 +1,496 @@
+#pragma once
+
+#include "Set.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(__linux__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace container {
+
+// ============================================================================
+/// @brief How open_mmap() maps a file in memory
+// ============================================================================
+enum class MapMode
+{
+    ReadOnly,     ///< Pages are shared with the file and must not be written
+    CopyOnWrite,  ///< Writes go to private copies of the pages, the file never changes
+    Shared        ///< Writes go to the file, sync() makes them durable
+};
+
+// ============================================================================
+/// @brief A whole file mapped in memory.
+///
+/// On Linux the file is mapped with mmap(): a page is only read from disk the
+/// first time it is touched, so opening a huge file costs a few system calls.
+/// On other systems the file is read into memory at once, which keeps the
+/// ReadOnly and CopyOnWrite modes working without the lazy loading; the
+/// Shared mode is not available there.
+// ============================================================================
+class MappedFile
+{
+public:
+    /// @brief Map a file
+    /// @param path File to map
+    /// @param mode Access mode
+    /// @throw std::system_error if the file cannot be opened or mapped
+    MappedFile(const std::filesystem::path& path, MapMode mode)
+        : m_path(path), m_mode(mode)
+    {
+#if defined(__linux__)
+        const int fd = ::open(path.c_str(), (mode == MapMode::Shared) ? O_RDWR : O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "MappedFile - cannot open " + path.string());
+        }
+
+        struct stat info{};
+        void* base = MAP_FAILED;
+        int error = EINVAL;  // An empty file cannot be mapped
+        if (::fstat(fd, &info) != 0)
+        {
+            error = errno;
+        }
+        else if (info.st_size > 0)
+        {
+            m_size = static_cast<size_t>(info.st_size);
+            const int protection = (mode == MapMode::ReadOnly) ? PROT_READ : (PROT_READ | PROT_WRITE);
+            const int flags = (mode == MapMode::CopyOnWrite) ? MAP_PRIVATE : MAP_SHARED;
+            base = ::mmap(nullptr, m_size, protection, flags, fd, 0);
+            error = errno;
+        }
+        ::close(fd);  // The mapping keeps its own reference on the file
+        if (base == MAP_FAILED)
+        {
+            throw std::system_error(error, std::generic_category(),
+                                    "MappedFile - cannot map " + path.string());
+        }
+        m_data = static_cast<std::byte*>(base);
+#else
+        if (mode == MapMode::Shared)
+        {
+            throw std::system_error(std::make_error_code(std::errc::operation_not_supported),
+                                    "MappedFile - shared mapping of " + path.string());
+        }
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+        {
+            throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory),
+                                    "MappedFile - cannot open " + path.string());
+        }
+        m_size = static_cast<size_t>(in.tellg());
+        m_data = static_cast<std::byte*>(::operator new(m_size, std::align_val_t{page_size()}));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(m_data), static_cast<std::streamsize>(m_size));
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief Unmap the file (unsynchronized Shared writes still reach the
+    ///        file eventually, through the page cache)
+    ~MappedFile()
+    {
+#if defined(__linux__)
+        ::munmap(m_data, m_size);
+#else
+        ::operator delete(m_data, std::align_val_t{page_size()});
+#endif
+    }
+
+    /// @brief First byte of the file (page aligned)
+    [[nodiscard]] std::byte* data() const noexcept
+    {
+        return m_data;
+    }
+
+    /// @brief Size of the file in bytes
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /// @brief Access mode of the mapping
+    [[nodiscard]] MapMode mode() const noexcept
+    {
+        return m_mode;
+    }
+
+    /// @brief Path of the mapped file
+    [[nodiscard]] const std::filesystem::path& path() const noexcept
+    {
+        return m_path;
+    }
+
+    /// @brief Write the pages covering [offset, offset + bytes) back to the
+    ///        file and wait for completion (Shared mode only)
+    /// @throw std::system_error if msync() fails
+    void sync(size_t offset, size_t bytes) const
+    {
+        assert(m_mode == MapMode::Shared && offset + bytes <= m_size);
+#if defined(__linux__)
+        const size_t first = offset & ~(page_size() - 1u);
+        if (::msync(m_data + first, offset + bytes - first, MS_SYNC) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "MappedFile::sync - msync failed on " + m_path.string());
+        }
+#else
+        (void) offset;
+        (void) bytes;
+#endif
+    }
+
+    /// @brief Granularity of sync()
+    [[nodiscard]] static size_t page_size() noexcept
+    {
+#if defined(__linux__)
+        static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+#else
+        return 4096u;
+#endif
+    }
+
+private:
+    std::filesystem::path m_path;  ///< Mapped file
+    MapMode m_mode;                ///< Access mode
+    std::byte* m_data = nullptr;   ///< First byte of the mapping
+    size_t m_size = 0u;            ///< Size of the mapping
+};
+
+namespace detail {
+
+// ============================================================================
+/// @brief Header of the files written by save() and mapped by open_mmap().
+///
+/// The file is the header, the occupancy bitfields of all blocks, then the
+/// element storage of all blocks, each section starting on a page boundary
+/// so that the element arrays can be used in place once mapped. Values are
+/// in native byte order: files are not portable across architectures.
+// ============================================================================
+struct FileHeader
+{
+    /// @brief Alignment of each section in the file
+    static constexpr uint64_t SectionAlignment = 4096u;
+    /// @brief Format version written by this code
+    static constexpr uint32_t CurrentVersion = 1u;
+
+    char magic[8];           ///< "BLKCONT" and a null character
+    uint32_t version;        ///< Format version
+    uint32_t element_size;   ///< sizeof(T)
+    uint32_t element_align;  ///< alignof(T)
+    uint32_t block_log2;     ///< N
+    uint64_t element_count;  ///< Number of occupied slots
+    uint64_t block_count;    ///< Number of blocks
+    uint64_t bitfield_offset;///< Offset of the occupancy bitfields
+    uint64_t data_offset;    ///< Offset of the element storage
+};
+
+/// @brief Magic bytes starting every file written by save()
+inline constexpr char FileMagic[8] = {'B', 'L', 'K', 'C', 'O', 'N', 'T', '\0'};
+
+// ============================================================================
+/// @brief Reads and writes the blocks of a Set or a Collection, as a friend
+///        of ContainerBase. Use save(), sync() and open_mmap() below.
+// ============================================================================
+struct Persistence
+{
+    /// @brief Pending runs closer than this (in bytes) are synced together
+    static constexpr size_t SyncMergeGap = size_t(1) << 20;
+
+    /// @brief Header describing the file of num_blocks blocks of self
+    template<typename T, size_t N>
+    [[nodiscard]] static FileHeader make_header(const ContainerBase<T, N>& self, size_t num_blocks) noexcept
+    {
+        constexpr uint64_t alignment = FileHeader::SectionAlignment;
+        auto align = [](uint64_t offset) { return (offset + alignment - 1u) & ~(alignment - 1u); };
+
+        FileHeader header{};
+        std::memcpy(header.magic, FileMagic, sizeof(header.magic));
+        header.version = FileHeader::CurrentVersion;
+        header.element_size = static_cast<uint32_t>(sizeof(T));
+        header.element_align = static_cast<uint32_t>(alignof(T));
+        header.block_log2 = static_cast<uint32_t>(N);
+        header.element_count = self.m_stored_elements;
+        header.block_count = num_blocks;
+        header.bitfield_offset = align(sizeof(FileHeader));
+        header.data_offset = align(header.bitfield_offset +
+                                   num_blocks * Block<T, N>::NumBitfieldWords * sizeof(size_t));
+        return header;
+    }
+
+    /// @brief Implementation of save()
+    template<typename T, size_t N>
+    static void save(const ContainerBase<T, N>& self, const std::filesystem::path& path)
+    {
+        constexpr size_t block_bytes = ContainerBase<T, N>::BlockBytes;
+        if (self.m_mapping != nullptr && std::filesystem::exists(path) &&
+            std::filesystem::equivalent(path, self.m_mapping->path()))
+        {
+            throw std::invalid_argument("save - " + path.string() + " is mapped by this container");
+        }
+
+        const FileHeader header = make_header(self, self.m_blocks.size());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        auto write = [&out](const void* data, size_t bytes)
+        {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        };
+        auto pad_to = [&out](uint64_t offset)
+        {
+            const auto position = static_cast<uint64_t>(out.tellp());
+            for (uint64_t i = position; i < offset; ++i)
+            {
+                out.put('\0');
+            }
+        };
+
+        write(&header, sizeof(header));
+        pad_to(header.bitfield_offset);
+        for (const auto& block : self.m_blocks)
+        {
+            write(block->occupancy_bitfield(), Block<T, N>::NumBitfieldWords * sizeof(size_t));
+        }
+        pad_to(header.data_offset);
+        const std::vector<char> empty_block(block_bytes, '\0');
+        for (const auto& block : self.m_blocks)
+        {
+            write(block->is_allocated() ? static_cast<const void*>(std::as_const(*block).data())
+                                        : empty_block.data(), block_bytes);
+        }
+
+        out.flush();
+        if (!out)
+        {
+            throw std::system_error(errno, std::generic_category(), "save - cannot write " + path.string());
+        }
+    }
+
+    /// @brief Implementation of sync()
+    template<typename T, size_t N>
+    static size_t sync(ContainerBase<T, N>& self)
+    {
+        constexpr size_t block_bytes = ContainerBase<T, N>::BlockBytes;
+        MappedFile* const mapping = self.m_mapping.get();
+        if (mapping == nullptr || mapping->mode() != MapMode::Shared)
+        {
+            throw std::logic_error("sync - container is not mapped in shared mode");
+        }
+
+        std::byte* const base = mapping->data();
+        FileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        for (size_t bid = 0u; bid < self.m_blocks.size(); ++bid)
+        {
+            const auto* storage = reinterpret_cast<const std::byte*>(std::as_const(*self.m_blocks[bid]).data());
+            if (bid >= header.block_count || storage != base + header.data_offset + bid * block_bytes)
+            {
+                throw std::length_error("sync - blocks were added after mapping " +
+                                        mapping->path().string() + ", use save()");
+            }
+        }
+
+        // Elements: one msync per group of close pending runs
+        size_t first = 0u;
+        size_t last = 0u;
+        const size_t synced = self.flush_pending([&](std::span<const T> run)
+        {
+            const auto begin = static_cast<size_t>(reinterpret_cast<const std::byte*>(run.data()) - base);
+            if (last != 0u && begin - last > SyncMergeGap)
+            {
+                mapping->sync(first, last - first);
+                last = 0u;
+            }
+            first = (last == 0u) ? begin : first;
+            last = begin + run.size_bytes();
+        });
+        if (last != 0u)
+        {
+            mapping->sync(first, last - first);
+        }
+
+        // Occupancy bitfields: copy and flush the words that changed
+        constexpr size_t bitfield_bytes = Block<T, N>::NumBitfieldWords * sizeof(size_t);
+        const size_t no_bits[Block<T, N>::NumBitfieldWords] = {};
+        size_t changed_first = 0u;
+        size_t changed_last = 0u;
+        for (size_t bid = 0u; bid < header.block_count; ++bid)
+        {
+            const size_t* bits = (bid < self.m_blocks.size()) ? self.m_blocks[bid]->occupancy_bitfield() : no_bits;
+            const size_t offset = header.bitfield_offset + bid * bitfield_bytes;
+            if (std::memcmp(base + offset, bits, bitfield_bytes) != 0)
+            {
+                std::memcpy(base + offset, bits, bitfield_bytes);
+                changed_first = (changed_last == 0u) ? offset : changed_first;
+                changed_last = offset + bitfield_bytes;
+            }
+        }
+        if (changed_last != 0u)
+        {
+            mapping->sync(changed_first, changed_last - changed_first);
+        }
+
+        if (header.element_count != self.m_stored_elements)
+        {
+            header.element_count = self.m_stored_elements;
+            std::memcpy(base, &header, sizeof(header));
+            mapping->sync(0u, sizeof(header));
+        }
+        return synced;
+    }
+
+    /// @brief Replace the content of self by the blocks of a file written by
+    ///        save(). The element storage is used in place, only the
+    ///        occupancy bitfields are copied.
+    /// @throw std::runtime_error if the file was not saved from a container
+    ///        of the same T and N, is truncated, or does not suit self
+    template<typename T, size_t N>
+        requires std::is_trivially_copyable_v<T>
+    static void map_blocks(ContainerBase<T, N>& self, const std::filesystem::path& path, MapMode mode)
+    {
+        constexpr size_t block_bytes = ContainerBase<T, N>::BlockBytes;
+        auto file = std::make_shared<MappedFile>(path, mode);
+        auto fail = [&path](const char* reason)
+        {
+            throw std::runtime_error("open_mmap - " + path.string() + ": " + reason);
+        };
+
+        FileHeader header;
+        if (file->size() < sizeof(header))
+        {
+            fail("file too small");
+        }
+        std::memcpy(&header, file->data(), sizeof(header));
+        if (std::memcmp(header.magic, FileMagic, sizeof(header.magic)) != 0 ||
+            header.version != FileHeader::CurrentVersion)
+        {
+            fail("not a container file");
+        }
+        if (header.element_size != sizeof(T) || header.element_align != alignof(T) ||
+            header.block_log2 != N)
+        {
+            fail("saved from a container of another element type or block size");
+        }
+        const FileHeader expected = make_header(self, static_cast<size_t>(header.block_count));
+        if (header.bitfield_offset != expected.bitfield_offset ||
+            header.data_offset != expected.data_offset ||
+            header.data_offset > file->size() ||
+            header.block_count > (file->size() - header.data_offset) / block_bytes)
+        {
+            fail("truncated or corrupted file");
+        }
+
+        std::vector<std::unique_ptr<Block<T, N>>> blocks;
+        blocks.reserve(static_cast<size_t>(header.block_count));
+        size_t stored = 0u;
+        size_t bits[Block<T, N>::NumBitfieldWords];
+        for (size_t bid = 0u; bid < header.block_count; ++bid)
+        {
+            auto block = std::make_unique<Block<T, N>>(file->data() + header.data_offset + bid * block_bytes);
+            std::memcpy(bits, file->data() + header.bitfield_offset + bid * sizeof(bits), sizeof(bits));
+            block->adopt_occupancy(bits);
+            stored += block->occupation();
+            blocks.push_back(std::move(block));
+        }
+        if (stored != header.element_count)
+        {
+            fail("element count does not match the occupancy bitfields");
+        }
+
+        self.release_blocks();
+        self.m_blocks = std::move(blocks);
+        self.m_stored_elements = stored;
+        self.m_mapping = std::move(file);
+        if (const char* reason = self.adopt_mapped_blocks())
+        {
+            fail(reason);
+        }
+    }
+};
+
+} // namespace detail
+
+// ============================================================================
+// Persistence (trivially copyable elements only)
+// ============================================================================
+
+/// @brief Write the blocks of a Set or a Collection and their occupancy
+///        bitfields to a file that open_mmap() maps back without
+///        deserializing anything
+/// @param container Container to write
+/// @param path Destination file (replaced), must not be the file the
+///        container is mapped from
+/// @throw std::system_error if the file cannot be written
+/// @throw std::invalid_argument if path is the mapped file
+template<typename T, size_t N>
+    requires std::is_trivially_copyable_v<T>
+void save(const detail::ContainerBase<T, N>& container, const std::filesystem::path& path)
+{
+    detail::Persistence::save(container, path);
+}
+
+/// @brief Write the modified elements of a container opened with
+///        MapMode::Shared back to its file, then clear the pending state
+/// @return Number of synchronized elements
+/// @throw std::logic_error if the container is not mapped in Shared mode
+/// @throw std::length_error if blocks were added since the file was
+///        mapped (use save() instead)
+///
+/// Only the pages holding pending elements are written. Every msync()
+/// waits for its own I/O while the kernel only writes back the dirty
+/// pages of the range it is given, so pending runs less than
+/// Persistence::SyncMergeGap bytes apart share one call. The changed
+/// occupancy words and the element count follow.
+template<typename T, size_t N>
+    requires std::is_trivially_copyable_v<T>
+size_t sync(detail::ContainerBase<T, N>& container)
+{
+    return detail::Persistence::sync(container);
+}
+
+/// @brief Open a file written by save(), using its blocks in place
+/// @tparam Container Set<T, N> or Collection<T, N>
+/// @param path File to map (a Collection opens files of both containers,
+///        a Set only files without holes)
+/// @param mode ReadOnly (the container must not be modified), CopyOnWrite
+///        (modifications stay in memory) or Shared (modifications go to
+///        the file, see sync())
+/// @return Container whose elements live in the mapped file
+/// @throw std::system_error if the file cannot be mapped
+/// @throw std::runtime_error if the file does not hold elements of T with
+///        blocks of 2^N, or holds holes and Container is a Set
+///
+/// Pages are loaded on first access: opening a file of any size only
+/// costs the copy of its occupancy bitfields (one bit per element).
+/// Elements appended past the mapped blocks live in regular memory and
+/// are only persisted by the next save().
+///
+/// @code
+/// save(points, "points.bin");
+/// auto mapped = open_mmap<Set<Point>>("points.bin", MapMode::ReadOnly);
+/// @endcode
+template<typename Container>
+[[nodiscard]] Container open_mmap(const std::filesystem::path& path, MapMode mode = MapMode::ReadOnly)
+{
+    Container container;
+    detail::Persistence::map_blocks(container, path, mode);
+    return container;
+}
+
+} // namespace container
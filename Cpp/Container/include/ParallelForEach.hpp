@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Set.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <execution>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace container {
+
+// ============================================================================
+/// @brief Apply a function to every element of a Set, handing out whole
+///        blocks to worker threads.
+///
+/// Kept out of Set.hpp: <execution> makes libstdc++ pull in TBB, and the
+/// workers need the thread library, so only the users of this header link
+/// against them.
+///
+/// @param policy std::execution policy. Sequenced policies run on the
+///        calling thread, other policies spread the blocks over
+///        std::thread::hardware_concurrency() threads.
+/// @param set Container whose elements are visited
+/// @param fn Function called as fn(T&) for each element. It must be safe
+///        to call concurrently on distinct elements.
+///
+/// @code
+/// Set<float> speeds = ...;
+/// parallel_for_each(std::execution::par, speeds, [](float& v) { v *= 0.5f; });
+/// @endcode
+// ============================================================================
+template<typename ExecutionPolicy, typename T, size_t N, typename Function>
+    requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+void parallel_for_each(ExecutionPolicy&&, Set<T, N>& set, Function fn)
+{
+    auto blocks = set.segments();
+    const auto num_blocks = static_cast<size_t>(std::ranges::size(blocks));
+    auto process = [&blocks, &fn](size_t bid)
+    {
+        for (T& element : blocks[static_cast<std::ptrdiff_t>(bid)])
+        {
+            fn(element);
+        }
+    };
+
+    using Policy = std::remove_cvref_t<ExecutionPolicy>;
+    if constexpr (std::is_same_v<Policy, std::execution::sequenced_policy> ||
+                  std::is_same_v<Policy, std::execution::unsequenced_policy>)
+    {
+        for (size_t bid = 0u; bid < num_blocks; ++bid)
+        {
+            process(bid);
+        }
+    }
+    else
+    {
+        const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        const size_t workers = std::min(num_blocks, hardware);
+        std::atomic<size_t> next_block{0u};
+        auto worker = [&next_block, num_blocks, &process]()
+        {
+            for (size_t bid = next_block.fetch_add(1u, std::memory_order_relaxed);
+                 bid < num_blocks;
+                 bid = next_block.fetch_add(1u, std::memory_order_relaxed))
+            {
+                process(bid);
+            }
+        };
+
+        std::vector<std::jthread> threads;
+        threads.reserve(workers);
+        for (size_t i = 1u; i < workers; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+    }
+}
+
+} // namespace container
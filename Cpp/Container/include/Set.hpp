@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <bit>
 #include <cassert>
@@ -9,7 +10,12 @@
 #include <span>
 #include <initializer_list>
 #include <iterator>
+#include <ranges>
 #include <concepts>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <string>
 
 namespace container {
 
@@ -65,6 +71,25 @@ template<size_t N>
     return modulo_pow2<N>(index);
 }
 
+/// @brief Store a value built from args into an existing slot.
+/// A single argument of type T is assigned directly (copy or move), anything
+/// else constructs a temporary that is moved into the slot.
+/// @param slot Destination element
+/// @param args Arguments forwarded to the constructor of T
+template<typename T, typename... Args>
+void assign_from(T& slot, Args&&... args)
+{
+    if constexpr (sizeof...(Args) == 1u &&
+                  (std::is_same_v<std::remove_cvref_t<Args>, T> && ...))
+    {
+        slot = (std::forward<Args>(args), ...);
+    }
+    else
+    {
+        slot = T(std::forward<Args>(args)...);
+    }
+}
+
 // ============================================================================
 /// @brief Tracks the smallest contiguous range of modified elements.
 ///
@@ -162,11 +187,282 @@ protected:
     size_t m_pending_end = npos;    ///< End of dirty range (exclusive)
 };
 
+// ============================================================================
+/// @brief One bit per slot of a block of 2^N slots, stored in size_t words.
+///
+/// Block, SoABlock and ConcurrentBlock keep their occupancy in this format.
+/// The static helpers only do the word and mask arithmetic, so that
+/// ConcurrentBlock can apply them to its atomic words.
+///
+/// @tparam N Log2 of the number of bits
+// ============================================================================
+template<size_t N>
+class Bitfield
+{
+public:
+    /// @brief Number of bits
+    static constexpr size_t Capacity = BlockSize<N>;
+
+    /// @brief Number of words
+    static constexpr size_t NumWords = BitfieldWords<N>;
+
+    /// @brief Bitmask of count consecutive bits starting at bit
+    [[nodiscard]] static constexpr size_t range_mask(size_t bit, size_t count) noexcept
+    {
+        return (count == BitsPerWord) ? ~size_t(0) : (((size_t(1) << count) - 1u) << bit);
+    }
+
+    /// @brief Call op(word, mask) for every word covering the bits
+    ///        [first, last), mask selecting the bits of the range in it
+    template<typename Operation>
+    static void for_each_word(size_t first, size_t last, Operation&& op)
+    {
+        assert(first <= last && last <= Capacity);
+        while (first < last)
+        {
+            const size_t word = first / BitsPerWord;
+            const size_t bit = first % BitsPerWord;
+            const size_t count = std::min(last - first, BitsPerWord - bit);
+            op(word, range_mask(bit, count));
+            first += count;
+        }
+    }
+
+    /// @brief Call fn(i) for every bit set in bits, the value of word
+    ///        number word, in increasing order
+    template<typename Function>
+    static void for_each_bit(size_t word, size_t bits, Function&& fn)
+    {
+        for (; bits != 0u; bits &= bits - 1u)
+        {
+            fn(word * BitsPerWord + static_cast<size_t>(std::countr_zero(bits)));
+        }
+    }
+
+    /// @brief Check if bit i is set
+    [[nodiscard]] bool test(size_t i) const noexcept
+    {
+        assert(i < Capacity);
+        return (m_words[i / BitsPerWord] & (size_t(1) << (i % BitsPerWord))) != 0u;
+    }
+
+    /// @brief Set bit i
+    void set(size_t i) noexcept
+    {
+        assert(i < Capacity);
+        m_words[i / BitsPerWord] |= size_t(1) << (i % BitsPerWord);
+    }
+
+    /// @brief Clear bit i
+    void reset(size_t i) noexcept
+    {
+        assert(i < Capacity);
+        m_words[i / BitsPerWord] &= ~(size_t(1) << (i % BitsPerWord));
+    }
+
+    /// @brief Set the bits [first, last), one word at a time
+    void set_range(size_t first, size_t last) noexcept
+    {
+        for_each_word(first, last, [this](size_t word, size_t mask) { m_words[word] |= mask; });
+    }
+
+    /// @brief Clear the bits [first, last), one word at a time
+    void reset_range(size_t first, size_t last) noexcept
+    {
+        for_each_word(first, last, [this](size_t word, size_t mask) { m_words[word] &= ~mask; });
+    }
+
+    /// @brief Clear the bits [first, last), calling fn(i) first for each of
+    ///        them that was set. Words without any set bit in the range
+    ///        cost one test.
+    template<typename Function>
+    void reset_range(size_t first, size_t last, Function&& fn)
+    {
+        for_each_word(first, last, [this, &fn](size_t word, size_t mask)
+        {
+            for_each_bit(word, m_words[word] & mask, fn);
+            m_words[word] &= ~mask;
+        });
+    }
+
+    /// @brief Clear all bits
+    void reset() noexcept
+    {
+        for (size_t& word : m_words)
+        {
+            word = 0u;
+        }
+    }
+
+    /// @brief Number of set bits, using popcount
+    [[nodiscard]] size_t count() const noexcept
+    {
+        size_t total = 0u;
+        for (const size_t word : m_words)
+        {
+            total += static_cast<size_t>(std::popcount(word));
+        }
+        return total;
+    }
+
+    /// @brief Find the first set bit at or after i, scanning whole words
+    ///        with countr_zero
+    /// @param i Bit index [0, Capacity]
+    /// @return Index of the bit, or Capacity if there is none
+    [[nodiscard]] size_t next_set(size_t i) const noexcept
+    {
+        if (i >= Capacity)
+        {
+            return Capacity;
+        }
+        size_t word = i / BitsPerWord;
+        size_t bits = m_words[word] & (~size_t(0) << (i % BitsPerWord));
+        while (bits == 0u)
+        {
+            if (++word == NumWords)
+            {
+                return Capacity;
+            }
+            bits = m_words[word];
+        }
+        return word * BitsPerWord + static_cast<size_t>(std::countr_zero(bits));
+    }
+
+    /// @brief Find the first clear bit at or after i
+    /// @param i Bit index [0, Capacity]
+    /// @return Index of the bit, or Capacity if all are set
+    [[nodiscard]] size_t next_clear(size_t i) const noexcept
+    {
+        if (i >= Capacity)
+        {
+            return Capacity;
+        }
+        size_t word = i / BitsPerWord;
+        size_t bits = ~m_words[word] & (~size_t(0) << (i % BitsPerWord));
+        while (bits == 0u)
+        {
+            if (++word == NumWords)
+            {
+                return Capacity;
+            }
+            bits = ~m_words[word];
+        }
+        // With fewer bits than a word, the bits above Capacity read as clear
+        return std::min(word * BitsPerWord + static_cast<size_t>(std::countr_zero(bits)), Capacity);
+    }
+
+    /// @brief Find the last set bit strictly before i, scanning whole words
+    ///        with countl_zero
+    /// @param i Bit index [0, Capacity]
+    /// @return Index of the bit, or Capacity if there is none
+    [[nodiscard]] size_t prev_set(size_t i) const noexcept
+    {
+        if (i == 0u)
+        {
+            return Capacity;
+        }
+        --i;
+        size_t word = i / BitsPerWord;
+        const size_t bit = i % BitsPerWord;
+        size_t bits = m_words[word] & (~size_t(0) >> (BitsPerWord - 1u - bit));
+        while (bits == 0u)
+        {
+            if (word-- == 0u)
+            {
+                return Capacity;
+            }
+            bits = m_words[word];
+        }
+        return word * BitsPerWord + (BitsPerWord - 1u) - static_cast<size_t>(std::countl_zero(bits));
+    }
+
+    /// @brief Bits of the word holding bit i, keeping only bit i and above
+    [[nodiscard]] size_t word_from(size_t i) const noexcept
+    {
+        assert(i < Capacity);
+        return m_words[i / BitsPerWord] & (~size_t(0) << (i % BitsPerWord));
+    }
+
+    /// @brief Call fn(i) for every set bit i, in increasing order
+    template<typename Function>
+    void for_each_set(Function&& fn) const
+    {
+        for (size_t word = 0u; word < NumWords; ++word)
+        {
+            for_each_bit(word, m_words[word], fn);
+        }
+    }
+
+    /// @brief Call fn(first, last) for every maximal run [first, last) of
+    ///        set bits, in increasing order
+    template<typename Function>
+    void for_each_run(Function&& fn) const
+    {
+        constexpr size_t npos = static_cast<size_t>(-1);
+        size_t run_start = npos;
+        for (size_t word = 0u; word < NumWords; ++word)
+        {
+            const size_t bits = m_words[word];
+            const size_t base = word * BitsPerWord;
+            size_t pos = 0u;
+            while (pos < BitsPerWord)
+            {
+                if (run_start == npos)
+                {
+                    const size_t rest = bits >> pos;
+                    if (rest == 0u)
+                    {
+                        break;
+                    }
+                    pos += static_cast<size_t>(std::countr_zero(rest));
+                    run_start = base + pos;
+                }
+                pos += static_cast<size_t>(std::countr_one(bits >> pos));
+                if (pos < BitsPerWord)
+                {
+                    fn(run_start, base + pos);
+                    run_start = npos;
+                }
+            }
+        }
+        if (run_start != npos)
+        {
+            fn(run_start, Capacity);
+        }
+    }
+
+    /// @brief Raw words: bit b of word w stands for bit w * BitsPerWord + b
+    [[nodiscard]] const size_t* words() const noexcept
+    {
+        return m_words;
+    }
+
+    /// @brief Overwrite all words, dropping the bits above Capacity
+    /// @param words NumWords words, as given by words()
+    void assign(const size_t* words) noexcept
+    {
+        for (size_t i = 0u; i < NumWords; ++i)
+        {
+            m_words[i] = words[i];
+        }
+        if constexpr (Capacity < BitsPerWord)
+        {
+            m_words[0] &= range_mask(0u, Capacity);
+        }
+    }
+
+private:
+    size_t m_words[NumWords]{};  ///< The bits, low bits first
+};
+
 // ============================================================================
 /// @brief A contiguous block of M = 2^N elements with occupancy tracking.
 ///
-/// Each block stores elements in a contiguous array and uses a bitfield to
-/// track which slots are occupied. This allows O(1) insertion/removal.
+/// Each block owns raw, suitably aligned storage for 2^N elements and uses a
+/// bitfield to track which slots are occupied. Elements only exist in
+/// occupied slots: they are constructed when their bit is set and destroyed
+/// when it is cleared, so T does not need to be default constructible and
+/// empty slots cost nothing but (untouched) memory.
 ///
 /// @tparam T Element type
 /// @tparam N Log2 of block size (block holds 2^N elements)
@@ -178,11 +474,9 @@ public:
     /// @brief Number of elements this block can hold
     static constexpr size_t Capacity = BlockSize<N>;
 
-private:
     /// @brief Number of words in the occupancy bitfield
-    static constexpr size_t NumBitfieldWords = BitfieldWords<N>;
+    static constexpr size_t NumBitfieldWords = Bitfield<N>::NumWords;
 
-public:
     /// @brief Construct a block, optionally deferring memory allocation
     /// @param lazy_allocation If true, defer allocation until first access
     explicit Block(bool lazy_allocation = false)
@@ -190,21 +484,87 @@ public:
     {
         if (!lazy_allocation)
         {
-            m_data = std::make_unique<T[]>(Capacity);
+            ensure_allocated();
         }
-        clear();
+        clear_pending();
     }
 
-    /// @brief Clear occupancy bitfield (mark all slots as empty)
-    void clear() noexcept
+    /// @brief Construct a block on externally owned storage (e.g. an arena)
+    /// @param storage Uninitialized memory for Capacity elements, aligned for
+    ///        T. It must outlive the block and is not freed by it.
+    explicit Block(std::byte* storage) noexcept
+        : PendingData(), m_data(storage), m_owns_storage(false)
+    {}
+
+    Block(const Block&) = delete;
+    Block& operator=(const Block&) = delete;
+
+    /// @brief Destroy the stored elements and release the storage
+    ~Block()
     {
-        for (size_t i = 0u; i < NumBitfieldWords; ++i)
+        destroy_range(0u, Capacity);
+        if (m_data != nullptr && m_owns_storage)
         {
-            m_occupied[i] = 0u;
+            ::operator delete(m_data, std::align_val_t{alignof(T)});
         }
+    }
+
+    /// @brief Destroy all elements and mark all slots as empty
+    void clear() noexcept
+    {
+        destroy_range(0u, Capacity);
         clear_pending();
     }
 
+    // ------------------------------------------------------------------------
+    // Pending data: the inherited [start, end) span is kept for coarse
+    // queries, and a dirty bit per slot records exactly what was modified.
+    // ------------------------------------------------------------------------
+
+    /// @brief Reset pending state (no dirty elements)
+    void clear_pending() noexcept
+    {
+        PendingData::clear_pending();
+        m_dirty.reset();
+    }
+
+    /// @brief Mark a slot as modified
+    /// @param pos Index within block
+    void tag_as_pending(size_t pos) noexcept
+    {
+        PendingData::tag_as_pending(pos);
+        m_dirty.set(pos);
+    }
+
+    /// @brief Mark the slots [pos_start, pos_end) as modified
+    /// @param pos_start First index within block
+    /// @param pos_end End index within block (exclusive)
+    void tag_as_pending(size_t pos_start, size_t pos_end) noexcept
+    {
+        if (pos_start >= pos_end)
+        {
+            return;
+        }
+        PendingData::tag_as_pending(pos_start, pos_end);
+        m_dirty.set_range(pos_start, pos_end);
+    }
+
+    /// @brief Check if a slot has been modified since the last clear_pending()
+    /// @param pos Index within block
+    [[nodiscard]] bool is_pending(size_t pos) const noexcept
+    {
+        return m_dirty.test(pos);
+    }
+
+    /// @brief Call fn(first, last) for every maximal run [first, last) of
+    ///        modified slots, in increasing order
+    /// @param fn Function taking the bounds of the run within the block
+    template<typename Function>
+    void for_each_pending_run(Function&& fn) const
+    {
+        m_dirty.for_each_run(std::forward<Function>(fn));
+    }
+
     /// @brief Get block capacity
     /// @return Number of elements the block can hold (2^N)
     [[nodiscard]] static constexpr size_t capacity() noexcept
@@ -216,32 +576,27 @@ public:
     /// @return Number of elements currently stored in this block
     [[nodiscard]] size_t occupation() const noexcept
     {
-        size_t total = 0u;
-        for (size_t i = 0u; i < NumBitfieldWords; ++i)
-        {
-            total += static_cast<size_t>(std::popcount(m_occupied[i]));
-        }
-        return total;
+        return m_occupied.count();
     }
 
-    /// @brief Access element at index (allocates if needed)
-    /// @param i Index within block [0, Capacity)
+    /// @brief Access element at index
+    /// @param i Index within block [0, Capacity), must be occupied
     /// @return Reference to element
     [[nodiscard]] T& operator[](size_t i)
     {
         assert(i < Capacity);
-        ensure_allocated();
-        return m_data[i];
+        assert(m_data != nullptr);
+        return data()[i];
     }
 
     /// @brief Access element at index (const version)
-    /// @param i Index within block [0, Capacity)
+    /// @param i Index within block [0, Capacity), must be occupied
     /// @return Const reference to element
     [[nodiscard]] const T& operator[](size_t i) const
     {
         assert(i < Capacity);
         assert(m_data != nullptr);
-        return m_data[i];
+        return data()[i];
     }
 
     /// @brief Check if a slot is occupied
@@ -249,30 +604,112 @@ public:
     /// @return true if slot contains an element
     [[nodiscard]] bool is_occupied(size_t i) const noexcept
     {
-        assert(i < Capacity);
-        const size_t word = i / BitsPerWord;
-        const size_t bit = i % BitsPerWord;
-        return (m_occupied[word] & (1ull << bit)) != 0u;
+        return m_occupied.test(i);
+    }
+
+    /// @brief Find the first occupied slot at or after i, scanning whole
+    ///        bitfield words with countr_zero
+    /// @param i Index within block [0, Capacity]
+    /// @return Index of the occupied slot, or Capacity if there is none
+    [[nodiscard]] size_t next_occupied(size_t i) const noexcept
+    {
+        return m_occupied.next_set(i);
     }
 
-    /// @brief Mark a slot as occupied
+    /// @brief Find the first empty slot at or after i
+    /// @param i Index within block [0, Capacity]
+    /// @return Index of the empty slot, or Capacity if the block is full
+    [[nodiscard]] size_t next_free(size_t i) const noexcept
+    {
+        return m_occupied.next_clear(i);
+    }
+
+    /// @brief Find the last occupied slot strictly before i, scanning whole
+    ///        bitfield words with countl_zero
+    /// @param i Index within block [0, Capacity]
+    /// @return Index of the occupied slot, or Capacity if there is none
+    [[nodiscard]] size_t prev_occupied(size_t i) const noexcept
+    {
+        return m_occupied.prev_set(i);
+    }
+
+    /// @brief Occupancy bits of the bitfield word holding slot i, keeping only
+    ///        the bits of slot i and above
     /// @param i Index within block
-    void set_occupied(size_t i) noexcept
+    [[nodiscard]] size_t occupancy_word(size_t i) const noexcept
+    {
+        return m_occupied.word_from(i);
+    }
+
+    /// @brief Call fn(i) for every occupied slot i, in increasing order
+    /// @param fn Function taking the index within the block
+    template<typename Function>
+    void for_each_occupied_slot(Function&& fn) const
+    {
+        m_occupied.for_each_set(std::forward<Function>(fn));
+    }
+
+    /// @brief Raw occupancy bitfield: NumBitfieldWords words, bit b of word w
+    ///        stands for the slot w * BitsPerWord + b
+    [[nodiscard]] const size_t* occupancy_bitfield() const noexcept
+    {
+        return m_occupied.words();
+    }
+
+    /// @brief Take over elements already living in the storage (e.g. mapped
+    ///        from a file) by overwriting the occupancy bitfield
+    /// @param bitfield NumBitfieldWords words, as given by occupancy_bitfield()
+    /// @note Only valid for trivially copyable T: no constructor is run.
+    void adopt_occupancy(const size_t* bitfield) noexcept
+    {
+        m_occupied.assign(bitfield);
+    }
+
+    /// @brief Construct an element in an empty slot and mark it as occupied
+    /// @param i Index within block, must be empty
+    /// @param args Arguments forwarded to the constructor of T
+    /// @return Reference to the new element
+    template<typename... Args>
+    T& emplace(size_t i, Args&&... args)
     {
         assert(i < Capacity);
-        const size_t word = i / BitsPerWord;
-        const size_t bit = i % BitsPerWord;
-        m_occupied[word] |= (1ull << bit);
+        assert(!is_occupied(i));
+        T* slot = std::construct_at(data() + i, std::forward<Args>(args)...);
+        m_occupied.set(i);
+        return *slot;
     }
 
-    /// @brief Mark a slot as empty
-    /// @param i Index within block
-    void clear_occupied(size_t i) noexcept
+    /// @brief Construct count elements into the empty slots [first, first + count)
+    /// @param first First index within block
+    /// @param src Iterator on the source elements (a move_iterator moves them)
+    /// @param count Number of elements to construct
+    template<typename InputIterator>
+    void emplace_range(size_t first, InputIterator src, size_t count)
+    {
+        assert(first + count <= Capacity);
+        std::uninitialized_copy_n(src, count, data() + first);
+        m_occupied.set_range(first, first + count);
+    }
+
+    /// @brief Destroy the element in a slot and mark it as empty (and clean)
+    /// @param i Index within block (no-op if already empty)
+    void erase(size_t i) noexcept
     {
         assert(i < Capacity);
-        const size_t word = i / BitsPerWord;
-        const size_t bit = i % BitsPerWord;
-        m_occupied[word] &= ~(1ull << bit);
+        if (is_occupied(i))
+        {
+            std::destroy_at(data() + i);
+            m_occupied.reset(i);
+            m_dirty.reset(i);
+        }
+    }
+
+    /// @brief Destroy the elements in the slots [first, last) and mark them as empty
+    /// @param first First index within block
+    /// @param last End index within block (exclusive)
+    void erase_range(size_t first, size_t last) noexcept
+    {
+        destroy_range(first, last);
     }
 
     /// @brief Check if data has been allocated
@@ -281,20 +718,136 @@ public:
         return m_data != nullptr;
     }
 
+    /// @brief Raw access to the contiguous element storage (allocates if needed)
+    /// @return Pointer to the first slot of the block
+    /// @note Only occupied slots hold living objects.
+    [[nodiscard]] T* data()
+    {
+        ensure_allocated();
+        return std::launder(reinterpret_cast<T*>(m_data));
+    }
+
+    /// @brief Raw access to the contiguous element storage (const version)
+    /// @return Pointer to the first slot of the block, nullptr if not allocated
+    [[nodiscard]] const T* data() const noexcept
+    {
+        return std::launder(reinterpret_cast<const T*>(m_data));
+    }
+
 private:
-    /// @brief Ensure memory is allocated (for lazy allocation)
+    /// @brief Destroy the elements living in [first, last) and clear their
+    ///        bits, one bitfield word at a time. Words without any occupied
+    ///        slot are skipped.
+    void destroy_range(size_t first, size_t last) noexcept
+    {
+        if constexpr (std::is_trivially_destructible_v<T>)
+        {
+            m_occupied.reset_range(first, last);
+        }
+        else
+        {
+            m_occupied.reset_range(first, last, [this](size_t i)
+            {
+                std::destroy_at(std::launder(reinterpret_cast<T*>(m_data)) + i);
+            });
+        }
+        m_dirty.reset_range(first, last);
+    }
+
+    /// @brief Ensure memory is allocated (for lazy allocation). The storage
+    ///        is left uninitialized: no element is constructed here.
     void ensure_allocated()
     {
         if (m_data == nullptr)
         {
-            m_data = std::make_unique<T[]>(Capacity);
+            m_data = static_cast<std::byte*>(
+                ::operator new(Capacity * sizeof(T), std::align_val_t{alignof(T)}));
         }
     }
 
-    std::unique_ptr<T[]> m_data;            ///< Element storage
-    size_t m_occupied[NumBitfieldWords]{};  ///< Bitfield tracking occupied slots
+    std::byte* m_data = nullptr;  ///< Uninitialized element storage
+    bool m_owns_storage = true;   ///< False when m_data belongs to an arena
+    Bitfield<N> m_occupied;       ///< Occupied slots
+    Bitfield<N> m_dirty;          ///< Modified slots
 };
 
+// ============================================================================
+/// @brief Source of blocks for a container, implemented by BlockPool.
+///
+/// Containers only hold this interface, so that Set.hpp does not depend on
+/// the pool and its huge page arena.
+// ============================================================================
+template<typename T, size_t N>
+class BlockProvider
+{
+public:
+    virtual ~BlockProvider() = default;
+
+    /// @brief Get an empty block with allocated storage
+    [[nodiscard]] virtual std::unique_ptr<Block<T, N>> acquire() = 0;
+
+    /// @brief Take back a block with allocated storage (its elements are destroyed)
+    virtual void release(std::unique_ptr<Block<T, N>> block) = 0;
+};
+
+} // namespace detail
+
+/// @brief Shared free-list recycling blocks across containers (BlockPool.hpp)
+template<typename T, size_t N>
+class BlockPool;
+
+/// @brief A whole file mapped in memory (MappedFile.hpp)
+class MappedFile;
+
+// ============================================================================
+/// @brief How many blocks a container allocates when it runs out of space.
+///
+/// The default allocates the missing blocks only, one allocation each. Larger
+/// batches are allocated ahead of need: without a pool, a batch of blocks
+/// shares a single allocation (a slab), so growing costs fewer calls to the
+/// allocator and consecutive blocks are contiguous in memory. A slab is freed
+/// once all of its blocks have been released.
+///
+/// @code
+/// Set<Particle, 6> particles;
+/// particles.set_growth_policy(GrowthPolicy::geometric());  // Double the blocks
+/// @endcode
+// ============================================================================
+struct GrowthPolicy
+{
+    size_t percent = 0u;                          ///< Blocks added per growth, in percent of the allocated ones
+    size_t min_batch = 1u;                        ///< Minimum number of blocks added per growth
+    size_t max_batch = static_cast<size_t>(-1);   ///< Maximum number of blocks added per growth
+
+    /// @brief Add the same number of blocks at each growth
+    /// @param batch Number of blocks per growth
+    [[nodiscard]] static constexpr GrowthPolicy linear(size_t batch = 1u) noexcept
+    {
+        return {0u, batch, batch};
+    }
+
+    /// @brief Add a number of blocks proportional to the allocated ones
+    /// @param percent 100 doubles the number of blocks at each growth
+    /// @param max_batch Cap on the blocks added at once
+    [[nodiscard]] static constexpr GrowthPolicy geometric(size_t percent = 100u, size_t max_batch = 1024u) noexcept
+    {
+        return {percent, 1u, max_batch};
+    }
+
+    /// @brief Number of blocks to add
+    /// @param allocated Blocks already allocated
+    /// @param missing Blocks needed right now (always granted)
+    [[nodiscard]] constexpr size_t batch(size_t allocated, size_t missing) const noexcept
+    {
+        return std::max(missing, std::min(std::max(allocated * percent / 100u, min_batch), max_batch));
+    }
+};
+
+namespace detail {
+
+/// @brief Implementation of save(), sync() and open_mmap() (MappedFile.hpp)
+struct Persistence;
+
 // ============================================================================
 /// @brief Base class for block-allocated containers.
 ///
@@ -305,9 +858,11 @@ private:
 /// @tparam N Log2 of block size
 // ============================================================================
 template<typename T, size_t N>
-    requires std::default_initializable<T> && std::copyable<T>
+    requires std::movable<T>
 class ContainerBase
 {
+    friend struct Persistence;
+
 public:
     using block_type = Block<T, N>;
     static constexpr size_t BlockCapacity = BlockSize<N>;
@@ -315,7 +870,9 @@ public:
 protected:
     /// @brief Construct with optional pre-allocation
     /// @param reserve_elements Number of elements to pre-allocate space for
-    explicit ContainerBase(size_t reserve_elements = 0u)
+    /// @param pool Optional pool providing and recycling the blocks
+    explicit ContainerBase(size_t reserve_elements = 0u, BlockProvider<T, N>* pool = nullptr)
+        : m_pool(pool)
     {
         if (reserve_elements > 0u)
         {
@@ -323,16 +880,64 @@ protected:
         }
     }
 
-    /// @brief Virtual destructor for proper cleanup
-    virtual ~ContainerBase() = default;
+    /// @brief Move constructor (blocks are transferred, not copied)
+    ContainerBase(ContainerBase&& other) noexcept
+        : m_mapping(std::move(other.m_mapping)),
+          m_slabs(std::exchange(other.m_slabs, {})),
+          m_blocks(std::move(other.m_blocks)),
+          m_stored_elements(std::exchange(other.m_stored_elements, 0u)),
+          m_pool(other.m_pool),
+          m_growth(other.m_growth)
+    {
+        other.m_blocks.clear();
+    }
+
+    /// @brief Move assignment (blocks are transferred, not copied)
+    ContainerBase& operator=(ContainerBase&& other) noexcept
+    {
+        release_blocks();
+        m_mapping = std::move(other.m_mapping);
+        m_slabs = std::exchange(other.m_slabs, {});
+        m_blocks = std::move(other.m_blocks);
+        m_stored_elements = std::exchange(other.m_stored_elements, 0u);
+        m_pool = other.m_pool;
+        m_growth = other.m_growth;
+        other.m_blocks.clear();
+        return *this;
+    }
+
+    /// @brief Virtual destructor for proper cleanup (blocks go back to the pool)
+    virtual ~ContainerBase()
+    {
+        release_blocks();
+    }
 
 public:
-    /// @brief Pre-allocate space for at least n elements
-    /// @param n Minimum number of elements to reserve space for
+    /// @brief Pre-allocate space for at least n elements in total
+    /// @param n Minimum capacity after the call (nothing is allocated if the
+    ///        capacity is already enough)
+    ///
+    /// The missing blocks are allocated at once (in one slab without pool),
+    /// whatever the growth policy.
     void reserve(size_t n)
     {
         const size_t needed_blocks = (n + BlockCapacity - 1u) >> N;
-        allocate_blocks(needed_blocks);
+        if (needed_blocks > m_blocks.size())
+        {
+            allocate_blocks(needed_blocks - m_blocks.size());
+        }
+    }
+
+    /// @brief Choose how many blocks are allocated when the container grows
+    void set_growth_policy(GrowthPolicy policy) noexcept
+    {
+        m_growth = policy;
+    }
+
+    /// @brief Get the growth policy
+    [[nodiscard]] GrowthPolicy growth_policy() const noexcept
+    {
+        return m_growth;
     }
 
     /// @brief Get number of stored elements
@@ -380,7 +985,7 @@ public:
     }
 
     /// @brief Access element without bounds checking
-    /// @param index Element index
+    /// @param index Element index (the slot must be occupied)
     /// @return Reference to element
     [[nodiscard]] T& operator[](size_t index)
     {
@@ -390,7 +995,7 @@ public:
     }
 
     /// @brief Access element without bounds checking (const)
-    /// @param index Element index
+    /// @param index Element index (the slot must be occupied)
     /// @return Const reference to element
     [[nodiscard]] const T& operator[](size_t index) const
     {
@@ -418,6 +1023,96 @@ public:
         return m_blocks[bid]->is_occupied(sid);
     }
 
+    /// @brief Mark an element as modified (e.g. after writing it through
+    ///        operator[], which does not track modifications)
+    /// @param index Element index (the slot must be occupied)
+    void tag_as_pending(size_t index) noexcept
+    {
+        m_blocks[block_index<N>(index)]->tag_as_pending(sub_index<N>(index));
+    }
+
+    /// @brief Get the modified elements as a sorted list of disjoint ranges
+    /// @param max_gap Ranges separated by at most max_gap clean elements are
+    ///        merged (0 only merges adjacent ranges). A larger gap trades a
+    ///        few redundant elements for fewer ranges.
+    /// @return List of {start_index, end_index} (end is exclusive)
+    ///
+    /// Unlike get_pending_range(), modifying element 0 and element 1000000
+    /// gives two one-element ranges instead of the whole container.
+    [[nodiscard]] std::vector<std::pair<size_t, size_t>> get_pending_ranges(size_t max_gap = 0u) const
+    {
+        std::vector<std::pair<size_t, size_t>> ranges;
+        for (size_t bid = 0u; bid < m_blocks.size(); ++bid)
+        {
+            if (!m_blocks[bid]->has_pending_data())
+            {
+                continue;
+            }
+            m_blocks[bid]->for_each_pending_run([&ranges, bid, max_gap](size_t first, size_t last)
+            {
+                const size_t start = (bid << N) + first;
+                const size_t end = (bid << N) + last;
+                if (!ranges.empty() && start - ranges.back().second <= max_gap)
+                {
+                    ranges.back().second = end;
+                }
+                else
+                {
+                    ranges.emplace_back(start, end);
+                }
+            });
+        }
+        return ranges;
+    }
+
+    /// @brief Hand every modified run of elements to fn, then clear the
+    ///        pending state
+    /// @param fn Function called as fn(std::span<const T>) or
+    ///        fn(first_index, std::span<const T>) for each run. A run never
+    ///        crosses a block boundary, so each span is contiguous in memory.
+    /// @return Number of flushed elements
+    ///
+    /// @code
+    /// set.flush_pending([](size_t first, std::span<const float> data) {
+    ///     glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(float),
+    ///                     data.size_bytes(), data.data());
+    /// });
+    /// @endcode
+    template<typename Function>
+    size_t flush_pending(Function fn)
+    {
+        size_t flushed = 0u;
+        for (size_t bid = 0u; bid < m_blocks.size(); ++bid)
+        {
+            const block_type& block = *m_blocks[bid];
+            if (!block.has_pending_data())
+            {
+                continue;
+            }
+            block.for_each_pending_run([&fn, &flushed, &block, bid](size_t first, size_t last)
+            {
+                std::span<const T> run(block.data() + first, last - first);
+                if constexpr (std::is_invocable_v<Function&, size_t, std::span<const T>>)
+                {
+                    fn((bid << N) + first, run);
+                }
+                else
+                {
+                    fn(run);
+                }
+                flushed += run.size();
+            });
+            m_blocks[bid]->clear_pending();
+        }
+        return flushed;
+    }
+
+    /// @brief Check if the blocks live in a mapped file
+    [[nodiscard]] bool is_mapped() const noexcept
+    {
+        return m_mapping != nullptr;
+    }
+
     /// @brief Clear all elements (does not deallocate blocks)
     virtual void clear()
     {
@@ -436,6 +1131,7 @@ public:
         {
             if (m_blocks.back()->occupation() == 0u)
             {
+                release_block(std::move(m_blocks.back()));
                 m_blocks.pop_back();
             }
             else
@@ -446,50 +1142,187 @@ public:
     }
 
 protected:
+    /// @brief Bytes of element storage in a block
+    static constexpr size_t BlockBytes = BlockCapacity * sizeof(T);
+
     /// @brief Allocate additional blocks
-    /// @param num_blocks Number of blocks to add
+    /// @param num_blocks Number of blocks to add. Without pool, several
+    ///        blocks share the storage of a single slab.
     void allocate_blocks(size_t num_blocks)
     {
-        m_blocks.reserve(m_blocks.size() + num_blocks);
+        // Exact reserves would reallocate the pointers at each growth
+        if (m_blocks.size() + num_blocks > m_blocks.capacity())
+        {
+            m_blocks.reserve(std::max(m_blocks.size() + num_blocks, 2u * m_blocks.capacity()));
+        }
+        if (m_pool != nullptr || num_blocks == 1u)
+        {
+            for (size_t i = 0u; i < num_blocks; ++i)
+            {
+                m_blocks.push_back(acquire_block());
+            }
+            return;
+        }
+        if (num_blocks == 0u)
+        {
+            return;
+        }
+
+        if (m_slabs.size() == m_slabs.capacity())
+        {
+            m_slabs.reserve(std::max<size_t>(4u, 2u * m_slabs.capacity()));
+        }
+        auto* base = static_cast<std::byte*>(::operator new(num_blocks * BlockBytes, std::align_val_t{alignof(T)}));
+        m_slabs.push_back({base, num_blocks * BlockBytes, num_blocks});
         for (size_t i = 0u; i < num_blocks; ++i)
         {
-            m_blocks.push_back(std::make_unique<block_type>(false));
+            m_blocks.push_back(std::make_unique<block_type>(base + i * BlockBytes));
         }
     }
 
-    /// @brief Ensure we have capacity for the given index
+    /// @brief Get one block with storage, from the pool if there is one
+    [[nodiscard]] std::unique_ptr<block_type> acquire_block()
+    {
+        return (m_pool != nullptr) ? m_pool->acquire() : std::make_unique<block_type>(false);
+    }
+
+    /// @brief Allocate the blocks needed to store index, and more if the
+    ///        growth policy asks for a larger batch
     /// @param index Index that must be valid after this call
     void ensure_capacity(size_t index)
     {
         const size_t needed_blocks = block_index<N>(index) + 1u;
         if (needed_blocks > m_blocks.size())
         {
-            allocate_blocks(needed_blocks - m_blocks.size());
+            allocate_blocks(m_growth.batch(m_blocks.size(), needed_blocks - m_blocks.size()));
         }
     }
 
-    /// @brief Mark element as occupied and update count
-    void mark_occupied(size_t bid, size_t sid)
+    /// @brief Give a block back to the pool, or free it without pool (its
+    ///        slab is freed with the last block using it). A block without
+    ///        storage is simply destroyed: the pool only keeps blocks with storage.
+    void release_block(std::unique_ptr<block_type> block)
     {
-        if (!m_blocks[bid]->is_occupied(sid))
+        if (block == nullptr || !block->is_allocated())
+        {
+            return;
+        }
+        if (m_pool != nullptr)
         {
-            m_blocks[bid]->set_occupied(sid);
-            ++m_stored_elements;
+            m_pool->release(std::move(block));
+        }
+        else if (!m_slabs.empty())
+        {
+            const auto* storage = reinterpret_cast<const std::byte*>(std::as_const(*block).data());
+            block.reset();
+            auto slab = std::ranges::find_if(m_slabs, [storage](const Slab& candidate)
+            {
+                return storage >= candidate.base && storage < candidate.base + candidate.bytes;
+            });
+            if (slab != m_slabs.end() && --slab->blocks == 0u)
+            {
+                ::operator delete(slab->base, std::align_val_t{alignof(T)});
+                m_slabs.erase(slab);
+            }
         }
     }
 
-    /// @brief Mark element as empty and update count
-    void mark_empty(size_t bid, size_t sid)
+    /// @brief Release all blocks (the container becomes empty)
+    void release_blocks()
+    {
+        for (auto& block : m_blocks)
+        {
+            release_block(std::move(block));
+        }
+        m_blocks.clear();
+        m_stored_elements = 0u;
+    }
+
+    /// @brief Number of slots covered by one word of a block bitfield
+    static constexpr size_t WordSlots = std::min(BitsPerWord, BlockSize<N>);
+
+    /// @brief Occupancy bits of the bitfield word holding index, keeping only
+    ///        the bits of index and above. Bit k stands for the slot
+    ///        (index & ~(WordSlots - 1)) + k.
+    [[nodiscard]] size_t occupancy_word(size_t index) const noexcept
+    {
+        return m_blocks[block_index<N>(index)]->occupancy_word(sub_index<N>(index));
+    }
+
+    /// @brief Find the first occupied index in [first, last), skipping empty
+    ///        bitfield words and empty blocks at once
+    /// @return The occupied index, or last if there is none
+    [[nodiscard]] size_t find_occupied(size_t first, size_t last) const noexcept
+    {
+        last = std::min(last, m_blocks.size() << N);
+        while (first < last)
+        {
+            const size_t bid = block_index<N>(first);
+            const size_t found = m_blocks[bid]->next_occupied(sub_index<N>(first));
+            if (found != BlockCapacity)
+            {
+                return std::min((bid << N) + found, last);
+            }
+            first = (bid + 1u) << N;
+        }
+        return last;
+    }
+
+    /// @brief Find the last occupied index in [first, last)
+    /// @return The occupied index, or npos (size_t(-1)) if there is none
+    [[nodiscard]] size_t find_last_occupied(size_t first, size_t last) const noexcept
+    {
+        constexpr size_t npos = static_cast<size_t>(-1);
+        last = std::min(last, m_blocks.size() << N);
+        while (last > first)
+        {
+            const size_t bid = block_index<N>(last - 1u);
+            const size_t found = m_blocks[bid]->prev_occupied(last - (bid << N));
+            if (found != BlockCapacity)
+            {
+                const size_t index = (bid << N) + found;
+                return (index >= first) ? index : npos;
+            }
+            last = bid << N;
+        }
+        return npos;
+    }
+
+    /// @brief Rebuild what the container derives from the occupancy once the
+    ///        blocks of a mapped file are installed (see open_mmap())
+    /// @return nullptr if the blocks suit this container, or why they do not
+    [[nodiscard]] virtual const char* adopt_mapped_blocks()
+    {
+        return nullptr;
+    }
+
+    /// @brief Destroy element, mark it as empty and update count
+    void mark_empty(size_t bid, size_t sid) noexcept
     {
         if (m_blocks[bid]->is_occupied(sid))
         {
-            m_blocks[bid]->clear_occupied(sid);
+            m_blocks[bid]->erase(sid);
             --m_stored_elements;
         }
     }
 
+    /// @brief Storage shared by the blocks of one allocation batch
+    struct Slab
+    {
+        std::byte* base;  ///< Start of the storage
+        size_t bytes;     ///< Size of the storage
+        size_t blocks;    ///< Blocks still using the storage
+    };
+
+    // Declared first: blocks using the mapped storage must die before it.
+    // A shared_ptr binds its deleter where the file is mapped, so this
+    // header compiles without the definition of MappedFile.
+    std::shared_ptr<MappedFile> m_mapping;               ///< File holding the blocks, if mapped
+    std::vector<Slab> m_slabs;                           ///< Storage of blocks allocated in batches
     std::vector<std::unique_ptr<block_type>> m_blocks;  ///< Block storage
     size_t m_stored_elements = 0u;                       ///< Number of stored elements
+    BlockProvider<T, N>* m_pool = nullptr;               ///< Optional block provider
+    GrowthPolicy m_growth;                               ///< Blocks added when growing
 };
 
 } // namespace detail
@@ -507,7 +1340,7 @@ protected:
 /// - O(1) removal (swaps with last element)
 /// - No holes: removing an element compacts the container
 ///
-/// @tparam T Element type (must be default_initializable and copyable)
+/// @tparam T Element type (must be movable)
 /// @tparam N Log2 of block size (default 4 = 16 elements per block)
 ///
 /// @code
@@ -521,7 +1354,7 @@ protected:
 /// @endcode
 // ============================================================================
 template<typename T, size_t N = 4>
-    requires std::default_initializable<T> && std::copyable<T>
+    requires std::movable<T>
 class Set : public detail::ContainerBase<T, N>
 {
     using Base = detail::ContainerBase<T, N>;
@@ -531,84 +1364,149 @@ class Set : public detail::ContainerBase<T, N>
 
 public:
     // ========================================================================
-    // Forward Iterator
+    // Random Access Iterator
     // ========================================================================
-    class iterator
+
+    /// @brief Random access iterator caching a pointer into the current block.
+    ///
+    /// Stepping inside a block is a pointer increment: the block table is
+    /// only looked up again when the position crosses a block boundary or
+    /// jumps to another block, so std::sort, std::reduce or ranges views run
+    /// without the block/sub-index math of operator[] on every access.
+    ///
+    /// Blocks never move, so appending elements keeps iterators valid,
+    /// end() included: an iterator created past the last element has no
+    /// cached pointer and looks its element up when dereferenced.
+    /// Like operator[], writing through an iterator is not tracked by the
+    /// pending data: use tag_as_pending() or the return value of the
+    /// algorithm to mark what was modified.
+    template<bool Const>
+    class basic_iterator
     {
+        using container_type = std::conditional_t<Const, const Set, Set>;
+
     public:
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
         using value_type = T;
         using difference_type = std::ptrdiff_t;
-        using pointer = T*;
-        using reference = T&;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
 
-        iterator() = default;
+        basic_iterator() = default;
 
-        iterator(Set& container, size_t pos)
+        basic_iterator(container_type& container, size_t pos)
             : m_container(&container), m_pos(pos)
-        {}
+        {
+            reload();
+        }
 
-        reference operator*() const { return (*m_container)[m_pos]; }
-        pointer operator->() const { return &(*m_container)[m_pos]; }
+        /// @brief Conversion from iterator to const_iterator
+        template<bool OtherConst>
+            requires (Const && !OtherConst)
+        basic_iterator(const basic_iterator<OtherConst>& other)
+            : m_container(other.m_container), m_element(other.m_element), m_pos(other.m_pos)
+        {}
 
-        iterator& operator++()
+        reference operator*() const { return *element(); }
+        pointer operator->() const { return element(); }
+        reference operator[](difference_type n) const
         {
-            ++m_pos;
-            return *this;
+            // Algorithms indexing from a fixed iterator jump across blocks:
+            // go straight to the block table instead of moving a copy
+            const size_t pos = m_pos + static_cast<size_t>(n);
+            const detail::Block<T, N>& block = *m_container->m_blocks[detail::block_index<N>(pos)];
+            return const_cast<reference>(block.data()[detail::sub_index<N>(pos)]);
         }
 
-        iterator operator++(int)
+        basic_iterator& operator++() { return *this += 1; }
+        basic_iterator& operator--() { return *this -= 1; }
+
+        basic_iterator operator++(int)
         {
-            iterator tmp = *this;
+            basic_iterator tmp = *this;
             ++(*this);
             return tmp;
         }
 
-        bool operator==(const iterator& other) const = default;
+        basic_iterator operator--(int)
+        {
+            basic_iterator tmp = *this;
+            --(*this);
+            return tmp;
+        }
 
-    private:
-        Set* m_container = nullptr;
-        size_t m_pos = 0u;
-    };
+        basic_iterator& operator+=(difference_type n)
+        {
+            const size_t pos = m_pos + static_cast<size_t>(n);
+            if (m_element != nullptr && detail::block_index<N>(pos) == detail::block_index<N>(m_pos))
+            {
+                m_element += n;
+                m_pos = pos;
+            }
+            else
+            {
+                m_pos = pos;
+                reload();
+            }
+            return *this;
+        }
 
-    class const_iterator
-    {
-    public:
-        using iterator_category = std::forward_iterator_tag;
-        using value_type = T;
-        using difference_type = std::ptrdiff_t;
-        using pointer = const T*;
-        using reference = const T&;
+        basic_iterator& operator-=(difference_type n) { return *this += -n; }
 
-        const_iterator() = default;
+        [[nodiscard]] friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+        [[nodiscard]] friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+        [[nodiscard]] friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
 
-        const_iterator(const Set& container, size_t pos)
-            : m_container(&container), m_pos(pos)
-        {}
+        [[nodiscard]] friend difference_type operator-(const basic_iterator& a, const basic_iterator& b)
+        {
+            return static_cast<difference_type>(a.m_pos - b.m_pos);
+        }
 
-        reference operator*() const { return (*m_container)[m_pos]; }
-        pointer operator->() const { return &(*m_container)[m_pos]; }
+        /// @note Only the positions are compared: comparing iterators of
+        ///       different containers is undefined, like for std::vector.
+        [[nodiscard]] bool operator==(const basic_iterator& other) const { return m_pos == other.m_pos; }
+        [[nodiscard]] auto operator<=>(const basic_iterator& other) const { return m_pos <=> other.m_pos; }
+
+    private:
+        friend class basic_iterator<true>;
 
-        const_iterator& operator++()
+        /// @brief Point m_element at the element m_pos, or at nothing when
+        ///        m_pos is past the last element
+        void reload()
         {
-            ++m_pos;
-            return *this;
+            if (m_container == nullptr || m_pos >= m_container->m_stored_elements)
+            {
+                m_element = nullptr;
+                return;
+            }
+            // Blocks holding elements are allocated: skip the allocation check
+            // of the non-const Block::data()
+            const detail::Block<T, N>& block = *m_container->m_blocks[detail::block_index<N>(m_pos)];
+            m_element = const_cast<pointer>(block.data()) + detail::sub_index<N>(m_pos);
         }
 
-        const_iterator operator++(int)
+        /// @brief Element at m_pos. Without a cached pointer (the iterator was
+        ///        at or past the end), elements may have been appended since:
+        ///        look it up in the block table.
+        [[nodiscard]] pointer element() const
         {
-            const_iterator tmp = *this;
-            ++(*this);
-            return tmp;
+            if (m_element != nullptr)
+            {
+                return m_element;
+            }
+            const detail::Block<T, N>& block = *m_container->m_blocks[detail::block_index<N>(m_pos)];
+            return const_cast<pointer>(block.data()) + detail::sub_index<N>(m_pos);
         }
 
-        bool operator==(const const_iterator& other) const = default;
-
-    private:
-        const Set* m_container = nullptr;
+        container_type* m_container = nullptr;
+        pointer m_element = nullptr;  ///< Element at m_pos (nullptr past the end)
         size_t m_pos = 0u;
     };
 
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
     // ========================================================================
     // Constructors
     // ========================================================================
@@ -620,14 +1518,18 @@ public:
     /// @param reserve_elements Number of elements to reserve space for
     explicit Set(size_t reserve_elements) : Base(reserve_elements) {}
 
+    /// @brief Construct with blocks taken from (and given back to) a shared pool
+    /// @param pool Block pool, must outlive the container
+    /// @param reserve_elements Number of elements to reserve space for
+    explicit Set(BlockPool<T, N>& pool, size_t reserve_elements = 0u)
+        : Base(reserve_elements, &pool)
+    {}
+
     /// @brief Construct from initializer list
     /// @param init Elements to insert
     Set(std::initializer_list<T> init) : Base(init.size())
     {
-        for (const auto& elem : init)
-        {
-            append_impl(elem);
-        }
+        append_range(init.begin(), init.size());
     }
 
     // ========================================================================
@@ -670,19 +1572,47 @@ public:
     /// @return Reference to this container
     Set& operator+=(const T& elem)
     {
-        append_impl(elem);
+        emplace_impl(elem);
+        return *this;
+    }
+
+    /// @brief Append a single element by moving it
+    /// @param elem Element to append
+    /// @return Reference to this container
+    Set& operator+=(T&& elem)
+    {
+        emplace_impl(std::move(elem));
         return *this;
     }
 
+    /// @brief Construct an element in place at the end
+    /// @param args Arguments forwarded to the constructor of T
+    /// @return Reference to the new element
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    T& emplace_back(Args&&... args)
+    {
+        return emplace_impl(std::forward<Args>(args)...);
+    }
+
     /// @brief Append multiple elements from a span
     /// @param data Elements to append
     /// @return Reference to this container
+    ///
+    /// Elements are copied block by block: one contiguous copy, one occupancy
+    /// update and one pending tag per block instead of per element.
     Set& operator+=(std::span<const T> data)
     {
-        for (const auto& elem : data)
-        {
-            append_impl(elem);
-        }
+        append_range(data.begin(), data.size());
+        return *this;
+    }
+
+    /// @brief Append multiple elements by moving them out of a vector
+    /// @param data Elements to append (left in a moved-from state)
+    /// @return Reference to this container
+    Set& operator+=(std::vector<T>&& data)
+    {
+        append_range(std::make_move_iterator(data.begin()), data.size());
         return *this;
     }
 
@@ -691,14 +1621,11 @@ public:
     /// @return Reference to this container
     Set& operator+=(std::initializer_list<T> init)
     {
-        for (const auto& elem : init)
-        {
-            append_impl(elem);
-        }
+        append_range(init.begin(), init.size());
         return *this;
     }
 
-    /// @brief Remove element at index (swaps with last element)
+    /// @brief Remove element at index (moves the last element into its slot)
     /// @param index Index of element to remove
     /// @note After removal, the element previously at the end is at index
     void remove(size_t index)
@@ -711,7 +1638,7 @@ public:
         // If not removing the last element, swap with last
         if (index != m_stored_elements - 1u)
         {
-            (*this)[index] = (*this)[m_stored_elements - 1u];
+            (*this)[index] = std::move((*this)[m_stored_elements - 1u]);
             const size_t bid = detail::block_index<N>(index);
             const size_t sid = detail::sub_index<N>(index);
             m_blocks[bid]->tag_as_pending(sid);
@@ -729,11 +1656,50 @@ public:
         }
 
         const size_t last = m_stored_elements - 1u;
-        const size_t bid = detail::block_index<N>(last);
-        const size_t sid = detail::sub_index<N>(last);
+        this->mark_empty(detail::block_index<N>(last), detail::sub_index<N>(last));
+    }
 
-        m_blocks[bid]->clear_occupied(sid);
-        --m_stored_elements;
+    /// @brief Remove all elements satisfying a predicate in a single pass
+    /// @param pred Unary predicate returning true for elements to remove
+    /// @return Number of removed elements
+    ///
+    /// Unlike remove(), the relative order of the kept elements is preserved:
+    /// survivors are moved toward the front and the tail is released at once.
+    ///
+    /// @code
+    /// Set<int> set = {1, 2, 3, 4, 5, 6};
+    /// set.remove_if([](int x) { return x % 2 == 0; });  // set = {1, 3, 5}
+    /// @endcode
+    template<typename Predicate>
+    size_t remove_if(Predicate pred)
+    {
+        const size_t count = m_stored_elements;
+        size_t write = 0u;
+        size_t first_moved = count;
+
+        for (size_t bid = 0u; (bid << N) < count; ++bid)
+        {
+            T* src = m_blocks[bid]->data();
+            const size_t in_block = std::min(BlockCapacity, count - (bid << N));
+            for (size_t sid = 0u; sid < in_block; ++sid)
+            {
+                if (pred(std::as_const(src[sid])))
+                {
+                    continue;
+                }
+                const size_t read = (bid << N) + sid;
+                if (write != read)
+                {
+                    (*this)[write] = std::move(src[sid]);
+                    first_moved = std::min(first_moved, write);
+                }
+                ++write;
+            }
+        }
+
+        tag_range_as_pending(first_moved, write);
+        truncate(write);
+        return count - write;
     }
 
     /// @brief Swap two elements
@@ -746,22 +1712,14 @@ public:
             return;
         }
 
-        T temp = (*this)[i];
-        (*this)[i] = (*this)[j];
-        (*this)[j] = temp;
+        std::ranges::swap((*this)[i], (*this)[j]);
 
         // Mark as pending
         m_blocks[detail::block_index<N>(i)]->tag_as_pending(detail::sub_index<N>(i));
         m_blocks[detail::block_index<N>(j)]->tag_as_pending(detail::sub_index<N>(j));
     }
 
-    /// @brief Clear all elements
-    void clear() override
-    {
-        Base::clear();
-        m_index = 0u;
-        m_subindex = 0u;
-    }
+    using Base::clear;
 
     // ========================================================================
     // Capacity
@@ -886,35 +1844,140 @@ public:
     [[nodiscard]] const_iterator cbegin() const { return begin(); }
     [[nodiscard]] const_iterator cend() const { return end(); }
 
+    /// @brief View the elements as one contiguous span per block
+    /// @return Random access range of std::span<T>, one per block holding
+    ///         elements (the last span may be shorter than a block)
+    ///
+    /// Loops over a span are plain pointer loops that the compiler can
+    /// vectorize, and a parallel algorithm over the segments hands whole
+    /// blocks to each thread.
+    ///
+    /// @code
+    /// auto blocks = set.segments();
+    /// std::for_each(std::execution::par, blocks.begin(), blocks.end(), [](std::span<float> block) {
+    ///     for (float& v : block) { v *= 0.5f; }
+    /// });
+    /// @endcode
+    [[nodiscard]] auto segments()
+    {
+        return std::views::iota(size_t(0), segment_count()) |
+               std::views::transform([this](size_t bid) { return segment(bid); });
+    }
+
+    /// @brief View the elements as one contiguous span per block (const)
+    [[nodiscard]] auto segments() const
+    {
+        return std::views::iota(size_t(0), segment_count()) |
+               std::views::transform([this](size_t bid) { return segment(bid); });
+    }
+
 private:
-    /// @brief Implementation of append
-    void append_impl(const T& elem)
+    /// @brief A mapped Set must hold its elements in [0, size())
+    [[nodiscard]] const char* adopt_mapped_blocks() override
     {
-        // Advance position
-        if (m_stored_elements > 0u)
+        if (this->find_last_occupied(0u, this->capacity()) + 1u != m_stored_elements)
         {
-            m_subindex = detail::modulo_pow2<N>(m_subindex + 1u);
-            if (m_subindex == 0u)
-            {
-                ++m_index;
-            }
+            return "elements are not contiguous (saved from a Collection?)";
         }
+        return nullptr;
+    }
+
+    /// @brief Number of blocks holding elements
+    [[nodiscard]] size_t segment_count() const noexcept
+    {
+        return (m_stored_elements + BlockCapacity - 1u) >> N;
+    }
+
+    /// @brief Elements of a block as a span
+    /// @param bid Block index, lower than segment_count()
+    [[nodiscard]] std::span<T> segment(size_t bid)
+    {
+        return {m_blocks[bid]->data(), std::min(BlockCapacity, m_stored_elements - (bid << N))};
+    }
+
+    /// @brief Elements of a block as a span (const)
+    [[nodiscard]] std::span<const T> segment(size_t bid) const
+    {
+        return {std::as_const(*m_blocks[bid]).data(), std::min(BlockCapacity, m_stored_elements - (bid << N))};
+    }
+
+    /// @brief Implementation of append
+    /// @note The insertion slot is derived from the size, so pop_back() and
+    ///       remove() never leave a stale write position behind.
+    template<typename... Args>
+    T& emplace_impl(Args&&... args)
+    {
+        const size_t bid = detail::block_index<N>(m_stored_elements);
+        const size_t sid = detail::sub_index<N>(m_stored_elements);
 
         // Ensure we have space
-        if (m_index >= m_blocks.size())
+        if (bid >= m_blocks.size())
         {
-            this->allocate_blocks(1u);
+            this->ensure_capacity(m_stored_elements);
         }
 
         // Insert element
-        (*m_blocks[m_index])[m_subindex] = elem;
-        m_blocks[m_index]->set_occupied(m_subindex);
-        m_blocks[m_index]->tag_as_pending(m_subindex);
+        T& slot = m_blocks[bid]->emplace(sid, std::forward<Args>(args)...);
+        m_blocks[bid]->tag_as_pending(sid);
         ++m_stored_elements;
+        return slot;
     }
 
-    size_t m_index = 0u;     ///< Current block index
-    size_t m_subindex = 0u;  ///< Current position within block
+    /// @brief Bulk append: fill whole blocks with one contiguous copy each
+    /// @param first Iterator on the first element to append (a move_iterator
+    ///        moves the elements instead of copying them)
+    /// @param count Number of elements to append
+    template<typename InputIterator>
+    void append_range(InputIterator first, size_t count)
+    {
+        if (count == 0u)
+        {
+            return;
+        }
+
+        this->ensure_capacity(m_stored_elements + count - 1u);
+        while (count > 0u)
+        {
+            const size_t bid = detail::block_index<N>(m_stored_elements);
+            const size_t sid = detail::sub_index<N>(m_stored_elements);
+            const size_t chunk = std::min(count, BlockCapacity - sid);
+
+            m_blocks[bid]->emplace_range(sid, first, chunk);
+            m_blocks[bid]->tag_as_pending(sid, sid + chunk);
+
+            std::advance(first, chunk);
+            m_stored_elements += chunk;
+            count -= chunk;
+        }
+    }
+
+    /// @brief Tag the global range [first, last) as pending, block by block
+    void tag_range_as_pending(size_t first, size_t last) noexcept
+    {
+        while (first < last)
+        {
+            const size_t bid = detail::block_index<N>(first);
+            const size_t sid = detail::sub_index<N>(first);
+            const size_t chunk = std::min(last - first, BlockCapacity - sid);
+            m_blocks[bid]->tag_as_pending(sid, sid + chunk);
+            first += chunk;
+        }
+    }
+
+    /// @brief Drop the elements at the end so that only new_size remain
+    void truncate(size_t new_size) noexcept
+    {
+        size_t first = new_size;
+        while (first < m_stored_elements)
+        {
+            const size_t bid = detail::block_index<N>(first);
+            const size_t sid = detail::sub_index<N>(first);
+            const size_t chunk = std::min(m_stored_elements - first, BlockCapacity - sid);
+            m_blocks[bid]->erase_range(sid, sid + chunk);
+            first += chunk;
+        }
+        m_stored_elements = std::min(m_stored_elements, new_size);
+    }
 };
 
 } // namespace container
\ No newline at end of file
@@ -0,0 +1,413 @@
+#pragma once
+
+#include "Collection.hpp"
+
+#include <cstdint>
+
+namespace container {
+
+// ============================================================================
+/// @brief Reference to an element of a SlotMap that detects removal.
+///
+/// The index locates the slot, the generation tells which element of that
+/// slot the handle was made for: once the element is removed the slot moves
+/// to the next generation and the handle becomes stale, even if a new element
+/// is later stored in the same slot.
+// ============================================================================
+struct Handle
+{
+    /// @brief Sentinel index of a handle that refers to nothing
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    size_t index = npos;       ///< Slot of the element
+    uint32_t generation = 0u;  ///< Generation of the slot when the handle was made (odd)
+
+    bool operator==(const Handle& other) const = default;
+};
+
+// ============================================================================
+/// @brief Collection addressed by generational handles.
+///
+/// SlotMap stores its elements in a Collection (stable indices, holes on
+/// removal) and keeps one generation counter per slot, bumped each time an
+/// element is stored in or removed from the slot: odd generations are live,
+/// even ones are holes. A Handle remembers both index and generation, so
+/// get() tells a live element from a stale reference with one comparison,
+/// without any validity map kept by the caller. Freed slots go on a
+/// free-list and are reused by the next insertions, most recently freed
+/// first, without scanning for holes.
+///
+/// Key properties:
+/// - Amortized O(1) insertion (reuses holes first)
+/// - O(1) lookup by handle, nullptr on stale handles
+/// - O(1) removal (leaves a hole, the handle becomes stale)
+/// - Iteration skips holes like Collection
+///
+/// @tparam T Element type (must be movable)
+/// @tparam N Log2 of block size (default 4 = 16 elements per block)
+///
+/// @code
+/// SlotMap<Entity> entities;
+/// Handle player = entities.emplace("player");
+/// entities.remove(player);
+/// Handle enemy = entities.emplace("enemy");  // Reuses the slot of player
+/// assert(entities.get(player) == nullptr);   // ... but player stays stale
+/// @endcode
+///
+/// @note Generations are 32 bits: a handle kept while its slot is reused
+///       2^31 times would become valid again.
+// ============================================================================
+template<typename T, size_t N = 4>
+    requires std::movable<T>
+class SlotMap
+{
+public:
+    using iterator = typename Collection<T, N>::iterator;
+    using const_iterator = typename Collection<T, N>::const_iterator;
+
+    // ========================================================================
+    // Constructors
+    // ========================================================================
+
+    /// @brief Default constructor (empty container)
+    SlotMap() = default;
+
+    /// @brief Construct with pre-allocated capacity
+    /// @param reserve_elements Number of elements to reserve space for
+    explicit SlotMap(size_t reserve_elements)
+        : m_elements(reserve_elements)
+    {
+        m_generations.reserve(reserve_elements);
+    }
+
+    /// @brief Move constructor (the source is left empty)
+    SlotMap(SlotMap&& other) noexcept
+        : m_elements(std::move(other.m_elements)),
+          m_generations(std::exchange(other.m_generations, {})),
+          m_free(std::exchange(other.m_free, {}))
+    {}
+
+    /// @brief Move assignment (the source is left empty)
+    SlotMap& operator=(SlotMap&& other) noexcept
+    {
+        m_elements = std::move(other.m_elements);
+        m_generations = std::exchange(other.m_generations, {});
+        m_free = std::exchange(other.m_free, {});
+        return *this;
+    }
+
+    // ========================================================================
+    // Element Access
+    // ========================================================================
+
+    /// @brief Get the element referred to by a handle
+    /// @param handle Handle returned by insert() or emplace()
+    /// @return Pointer to the element, nullptr if the handle is stale
+    [[nodiscard]] T* get(Handle handle) noexcept
+    {
+        return contains(handle) ? &m_elements[handle.index] : nullptr;
+    }
+
+    /// @brief Get the element referred to by a handle (const)
+    [[nodiscard]] const T* get(Handle handle) const noexcept
+    {
+        return contains(handle) ? &m_elements[handle.index] : nullptr;
+    }
+
+    /// @brief Get the element referred to by a handle, with checking
+    /// @throw std::out_of_range if the handle is stale
+    [[nodiscard]] T& at(Handle handle)
+    {
+        check_access(handle);
+        return m_elements[handle.index];
+    }
+
+    /// @brief Get the element referred to by a handle, with checking (const)
+    [[nodiscard]] const T& at(Handle handle) const
+    {
+        check_access(handle);
+        return m_elements[handle.index];
+    }
+
+    /// @brief Check if a handle refers to a live element
+    [[nodiscard]] bool contains(Handle handle) const noexcept
+    {
+        return (handle.generation & 1u) != 0u &&
+               handle.index < m_generations.size() &&
+               m_generations[handle.index] == handle.generation;
+    }
+
+    /// @brief Get the handle of the live element stored at an index
+    /// @param index Slot index (e.g. from for_each())
+    /// @return The handle, or a default Handle if the slot is empty
+    [[nodiscard]] Handle handle_at(size_t index) const noexcept
+    {
+        if (index >= m_generations.size() || (m_generations[index] & 1u) == 0u)
+        {
+            return {};
+        }
+        return {index, m_generations[index]};
+    }
+
+    // ========================================================================
+    // Modifiers
+    // ========================================================================
+
+    /// @brief Insert an element
+    /// @param elem Element to insert
+    /// @return Handle of the new element
+    Handle insert(const T& elem)
+    {
+        return emplace(elem);
+    }
+
+    /// @brief Insert an element by moving it
+    /// @param elem Element to insert
+    /// @return Handle of the new element
+    Handle insert(T&& elem)
+    {
+        return emplace(std::move(elem));
+    }
+
+    /// @brief Construct an element in place, in a freed slot if there is one
+    /// @param args Arguments forwarded to the constructor of T
+    /// @return Handle of the new element
+    template<typename... Args>
+        requires std::constructible_from<T, Args...>
+    Handle emplace(Args&&... args)
+    {
+        // Slots filled by a compaction since they were freed are skipped
+        while (!m_free.empty() && m_generations[m_free.back().index] != m_free.back().generation)
+        {
+            m_free.pop_back();
+        }
+
+        if (m_free.empty())
+        {
+            const size_t index = m_generations.size();
+            m_elements.emplace(index, std::forward<Args>(args)...);
+            m_generations.push_back(1u);
+            return {index, 1u};
+        }
+
+        const size_t index = m_free.back().index;
+        m_elements.emplace(index, std::forward<Args>(args)...);
+        m_free.pop_back();
+        return {index, ++m_generations[index]};
+    }
+
+    /// @brief Remove the element referred to by a handle
+    /// @param handle Handle of the element
+    /// @return false if the handle was already stale
+    bool remove(Handle handle)
+    {
+        if (!contains(handle))
+        {
+            return false;
+        }
+        release(handle.index);
+        return true;
+    }
+
+    /// @brief Remove all elements (every existing handle becomes stale)
+    void clear()
+    {
+        m_elements.for_each_occupied([this](size_t index, const T&)
+        {
+            m_free.push_back({index, ++m_generations[index]});
+        });
+        m_elements.clear();
+    }
+
+    /// @brief Apply a function to every element, skipping holes
+    /// @param fn Function called as fn(T&) or fn(Handle, T&)
+    template<typename Function>
+    void for_each(Function fn)
+    {
+        for_each_impl(*this, fn);
+    }
+
+    /// @brief Apply a function to every element (const version)
+    /// @param fn Function called as fn(const T&) or fn(Handle, const T&)
+    template<typename Function>
+    void for_each(Function fn) const
+    {
+        for_each_impl(*this, fn);
+    }
+
+    // ========================================================================
+    // Compaction
+    // ========================================================================
+
+    /// @brief Move elements out of the sparsest blocks into the densest ones
+    ///        (see Collection::compact())
+    /// @param max_moves Maximum number of elements to move in this call
+    /// @return {old_handle, new_handle} of every moved element. The old
+    ///         handles become stale: holders must switch to the new ones.
+    ///
+    /// Afterwards the free-list hands out the slots emptied by the compaction
+    /// first, lowest first, then the older holes last-in first-out. The cost
+    /// is in the number of moved elements, not in the number of slots.
+    std::vector<std::pair<Handle, Handle>> compact(size_t max_moves = static_cast<size_t>(-1))
+    {
+        return rekey(m_elements.compact(max_moves));
+    }
+
+    /// @brief Compact for at most a given duration
+    /// @param budget Time after which the call stops moving elements
+    /// @return {old_handle, new_handle} of every moved element
+    template<typename Rep, typename Period>
+    std::vector<std::pair<Handle, Handle>> compact(std::chrono::duration<Rep, Period> budget)
+    {
+        return rekey(m_elements.compact(budget));
+    }
+
+    /// @brief Measure how sparse the blocks are (see Collection::fragmentation())
+    [[nodiscard]] typename Collection<T, N>::Fragmentation fragmentation() const
+    {
+        return m_elements.fragmentation();
+    }
+
+    // ========================================================================
+    // Capacity
+    // ========================================================================
+
+    /// @brief Get number of live elements
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_elements.size();
+    }
+
+    /// @brief Check if container is empty
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_elements.empty();
+    }
+
+    /// @brief Boolean conversion (true if not empty)
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+        return !empty();
+    }
+
+    /// @brief Get number of slots ever used (live elements and holes)
+    [[nodiscard]] size_t slot_count() const noexcept
+    {
+        return m_generations.size();
+    }
+
+    /// @brief Get number of holes waiting to be reused
+    [[nodiscard]] size_t free_count() const noexcept
+    {
+        return m_generations.size() - m_elements.size();
+    }
+
+    // ========================================================================
+    // Iterators
+    // ========================================================================
+
+    [[nodiscard]] iterator begin() { return m_elements.begin(); }
+    [[nodiscard]] iterator end() { return m_elements.end(); }
+    [[nodiscard]] const_iterator begin() const { return m_elements.begin(); }
+    [[nodiscard]] const_iterator end() const { return m_elements.end(); }
+    [[nodiscard]] const_iterator cbegin() const { return begin(); }
+    [[nodiscard]] const_iterator cend() const { return end(); }
+
+private:
+    /// @brief Destroy the element of a slot, make its handles stale and
+    ///        push the slot on the free-list
+    void release(size_t index)
+    {
+        m_elements.remove(index);
+        m_free.push_back({index, ++m_generations[index]});
+    }
+
+    /// @brief Move the generations along with the elements moved by a
+    ///        compaction, and push the emptied slots on the free-list,
+    ///        lowest slot last. The filled slots are left in the free-list,
+    ///        where their generation no longer matches.
+    /// @param remap {old_index, new_index} of the moved elements
+    std::vector<std::pair<Handle, Handle>> rekey(const std::vector<std::pair<size_t, size_t>>& remap)
+    {
+        std::vector<std::pair<Handle, Handle>> handles;
+        if (remap.empty())
+        {
+            return handles;
+        }
+
+        handles.reserve(remap.size());
+        std::vector<Handle> freed;
+        freed.reserve(remap.size());
+        for (const auto& [from, to] : remap)
+        {
+            // Blocks can have free slots past the last slot ever used: they
+            // become holes too
+            for (size_t index = m_generations.size(); index < to; ++index)
+            {
+                freed.push_back({index, 0u});
+            }
+            if (to >= m_generations.size())
+            {
+                m_generations.resize(to + 1u, 0u);
+            }
+            const Handle old_handle{from, m_generations[from]++};
+            freed.push_back({from, m_generations[from]});
+            handles.emplace_back(old_handle, Handle{to, ++m_generations[to]});
+        }
+
+        // A slot may be filled after being freed by the same compaction
+        std::erase_if(freed, [this](const Handle& slot)
+        {
+            return m_generations[slot.index] != slot.generation;
+        });
+        std::sort(freed.begin(), freed.end(), [](const Handle& a, const Handle& b)
+        {
+            return a.index > b.index;
+        });
+        m_free.insert(m_free.end(), freed.begin(), freed.end());
+
+        // Drop the filled slots once they outnumber the free ones
+        if (m_free.size() > 2u * free_count())
+        {
+            std::erase_if(m_free, [this](const Handle& slot)
+            {
+                return m_generations[slot.index] != slot.generation;
+            });
+        }
+        return handles;
+    }
+
+    /// @brief Implementation of for_each (const and non-const)
+    template<typename Self, typename Function>
+    static void for_each_impl(Self& self, Function& fn)
+    {
+        self.m_elements.for_each_occupied([&self, &fn](size_t index, auto& elem)
+        {
+            if constexpr (std::is_invocable_v<Function&, Handle, decltype(elem)>)
+            {
+                fn(Handle{index, self.m_generations[index]}, elem);
+            }
+            else
+            {
+                fn(elem);
+            }
+        });
+    }
+
+    /// @brief Check if a handle refers to a live element
+    /// @throw std::out_of_range if the handle is stale
+    void check_access(Handle handle) const
+    {
+        if (!contains(handle))
+        {
+            throw std::out_of_range("SlotMap::at - handle {" + std::to_string(handle.index) + ", " +
+                                    std::to_string(handle.generation) + "} is stale");
+        }
+    }
+
+    Collection<T, N> m_elements;          ///< Element storage, indexed by slot
+    std::vector<uint32_t> m_generations;  ///< Generation of each slot, odd when live
+    std::vector<Handle> m_free;           ///< Freed slots and their generation, reused last-in first-out
+};
+
+} // namespace container
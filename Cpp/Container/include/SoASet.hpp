@@ -0,0 +1,556 @@
+#pragma once
+
+#include "Set.hpp"
+
+#include <array>
+#include <memory>
+#include <tuple>
+
+namespace container {
+
+namespace detail {
+
+/// @brief Minimal alignment of each field array: a cache line, which also
+///        covers the widest SIMD registers (AVX-512)
+inline constexpr size_t SoAAlignment = 64u;
+
+// ============================================================================
+/// @brief Block of 2^N elements stored as one array per field.
+///
+/// Same occupancy bitfield as Block, but the storage is split: a single
+/// allocation holds one array of 2^N values per field, each array starting
+/// on a SoAAlignment boundary. Slot i of the block is made of the i-th value
+/// of every array; the values of a slot are constructed and destroyed
+/// together.
+///
+/// @tparam N Log2 of block size (block holds 2^N elements)
+/// @tparam Fields Type of each field
+// ============================================================================
+template<size_t N, typename... Fields>
+class SoABlock
+{
+public:
+    /// @brief Number of elements this block can hold
+    static constexpr size_t Capacity = BlockSize<N>;
+
+    /// @brief Alignment of every field array
+    static constexpr size_t Alignment = std::max({SoAAlignment, alignof(Fields)...});
+
+    /// @brief Type of the K-th field
+    template<size_t K>
+    using field_type = std::tuple_element_t<K, std::tuple<Fields...>>;
+
+private:
+    /// @brief Byte offset of each field array, the last entry is the total size
+    static constexpr std::array<size_t, sizeof...(Fields) + 1u> field_offsets() noexcept
+    {
+        constexpr size_t sizes[] = {sizeof(Fields)...};
+        std::array<size_t, sizeof...(Fields) + 1u> offsets{};
+        for (size_t k = 0u; k < sizeof...(Fields); ++k)
+        {
+            const size_t end = offsets[k] + sizes[k] * Capacity;
+            offsets[k + 1u] = (end + Alignment - 1u) & ~(Alignment - 1u);
+        }
+        return offsets;
+    }
+
+    static constexpr std::array<size_t, sizeof...(Fields) + 1u> Offsets = field_offsets();
+
+public:
+    /// @brief Allocate the (uninitialized) storage of all field arrays
+    SoABlock()
+        : m_data(static_cast<std::byte*>(::operator new(Offsets.back(), std::align_val_t{Alignment})))
+    {}
+
+    SoABlock(const SoABlock&) = delete;
+    SoABlock& operator=(const SoABlock&) = delete;
+
+    /// @brief Destroy the stored elements and release the storage
+    ~SoABlock()
+    {
+        clear();
+        ::operator delete(m_data, std::align_val_t{Alignment});
+    }
+
+    /// @brief Destroy all elements and mark all slots as empty
+    void clear() noexcept
+    {
+        erase_range(0u, Capacity);
+    }
+
+    /// @brief Array of the K-th field (only occupied slots hold living values)
+    template<size_t K>
+    [[nodiscard]] field_type<K>* field() noexcept
+    {
+        return std::assume_aligned<Alignment>(
+            std::launder(reinterpret_cast<field_type<K>*>(m_data + Offsets[K])));
+    }
+
+    /// @brief Array of the K-th field (const version)
+    template<size_t K>
+    [[nodiscard]] const field_type<K>* field() const noexcept
+    {
+        return std::assume_aligned<Alignment>(
+            std::launder(reinterpret_cast<const field_type<K>*>(m_data + Offsets[K])));
+    }
+
+    /// @brief Check if a slot is occupied
+    /// @param i Index within block
+    [[nodiscard]] bool is_occupied(size_t i) const noexcept
+    {
+        return m_occupied.test(i);
+    }
+
+    /// @brief Count number of occupied slots using popcount
+    [[nodiscard]] size_t occupation() const noexcept
+    {
+        return m_occupied.count();
+    }
+
+    /// @brief Construct the fields of an empty slot and mark it as occupied
+    /// @param i Index within block, must be empty
+    /// @param args One argument per field, forwarded to its constructor
+    /// @note If a field constructor throws, the fields already built are
+    ///       destroyed and the slot stays empty.
+    template<typename... Args>
+    void emplace(size_t i, Args&&... args)
+    {
+        assert(i < Capacity);
+        assert(!is_occupied(i));
+        emplace_fields(std::index_sequence_for<Fields...>{}, i, std::forward<Args>(args)...);
+        m_occupied.set(i);
+    }
+
+    /// @brief Destroy the element in a slot and mark it as empty
+    /// @param i Index within block (no-op if already empty)
+    void erase(size_t i) noexcept
+    {
+        assert(i < Capacity);
+        erase_range(i, i + 1u);
+    }
+
+    /// @brief Destroy the elements in the slots [first, last) and mark them
+    ///        as empty, one bitfield word at a time
+    void erase_range(size_t first, size_t last) noexcept
+    {
+        if constexpr ((std::is_trivially_destructible_v<Fields> && ...))
+        {
+            m_occupied.reset_range(first, last);
+        }
+        else
+        {
+            m_occupied.reset_range(first, last, [this](size_t i) { destroy_fields(i, sizeof...(Fields)); });
+        }
+    }
+
+private:
+    /// @brief Construct field K of slot i from the K-th argument
+    template<size_t... K, typename... Args>
+    void emplace_fields(std::index_sequence<K...>, size_t i, Args&&... args)
+    {
+        size_t constructed = 0u;
+        try
+        {
+            ((std::construct_at(field<K>() + i, std::forward<Args>(args)), ++constructed), ...);
+        }
+        catch (...)
+        {
+            destroy_fields(i, constructed);
+            throw;
+        }
+    }
+
+    /// @brief Destroy the first count fields of slot i
+    void destroy_fields(size_t i, size_t count) noexcept
+    {
+        [this, i, count]<size_t... K>(std::index_sequence<K...>)
+        {
+            ((K < count ? std::destroy_at(field<K>() + i) : void()), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    std::byte* m_data;       ///< Uninitialized storage of all field arrays
+    Bitfield<N> m_occupied;  ///< Occupied slots
+};
+
+} // namespace detail
+
+// ============================================================================
+/// @brief Dense container storing each field of its elements in its own array
+///        (structure of arrays).
+///
+/// SoASet behaves like a Set of std::tuple<Fields...> (O(1) append, O(1)
+/// removal by moving the last element into the hole, no holes), but each
+/// block stores one aligned array per field instead of an array of structs.
+/// A loop touching only positions and velocities streams those arrays and
+/// nothing else, and its body works on plain contiguous arrays that the
+/// compiler can vectorize.
+///
+/// Fields are designated by their index, an unscoped enum keeps call sites
+/// readable.
+///
+/// @tparam N Log2 of block size
+/// @tparam Fields Type of each field (must be movable)
+///
+/// @code
+/// enum Field : size_t { X, VX };
+/// SoASet<10, float, float> bodies;
+/// bodies.emplace_back(0.0f, 1.5f);
+/// bodies.for_each_block<X, VX>([dt](std::span<float> x, std::span<float> vx) {
+///     for (size_t i = 0; i < x.size(); ++i) { x[i] += vx[i] * dt; }
+/// });
+/// auto [x, vx] = bodies[0];   // Tuple of references on the element fields
+/// @endcode
+// ============================================================================
+template<size_t N, typename... Fields>
+    requires (sizeof...(Fields) > 0u) && (std::movable<Fields> && ...)
+class SoASet
+{
+    using block_type = detail::SoABlock<N, Fields...>;
+
+public:
+    static constexpr size_t BlockCapacity = detail::BlockSize<N>;
+
+    /// @brief Element type, as seen from the outside
+    using value_type = std::tuple<Fields...>;
+    /// @brief References on the fields of an element
+    using reference = std::tuple<Fields&...>;
+    /// @brief Const references on the fields of an element
+    using const_reference = std::tuple<const Fields&...>;
+
+    /// @brief Type of the K-th field
+    template<size_t K>
+    using field_type = typename block_type::template field_type<K>;
+
+    // ========================================================================
+    // Constructors
+    // ========================================================================
+
+    /// @brief Default constructor (empty container)
+    SoASet() = default;
+
+    /// @brief Construct with pre-allocated capacity
+    /// @param reserve_elements Number of elements to reserve space for
+    explicit SoASet(size_t reserve_elements)
+    {
+        reserve(reserve_elements);
+    }
+
+    /// @brief Move constructor (blocks are transferred, not copied)
+    SoASet(SoASet&& other) noexcept
+        : m_blocks(std::move(other.m_blocks)),
+          m_stored_elements(std::exchange(other.m_stored_elements, 0u))
+    {
+        other.m_blocks.clear();
+    }
+
+    /// @brief Move assignment (blocks are transferred, not copied)
+    SoASet& operator=(SoASet&& other) noexcept
+    {
+        m_blocks = std::move(other.m_blocks);
+        m_stored_elements = std::exchange(other.m_stored_elements, 0u);
+        other.m_blocks.clear();
+        return *this;
+    }
+
+    // ========================================================================
+    // Element Access
+    // ========================================================================
+
+    /// @brief Access one field of an element without bounds checking
+    /// @tparam K Field index
+    /// @param index Element index
+    template<size_t K>
+    [[nodiscard]] field_type<K>& get(size_t index)
+    {
+        return m_blocks[detail::block_index<N>(index)]->template field<K>()[detail::sub_index<N>(index)];
+    }
+
+    /// @brief Access one field of an element without bounds checking (const)
+    template<size_t K>
+    [[nodiscard]] const field_type<K>& get(size_t index) const
+    {
+        return m_blocks[detail::block_index<N>(index)]->template field<K>()[detail::sub_index<N>(index)];
+    }
+
+    /// @brief Access all the fields of an element without bounds checking
+    /// @param index Element index
+    /// @return Tuple of references on the fields
+    [[nodiscard]] reference operator[](size_t index)
+    {
+        return fields_at<reference>(*this, index, std::index_sequence_for<Fields...>{});
+    }
+
+    /// @brief Access all the fields of an element without bounds checking (const)
+    [[nodiscard]] const_reference operator[](size_t index) const
+    {
+        return fields_at<const_reference>(*this, index, std::index_sequence_for<Fields...>{});
+    }
+
+    /// @brief Access all the fields of an element with bounds checking
+    /// @throw std::out_of_range if index is invalid
+    [[nodiscard]] reference at(size_t index)
+    {
+        check_access(index);
+        return (*this)[index];
+    }
+
+    /// @brief Access all the fields of an element with bounds checking (const)
+    [[nodiscard]] const_reference at(size_t index) const
+    {
+        check_access(index);
+        return (*this)[index];
+    }
+
+    /// @brief Get the values of the K-th field stored in a block
+    /// @param bid Block index, less than block_count()
+    /// @return Contiguous, aligned span over the elements of the block
+    template<size_t K>
+    [[nodiscard]] std::span<field_type<K>> field_span(size_t bid)
+    {
+        return {m_blocks[bid]->template field<K>(), block_size(bid)};
+    }
+
+    /// @brief Get the values of the K-th field stored in a block (const)
+    template<size_t K>
+    [[nodiscard]] std::span<const field_type<K>> field_span(size_t bid) const
+    {
+        return {m_blocks[bid]->template field<K>(), block_size(bid)};
+    }
+
+    /// @brief Call fn with the spans of the selected fields, block by block
+    /// @tparam K Indices of the fields handed to fn
+    /// @param fn Function called as fn(std::span<field_type<K>>...) for every
+    ///        non-empty block. All spans have the same size.
+    ///
+    /// This is the intended way to write hot loops: the body is a plain loop
+    /// over aligned arrays, without per-element bookkeeping.
+    /// @note Arrays of different fields never overlap, but the compiler does
+    ///       not know it: a loop writing one field and reading one or two
+    ///       others vectorizes, larger fused loops may not.
+    template<size_t... K, typename Function>
+        requires (sizeof...(K) > 0u)
+    void for_each_block(Function fn)
+    {
+        for (size_t bid = 0u; (bid << N) < m_stored_elements; ++bid)
+        {
+            fn(field_span<K>(bid)...);
+        }
+    }
+
+    /// @brief Call fn with the spans of the selected fields, block by block (const)
+    template<size_t... K, typename Function>
+        requires (sizeof...(K) > 0u)
+    void for_each_block(Function fn) const
+    {
+        for (size_t bid = 0u; (bid << N) < m_stored_elements; ++bid)
+        {
+            fn(field_span<K>(bid)...);
+        }
+    }
+
+    /// @brief Apply a function to every element, in index order
+    /// @param fn Function called as fn(Fields&...)
+    template<typename Function>
+    void for_each(Function fn)
+    {
+        for (size_t index = 0u; index < m_stored_elements; ++index)
+        {
+            std::apply(fn, (*this)[index]);
+        }
+    }
+
+    // ========================================================================
+    // Modifiers
+    // ========================================================================
+
+    /// @brief Append an element
+    /// @param elem Values of the fields
+    /// @return Reference to this container
+    SoASet& operator+=(const value_type& elem)
+    {
+        std::apply([this](const Fields&... values) { emplace_back(values...); }, elem);
+        return *this;
+    }
+
+    /// @brief Append an element by moving its fields
+    /// @param elem Values of the fields
+    /// @return Reference to this container
+    SoASet& operator+=(value_type&& elem)
+    {
+        std::apply([this](Fields&... values) { emplace_back(std::move(values)...); }, elem);
+        return *this;
+    }
+
+    /// @brief Construct an element in place at the end
+    /// @param args One argument per field, forwarded to its constructor
+    /// @return References on the fields of the new element
+    template<typename... Args>
+        requires (sizeof...(Args) == sizeof...(Fields)) && (std::constructible_from<Fields, Args> && ...)
+    reference emplace_back(Args&&... args)
+    {
+        const size_t bid = detail::block_index<N>(m_stored_elements);
+        if (bid >= m_blocks.size())
+        {
+            m_blocks.push_back(std::make_unique<block_type>());
+        }
+        m_blocks[bid]->emplace(detail::sub_index<N>(m_stored_elements), std::forward<Args>(args)...);
+        return (*this)[m_stored_elements++];
+    }
+
+    /// @brief Remove element at index (moves the last element into its slot)
+    /// @param index Index of element to remove
+    /// @note After removal, the element previously at the end is at index
+    void remove(size_t index)
+    {
+        if (out_of_bounds(index))
+        {
+            return;
+        }
+
+        // If not removing the last element, move the last one into the hole
+        const size_t last = m_stored_elements - 1u;
+        if (index != last)
+        {
+            [this, index, last]<size_t... K>(std::index_sequence<K...>)
+            {
+                ((get<K>(index) = std::move(get<K>(last))), ...);
+            }(std::index_sequence_for<Fields...>{});
+        }
+
+        pop_back();
+    }
+
+    /// @brief Remove the last element
+    void pop_back()
+    {
+        if (m_stored_elements == 0u)
+        {
+            return;
+        }
+
+        --m_stored_elements;
+        m_blocks[detail::block_index<N>(m_stored_elements)]->erase(detail::sub_index<N>(m_stored_elements));
+    }
+
+    /// @brief Swap two elements, field by field
+    /// @param i First index
+    /// @param j Second index
+    void swap(size_t i, size_t j)
+    {
+        if (i == j || out_of_bounds(i) || out_of_bounds(j))
+        {
+            return;
+        }
+
+        [this, i, j]<size_t... K>(std::index_sequence<K...>)
+        {
+            (std::ranges::swap(get<K>(i), get<K>(j)), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    /// @brief Clear all elements (does not deallocate blocks)
+    void clear() noexcept
+    {
+        for (auto& block : m_blocks)
+        {
+            block->clear();
+        }
+        m_stored_elements = 0u;
+    }
+
+    // ========================================================================
+    // Capacity
+    // ========================================================================
+
+    /// @brief Allocate blocks until at least n elements fit
+    /// @param n Minimum total capacity
+    void reserve(size_t n)
+    {
+        const size_t needed_blocks = (n + BlockCapacity - 1u) >> N;
+        while (m_blocks.size() < needed_blocks)
+        {
+            m_blocks.push_back(std::make_unique<block_type>());
+        }
+    }
+
+    /// @brief Release the blocks holding no element
+    void shrink_to_fit()
+    {
+        m_blocks.resize((m_stored_elements + BlockCapacity - 1u) >> N);
+    }
+
+    /// @brief Get number of stored elements
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_stored_elements;
+    }
+
+    /// @brief Check if container is empty
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_stored_elements == 0u;
+    }
+
+    /// @brief Boolean conversion (true if not empty)
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+        return !empty();
+    }
+
+    /// @brief Get number of allocated blocks
+    [[nodiscard]] size_t block_count() const noexcept
+    {
+        return m_blocks.size();
+    }
+
+    /// @brief Get total capacity (allocated slots)
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return m_blocks.size() << N;
+    }
+
+    /// @brief Check if index is out of bounds
+    [[nodiscard]] bool out_of_bounds(size_t index) const noexcept
+    {
+        return index >= m_stored_elements;
+    }
+
+    /// @brief Check if a slot is occupied
+    [[nodiscard]] bool occupied(size_t index) const noexcept
+    {
+        return !out_of_bounds(index) &&
+               m_blocks[detail::block_index<N>(index)]->is_occupied(detail::sub_index<N>(index));
+    }
+
+private:
+    /// @brief Build a tuple of references on the fields of an element
+    template<typename Reference, typename Self, size_t... K>
+    [[nodiscard]] static Reference fields_at(Self& self, size_t index, std::index_sequence<K...>)
+    {
+        return Reference(self.template get<K>(index)...);
+    }
+
+    /// @brief Number of elements stored in a block
+    [[nodiscard]] size_t block_size(size_t bid) const noexcept
+    {
+        const size_t first = bid << N;
+        return (first >= m_stored_elements) ? 0u : std::min(BlockCapacity, m_stored_elements - first);
+    }
+
+    /// @brief Check if access to index is valid
+    /// @throw std::out_of_range if invalid
+    void check_access(size_t index) const
+    {
+        if (out_of_bounds(index))
+        {
+            throw std::out_of_range("SoASet::at - index " + std::to_string(index) +
+                                    " out of range (size=" + std::to_string(m_stored_elements) + ")");
+        }
+    }
+
+    std::vector<std::unique_ptr<block_type>> m_blocks;  ///< Block storage
+    size_t m_stored_elements = 0u;                       ///< Number of stored elements
+};
+
+} // namespace container
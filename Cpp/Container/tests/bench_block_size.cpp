@@ -0,0 +1,161 @@
+#include <benchmark/benchmark.h>
+#include "Set.hpp"
+#include <array>
+#include <cstdint>
+#include <sys/resource.h>
+
+using namespace container;
+
+// ============================================================================
+// Matrix of block sizes (N = 2..12) and element sizes, to pick N from data.
+//
+// Each benchmark reports:
+//   - items_per_second: append or iteration throughput
+//   - block_kb: memory held by the blocks of the filled container
+//   - peak_rss_kb: peak resident memory of the process so far. It is only
+//     meaningful per configuration when each one runs in its own process:
+//       ./bench_block_size --benchmark_filter='BM_Append<64, 8>/'
+// ============================================================================
+
+static constexpr int64_t ElementCount = 1 << 20;
+
+/// @brief Element of the given size in bytes
+template<size_t Bytes>
+struct Payload
+{
+    std::array<uint32_t, Bytes / sizeof(uint32_t)> words{};
+};
+
+/// @brief Peak resident memory of the process in KiB
+static size_t peak_rss_kb()
+{
+    struct rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);
+}
+
+/// @brief Memory held by the blocks of a set in KiB
+template<class T, size_t N>
+static size_t block_kb(const Set<T, N>& set)
+{
+    return set.block_count() * (size_t(1) << N) * sizeof(T) / 1024u;
+}
+
+/// @brief Report throughput and memory counters
+static void report(benchmark::State& state, size_t kb)
+{
+    state.SetItemsProcessed(state.iterations() * ElementCount);
+    state.counters["block_kb"] = benchmark::Counter(static_cast<double>(kb));
+    state.counters["peak_rss_kb"] = benchmark::Counter(static_cast<double>(peak_rss_kb()));
+}
+
+// ============================================================================
+// Append: one block per growth vs geometric batches vs reserve hint
+// ============================================================================
+
+template<size_t Bytes, size_t N>
+static void BM_Append(benchmark::State& state)
+{
+    const Payload<Bytes> value{};
+    size_t kb = 0u;
+    for (auto _ : state)
+    {
+        Set<Payload<Bytes>, N> set;
+        for (int64_t i = 0; i < ElementCount; ++i)
+        {
+            set += value;
+        }
+        benchmark::DoNotOptimize(&set[0]);
+        kb = block_kb(set);
+    }
+    report(state, kb);
+}
+
+template<size_t Bytes, size_t N>
+static void BM_AppendGeometric(benchmark::State& state)
+{
+    const Payload<Bytes> value{};
+    size_t kb = 0u;
+    for (auto _ : state)
+    {
+        Set<Payload<Bytes>, N> set;
+        set.set_growth_policy(GrowthPolicy::geometric());
+        for (int64_t i = 0; i < ElementCount; ++i)
+        {
+            set += value;
+        }
+        benchmark::DoNotOptimize(&set[0]);
+        kb = block_kb(set);
+    }
+    report(state, kb);
+}
+
+template<size_t Bytes, size_t N>
+static void BM_AppendReserved(benchmark::State& state)
+{
+    const Payload<Bytes> value{};
+    size_t kb = 0u;
+    for (auto _ : state)
+    {
+        Set<Payload<Bytes>, N> set;
+        set.reserve(static_cast<size_t>(ElementCount));
+        for (int64_t i = 0; i < ElementCount; ++i)
+        {
+            set += value;
+        }
+        benchmark::DoNotOptimize(&set[0]);
+        kb = block_kb(set);
+    }
+    report(state, kb);
+}
+
+// ============================================================================
+// Iteration: read the first word of every element
+// ============================================================================
+
+template<size_t Bytes, size_t N>
+static void BM_Iterate(benchmark::State& state)
+{
+    Set<Payload<Bytes>, N> set;
+    set.reserve(static_cast<size_t>(ElementCount));
+    for (int64_t i = 0; i < ElementCount; ++i)
+    {
+        Payload<Bytes> value{};
+        value.words[0] = static_cast<uint32_t>(i);
+        set += value;
+    }
+
+    for (auto _ : state)
+    {
+        uint64_t sum = 0u;
+        for (const auto& value : set)
+        {
+            sum += value.words[0];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, block_kb(set));
+}
+
+// ============================================================================
+// Registration: every benchmark for 4, 16, 64 and 256 byte elements
+// ============================================================================
+
+#define BENCH_BLOCK_SIZE(Bytes, N)                                                      \
+    BENCHMARK_TEMPLATE(BM_Append, Bytes, N)->Unit(benchmark::kMillisecond);             \
+    BENCHMARK_TEMPLATE(BM_AppendGeometric, Bytes, N)->Unit(benchmark::kMillisecond);    \
+    BENCHMARK_TEMPLATE(BM_AppendReserved, Bytes, N)->Unit(benchmark::kMillisecond);     \
+    BENCHMARK_TEMPLATE(BM_Iterate, Bytes, N)->Unit(benchmark::kMillisecond)
+
+#define BENCH_ELEMENT_SIZE(Bytes)                                                       \
+    BENCH_BLOCK_SIZE(Bytes, 2);  BENCH_BLOCK_SIZE(Bytes, 3);  BENCH_BLOCK_SIZE(Bytes, 4);  \
+    BENCH_BLOCK_SIZE(Bytes, 5);  BENCH_BLOCK_SIZE(Bytes, 6);  BENCH_BLOCK_SIZE(Bytes, 7);  \
+    BENCH_BLOCK_SIZE(Bytes, 8);  BENCH_BLOCK_SIZE(Bytes, 9);  BENCH_BLOCK_SIZE(Bytes, 10); \
+    BENCH_BLOCK_SIZE(Bytes, 11); BENCH_BLOCK_SIZE(Bytes, 12)
+
+BENCH_ELEMENT_SIZE(4);
+BENCH_ELEMENT_SIZE(16);
+BENCH_ELEMENT_SIZE(64);
+BENCH_ELEMENT_SIZE(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+#include "Collection.hpp"
+#include <optional>
+#include <random>
+
+using namespace container;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static constexpr size_t Slots = 1u << 20;
+
+/// @brief Collection with about density_percent % of its slots occupied
+static Collection<int, 8> make_collection(int64_t density_percent)
+{
+    Collection<int, 8> col;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int64_t> percent(0, 99);
+    for (size_t i = 0u; i < Slots; ++i)
+    {
+        if (percent(rng) < density_percent)
+        {
+            col.insert(i, static_cast<int>(i));
+        }
+    }
+    col.insert(Slots - 1u, 0);  // Same extent for every density
+    return col;
+}
+
+// ============================================================================
+// Iteration Benchmarks at 1%, 10%, 50% and 100% density
+// ============================================================================
+
+static void BM_IterateIndexScan(benchmark::State& state)
+{
+    // Reference: one occupied() test per slot (previous iterator behavior)
+    const auto col = make_collection(state.range(0));
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        for (size_t i = 0u; i < col.extent(); ++i)
+        {
+            if (col.occupied(i))
+            {
+                sum += col[i];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(col.size()));
+}
+BENCHMARK(BM_IterateIndexScan)->Arg(1)->Arg(10)->Arg(50)->Arg(100);
+
+static void BM_IterateIterator(benchmark::State& state)
+{
+    const auto col = make_collection(state.range(0));
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        for (const int value : col)
+        {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(col.size()));
+}
+BENCHMARK(BM_IterateIterator)->Arg(1)->Arg(10)->Arg(50)->Arg(100);
+
+static void BM_IterateForEachOccupied(benchmark::State& state)
+{
+    const auto col = make_collection(state.range(0));
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        col.for_each_occupied([&sum](const int& value) { sum += value; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(col.size()));
+}
+BENCHMARK(BM_IterateForEachOccupied)->Arg(1)->Arg(10)->Arg(50)->Arg(100);
+
+// ============================================================================
+// Compaction Benchmarks: iterate after churn, before and after compact()
+// ============================================================================
+
+static void BM_IterateFragmented(benchmark::State& state)
+{
+    const auto col = make_collection(state.range(0));
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        col.for_each_occupied([&sum](const int& value) { sum += value; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["MiB"] = static_cast<double>(col.fragmentation().allocated_blocks * 256u * sizeof(int)) / (1 << 20);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(col.size()));
+}
+BENCHMARK(BM_IterateFragmented)->Arg(1)->Arg(10)->Arg(50);
+
+static void BM_IterateCompacted(benchmark::State& state)
+{
+    auto col = make_collection(state.range(0));
+    col.compact();
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        col.for_each_occupied([&sum](const int& value) { sum += value; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["MiB"] = static_cast<double>(col.fragmentation().allocated_blocks * 256u * sizeof(int)) / (1 << 20);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(col.size()));
+}
+BENCHMARK(BM_IterateCompacted)->Arg(1)->Arg(10)->Arg(50);
+
+static void BM_CompactFrameBudget(benchmark::State& state)
+{
+    // Cost of one frame compacting at most 1024 elements. The collection is
+    // rebuilt (and the previous one destroyed) outside the timed region.
+    std::optional<Collection<int, 8>> col;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        col.reset();
+        col.emplace(make_collection(state.range(0)));
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(col->compact(1024u));
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_CompactFrameBudget)->Arg(1)->Arg(10)->Arg(50)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
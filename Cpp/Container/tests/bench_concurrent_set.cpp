@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+#include "ConcurrentSet.hpp"
+#include <memory>
+#include <mutex>
+
+using namespace container;
+
+// ============================================================================
+// Scaling Benchmarks: 1 to 32 producer threads
+// ============================================================================
+
+static constexpr int64_t AppendsPerIteration = 4096;
+static constexpr int64_t Iterations = 100;
+
+static std::unique_ptr<ConcurrentSet<int64_t, 10>> g_concurrent_set;
+static std::unique_ptr<Set<int64_t, 10>> g_locked_set;
+static std::mutex g_mutex;
+
+static void BM_ConcurrentSetAppend(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        g_concurrent_set = std::make_unique<ConcurrentSet<int64_t, 10>>();
+    }
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < AppendsPerIteration; ++i)
+        {
+            *g_concurrent_set += i;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * AppendsPerIteration);
+}
+BENCHMARK(BM_ConcurrentSetAppend)->ThreadRange(1, 32)->Iterations(Iterations)->UseRealTime();
+
+static void BM_MutexSetAppend(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        g_locked_set = std::make_unique<Set<int64_t, 10>>();
+    }
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < AppendsPerIteration; ++i)
+        {
+            std::scoped_lock lock(g_mutex);
+            *g_locked_set += i;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * AppendsPerIteration);
+}
+BENCHMARK(BM_MutexSetAppend)->ThreadRange(1, 32)->Iterations(Iterations)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,208 @@
+#include <benchmark/benchmark.h>
+#include "Set.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+// ============================================================================
+// Allocation counting: every operator new in this binary is counted
+// ============================================================================
+
+static std::atomic<size_t> g_allocations{0u};
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1u, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// ============================================================================
+// Heavy element type
+// ============================================================================
+
+struct Mesh
+{
+    Mesh() = default;
+    Mesh(size_t vertices, std::string mesh_name)
+        : positions(vertices, 1.0f), name(std::move(mesh_name))
+    {}
+
+    std::vector<float> positions;
+    std::string name;
+};
+
+static constexpr size_t MeshCount = 1024u;
+static constexpr size_t VerticesPerMesh = 256u;
+
+static Set<Mesh, 6> make_meshes()
+{
+    Set<Mesh, 6> set;
+    for (size_t i = 0u; i < MeshCount; ++i)
+    {
+        // Growing sizes so that copies into an existing slot must reallocate
+        set.emplace_back(VerticesPerMesh + i, "mesh_with_a_long_enough_name_" + std::to_string(i));
+    }
+    return set;
+}
+
+/// @brief Report the number of allocations done per processed element
+static void report_allocations(benchmark::State& state, size_t allocations)
+{
+    const auto elements = state.iterations() * static_cast<benchmark::IterationCount>(MeshCount);
+    state.counters["allocs_per_elem"] = benchmark::Counter(
+        static_cast<double>(allocations) / static_cast<double>(elements));
+    state.SetItemsProcessed(elements);
+}
+
+// ============================================================================
+// Removal: copy-based swap-and-pop (previous behavior) vs move-based remove()
+// ============================================================================
+
+static void BM_RemoveByCopy(benchmark::State& state)
+{
+    size_t allocations = 0u;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto set = make_meshes();
+        const size_t before = g_allocations.load();
+        state.ResumeTiming();
+
+        while (set.size() > 1u)
+        {
+            set[0] = set[set.size() - 1u];
+            set.pop_back();
+        }
+
+        state.PauseTiming();
+        allocations += g_allocations.load() - before;
+        state.ResumeTiming();
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_RemoveByCopy);
+
+static void BM_RemoveByMove(benchmark::State& state)
+{
+    size_t allocations = 0u;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto set = make_meshes();
+        const size_t before = g_allocations.load();
+        state.ResumeTiming();
+
+        while (set.size() > 1u)
+        {
+            set.remove(0u);
+        }
+
+        state.PauseTiming();
+        allocations += g_allocations.load() - before;
+        state.ResumeTiming();
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_RemoveByMove);
+
+// ============================================================================
+// Swap: through a copied temporary (previous behavior) vs std::ranges::swap
+// ============================================================================
+
+static void BM_SwapByCopy(benchmark::State& state)
+{
+    auto set = make_meshes();
+    size_t allocations = 0u;
+    for (auto _ : state)
+    {
+        const size_t before = g_allocations.load();
+        for (size_t i = 0u; i < MeshCount / 2u; ++i)
+        {
+            const size_t j = MeshCount - 1u - i;
+            Mesh temp = set[i];
+            set[i] = set[j];
+            set[j] = temp;
+        }
+        allocations += g_allocations.load() - before;
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_SwapByCopy);
+
+static void BM_SwapByMove(benchmark::State& state)
+{
+    auto set = make_meshes();
+    size_t allocations = 0u;
+    for (auto _ : state)
+    {
+        const size_t before = g_allocations.load();
+        for (size_t i = 0u; i < MeshCount / 2u; ++i)
+        {
+            set.swap(i, MeshCount - 1u - i);
+        }
+        allocations += g_allocations.load() - before;
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_SwapByMove);
+
+// ============================================================================
+// Insertion: copy a temporary vs construct in place
+// ============================================================================
+
+static void BM_AppendByCopy(benchmark::State& state)
+{
+    size_t allocations = 0u;
+    for (auto _ : state)
+    {
+        const size_t before = g_allocations.load();
+        Set<Mesh, 6> set;
+        for (size_t i = 0u; i < MeshCount; ++i)
+        {
+            const Mesh mesh(VerticesPerMesh, "mesh_with_a_long_enough_name");
+            set += mesh;
+        }
+        allocations += g_allocations.load() - before;
+        benchmark::DoNotOptimize(&set[0]);
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_AppendByCopy);
+
+static void BM_AppendByEmplace(benchmark::State& state)
+{
+    size_t allocations = 0u;
+    for (auto _ : state)
+    {
+        const size_t before = g_allocations.load();
+        Set<Mesh, 6> set;
+        for (size_t i = 0u; i < MeshCount; ++i)
+        {
+            set.emplace_back(VerticesPerMesh, "mesh_with_a_long_enough_name");
+        }
+        allocations += g_allocations.load() - before;
+        benchmark::DoNotOptimize(&set[0]);
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_AppendByEmplace);
+
+BENCHMARK_MAIN();
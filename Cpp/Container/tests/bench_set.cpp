@@ -0,0 +1,542 @@
+#include <benchmark/benchmark.h>
+#include "Set.hpp"
+#include "BlockPool.hpp"
+#include "MappedFile.hpp"
+#include "ParallelForEach.hpp"
+#include <algorithm>
+#include <execution>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace container;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static std::vector<float> make_data(size_t count)
+{
+    std::vector<float> data(count);
+    std::iota(data.begin(), data.end(), 0.0f);
+    return data;
+}
+
+// ============================================================================
+// Append Benchmarks
+// ============================================================================
+
+static void BM_VectorAppend(benchmark::State& state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        std::vector<float> vec;
+        vec.insert(vec.end(), data.begin(), data.end());
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorAppend)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+static void BM_SetAppendOneByOne(benchmark::State& state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        Set<float, 10> set;
+        for (const float value : data)
+        {
+            set += value;
+        }
+        benchmark::DoNotOptimize(&set[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetAppendOneByOne)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+static void BM_SetAppendBulk(benchmark::State& state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        Set<float, 10> set;
+        set += std::span<const float>(data);
+        benchmark::DoNotOptimize(&set[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetAppendBulk)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+// ============================================================================
+// Remove Benchmarks
+// ============================================================================
+
+static void BM_VectorEraseIf(benchmark::State& state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::vector<float> vec(data);
+        state.ResumeTiming();
+        std::erase_if(vec, [](float x) { return static_cast<int>(x) % 3 == 0; });
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorEraseIf)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+static void BM_SetRemoveIf(benchmark::State& state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Set<float, 10> set;
+        set += std::span<const float>(data);
+        state.ResumeTiming();
+        set.remove_if([](float x) { return static_cast<int>(x) % 3 == 0; });
+        benchmark::DoNotOptimize(&set[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetRemoveIf)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+// ============================================================================
+// For-each Benchmarks
+// ============================================================================
+
+static void BM_VectorForEach(benchmark::State& state)
+{
+    auto vec = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        std::for_each(vec.begin(), vec.end(), [](float& x) { x = x * 0.5f + 1.0f; });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorForEach)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+static void BM_SetForEachSequenced(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        parallel_for_each(std::execution::seq, set, [](float& x) { x = x * 0.5f + 1.0f; });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetForEachSequenced)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+static void BM_SetForEachParallel(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        parallel_for_each(std::execution::par, set, [](float& x) { x = x * 0.5f + 1.0f; });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetForEachParallel)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+// ============================================================================
+// Standard Algorithm Benchmarks: iterators and segments against std::vector
+// ============================================================================
+
+static std::vector<float> make_shuffled(size_t count)
+{
+    auto data = make_data(count);
+    std::shuffle(data.begin(), data.end(), std::mt19937(42));
+    return data;
+}
+
+static void BM_VectorSort(benchmark::State& state)
+{
+    const auto shuffled = make_shuffled(static_cast<size_t>(state.range(0)));
+    auto vec = shuffled;
+    for (auto _ : state)
+    {
+        // The copy restoring the unsorted order is timed for both containers
+        std::copy(shuffled.begin(), shuffled.end(), vec.begin());
+        std::sort(vec.begin(), vec.end());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorSort)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+static void BM_SetSort(benchmark::State& state)
+{
+    const auto shuffled = make_shuffled(static_cast<size_t>(state.range(0)));
+    Set<float, 10> set;
+    set += std::span<const float>(shuffled);
+    for (auto _ : state)
+    {
+        std::copy(shuffled.begin(), shuffled.end(), set.begin());
+        std::sort(set.begin(), set.end());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetSort)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+
+static void BM_VectorReduce(benchmark::State& state)
+{
+    const auto vec = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::reduce(std::execution::par_unseq, vec.begin(), vec.end(), 0.0f));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorReduce)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+static void BM_SetReduceIndexed(benchmark::State& state)
+{
+    // What the former forward iterator did: operator[] on every element
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0u; i < set.size(); ++i)
+        {
+            sum += set[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetReduceIndexed)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+static void BM_SetReduce(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::reduce(std::execution::par_unseq, set.cbegin(), set.cend(), 0.0f));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetReduce)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+static void BM_SetReduceSegments(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        auto blocks = std::as_const(set).segments();
+        benchmark::DoNotOptimize(std::transform_reduce(std::execution::par, blocks.begin(), blocks.end(), 0.0f,
+            std::plus<>(), [](std::span<const float> block)
+            {
+                return std::reduce(std::execution::unseq, block.begin(), block.end(), 0.0f);
+            }));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetReduceSegments)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+static void BM_VectorTransform(benchmark::State& state)
+{
+    auto vec = make_data(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        std::transform(std::execution::par_unseq, vec.begin(), vec.end(), vec.begin(),
+                       [](float x) { return x * 0.5f + 1.0f; });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorTransform)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+static void BM_SetTransform(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        std::transform(std::execution::par_unseq, set.begin(), set.end(), set.begin(),
+                       [](float x) { return x * 0.5f + 1.0f; });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetTransform)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+static void BM_SetTransformSegments(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        auto blocks = set.segments();
+        std::for_each(std::execution::par, blocks.begin(), blocks.end(), [](std::span<float> block)
+        {
+            std::transform(block.begin(), block.end(), block.begin(), [](float x) { return x * 0.5f + 1.0f; });
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetTransformSegments)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+
+// ============================================================================
+// Block Allocation Benchmarks
+// ============================================================================
+
+/// @brief Large element with a non-trivial default constructor
+struct Particle
+{
+    float attributes[32] = {};
+};
+
+static void BM_VectorReserveLarge(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        std::vector<Particle> vec;
+        vec.reserve(1u << 12);
+        vec.emplace_back();
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+BENCHMARK(BM_VectorReserveLarge);
+
+static void BM_SetFirstInsertLargeBlock(benchmark::State& state)
+{
+    // Blocks of 4096 particles: only the inserted one is constructed
+    for (auto _ : state)
+    {
+        Set<Particle, 12> set;
+        set.emplace_back();
+        benchmark::DoNotOptimize(&set[0]);
+    }
+}
+BENCHMARK(BM_SetFirstInsertLargeBlock);
+
+// ============================================================================
+// Grow/Shrink Benchmarks: many short-lived containers per frame
+// ============================================================================
+
+static constexpr size_t ContainersPerFrame = 32u;
+
+template<typename MakeSet>
+static void grow_shrink(benchmark::State& state, MakeSet make_set)
+{
+    const size_t elements = static_cast<size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        for (size_t c = 0u; c < ContainersPerFrame; ++c)
+        {
+            auto set = make_set();
+            for (size_t i = 0u; i < elements; ++i)
+            {
+                set += static_cast<float>(i);
+            }
+            benchmark::DoNotOptimize(&set[0]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) *
+                            static_cast<int64_t>(ContainersPerFrame));
+}
+
+static void BM_GrowShrinkHeap(benchmark::State& state)
+{
+    grow_shrink(state, []() { return Set<float, 8>(); });
+}
+BENCHMARK(BM_GrowShrinkHeap)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+
+static void BM_GrowShrinkPool(benchmark::State& state)
+{
+    BlockPool<float, 8> pool;
+    grow_shrink(state, [&pool]() { return Set<float, 8>(pool); });
+    const auto stats = pool.stats();
+    state.counters["pool_hits"] = static_cast<double>(stats.hits);
+    state.counters["pool_misses"] = static_cast<double>(stats.misses);
+}
+BENCHMARK(BM_GrowShrinkPool)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+
+static void BM_GrowShrinkHugePagePool(benchmark::State& state)
+{
+    BlockPool<float, 8> pool(BlockPool<float, 8>::Mode::HugePages);
+    grow_shrink(state, [&pool]() { return Set<float, 8>(pool); });
+    const auto stats = pool.stats();
+    state.counters["pool_hits"] = static_cast<double>(stats.hits);
+    state.counters["pool_misses"] = static_cast<double>(stats.misses);
+}
+BENCHMARK(BM_GrowShrinkHugePagePool)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+
+// ============================================================================
+// Sync Benchmarks: bytes "uploaded" after sparse random writes
+// ============================================================================
+
+static constexpr size_t SyncedElements = 1u << 20;
+
+/// @brief Write state.range(0) random elements, tagging them as pending
+static void sparse_writes(Set<float, 10>& set, std::mt19937& rng, int64_t writes)
+{
+    std::uniform_int_distribution<size_t> index(0u, set.size() - 1u);
+    for (int64_t i = 0; i < writes; ++i)
+    {
+        const size_t at = index(rng);
+        set[at] += 1.0f;
+        set.tag_as_pending(at);
+    }
+}
+
+static void BM_SyncSingleRange(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(SyncedElements));
+    set.clear_pending();  // Initial upload done
+    std::vector<float> gpu(SyncedElements);
+    std::mt19937 rng(42);
+    size_t bytes = 0u;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        sparse_writes(set, rng, state.range(0));
+        state.ResumeTiming();
+
+        // One contiguous upload of [start, end), one copy per block
+        auto [start, end] = set.get_pending_range();
+        for (size_t i = start; i < end; i = (i | 1023u) + 1u)
+        {
+            const size_t count = std::min(end, (i | 1023u) + 1u) - i;
+            std::memcpy(&gpu[i], &set[i], count * sizeof(float));
+            bytes += count * sizeof(float);
+        }
+        set.clear_pending();
+    }
+    state.counters["bytes_per_sync"] = static_cast<double>(bytes) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_SyncSingleRange)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_SyncFlushPending(benchmark::State& state)
+{
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(SyncedElements));
+    set.clear_pending();  // Initial upload done
+    std::vector<float> gpu(SyncedElements);
+    std::mt19937 rng(42);
+    size_t bytes = 0u;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        sparse_writes(set, rng, state.range(0));
+        state.ResumeTiming();
+
+        set.flush_pending([&gpu, &bytes](size_t first, std::span<const float> data)
+        {
+            std::memcpy(&gpu[first], data.data(), data.size_bytes());
+            bytes += data.size_bytes();
+        });
+    }
+    state.counters["bytes_per_sync"] = static_cast<double>(bytes) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_SyncFlushPending)->Arg(16)->Arg(256)->Arg(4096);
+
+// ============================================================================
+// Persistence Benchmarks: restart from a saved file
+// ============================================================================
+
+static std::filesystem::path bench_file(const char* name)
+{
+    return std::filesystem::temp_directory_path() / name;
+}
+
+static void BM_LoadByRead(benchmark::State& state)
+{
+    const auto path = bench_file("bench_set_load.bin");
+    {
+        Set<float, 10> set;
+        set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+        save(set, path);
+    }
+
+    for (auto _ : state)
+    {
+        // Full deserialization: read every block and append it
+        auto mapped = open_mmap<Set<float, 10>>(path);
+        Set<float, 10> set;
+        for (size_t bid = 0u; bid < mapped.block_count(); ++bid)
+        {
+            const size_t first = bid << 10;
+            const size_t count = std::min<size_t>(1024u, mapped.size() - first);
+            set += std::span<const float>(&mapped[first], count);
+        }
+        benchmark::DoNotOptimize(&set[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(float)));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_LoadByRead)->RangeMultiplier(16)->Range(1 << 16, 1 << 24)->Unit(benchmark::kMicrosecond);
+
+static void BM_OpenMmap(benchmark::State& state)
+{
+    const auto path = bench_file("bench_set_open.bin");
+    {
+        Set<float, 10> set;
+        set += std::span<const float>(make_data(static_cast<size_t>(state.range(0))));
+        save(set, path);
+    }
+
+    for (auto _ : state)
+    {
+        auto mapped = open_mmap<Set<float, 10>>(path);
+        benchmark::DoNotOptimize(mapped[mapped.size() / 2u]);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(float)));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_OpenMmap)->RangeMultiplier(16)->Range(1 << 16, 1 << 24)->Unit(benchmark::kMicrosecond);
+
+static void BM_PersistBySave(benchmark::State& state)
+{
+    const auto path = bench_file("bench_set_save.bin");
+    Set<float, 10> set;
+    set += std::span<const float>(make_data(SyncedElements));
+    std::mt19937 rng(42);
+
+    for (auto _ : state)
+    {
+        sparse_writes(set, rng, state.range(0));
+        save(set, path);
+    }
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_PersistBySave)->Arg(16)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+static void BM_PersistBySync(benchmark::State& state)
+{
+    const auto path = bench_file("bench_set_sync.bin");
+    {
+        Set<float, 10> set;
+        set += std::span<const float>(make_data(SyncedElements));
+        save(set, path);
+    }
+    auto set = open_mmap<Set<float, 10>>(path, MapMode::Shared);
+    std::mt19937 rng(42);
+
+    for (auto _ : state)
+    {
+        sparse_writes(set, rng, state.range(0));
+        sync(set);  // Only the pages holding the written elements
+    }
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_PersistBySync)->Arg(16)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
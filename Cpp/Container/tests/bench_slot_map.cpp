@@ -0,0 +1,136 @@
+#include <benchmark/benchmark.h>
+#include "SlotMap.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace container;
+
+// ============================================================================
+// Entities referenced by id (unordered_map) or by handle (SlotMap)
+// ============================================================================
+
+struct Entity
+{
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    uint32_t flags = 0u;
+};
+
+using EntityMap = std::unordered_map<uint64_t, Entity>;
+using EntitySlots = SlotMap<Entity, 10>;
+
+/// @brief Random order of the indices [0, count)
+static std::vector<size_t> shuffled_indices(size_t count)
+{
+    std::vector<size_t> order(count);
+    for (size_t i = 0u; i < count; ++i)
+    {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    return order;
+}
+
+// ============================================================================
+// Lookup: random access to live entities
+// ============================================================================
+
+static void BM_LookupUnorderedMap(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    EntityMap map;
+    for (uint64_t id = 0u; id < count; ++id)
+    {
+        map.emplace(id, Entity{});
+    }
+    const auto order = shuffled_indices(count);
+
+    for (auto _ : state)
+    {
+        for (const size_t id : order)
+        {
+            auto it = map.find(id);
+            benchmark::DoNotOptimize(it->second.x += 1.0f);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LookupUnorderedMap)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_LookupSlotMap(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    EntitySlots slots;
+    std::vector<Handle> handles;
+    for (size_t i = 0u; i < count; ++i)
+    {
+        handles.push_back(slots.emplace());
+    }
+    const auto order = shuffled_indices(count);
+
+    for (auto _ : state)
+    {
+        for (const size_t i : order)
+        {
+            Entity* entity = slots.get(handles[i]);
+            benchmark::DoNotOptimize(entity->x += 1.0f);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LookupSlotMap)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+// ============================================================================
+// Churn: destroy a random entity and spawn a new one, keeping the count
+// ============================================================================
+
+static void BM_ChurnUnorderedMap(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    EntityMap map;
+    std::vector<uint64_t> ids;
+    uint64_t next_id = 0u;
+    for (; next_id < count; ++next_id)
+    {
+        map.emplace(next_id, Entity{});
+        ids.push_back(next_id);
+    }
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0u, count - 1u);
+
+    for (auto _ : state)
+    {
+        uint64_t& victim = ids[pick(rng)];
+        map.erase(victim);
+        victim = next_id++;
+        map.emplace(victim, Entity{});
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ChurnUnorderedMap)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_ChurnSlotMap(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    EntitySlots slots;
+    std::vector<Handle> handles;
+    for (size_t i = 0u; i < count; ++i)
+    {
+        handles.push_back(slots.emplace());
+    }
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0u, count - 1u);
+
+    for (auto _ : state)
+    {
+        Handle& victim = handles[pick(rng)];
+        slots.remove(victim);
+        victim = slots.emplace();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ChurnSlotMap)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
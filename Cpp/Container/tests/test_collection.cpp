@@ -1,8 +1,13 @@
 #include <gtest/gtest.h>
 #include "Collection.hpp"
+#include "BlockPool.hpp"
+#include "MappedFile.hpp"
 #include <string>
 #include <vector>
 #include <set>
+#include <memory>
+#include <filesystem>
+#include <chrono>
 
 using namespace container;
 
@@ -354,6 +359,33 @@ TEST(CollectionTest, IteratorAfterRemovingAll)
     EXPECT_EQ(col.begin(), col.end());
 }
 
+TEST(CollectionTest, IteratorSkipsElementsRemovedDuringLoop)
+{
+    // 256 slots per block: the removed elements share the bitfield word of
+    // the current one
+    Collection<std::string, 8> col;
+    for (int i = 0; i < 100; ++i)
+    {
+        col += std::to_string(i);
+    }
+
+    std::vector<std::string> visited;
+    for (const auto& elem : col)
+    {
+        visited.push_back(elem);
+        const size_t index = std::stoul(elem);
+        col.remove(index + 1u);
+        col.remove(index + 2u);
+    }
+
+    ASSERT_EQ(visited.size(), 34u);
+    for (size_t i = 0; i < visited.size(); ++i)
+    {
+        EXPECT_EQ(visited[i], std::to_string(3u * i));
+    }
+    EXPECT_EQ(col.size(), 34u);
+}
+
 // ============================================================================
 // Sparse Usage Patterns
 // ============================================================================
@@ -454,6 +486,441 @@ TEST(CollectionTest, DifferentBlockSizes)
     }
 }
 
+// ============================================================================
+// Move Semantics Tests
+// ============================================================================
+
+TEST(CollectionTest, MoveOnlyElements)
+{
+    Collection<std::unique_ptr<int>, 2> col;
+    col += std::make_unique<int>(1);
+    col.insert(5, std::make_unique<int>(5));
+    col.emplace_back(new int(6));
+
+    EXPECT_EQ(col.size(), 3u);
+    EXPECT_EQ(*col[0], 1);
+    EXPECT_EQ(*col[5], 5);
+    EXPECT_EQ(*col[6], 6);
+    EXPECT_EQ(col.extent(), 7u);
+
+    col.remove(5);
+    EXPECT_FALSE(col.occupied(5));
+}
+
+TEST(CollectionTest, EmplaceAtIndex)
+{
+    Collection<std::string> col;
+    std::string& s = col.emplace(3, 2u, 'a');
+    EXPECT_EQ(s, "aa");
+    EXPECT_TRUE(col.occupied(3));
+    EXPECT_EQ(col.size(), 1u);
+
+    // Emplacing over an existing element replaces it
+    col.emplace(3, "bb");
+    EXPECT_EQ(col[3], "bb");
+    EXPECT_EQ(col.size(), 1u);
+
+    auto [start, end] = col.get_pending_range();
+    EXPECT_EQ(start, 3u);
+    EXPECT_EQ(end, 4u);
+}
+
+// ============================================================================
+// Element Lifetime Tests
+// ============================================================================
+
+namespace {
+
+/// @brief Counts living instances, not default constructible
+struct Tracked
+{
+    static inline int alive = 0;
+
+    explicit Tracked(int v) : value(v) { ++alive; }
+    Tracked(const Tracked& other) : value(other.value) { ++alive; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { ++alive; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) noexcept = default;
+    ~Tracked() { --alive; }
+
+    int value;
+};
+
+} // namespace
+
+TEST(CollectionTest, HolesDoNotHoldElements)
+{
+    Tracked::alive = 0;
+    {
+        Collection<Tracked, 4> col;
+        col.emplace(100, 1);
+        EXPECT_EQ(col.size(), 1u);
+        EXPECT_EQ(Tracked::alive, 1);  // The 100 slots before are not constructed
+
+        col.emplace(100, 2);           // Replaces the element in place
+        EXPECT_EQ(Tracked::alive, 1);
+        EXPECT_EQ(col[100].value, 2);
+
+        col.insert(3, Tracked(3));
+        EXPECT_EQ(Tracked::alive, 2);
+
+        col.remove(100);
+        EXPECT_EQ(Tracked::alive, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+// ============================================================================
+// Pending Ranges Tests
+// ============================================================================
+
+TEST(CollectionTest, PendingRangesSkipHoles)
+{
+    Collection<int, 3> col;
+    col.insert(2, 2);
+    col.insert(3, 3);
+    col.insert(50, 50);
+    col.insert(51, 51);
+    col.remove(51);
+
+    const auto ranges = col.get_pending_ranges();
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0], std::make_pair(size_t(2), size_t(4)));
+    EXPECT_EQ(ranges[1], std::make_pair(size_t(50), size_t(51)));
+
+    std::vector<int> flushed;
+    col.flush_pending([&flushed](std::span<const int> data)
+    {
+        flushed.insert(flushed.end(), data.begin(), data.end());
+    });
+    EXPECT_EQ(flushed, (std::vector<int>{2, 3, 50}));
+    EXPECT_TRUE(col.get_pending_ranges().empty());
+}
+
+// ============================================================================
+// Hole Skipping Tests
+// ============================================================================
+
+TEST(CollectionTest, IteratorSkipsEmptyBlocksAndWords)
+{
+    Collection<int, 7> col;  // 128 slots per block: 2 bitfield words
+    const std::vector<size_t> indices = {3, 64, 127, 128, 600, 1000, 1023};
+    for (size_t index : indices)
+    {
+        col.insert(index, static_cast<int>(index));
+    }
+
+    std::vector<int> values(col.begin(), col.end());
+    EXPECT_EQ(values, (std::vector<int>{3, 64, 127, 128, 600, 1000, 1023}));
+}
+
+TEST(CollectionTest, BoundsAfterRemovingAcrossBlocks)
+{
+    Collection<int, 7> col;
+    col.insert(5, 5);
+    col.insert(200, 200);
+    col.insert(900, 900);
+
+    col.remove(900);
+    EXPECT_EQ(col.extent(), 201u);
+    col.remove(5);
+    EXPECT_EQ(*col.begin(), 200);
+    EXPECT_EQ(col.extent(), 201u);
+    col.remove(200);
+    EXPECT_EQ(col.extent(), 0u);
+    EXPECT_EQ(col.begin(), col.end());
+}
+
+TEST(CollectionTest, ForEachOccupied)
+{
+    Collection<int, 2> col;
+    col.insert(1, 10);
+    col.insert(6, 60);
+    col.insert(40, 400);
+
+    std::vector<std::pair<size_t, int>> visited;
+    col.for_each_occupied([&visited](size_t index, int& value)
+    {
+        visited.emplace_back(index, value);
+        value += 1;
+    });
+    EXPECT_EQ(visited, (std::vector<std::pair<size_t, int>>{{1, 10}, {6, 60}, {40, 400}}));
+
+    const auto& ccol = col;
+    int sum = 0;
+    ccol.for_each_occupied([&sum](const int& value) { sum += value; });
+    EXPECT_EQ(sum, 473);
+}
+
+// ============================================================================
+// Compaction Tests
+// ============================================================================
+
+namespace {
+
+/// @brief Collection<int, 2> whose blocks hold 3, 1, 2 and 1 elements
+Collection<int, 2> make_fragmented()
+{
+    Collection<int, 2> col;
+    for (int i = 0; i < 16; ++i)
+    {
+        col += i;
+    }
+    for (size_t index : {3u, 4u, 5u, 6u, 8u, 9u, 13u, 14u, 15u})
+    {
+        col.remove(index);
+    }
+    return col;
+}
+
+} // namespace
+
+TEST(CollectionTest, FragmentationMetrics)
+{
+    auto col = make_fragmented();
+    const auto stats = col.fragmentation();
+
+    EXPECT_EQ(stats.occupancy, (std::vector<size_t>{3u, 1u, 2u, 1u}));
+    EXPECT_EQ(stats.allocated_blocks, 4u);
+    EXPECT_EQ(stats.used_blocks, 4u);
+    EXPECT_EQ(stats.min_blocks, 2u);
+    EXPECT_EQ(stats.wasted_bytes, 9u * sizeof(int));
+}
+
+TEST(CollectionTest, CompactEvacuatesSparsestBlocks)
+{
+    auto col = make_fragmented();
+    const auto remap = col.compact();
+
+    // The last one-element block goes first, then the other one
+    ASSERT_EQ(remap.size(), 2u);
+    EXPECT_EQ(remap[0], (std::pair<size_t, size_t>{12u, 3u}));
+    EXPECT_EQ(remap[1], (std::pair<size_t, size_t>{7u, 8u}));
+    EXPECT_EQ(col[3], 12);
+    EXPECT_EQ(col[8], 7);
+    EXPECT_FALSE(col.occupied(12));
+    EXPECT_EQ(col.size(), 7u);
+    EXPECT_EQ(col.extent(), 12u);
+
+    const auto stats = col.fragmentation();
+    EXPECT_EQ(stats.occupancy, (std::vector<size_t>{4u, 0u, 3u, 0u}));
+    EXPECT_EQ(stats.allocated_blocks, 2u);
+    EXPECT_EQ(stats.used_blocks, stats.min_blocks);
+    EXPECT_EQ(stats.wasted_bytes, sizeof(int));
+    EXPECT_TRUE(col.compact().empty());
+
+    // Emptied blocks can be used again
+    col.insert(5, 50);
+    EXPECT_EQ(col.at(5), 50);
+}
+
+TEST(CollectionTest, CompactSpreadsOverCalls)
+{
+    auto col = make_fragmented();
+    auto reference = make_fragmented();
+    const auto remap = reference.compact();
+
+    std::vector<std::pair<size_t, size_t>> moves;
+    for (auto step = col.compact(1u); !step.empty(); step = col.compact(1u))
+    {
+        ASSERT_EQ(step.size(), 1u);
+        moves.push_back(step[0]);
+    }
+    EXPECT_EQ(moves, remap);
+    EXPECT_TRUE(col.compact(std::chrono::milliseconds(10)).empty());
+}
+
+TEST(CollectionTest, CompactMovesElementsOnce)
+{
+    Collection<std::unique_ptr<int>, 3> col;
+    for (int i = 0; i < 64; ++i)
+    {
+        col.emplace_back(std::make_unique<int>(i));
+    }
+    for (size_t i = 0u; i < 64u; ++i)
+    {
+        if (i % 3u != 0u)
+        {
+            col.remove(i);
+        }
+    }
+
+    std::vector<int> before;
+    for (const auto& elem : col)
+    {
+        before.push_back(*elem);
+    }
+    col.compact(std::chrono::seconds(1));
+
+    std::multiset<int> after;
+    for (const auto& elem : col)
+    {
+        after.insert(*elem);
+    }
+    EXPECT_EQ(after, std::multiset<int>(before.begin(), before.end()));
+    EXPECT_EQ(col.fragmentation().used_blocks, 3u);
+}
+
+TEST(CollectionTest, CompactFreesSlabs)
+{
+    Collection<int, 2> col;
+    col.set_growth_policy(GrowthPolicy::geometric());
+    for (int i = 0; i < 32; ++i)
+    {
+        col += i;
+    }
+    for (size_t index = 0u; index < 32u; ++index)
+    {
+        if (index % 8u != 0u)
+        {
+            col.remove(index);
+        }
+    }
+
+    // The three evacuated blocks are released, the empty ones are left
+    col.compact();
+    EXPECT_EQ(col.fragmentation().allocated_blocks, 5u);
+    col.shrink_to_fit();
+    EXPECT_EQ(col.block_count(), 1u);
+    EXPECT_EQ(col.size(), 4u);
+    col.insert(30, 30);
+    EXPECT_EQ(col.at(30), 30);
+}
+
+TEST(CollectionTest, CompactGivesBlocksToPool)
+{
+    BlockPool<int, 2> pool;
+    Collection<int, 2> col(pool);
+    for (int i = 0; i < 16; ++i)
+    {
+        col += i;
+    }
+    for (size_t index = 1u; index < 16u; index += 2u)
+    {
+        col.remove(index);
+    }
+
+    col.compact();
+    EXPECT_EQ(pool.stats().released, 2u);
+    EXPECT_EQ(col.fragmentation().allocated_blocks, 2u);
+}
+
+TEST(CollectionTest, RefillsCompactedBlockFromPool)
+{
+    BlockPool<int, 2> pool;
+    {
+        Collection<int, 2> col(pool);
+        for (int i = 0; i < 16; ++i)
+        {
+            col += i;
+        }
+        for (size_t index = 1u; index < 16u; index += 2u)
+        {
+            col.remove(index);
+        }
+        col.compact();
+
+        // The last blocks were emptied: inserting there recycles a pooled block
+        col.insert(13, 13);
+        EXPECT_EQ(col.at(13), 13);
+        EXPECT_EQ(pool.stats().hits, 1u);
+        EXPECT_EQ(col.fragmentation().allocated_blocks, 3u);
+    }
+
+    // Only blocks with storage went back to the pool
+    const auto stats = pool.stats();
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.released, 5u);
+    EXPECT_EQ(stats.cached, 4u);
+}
+
+// ============================================================================
+// Block Pool Tests
+// ============================================================================
+
+TEST(CollectionTest, SharesPoolWithSet)
+{
+    BlockPool<int, 2> pool;
+    {
+        Set<int, 2> set(pool);
+        set += {1, 2, 3, 4, 5, 6, 7, 8};
+    }
+
+    Collection<int, 2> col(pool);
+    col.insert(6, 42);
+    EXPECT_EQ(col[6], 42);
+    EXPECT_FALSE(col.occupied(0));  // Recycled blocks come back empty
+    EXPECT_EQ(pool.stats().hits, 2u);
+}
+
+// ============================================================================
+// Persistence Tests
+// ============================================================================
+
+namespace {
+
+/// @brief Temporary file named after the running test, removed at the end
+struct TempFile
+{
+    TempFile()
+        : path(std::filesystem::temp_directory_path() /
+               (std::string("test_collection_") +
+                testing::UnitTest::GetInstance()->current_test_info()->name() + ".bin"))
+    {}
+
+    ~TempFile()
+    {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+} // namespace
+
+TEST(CollectionTest, SaveAndOpenKeepsHoles)
+{
+    TempFile file;
+    Collection<int, 2> col;
+    col.insert(3, 30);
+    col.insert(9, 90);
+    col.insert(10, 100);
+    col.remove(9);
+    save(col, file.path);
+
+    auto mapped = open_mmap<Collection<int, 2>>(file.path);
+    EXPECT_EQ(mapped.size(), 2u);
+    EXPECT_EQ(mapped.extent(), 11u);
+    EXPECT_FALSE(mapped.occupied(9));
+    EXPECT_EQ(mapped.at(3), 30);
+    EXPECT_EQ(mapped.at(10), 100);
+
+    std::vector<int> values(mapped.begin(), mapped.end());
+    EXPECT_EQ(values, (std::vector<int>{30, 100}));
+
+    // A Set cannot hold holes
+    EXPECT_THROW((void)(open_mmap<Set<int, 2>>(file.path)), std::runtime_error);
+}
+
+TEST(CollectionTest, SharedSyncWritesOccupancy)
+{
+    TempFile file;
+    Collection<int, 3> col = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    save(col, file.path);
+
+    {
+        auto mapped = open_mmap<Collection<int, 3>>(file.path, MapMode::Shared);
+        mapped.remove(2);
+        mapped.insert(5, 500);
+        EXPECT_EQ(sync(mapped), 1u);
+    }
+
+    auto reopened = open_mmap<Collection<int, 3>>(file.path);
+    EXPECT_EQ(reopened.size(), 9u);
+    EXPECT_FALSE(reopened.occupied(2));
+    EXPECT_EQ(reopened[5], 500);
+}
+
 // ============================================================================
 // Edge Cases
 // ============================================================================
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "ConcurrentSet.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace container;
+
+// ============================================================================
+// Single Thread Tests
+// ============================================================================
+
+TEST(ConcurrentSetTest, DefaultConstruction)
+{
+    ConcurrentSet<int> set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.size(), 0u);
+    EXPECT_FALSE(static_cast<bool>(set));
+    EXPECT_EQ(set.block_count(), 0u);
+}
+
+TEST(ConcurrentSetTest, AppendAndAccess)
+{
+    ConcurrentSet<std::string, 2> set;
+    set += "a";
+    set += std::string("b");
+    std::string& c = set.emplace_back(2u, 'c');
+
+    EXPECT_EQ(set.size(), 3u);
+    EXPECT_EQ(set[0], "a");
+    EXPECT_EQ(set.at(1), "b");
+    EXPECT_EQ(&set[2], &c);
+    EXPECT_TRUE(set.occupied(2));
+    EXPECT_FALSE(set.occupied(3));
+    EXPECT_THROW((void)set.at(3), std::out_of_range);
+}
+
+TEST(ConcurrentSetTest, BulkAppendAcrossBlocks)
+{
+    ConcurrentSet<int, 2> set;
+    set += -1;
+    std::vector<int> data(10);
+    for (size_t i = 0u; i < data.size(); ++i)
+    {
+        data[i] = static_cast<int>(i);
+    }
+
+    EXPECT_EQ(set.append(data), 1u);
+    EXPECT_EQ(set.size(), 11u);
+    for (size_t i = 0u; i < data.size(); ++i)
+    {
+        EXPECT_EQ(set[i + 1u], data[i]);
+    }
+}
+
+TEST(ConcurrentSetTest, ReferencesStayValid)
+{
+    ConcurrentSet<int, 2> set;
+    int& first = set.emplace_back(42);
+    for (int i = 0; i < 1000; ++i)
+    {
+        set += i;
+    }
+    EXPECT_EQ(&first, &set[0]);
+    EXPECT_EQ(first, 42);
+}
+
+TEST(ConcurrentSetTest, ClearDestroysElements)
+{
+    auto counter = std::make_shared<int>(0);
+    ConcurrentSet<std::shared_ptr<int>, 2> set;
+    for (int i = 0; i < 10; ++i)
+    {
+        set += counter;
+    }
+    EXPECT_EQ(counter.use_count(), 11);
+
+    const size_t blocks = set.block_count();
+    set.clear();
+    EXPECT_EQ(counter.use_count(), 1);
+    EXPECT_TRUE(set.empty());
+
+    set += counter;
+    EXPECT_EQ(set.block_count(), blocks);  // Blocks are reused
+    EXPECT_EQ(counter.use_count(), 2);
+}
+
+// ============================================================================
+// Multi Thread Stress Tests
+// ============================================================================
+
+TEST(ConcurrentSetTest, ConcurrentProducers)
+{
+    constexpr int Threads = 8;
+    constexpr int PerThread = 10000;
+
+    ConcurrentSet<int, 4> set;
+    {
+        std::vector<std::jthread> producers;
+        for (int t = 0; t < Threads; ++t)
+        {
+            producers.emplace_back([&set, t]()
+            {
+                for (int i = 0; i < PerThread; ++i)
+                {
+                    set += t * PerThread + i;
+                }
+            });
+        }
+    }
+
+    ASSERT_EQ(set.size(), static_cast<size_t>(Threads * PerThread));
+    std::vector<int> values;
+    set.for_each([&values](int& value) { values.push_back(value); });
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < Threads * PerThread; ++i)
+    {
+        ASSERT_EQ(values[static_cast<size_t>(i)], i);
+    }
+}
+
+TEST(ConcurrentSetTest, ConcurrentBulkProducers)
+{
+    constexpr int Threads = 4;
+    constexpr int Batches = 200;
+    constexpr int BatchSize = 37;  // Not a multiple of the block size
+
+    ConcurrentSet<int, 3> set;
+    {
+        std::vector<std::jthread> producers;
+        for (int t = 0; t < Threads; ++t)
+        {
+            producers.emplace_back([&set, t]()
+            {
+                std::vector<int> batch(BatchSize, t);
+                for (int b = 0; b < Batches; ++b)
+                {
+                    set.append(batch);
+                }
+            });
+        }
+    }
+
+    ASSERT_EQ(set.size(), static_cast<size_t>(Threads * Batches * BatchSize));
+    std::vector<size_t> per_thread(Threads, 0u);
+    set.for_each([&per_thread](int& value) { ++per_thread[static_cast<size_t>(value)]; });
+    for (size_t count : per_thread)
+    {
+        EXPECT_EQ(count, static_cast<size_t>(Batches * BatchSize));
+    }
+}
+
+TEST(ConcurrentSetTest, ReaderSeesOnlyPublishedElements)
+{
+    constexpr size_t Total = 20000u;
+    ConcurrentSet<std::string, 4> set;
+
+    std::jthread producer([&set]()
+    {
+        for (size_t i = 0u; i < Total; ++i)
+        {
+            set.emplace_back(std::to_string(i));
+        }
+    });
+
+    // Concurrent reader: every published element must be complete
+    size_t checked = 0u;
+    while (checked < Total)
+    {
+        if (set.occupied(checked))
+        {
+            ASSERT_EQ(set[checked], std::to_string(checked));
+            ++checked;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
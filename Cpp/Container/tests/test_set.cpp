@@ -1,7 +1,15 @@
 #include <gtest/gtest.h>
 #include "Set.hpp"
+#include "BlockPool.hpp"
+#include "MappedFile.hpp"
+#include "ParallelForEach.hpp"
 #include <string>
 #include <vector>
+#include <numeric>
+#include <execution>
+#include <memory>
+#include <filesystem>
+#include <ranges>
 
 using namespace container;
 
@@ -260,6 +268,64 @@ TEST(SetTest, ShrinkToFit)
     EXPECT_EQ(set.size(), 8u);
 }
 
+TEST(SetTest, ReserveReachesTotalCapacity)
+{
+    Set<int, 2> set;
+    set.reserve(10);
+    EXPECT_EQ(set.block_count(), 3u);
+    set.reserve(12);
+    EXPECT_EQ(set.block_count(), 3u);
+    set.reserve(4);
+    EXPECT_EQ(set.block_count(), 3u);
+    set.reserve(13);
+    EXPECT_EQ(set.block_count(), 4u);
+}
+
+TEST(SetTest, GeometricGrowth)
+{
+    Set<int, 2> set;
+    set.set_growth_policy(GrowthPolicy::geometric(100u, 4u));
+
+    std::vector<size_t> block_counts;
+    for (int i = 0; i < 64; ++i)
+    {
+        set += i;
+        if (block_counts.empty() || block_counts.back() != set.block_count())
+        {
+            block_counts.push_back(set.block_count());
+        }
+    }
+    EXPECT_EQ(block_counts, (std::vector<size_t>{1u, 2u, 4u, 8u, 12u, 16u}));
+
+    // Blocks of a batch are contiguous
+    EXPECT_EQ(&set[28] - &set[16], 12);
+    EXPECT_EQ(set[63], 63);
+}
+
+TEST(SetTest, SlabFreedWithItsLastBlock)
+{
+    Set<std::string, 2> set;
+    set.set_growth_policy(GrowthPolicy::linear(4u));
+    set.reserve(16);
+    for (int i = 0; i < 20; ++i)
+    {
+        set += std::string(32u, 'a');
+    }
+    EXPECT_EQ(set.block_count(), 8u);
+
+    // Shrinking releases blocks one by one: the slabs go with their last block
+    while (set.size() > 2u)
+    {
+        set.pop_back();
+    }
+    set.shrink_to_fit();
+    EXPECT_EQ(set.block_count(), 1u);
+
+    Set<std::string, 2> moved(std::move(set));
+    EXPECT_EQ(moved[1], std::string(32u, 'a'));
+    EXPECT_EQ(moved.growth_policy().min_batch, 4u);
+}
+
 // ============================================================================
 // Iterator Tests
 // ============================================================================
@@ -319,6 +385,120 @@ TEST(SetTest, ConstIterator)
     EXPECT_EQ(values[2], 3);
 }
 
+static_assert(std::random_access_iterator<Set<int>::iterator>);
+static_assert(std::random_access_iterator<Set<int>::const_iterator>);
+static_assert(std::ranges::random_access_range<Set<int>>);
+static_assert(std::ranges::sized_range<Set<int>>);
+
+TEST(SetTest, IteratorArithmeticAcrossBlocks)
+{
+    Set<int, 2> set;
+    for (int i = 0; i < 10; ++i)
+    {
+        set += i;
+    }
+
+    auto it = set.begin();
+    EXPECT_EQ(it[9], 9);
+    it += 6;
+    EXPECT_EQ(*it, 6);
+    EXPECT_EQ(*(it - 3), 3);
+    EXPECT_EQ(*--it, 5);
+    EXPECT_EQ(*(set.end() - 1), 9);
+    EXPECT_EQ(set.end() - set.begin(), 10);
+    EXPECT_LT(it, set.end());
+    EXPECT_EQ(std::prev(set.end(), 10), set.begin());
+
+    Set<int, 2>::const_iterator cit = it;
+    EXPECT_EQ(*cit, 5);
+    EXPECT_EQ(std::ranges::distance(set), 10);
+}
+
+TEST(SetTest, IteratorStaysValidAfterAppend)
+{
+    Set<int, 2> set = {0, 1, 2, 3};
+    auto it = set.begin() + 3;
+    for (int i = 4; i < 20; ++i)
+    {
+        set += i;
+    }
+
+    EXPECT_EQ(*it, 3);
+    EXPECT_EQ(*++it, 4);
+    EXPECT_EQ(*(it + 15), 19);
+}
+
+TEST(SetTest, EndIteratorReachesAppendedElements)
+{
+    Set<int, 2> set = {0, 1, 2, 3};
+    auto it = set.end();
+    auto last = set.cend() - 1;
+    set += {4, 5};
+
+    EXPECT_EQ(*it, 4);
+    EXPECT_EQ(*++it, 5);
+    EXPECT_EQ(*++last, 4);
+
+    struct Point { int x; int y; };
+    Set<Point, 2> points;
+    auto pit = points.begin();
+    points += Point{1, 2};
+    EXPECT_EQ(pit->y, 2);
+}
+
+TEST(SetTest, StandardAlgorithms)
+{
+    Set<int, 3> set;
+    for (int i = 0; i < 100; ++i)
+    {
+        set += (i * 37) % 100;
+    }
+
+    std::sort(std::execution::par, set.begin(), set.end());
+    EXPECT_TRUE(std::is_sorted(set.begin(), set.end()));
+    EXPECT_EQ(std::reduce(std::execution::par_unseq, set.cbegin(), set.cend()), 4950);
+
+    std::transform(std::execution::par, set.begin(), set.end(), set.begin(), [](int v) { return -v; });
+    std::ranges::sort(set);
+    EXPECT_EQ(set[0], -99);
+    EXPECT_EQ(set[99], 0);
+
+    auto evens = set | std::views::filter([](int v) { return v % 2 == 0; });
+    EXPECT_EQ(std::ranges::distance(evens), 50);
+}
+
+TEST(SetTest, SegmentsAreBlockSpans)
+{
+    Set<int, 2> set;
+    EXPECT_TRUE(set.segments().empty());
+    for (int i = 0; i < 10; ++i)
+    {
+        set += i;
+    }
+
+    auto segments = set.segments();
+    ASSERT_EQ(segments.size(), 3u);
+    EXPECT_EQ(segments[0].size(), 4u);
+    EXPECT_EQ(segments[2].size(), 2u);
+    EXPECT_EQ(segments[1][0], 4);
+    EXPECT_EQ(segments[2].data(), &set[8]);
+
+    std::for_each(std::execution::par, segments.begin(), segments.end(), [](std::span<int> block)
+    {
+        for (int& v : block)
+        {
+            v *= 2;
+        }
+    });
+
+    int sum = 0;
+    for (std::span<const int> block : std::as_const(set).segments())
+    {
+        sum = std::accumulate(block.begin(), block.end(), sum);
+    }
+    EXPECT_EQ(sum, 90);
+}
+
 // ============================================================================
 // Type Tests
 // ============================================================================
@@ -480,6 +660,587 @@ TEST(SetTest, PendingDataWorkflow)
     EXPECT_EQ(e2, 3u);
 }
 
+TEST(SetTest, PendingRangesAreDisjoint)
+{
+    Set<int, 4> set;
+    for (int i = 0; i < 2000; ++i)
+    {
+        set += i;
+    }
+    set.clear_pending();
+
+    set[0] = -1;
+    set.tag_as_pending(0);
+    set[1000] = -1;
+    set.tag_as_pending(1000);
+
+    // The coarse range covers everything in between
+    auto [start, end] = set.get_pending_range();
+    EXPECT_EQ(start, 0u);
+    EXPECT_EQ(end, 1001u);
+
+    // The fine ranges only cover the two modified elements
+    const auto ranges = set.get_pending_ranges();
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0], std::make_pair(size_t(0), size_t(1)));
+    EXPECT_EQ(ranges[1], std::make_pair(size_t(1000), size_t(1001)));
+}
+
+TEST(SetTest, PendingRangesMergeAcrossBlocks)
+{
+    Set<int, 2> set;  // 4 elements per block
+    for (int i = 0; i < 16; ++i)
+    {
+        set += i;
+    }
+    set.clear_pending();
+
+    set.swap(3, 4);   // Adjacent, in two blocks
+    set.swap(9, 12);
+
+    auto ranges = set.get_pending_ranges();
+    ASSERT_EQ(ranges.size(), 3u);
+    EXPECT_EQ(ranges[0], std::make_pair(size_t(3), size_t(5)));
+    EXPECT_EQ(ranges[1], std::make_pair(size_t(9), size_t(10)));
+    EXPECT_EQ(ranges[2], std::make_pair(size_t(12), size_t(13)));
+
+    ranges = set.get_pending_ranges(2u);
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[1], std::make_pair(size_t(9), size_t(13)));
+}
+
+TEST(SetTest, FlushPending)
+{
+    Set<int, 2> set;
+    for (int i = 0; i < 16; ++i)
+    {
+        set += i;
+    }
+
+    // Initial upload: one span per block
+    std::vector<int> gpu(16, 0);
+    size_t calls = 0u;
+    size_t flushed = set.flush_pending([&gpu, &calls](size_t first, std::span<const int> data)
+    {
+        std::copy(data.begin(), data.end(), gpu.begin() + static_cast<std::ptrdiff_t>(first));
+        ++calls;
+    });
+    EXPECT_EQ(flushed, 16u);
+    EXPECT_EQ(calls, 4u);
+    EXPECT_FALSE(set.has_pending_data());
+    EXPECT_EQ(gpu[15], 15);
+
+    // Sparse modification: only the modified element is flushed
+    set[6] = 60;
+    set.tag_as_pending(6);
+    flushed = set.flush_pending([&gpu](size_t first, std::span<const int> data)
+    {
+        std::copy(data.begin(), data.end(), gpu.begin() + static_cast<std::ptrdiff_t>(first));
+    });
+    EXPECT_EQ(flushed, 1u);
+    EXPECT_EQ(gpu[6], 60);
+
+    // Removed elements are not flushed
+    set.remove(2);
+    size_t bytes = 0u;
+    set.flush_pending([&bytes](std::span<const int> data) { bytes += data.size_bytes(); });
+    EXPECT_EQ(bytes, sizeof(int));
+    EXPECT_FALSE(set.has_pending_data());
+}
+
+// ============================================================================
+// Bulk Operation Tests
+// ============================================================================
+
+TEST(SetTest, BulkAppendAcrossBlocks)
+{
+    Set<int, 3> set;  // Blocks of 8 elements
+    set += {-1, -2, -3};
+
+    std::vector<int> data(30);
+    std::iota(data.begin(), data.end(), 0);
+    set += std::span<const int>(data);
+
+    EXPECT_EQ(set.size(), 33u);
+    EXPECT_EQ(set.block_count(), 5u);
+    EXPECT_EQ(set[2], -3);
+    for (size_t i = 0u; i < data.size(); ++i)
+    {
+        EXPECT_EQ(set[i + 3u], data[i]);
+    }
+
+    auto [start, end] = set.get_pending_range();
+    EXPECT_EQ(start, 0u);
+    EXPECT_EQ(end, 33u);
+}
+
+TEST(SetTest, BulkAppendMovesElements)
+{
+    Set<std::string, 2> set;
+    std::vector<std::string> data = {"a", "b", "c", "d", "e", "f"};
+    set += std::move(data);
+
+    EXPECT_EQ(set.size(), 6u);
+    EXPECT_EQ(set[0], "a");
+    EXPECT_EQ(set[5], "f");
+}
+
+TEST(SetTest, AppendAfterRemove)
+{
+    Set<int, 2> set = {1, 2, 3, 4, 5};
+    set.pop_back();
+    set.remove(0);
+    set += 6;
+
+    EXPECT_EQ(set.size(), 4u);
+    EXPECT_EQ(set[0], 4);
+    EXPECT_EQ(set[3], 6);
+}
+
+TEST(SetTest, RemoveIfKeepsOrder)
+{
+    Set<int, 2> set;
+    for (int i = 0; i < 20; ++i)
+    {
+        set += i;
+    }
+    set.clear_pending();
+
+    const size_t removed = set.remove_if([](int x) { return x % 3 == 0; });
+
+    EXPECT_EQ(removed, 7u);
+    EXPECT_EQ(set.size(), 13u);
+    std::vector<int> values(set.begin(), set.end());
+    EXPECT_EQ(values, (std::vector<int>{1, 2, 4, 5, 7, 8, 10, 11, 13, 14, 16, 17, 19}));
+
+    // The first element was removed: everything has moved
+    auto [start, end] = set.get_pending_range();
+    EXPECT_EQ(start, 0u);
+    EXPECT_EQ(end, 13u);
+
+    set += 42;
+    EXPECT_EQ(set[13], 42);
+}
+
+TEST(SetTest, RemoveIfNothingToRemove)
+{
+    Set<int> set = {1, 2, 3};
+    set.clear_pending();
+
+    EXPECT_EQ(set.remove_if([](int x) { return x > 10; }), 0u);
+    EXPECT_EQ(set.size(), 3u);
+    EXPECT_FALSE(set.has_pending_data());
+}
+
+TEST(SetTest, ParallelForEach)
+{
+    Set<int, 3> set;
+    std::vector<int> data(1000);
+    std::iota(data.begin(), data.end(), 0);
+    set += std::span<const int>(data);
+
+    parallel_for_each(std::execution::par, set, [](int& x) { x *= 2; });
+    for (size_t i = 0u; i < data.size(); ++i)
+    {
+        EXPECT_EQ(set[i], 2 * data[i]);
+    }
+
+    parallel_for_each(std::execution::seq, set, [](int& x) { x += 1; });
+    EXPECT_EQ(set[999], 1999);
+}
+
+TEST(SetTest, ParallelForEachOnEmpty)
+{
+    Set<int> set;
+    int calls = 0;
+    parallel_for_each(std::execution::par, set, [&calls](int&) { ++calls; });
+    EXPECT_EQ(calls, 0);
+}
+
+// ============================================================================
+// Move Semantics Tests
+// ============================================================================
+
+TEST(SetTest, MoveOnlyElements)
+{
+    Set<std::unique_ptr<int>, 2> set;
+    set += std::make_unique<int>(1);
+    set.emplace_back(new int(2));
+    set.emplace_back(std::make_unique<int>(3));
+
+    EXPECT_EQ(set.size(), 3u);
+    EXPECT_EQ(*set[0], 1);
+    EXPECT_EQ(*set[1], 2);
+    EXPECT_EQ(*set[2], 3);
+}
+
+TEST(SetTest, EmplaceBackReturnsElement)
+{
+    Set<std::string> set;
+    std::string& s = set.emplace_back(3u, 'x');
+    EXPECT_EQ(s, "xxx");
+    s += "y";
+    EXPECT_EQ(set[0], "xxxy");
+    EXPECT_TRUE(set.has_pending_data());
+}
+
+TEST(SetTest, RemoveMovesLastElement)
+{
+    Set<std::unique_ptr<int>, 2> set;
+    for (int i = 0; i < 6; ++i)
+    {
+        set.emplace_back(std::make_unique<int>(i));
+    }
+    int* last = set[5].get();
+
+    set.remove(1);
+
+    EXPECT_EQ(set.size(), 5u);
+    EXPECT_EQ(set[1].get(), last);  // Moved, not copied
+    EXPECT_EQ(*set[1], 5);
+}
+
+TEST(SetTest, SwapMoveOnlyElements)
+{
+    Set<std::unique_ptr<int>> set;
+    set.emplace_back(std::make_unique<int>(1));
+    set.emplace_back(std::make_unique<int>(2));
+
+    set.swap(0, 1);
+
+    EXPECT_EQ(*set[0], 2);
+    EXPECT_EQ(*set[1], 1);
+}
+
+TEST(SetTest, RemoveIfMoveOnlyElements)
+{
+    Set<std::unique_ptr<int>, 2> set;
+    for (int i = 0; i < 10; ++i)
+    {
+        set.emplace_back(std::make_unique<int>(i));
+    }
+
+    set.remove_if([](const std::unique_ptr<int>& p) { return *p < 5; });
+
+    EXPECT_EQ(set.size(), 5u);
+    EXPECT_EQ(*set[0], 5);
+    EXPECT_EQ(*set[4], 9);
+}
+
+// ============================================================================
+// Element Lifetime Tests
+// ============================================================================
+
+namespace {
+
+/// @brief Counts living instances, not default constructible
+struct Tracked
+{
+    static inline int alive = 0;
+
+    explicit Tracked(int v) : value(v) { ++alive; }
+    Tracked(const Tracked& other) : value(other.value) { ++alive; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { ++alive; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) noexcept = default;
+    ~Tracked() { --alive; }
+
+    int value;
+};
+
+} // namespace
+
+TEST(SetTest, ReserveDoesNotConstructElements)
+{
+    Tracked::alive = 0;
+    {
+        Set<Tracked, 6> set(256);
+        EXPECT_GE(set.capacity(), 256u);
+        EXPECT_EQ(Tracked::alive, 0);
+
+        set.emplace_back(1);
+        set += Tracked(2);
+        EXPECT_EQ(Tracked::alive, 2);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(SetTest, RemovalDestroysElements)
+{
+    Tracked::alive = 0;
+    Set<Tracked, 2> set;
+    for (int i = 0; i < 10; ++i)
+    {
+        set.emplace_back(i);
+    }
+    EXPECT_EQ(Tracked::alive, 10);
+
+    set.pop_back();
+    set.remove(0);
+    EXPECT_EQ(Tracked::alive, 8);
+    EXPECT_EQ(set[0].value, 8);
+
+    set.remove_if([](const Tracked& t) { return t.value > 5; });
+    EXPECT_EQ(Tracked::alive, static_cast<int>(set.size()));
+
+    set.clear();
+    EXPECT_EQ(Tracked::alive, 0);
+
+    std::vector<Tracked> data(20u, Tracked(7));
+    set += std::span<const Tracked>(data);
+    EXPECT_EQ(Tracked::alive, 40);
+    set.clear();
+    EXPECT_EQ(Tracked::alive, 20);
+}
+
+// ============================================================================
+// Block Pool Tests
+// ============================================================================
+
+TEST(SetTest, PoolRecyclesBlocksAcrossContainers)
+{
+    BlockPool<int, 2> pool;
+    {
+        Set<int, 2> set(pool);
+        set += {1, 2, 3, 4, 5, 6, 7, 8, 9};  // 3 blocks
+    }
+
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.released, 3u);
+    EXPECT_EQ(stats.cached, 3u);
+
+    Set<int, 2> other(pool, 8);
+    EXPECT_EQ(other.block_count(), 2u);
+    other += {10, 20, 30};
+    EXPECT_EQ(other[2], 30);
+
+    stats = pool.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.cached, 1u);
+
+    pool.trim();
+    EXPECT_EQ(pool.stats().cached, 0u);
+}
+
+TEST(SetTest, PoolReceivesShrunkBlocks)
+{
+    BlockPool<std::string, 2> pool;
+    Set<std::string, 2> set(pool);
+    for (int i = 0; i < 12; ++i)
+    {
+        set += std::to_string(i);
+    }
+    while (set.size() > 4u)
+    {
+        set.pop_back();
+    }
+    set.shrink_to_fit();
+
+    EXPECT_EQ(set.block_count(), 1u);
+    EXPECT_EQ(pool.stats().cached, 2u);
+    EXPECT_EQ(set[3], "3");
+}
+
+TEST(SetTest, PoolFollowsMovedContainer)
+{
+    BlockPool<int, 2> pool;
+    Set<int, 2> set(pool);
+    set += {1, 2, 3, 4, 5};
+
+    Set<int, 2> moved(std::move(set));
+    EXPECT_EQ(moved.size(), 5u);
+    EXPECT_EQ(pool.stats().released, 0u);
+
+    moved = Set<int, 2>();
+    EXPECT_EQ(pool.stats().released, 2u);
+}
+
+TEST(SetTest, PoolHugePageArena)
+{
+    BlockPool<double, 10> pool(BlockPool<double, 10>::Mode::HugePages);
+    {
+        Set<double, 10> set(pool);
+        for (int i = 0; i < 5000; ++i)
+        {
+            set += static_cast<double>(i);
+        }
+        EXPECT_EQ(set[4999], 4999.0);
+    }
+    EXPECT_GE(pool.arena().mapped_bytes(), 5u * 1024u * sizeof(double));
+
+    Set<double, 10> set(pool);
+    set += 1.0;
+    EXPECT_EQ(pool.stats().hits, 1u);
+    EXPECT_EQ(set[0], 1.0);
+}
+
+// ============================================================================
+// Persistence Tests
+// ============================================================================
+
+namespace {
+
+/// @brief Temporary file named after the running test, removed at the end
+struct TempFile
+{
+    TempFile()
+        : path(std::filesystem::temp_directory_path() /
+               (std::string("test_set_") +
+                testing::UnitTest::GetInstance()->current_test_info()->name() + ".bin"))
+    {}
+
+    ~TempFile()
+    {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+struct Point
+{
+    float x, y;
+};
+
+} // namespace
+
+TEST(SetTest, SaveAndOpenReadOnly)
+{
+    TempFile file;
+    Set<Point, 3> set;
+    for (int i = 0; i < 20; ++i)
+    {
+        set += Point{static_cast<float>(i), -static_cast<float>(i)};
+    }
+    save(set, file.path);
+
+    auto mapped = open_mmap<Set<Point, 3>>(file.path);
+    EXPECT_TRUE(mapped.is_mapped());
+    EXPECT_FALSE(set.is_mapped());
+    ASSERT_EQ(mapped.size(), 20u);
+    EXPECT_EQ(mapped.block_count(), 3u);
+    EXPECT_FALSE(mapped.has_pending_data());
+    for (size_t i = 0u; i < mapped.size(); ++i)
+    {
+        EXPECT_EQ(mapped[i].x, static_cast<float>(i));
+        EXPECT_EQ(mapped.at(i).y, -static_cast<float>(i));
+    }
+}
+
+TEST(SetTest, SaveAndOpenEmpty)
+{
+    TempFile file;
+    Set<int> set;
+    save(set, file.path);
+
+    auto mapped = open_mmap<Set<int>>(file.path);
+    EXPECT_TRUE(mapped.empty());
+    mapped += 1;
+    EXPECT_EQ(mapped[0], 1);
+}
+
+TEST(SetTest, CopyOnWriteLeavesFileUntouched)
+{
+    TempFile file;
+    Set<int, 2> set = {1, 2, 3, 4, 5};
+    save(set, file.path);
+
+    {
+        auto mapped = open_mmap<Set<int, 2>>(file.path, MapMode::CopyOnWrite);
+        mapped[0] = 100;
+        mapped.remove(1);
+        mapped += {6, 7, 8, 9, 10};  // Fills the mapped blocks, then a heap block
+        EXPECT_EQ(mapped[0], 100);
+        EXPECT_EQ(mapped[1], 5);
+        EXPECT_EQ(mapped.size(), 9u);
+        EXPECT_EQ(mapped.block_count(), 3u);
+        EXPECT_THROW(sync(mapped), std::logic_error);
+    }
+
+    auto reopened = open_mmap<Set<int, 2>>(file.path);
+    ASSERT_EQ(reopened.size(), 5u);
+    EXPECT_EQ(reopened[0], 1);
+    EXPECT_EQ(reopened[1], 2);
+}
+
+TEST(SetTest, SharedSyncWritesPendingElements)
+{
+    TempFile file;
+    Set<int, 4> set;
+    for (int i = 0; i < 40; ++i)
+    {
+        set += i;
+    }
+    save(set, file.path);
+
+    {
+        auto mapped = open_mmap<Set<int, 4>>(file.path, MapMode::Shared);
+        EXPECT_EQ(sync(mapped), 0u);
+
+        mapped[3] = 300;
+        mapped.tag_as_pending(3);
+        mapped[35] = 3500;
+        mapped.tag_as_pending(35);
+        mapped.pop_back();
+        EXPECT_EQ(sync(mapped), 2u);
+        EXPECT_FALSE(mapped.has_pending_data());
+
+        for (int i = 0; i < 10; ++i)
+        {
+            mapped += -i;  // The last ones need a block the file does not have
+        }
+        EXPECT_THROW(sync(mapped), std::length_error);
+    }
+
+    auto reopened = open_mmap<Set<int, 4>>(file.path);
+    ASSERT_EQ(reopened.size(), 39u);
+    EXPECT_EQ(reopened[3], 300);
+    EXPECT_EQ(reopened[35], 3500);
+    EXPECT_EQ(reopened[38], 38);
+}
+
+TEST(SetTest, OpenRejectsMismatchedFiles)
+{
+    TempFile file;
+    Set<int, 4> set = {1, 2, 3};
+    save(set, file.path);
+
+    EXPECT_THROW((void)(open_mmap<Set<int, 5>>(file.path)), std::runtime_error);
+    EXPECT_THROW((void)(open_mmap<Set<double, 4>>(file.path)), std::runtime_error);
+    EXPECT_THROW((void)(open_mmap<Set<int, 4>>(file.path.string() + ".missing")), std::system_error);
+
+    std::filesystem::resize_file(file.path, 100u);
+    EXPECT_THROW((void)(open_mmap<Set<int, 4>>(file.path)), std::runtime_error);
+}
+
+TEST(SetTest, SaveRefusesToOverwriteMappedFile)
+{
+    TempFile file;
+    Set<int> set = {1, 2, 3};
+    save(set, file.path);
+
+    auto mapped = open_mmap<Set<int>>(file.path);
+    EXPECT_THROW(save(mapped, file.path), std::invalid_argument);
+}
+
+TEST(SetTest, MovedMappedSetKeepsMapping)
+{
+    TempFile file;
+    Set<int> set = {1, 2, 3};
+    save(set, file.path);
+
+    auto mapped = open_mmap<Set<int>>(file.path, MapMode::CopyOnWrite);
+    Set<int> moved(std::move(mapped));
+    EXPECT_TRUE(moved.is_mapped());
+    EXPECT_FALSE(mapped.is_mapped());
+    EXPECT_EQ(moved[2], 3);
+
+    mapped = std::move(moved);
+    EXPECT_EQ(mapped[1], 2);
+}
+
 // ============================================================================
 // Edge Cases
 // ============================================================================
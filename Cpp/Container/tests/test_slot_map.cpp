@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include "SlotMap.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+// ============================================================================
+// Handle Tests
+// ============================================================================
+
+TEST(SlotMapTest, DefaultConstruction)
+{
+    SlotMap<int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.size(), 0u);
+    EXPECT_FALSE(static_cast<bool>(map));
+    EXPECT_EQ(map.get(Handle{}), nullptr);
+    EXPECT_FALSE(map.contains(Handle{}));
+}
+
+TEST(SlotMapTest, InsertAndGet)
+{
+    SlotMap<std::string, 2> map;
+    const Handle a = map.insert("a");
+    const std::string b_value = "b";
+    const Handle b = map.insert(b_value);
+    const Handle c = map.emplace(3u, 'c');
+
+    EXPECT_EQ(map.size(), 3u);
+    ASSERT_NE(map.get(a), nullptr);
+    EXPECT_EQ(*map.get(a), "a");
+    EXPECT_EQ(map.at(b), "b");
+    EXPECT_EQ(*std::as_const(map).get(c), "ccc");
+    EXPECT_EQ(map.handle_at(c.index), c);
+}
+
+TEST(SlotMapTest, RemovedHandleIsStale)
+{
+    SlotMap<int> map;
+    const Handle a = map.insert(1);
+
+    EXPECT_TRUE(map.remove(a));
+    EXPECT_FALSE(map.remove(a));
+    EXPECT_EQ(map.get(a), nullptr);
+    EXPECT_FALSE(map.contains(a));
+    EXPECT_THROW((void)map.at(a), std::out_of_range);
+    EXPECT_EQ(map.handle_at(a.index), Handle{});
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(SlotMapTest, ReusedSlotKeepsOldHandleStale)
+{
+    SlotMap<int> map;
+    const Handle old_handle = map.insert(1);
+    map.remove(old_handle);
+
+    const Handle new_handle = map.insert(2);
+    EXPECT_EQ(new_handle.index, old_handle.index);
+    EXPECT_NE(new_handle.generation, old_handle.generation);
+    EXPECT_EQ(map.get(old_handle), nullptr);
+    EXPECT_EQ(*map.get(new_handle), 2);
+}
+
+TEST(SlotMapTest, ForgedHandleIsRejected)
+{
+    SlotMap<int> map;
+    const Handle a = map.insert(1);
+    map.remove(a);
+
+    // The current generation of a hole is never handed out
+    EXPECT_EQ(map.get(Handle{a.index, a.generation + 1u}), nullptr);
+    EXPECT_EQ(map.get(Handle{42u, 1u}), nullptr);
+}
+
+// ============================================================================
+// Free-list Tests
+// ============================================================================
+
+TEST(SlotMapTest, FreeListReusesHolesLastInFirstOut)
+{
+    SlotMap<int> map;
+    std::vector<Handle> handles;
+    for (int i = 0; i < 8; ++i)
+    {
+        handles.push_back(map.insert(i));
+    }
+
+    map.remove(handles[2]);
+    map.remove(handles[5]);
+    EXPECT_EQ(map.free_count(), 2u);
+
+    EXPECT_EQ(map.insert(10).index, handles[5].index);
+    EXPECT_EQ(map.insert(11).index, handles[2].index);
+    EXPECT_EQ(map.insert(12).index, 8u);
+    EXPECT_EQ(map.free_count(), 0u);
+    EXPECT_EQ(map.slot_count(), 9u);
+    EXPECT_EQ(map.size(), 9u);
+}
+
+TEST(SlotMapTest, ClearMakesAllHandlesStale)
+{
+    SlotMap<std::unique_ptr<int>, 2> map;
+    std::vector<Handle> handles;
+    for (int i = 0; i < 10; ++i)
+    {
+        handles.push_back(map.emplace(std::make_unique<int>(i)));
+    }
+    map.remove(handles[3]);
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.free_count(), 10u);
+    for (const Handle& handle : handles)
+    {
+        EXPECT_EQ(map.get(handle), nullptr);
+    }
+
+    const Handle fresh = map.emplace(std::make_unique<int>(42));
+    EXPECT_LT(fresh.index, 10u);
+    EXPECT_EQ(**map.get(fresh), 42);
+}
+
+// ============================================================================
+// Iteration Tests
+// ============================================================================
+
+TEST(SlotMapTest, IterationSkipsHoles)
+{
+    SlotMap<int, 2> map;
+    std::vector<Handle> handles;
+    for (int i = 0; i < 10; ++i)
+    {
+        handles.push_back(map.insert(i));
+    }
+    for (size_t i = 0u; i < handles.size(); i += 3u)
+    {
+        map.remove(handles[i]);
+    }
+
+    int sum = 0;
+    for (int value : map)
+    {
+        sum += value;
+    }
+    EXPECT_EQ(sum, 1 + 2 + 4 + 5 + 7 + 8);
+
+    size_t visited = 0u;
+    map.for_each([&map, &visited](Handle handle, int& value)
+    {
+        EXPECT_EQ(map.get(handle), &value);
+        ++visited;
+    });
+    EXPECT_EQ(visited, 6u);
+}
+
+TEST(SlotMapTest, MoveKeepsHandlesValid)
+{
+    SlotMap<std::string> map;
+    const Handle a = map.insert("a");
+
+    SlotMap<std::string> moved(std::move(map));
+    EXPECT_EQ(*moved.get(a), "a");
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.get(a), nullptr);
+
+    map = std::move(moved);
+    EXPECT_EQ(map.at(a), "a");
+}
+
+// ============================================================================
+// Compaction Tests
+// ============================================================================
+
+TEST(SlotMapTest, CompactRekeysHandles)
+{
+    SlotMap<std::string, 2> map;
+    std::vector<Handle> handles;
+    for (int i = 0; i < 16; ++i)
+    {
+        handles.push_back(map.insert(std::to_string(i)));
+    }
+    for (size_t i = 1u; i < 16u; ++i)
+    {
+        if (i % 4u != 0u)
+        {
+            map.remove(handles[i]);
+        }
+    }
+    EXPECT_EQ(map.fragmentation().used_blocks, 4u);
+
+    const auto moved = map.compact();
+    ASSERT_EQ(moved.size(), 3u);
+    for (const auto& [old_handle, new_handle] : moved)
+    {
+        EXPECT_FALSE(map.contains(old_handle));
+        EXPECT_EQ(*map.get(new_handle), std::to_string(old_handle.index));
+        EXPECT_EQ(map.handle_at(new_handle.index), new_handle);
+    }
+    EXPECT_EQ(map.fragmentation().used_blocks, 1u);
+    EXPECT_EQ(map.size(), 4u);
+
+    // New elements go to the lowest free slots
+    EXPECT_EQ(map.insert("x").index, 4u);
+    EXPECT_EQ(map.free_count(), 11u);
+}
+
+TEST(SlotMapTest, CompactFreesLowestSlotsFirst)
+{
+    SlotMap<std::string, 2> map;
+    std::vector<Handle> handles;
+    for (int i = 0; i < 24; ++i)
+    {
+        handles.push_back(map.insert(std::to_string(i)));
+    }
+    // One element left in each block but the first, which keeps two
+    for (size_t i = 2u; i < 24u; ++i)
+    {
+        if (i % 4u != 0u)
+        {
+            map.remove(handles[i]);
+        }
+    }
+    map.remove(handles[1]);  // Older hole, reused after the compaction ones
+
+    const auto moved = map.compact();
+    ASSERT_FALSE(moved.empty());
+    std::vector<size_t> emptied;
+    for (const auto& [old_handle, new_handle] : moved)
+    {
+        if (map.handle_at(old_handle.index) == Handle{})
+        {
+            emptied.push_back(old_handle.index);
+        }
+    }
+    std::sort(emptied.begin(), emptied.end());
+    ASSERT_FALSE(emptied.empty());
+    EXPECT_EQ(map.free_count(), map.slot_count() - map.size());
+
+    for (size_t index : emptied)
+    {
+        EXPECT_EQ(map.insert("x").index, index);
+    }
+    if (map.handle_at(1u) == Handle{})
+    {
+        EXPECT_EQ(map.insert("y").index, 1u);
+    }
+}
+
+TEST(SlotMapTest, IncrementalCompactKeepsFreeListConsistent)
+{
+    SlotMap<int, 2> map;
+    std::vector<Handle> handles;
+    for (int i = 0; i < 64; ++i)
+    {
+        handles.push_back(map.insert(i));
+    }
+    for (size_t i = 0u; i < 64u; ++i)
+    {
+        if (i % 3u != 0u)
+        {
+            map.remove(handles[i]);
+        }
+    }
+
+    // One move per call, as a per-frame budget would do
+    while (!map.compact(1u).empty())
+    {
+        EXPECT_EQ(map.free_count(), map.slot_count() - map.size());
+    }
+
+    // Every hole is reused before any new slot
+    const size_t slots = map.slot_count();
+    const size_t holes = map.free_count();
+    for (size_t i = 0u; i < holes; ++i)
+    {
+        const Handle handle = map.insert(-1);
+        EXPECT_LT(handle.index, slots);
+        EXPECT_EQ(*map.get(handle), -1);
+    }
+    EXPECT_EQ(map.free_count(), 0u);
+    EXPECT_EQ(map.insert(-2).index, slots);
+}
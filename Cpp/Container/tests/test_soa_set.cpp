@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include "SoASet.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace container;
+
+namespace {
+
+enum Field : size_t { X, VX, Name };
+
+using Bodies = SoASet<2, float, float, std::string>;
+
+/// @brief Field whose constructor can be told to throw
+struct Fragile
+{
+    static inline int alive = 0;
+
+    explicit Fragile(bool fail)
+    {
+        if (fail)
+        {
+            throw std::runtime_error("Fragile");
+        }
+        ++alive;
+    }
+    Fragile(const Fragile&) { ++alive; }
+    Fragile(Fragile&&) noexcept { ++alive; }
+    Fragile& operator=(const Fragile&) = default;
+    Fragile& operator=(Fragile&&) noexcept = default;
+    ~Fragile() { --alive; }
+};
+
+} // namespace
+
+// ============================================================================
+// Construction and Access Tests
+// ============================================================================
+
+TEST(SoASetTest, DefaultConstruction)
+{
+    Bodies set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.size(), 0u);
+    EXPECT_FALSE(static_cast<bool>(set));
+    EXPECT_EQ(set.block_count(), 0u);
+}
+
+TEST(SoASetTest, ReserveConstruction)
+{
+    Bodies set(10u);
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.block_count(), 3u);
+    EXPECT_EQ(set.capacity(), 12u);
+
+    set.reserve(5u);
+    EXPECT_EQ(set.block_count(), 3u);
+}
+
+TEST(SoASetTest, AppendAndAccess)
+{
+    Bodies set;
+    set.emplace_back(1.0f, 10.0f, "a");
+    set += std::make_tuple(2.0f, 20.0f, std::string("b"));
+    const Bodies::value_type c{3.0f, 30.0f, "c"};
+    set += c;
+
+    ASSERT_EQ(set.size(), 3u);
+    EXPECT_FLOAT_EQ(set.get<X>(1), 2.0f);
+    EXPECT_FLOAT_EQ(set.get<VX>(2), 30.0f);
+    EXPECT_EQ(set.get<Name>(0), "a");
+
+    auto [x, vx, name] = set[1];
+    x = 5.0f;
+    EXPECT_FLOAT_EQ(set.get<X>(1), 5.0f);
+    EXPECT_FLOAT_EQ(vx, 20.0f);
+    EXPECT_EQ(name, "b");
+
+    EXPECT_EQ(std::get<Name>(set.at(2)), "c");
+    EXPECT_THROW((void)set.at(3), std::out_of_range);
+    EXPECT_TRUE(set.occupied(2));
+    EXPECT_FALSE(set.occupied(3));
+}
+
+TEST(SoASetTest, FieldArraysAreAligned)
+{
+    SoASet<3, uint8_t, double, float> set;
+    for (size_t i = 0u; i < 20u; ++i)
+    {
+        set.emplace_back(static_cast<uint8_t>(i), static_cast<double>(i), static_cast<float>(i));
+    }
+
+    for (size_t bid = 0u; bid < set.block_count(); ++bid)
+    {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(set.field_span<0>(bid).data()) % detail::SoAAlignment, 0u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(set.field_span<1>(bid).data()) % detail::SoAAlignment, 0u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(set.field_span<2>(bid).data()) % detail::SoAAlignment, 0u);
+    }
+}
+
+// ============================================================================
+// Field Span Tests
+// ============================================================================
+
+TEST(SoASetTest, FieldSpanCoversBlockElements)
+{
+    Bodies set;
+    for (size_t i = 0u; i < 10u; ++i)
+    {
+        set.emplace_back(static_cast<float>(i), 1.0f, std::to_string(i));
+    }
+
+    ASSERT_EQ(set.block_count(), 3u);
+    EXPECT_EQ(set.field_span<X>(0).size(), 4u);
+    EXPECT_EQ(set.field_span<X>(2).size(), 2u);
+    EXPECT_FLOAT_EQ(set.field_span<X>(2)[1], 9.0f);
+    EXPECT_EQ(std::as_const(set).field_span<Name>(1)[0], "4");
+}
+
+TEST(SoASetTest, ForEachBlockUpdatesFields)
+{
+    Bodies set;
+    for (size_t i = 0u; i < 10u; ++i)
+    {
+        set.emplace_back(static_cast<float>(i), 2.0f, "");
+    }
+
+    size_t blocks = 0u;
+    set.for_each_block<X, VX>([&blocks](std::span<float> x, std::span<const float> vx)
+    {
+        ASSERT_EQ(x.size(), vx.size());
+        for (size_t i = 0u; i < x.size(); ++i)
+        {
+            x[i] += vx[i] * 0.5f;
+        }
+        ++blocks;
+    });
+
+    EXPECT_EQ(blocks, 3u);
+    for (size_t i = 0u; i < set.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(set.get<X>(i), static_cast<float>(i) + 1.0f);
+    }
+}
+
+TEST(SoASetTest, ForEachVisitsElementsInOrder)
+{
+    Bodies set;
+    set.emplace_back(1.0f, 0.0f, "a");
+    set.emplace_back(2.0f, 0.0f, "b");
+
+    std::string names;
+    set.for_each([&names](float& x, float&, std::string& name)
+    {
+        x *= 2.0f;
+        names += name;
+    });
+
+    EXPECT_EQ(names, "ab");
+    EXPECT_FLOAT_EQ(set.get<X>(1), 4.0f);
+}
+
+// ============================================================================
+// Removal Tests
+// ============================================================================
+
+TEST(SoASetTest, RemoveMovesLastElement)
+{
+    Bodies set;
+    for (size_t i = 0u; i < 6u; ++i)
+    {
+        set.emplace_back(static_cast<float>(i), 0.0f, std::string(20u, static_cast<char>('a' + i)));
+    }
+
+    set.remove(1u);
+    ASSERT_EQ(set.size(), 5u);
+    EXPECT_FLOAT_EQ(set.get<X>(1), 5.0f);
+    EXPECT_EQ(set.get<Name>(1), std::string(20u, 'f'));
+
+    set.remove(4u);
+    ASSERT_EQ(set.size(), 4u);
+    EXPECT_FALSE(set.occupied(4u));
+
+    set.remove(10u);
+    EXPECT_EQ(set.size(), 4u);
+}
+
+TEST(SoASetTest, SwapExchangesAllFields)
+{
+    Bodies set;
+    set.emplace_back(1.0f, 10.0f, "a");
+    set.emplace_back(2.0f, 20.0f, "b");
+
+    set.swap(0u, 1u);
+    EXPECT_EQ(set[0], std::make_tuple(2.0f, 20.0f, std::string("b")));
+    EXPECT_EQ(set[1], std::make_tuple(1.0f, 10.0f, std::string("a")));
+}
+
+TEST(SoASetTest, ClearAndShrink)
+{
+    Bodies set;
+    for (size_t i = 0u; i < 10u; ++i)
+    {
+        set.emplace_back(0.0f, 0.0f, "x");
+    }
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.block_count(), 3u);
+
+    set.emplace_back(1.0f, 1.0f, "y");
+    set.shrink_to_fit();
+    EXPECT_EQ(set.block_count(), 1u);
+    EXPECT_EQ(set.get<Name>(0), "y");
+}
+
+// ============================================================================
+// Element Lifetime Tests
+// ============================================================================
+
+TEST(SoASetTest, FailedEmplaceLeavesNoLivingField)
+{
+    Fragile::alive = 0;
+    {
+        SoASet<2, Fragile, Fragile> set;
+        set.emplace_back(false, false);
+        EXPECT_EQ(Fragile::alive, 2);
+
+        EXPECT_THROW(set.emplace_back(false, true), std::runtime_error);
+        EXPECT_EQ(Fragile::alive, 2);
+        EXPECT_EQ(set.size(), 1u);
+        EXPECT_FALSE(set.occupied(1u));
+
+        set.emplace_back(false, false);
+        set.remove(0u);
+        EXPECT_EQ(Fragile::alive, 2);
+    }
+    EXPECT_EQ(Fragile::alive, 0);
+}
+
+TEST(SoASetTest, MoveTransfersBlocks)
+{
+    Bodies set;
+    set.emplace_back(1.0f, 2.0f, "a");
+    const float* x = &set.get<X>(0);
+
+    Bodies moved(std::move(set));
+    EXPECT_EQ(moved.size(), 1u);
+    EXPECT_EQ(&moved.get<X>(0), x);
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.block_count(), 0u);
+
+    set = std::move(moved);
+    EXPECT_EQ(set.get<Name>(0), "a");
+    EXPECT_TRUE(moved.empty());
+}
@@ -96,7 +96,7 @@ void Client::update(float deltaTime)
 // ----------------------------------------------------------------------------
 void Client::updateStatusText()
 {
-    std::string status = m_is_host ? "Host - " : "Client - ";
+    std::string status = m_node->isHost() ? "Host - " : "Client - ";
     status += "Port: " + std::to_string(m_node->getPort()) + "\n";
     status += "Connected peers: " + std::to_string(m_node->getActivePeerCount()) + "\n";
     status += "Network status: " + m_node->getNetworkStatusString() + "\n";
@@ -1,23 +1,39 @@
 #include "GameManager.hpp"
+#include "RoadNetwork.hpp"
 #include <SFML/Graphics/Color.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
 #include <random>
 #include <iostream>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+//! @brief Cars closer than this to their target have reached it
+static constexpr float ARRIVAL_DISTANCE = 5.0f;
+
 // ----------------------------------------------------------------------------
-void GameManager::createInitialState(GameState& state)
+void GameManager::createInitialState(GameState& state, size_t num_cars, size_t num_buildings,
+                                     unsigned seed)
 {
-    const int NUM_CARS = 4;
-    const int NUM_BUILDINGS = 8;
+    const int NUM_CARS = static_cast<int>(num_cars);
+    const int NUM_BUILDINGS = static_cast<int>(std::max<size_t>(num_buildings, 2));
+    // Do not log every entity of large cities
+    const bool verbose = (NUM_CARS + NUM_BUILDINGS) <= 64;
 
     // Random number generators
     std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen((seed != 0) ? seed : rd());
     std::uniform_real_distribution<float> pos_dist_x(100.0f, 790.0f);
     std::uniform_real_distribution<float> pos_dist_y(10.0f, 590.0f);
     std::uniform_real_distribution<float> speed_dist(20.0f, 40.0f);
     std::uniform_int_distribution<int> color_dist(0, 255);
     std::uniform_real_distribution<float> income_dist(100.0f, 500.0f);
     std::uniform_int_distribution<int> building_dist(0, NUM_BUILDINGS - 1);
+    std::uniform_int_distribution<int> hop_dist(1, 3);
 
     // Clear existing data
     state.traffic.cars.clear();
@@ -33,7 +49,8 @@ void GameManager::createInitialState(GameState& state)
         building.income = income_dist(gen);
         building.color = sf::Color(100, 100, 100, 255);
         state.economy.buildings.push_back(building);
-        std::cout << "  Building " << i << " created at " << building.position.x << ", " << building.position.y << " with income " << building.income << std::endl;
+        if (verbose)
+            std::cout << "  Building " << i << " created at " << building.position.x << ", " << building.position.y << " with income " << building.income << std::endl;
     }
 
     // Roads initialization
@@ -46,7 +63,8 @@ void GameManager::createInitialState(GameState& state)
         road.building2_idx = i + 1;
         road.color = sf::Color(100, 100, 100, 255);
         state.traffic.roads.push_back(road);
-        std::cout << "  Road " << i << " created between building " << i << " and building " << i + 1 << std::endl;
+        if (verbose)
+            std::cout << "  Road " << i << " created between building " << i << " and building " << i + 1 << std::endl;
     }
 
     // Connect last building to first to create a loop
@@ -71,12 +89,23 @@ void GameManager::createInitialState(GameState& state)
         car.source_building_idx = chosen_road.building1_idx;
         car.destination_building_idx = chosen_road.building2_idx;
 
+        // Destination a few roads away from the source, cars follow the
+        // roads when the simulation runs with a RoadNetwork
+        const int hops = hop_dist(gen);
+        for (int hop = 1; hop < hops; ++hop)
+        {
+            const auto& next_road = state.traffic.roads[size_t(car.destination_building_idx) % state.traffic.roads.size()];
+            if (next_road.building2_idx != car.source_building_idx)
+                car.destination_building_idx = next_road.building2_idx;
+        }
+
         // Start at source building
         car.position = state.economy.buildings[car.source_building_idx].position;
         car.speed = speed_dist(gen);
         car.is_returning = false;
         state.traffic.cars.push_back(car);
-        std::cout << "  Car " << i << " created at " << car.position.x << ", " << car.position.y << " with speed " << car.speed << " and destination building " << car.destination_building_idx << std::endl;
+        if (verbose)
+            std::cout << "  Car " << i << " created at " << car.position.x << ", " << car.position.y << " with speed " << car.speed << " and destination building " << car.destination_building_idx << std::endl;
     }
 
     state.economy.money = 10000.0f;
@@ -87,10 +116,10 @@ void GameManager::createInitialState(GameState& state)
 bool GameManager::validateState(const GameState& state)
 {
     // Verify car data
-    for (const auto& car : state.traffic.cars)
+    const auto& cars = state.traffic.cars;
+    for (size_t i = 0; i < cars.size(); ++i)
     {
-        if (std::isnan(car.position.x) || std::isnan(car.position.y) ||
-            std::isnan(car.speed))
+        if (std::isnan(cars.x[i]) || std::isnan(cars.y[i]) || std::isnan(cars.speed[i]))
         {
             return false;
         }
@@ -105,47 +134,229 @@ bool GameManager::validateState(const GameState& state)
     return true;
 }
 
+// ----------------------------------------------------------------------------
+std::vector<GameManager::Range> GameManager::split(size_t count, size_t parts)
+{
+    std::vector<Range> ranges;
+    if (parts == 0)
+    {
+        return ranges;
+    }
+
+    const size_t size = count / parts;
+    const size_t remainder = count % parts;
+    size_t start = 0;
+    for (size_t i = 0; (i < parts) && (start < count); ++i)
+    {
+        const size_t n = size + ((i < remainder) ? 1 : 0);
+        ranges.push_back({static_cast<sf::Uint32>(start), static_cast<sf::Uint32>(n)});
+        start += n;
+    }
+    return ranges;
+}
+
+// ----------------------------------------------------------------------------
+std::vector<GameManager::Range> GameManager::split(size_t count, const std::vector<double>& weights)
+{
+    double total = 0.0;
+    for (double weight : weights)
+    {
+        total += std::max(weight, 0.0);
+    }
+    if (!(total > 0.0))
+    {
+        std::vector<Range> ranges = split(count, weights.size());
+        ranges.resize(weights.size(), Range{static_cast<sf::Uint32>(count), 0});
+        return ranges;
+    }
+
+    // Round down, then give the remaining elements to the largest fractions
+    std::vector<size_t> sizes(weights.size());
+    std::vector<std::pair<double, size_t>> fractions(weights.size());
+    size_t assigned = 0;
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        const double share = double(count) * std::max(weights[i], 0.0) / total;
+        sizes[i] = std::min(static_cast<size_t>(share), count - assigned);
+        fractions[i] = {share - double(sizes[i]), i};
+        assigned += sizes[i];
+    }
+    std::sort(fractions.begin(), fractions.end(), std::greater<>());
+    for (size_t i = 0; assigned < count; i = (i + 1) % fractions.size())
+    {
+        ++sizes[fractions[i].second];
+        ++assigned;
+    }
+
+    std::vector<Range> ranges(weights.size());
+    size_t start = 0;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        ranges[i] = {static_cast<sf::Uint32>(start), static_cast<sf::Uint32>(sizes[i])};
+        start += sizes[i];
+    }
+    return ranges;
+}
+
 // ----------------------------------------------------------------------------
 void GameManager::update(GameState& state, float dt, sf::Color color)
 {
-    for (sf::Uint32 i = state.traffic.startIdx; i < state.traffic.startIdx + state.traffic.count; ++i)
+    const size_t cars = state.traffic.cars.size();
+    const size_t car_begin = std::min<size_t>(state.traffic.startIdx, cars);
+    updateTraffic(state, car_begin, std::min<size_t>(car_begin + state.traffic.count, cars), dt, color);
+
+    const size_t buildings = state.economy.buildings.size();
+    const size_t building_begin = std::min<size_t>(state.economy.startIdx, buildings);
+    updateEconomy(state, building_begin, std::min<size_t>(building_begin + state.economy.count, buildings), color);
+}
+
+// ----------------------------------------------------------------------------
+// Moves a car of its step toward (tx, ty). The SIMD kernels do the same
+// operations in the same order, so a car ends at the same position whichever
+// code moves it (and whichever thread or peer runs it).
+static inline void moveCar(float& x, float& y, float tx, float ty, float speed, float dt)
+{
+    const float dx = tx - x;
+    const float dy = ty - y;
+    const float step = speed * dt / std::sqrt(dx * dx + dy * dy);
+    x += dx * step;
+    y += dy * step;
+}
+
+// ----------------------------------------------------------------------------
+// Slow path of a car that reached its target or whose target is unknown:
+// follows its route, caches the position of the next target and moves it.
+static void routeCar(GameState& state, size_t i, float dt, const RoadNetwork* roads)
+{
+    auto& cars = state.traffic.cars;
+    const auto& buildings = state.economy.buildings;
+    const int building_count = static_cast<int>(buildings.size());
+
+    // Get current target: the end of the trip, or the next building on
+    // the road leading to it
+    const bool returning = (cars.is_returning[i] != 0);
+    const int origin_idx = returning ? cars.destination_building_idx[i] : cars.source_building_idx[i];
+    const int final_idx = returning ? cars.source_building_idx[i] : cars.destination_building_idx[i];
+    int& waypoint = cars.waypoint_building_idx[i];
+    if (roads == nullptr)
+    {
+        waypoint = -1;
+    }
+    else if ((waypoint < 0) || (waypoint >= building_count))
     {
-        auto& car = state.traffic.cars[i];
-    
-        // Update car color
-        car.color = color;
+        waypoint = roads->nextHop(origin_idx, final_idx);
+    }
+    const int target_idx = (waypoint >= 0) ? waypoint : final_idx;
+    const sf::Vector2f target_pos = buildings[size_t(target_idx)].position;
 
-        // Get current target position
-        sf::Vector2f target_pos;
-        if (!car.is_returning)
+    const float dx = target_pos.x - cars.x[i];
+    const float dy = target_pos.y - cars.y[i];
+    if (dx * dx + dy * dy < ARRIVAL_DISTANCE * ARRIVAL_DISTANCE)
+    {
+        // We reached the target: the next one is looked up next tick
+        cars.target_x[i] = cars.target_y[i] = std::numeric_limits<float>::quiet_NaN();
+        if (target_idx == final_idx)
         {
-            target_pos = state.economy.buildings[car.destination_building_idx].position;
+            // Switch direction if we reached destination
+            cars.is_returning[i] = returning ? 0 : 1;
+            waypoint = (roads != nullptr) ? roads->nextHop(final_idx, origin_idx) : -1;
         }
         else
         {
-            target_pos = state.economy.buildings[car.source_building_idx].position;
+            // Next road segment
+            waypoint = roads->nextHop(target_idx, final_idx);
+        }
+    }
+    else
+    {
+        cars.target_x[i] = target_pos.x;
+        cars.target_y[i] = target_pos.y;
+        moveCar(cars.x[i], cars.y[i], target_pos.x, target_pos.y, cars.speed[i], dt);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void GameManager::updateTraffic(GameState& state, size_t begin, size_t end, float dt, sf::Color color,
+                                const RoadNetwork* roads)
+{
+    auto& cars = state.traffic.cars;
+    std::fill(cars.color.begin() + std::ptrdiff_t(begin), cars.color.begin() + std::ptrdiff_t(end), color);
+
+    float* x = cars.x.data();
+    float* y = cars.y.data();
+    const float* tx = cars.target_x.data();
+    const float* ty = cars.target_y.data();
+    const float* speed = cars.speed.data();
+    size_t i = begin;
+
+    // Fast path: cars far from a known target move straight toward it. The
+    // comparison is false for a NaN target, so these cars take the slow path.
+#if defined(__AVX2__)
+    const __m256 arrival = _mm256_set1_ps(ARRIVAL_DISTANCE * ARRIVAL_DISTANCE);
+    const __m256 dt8 = _mm256_set1_ps(dt);
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 px = _mm256_loadu_ps(x + i);
+        const __m256 py = _mm256_loadu_ps(y + i);
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(tx + i), px);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ty + i), py);
+        const __m256 distance2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        const __m256 moving = _mm256_cmp_ps(distance2, arrival, _CMP_GE_OQ);
+        const __m256 step = _mm256_div_ps(_mm256_mul_ps(_mm256_loadu_ps(speed + i), dt8),
+                                          _mm256_sqrt_ps(distance2));
+        _mm256_storeu_ps(x + i, _mm256_blendv_ps(px, _mm256_add_ps(px, _mm256_mul_ps(dx, step)), moving));
+        _mm256_storeu_ps(y + i, _mm256_blendv_ps(py, _mm256_add_ps(py, _mm256_mul_ps(dy, step)), moving));
+
+        for (int slow = ~_mm256_movemask_ps(moving) & 0xFF; slow != 0; slow &= slow - 1)
+        {
+            routeCar(state, i + size_t(__builtin_ctz(unsigned(slow))), dt, roads);
         }
+    }
+#elif defined(__SSE2__)
+    const __m128 arrival = _mm_set1_ps(ARRIVAL_DISTANCE * ARRIVAL_DISTANCE);
+    const __m128 dt4 = _mm_set1_ps(dt);
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 py = _mm_loadu_ps(y + i);
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(tx + i), px);
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ty + i), py);
+        const __m128 distance2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        const __m128 moving = _mm_cmpge_ps(distance2, arrival);
+        const __m128 step = _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(speed + i), dt4), _mm_sqrt_ps(distance2));
+        const __m128 nx = _mm_add_ps(px, _mm_mul_ps(dx, step));
+        const __m128 ny = _mm_add_ps(py, _mm_mul_ps(dy, step));
+        _mm_storeu_ps(x + i, _mm_or_ps(_mm_and_ps(moving, nx), _mm_andnot_ps(moving, px)));
+        _mm_storeu_ps(y + i, _mm_or_ps(_mm_and_ps(moving, ny), _mm_andnot_ps(moving, py)));
 
-        // Calculate direction to target
-        sf::Vector2f direction = target_pos - car.position;
-        float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        for (int slow = ~_mm_movemask_ps(moving) & 0xF; slow != 0; slow &= slow - 1)
+        {
+            routeCar(state, i + size_t(__builtin_ctz(unsigned(slow))), dt, roads);
+        }
+    }
+#endif
 
-        // If we reached the target
-        if (distance < 5.0f)
+    // Remaining cars (all of them without SIMD)
+    for (; i < end; ++i)
+    {
+        const float dx = tx[i] - x[i];
+        const float dy = ty[i] - y[i];
+        if (dx * dx + dy * dy >= ARRIVAL_DISTANCE * ARRIVAL_DISTANCE)
         {
-            // Switch direction if we reached destination
-            car.is_returning = !car.is_returning;
+            moveCar(x[i], y[i], tx[i], ty[i], speed[i], dt);
         }
         else
         {
-            // Normalize direction and move car
-            direction /= distance;
-            car.position += direction * car.speed * dt;
+            routeCar(state, i, dt, roads);
         }
     }
+}
 
+// ----------------------------------------------------------------------------
+void GameManager::updateEconomy(GameState& state, size_t begin, size_t end, sf::Color color)
+{
     // Update building incomes
-    for (sf::Uint32 i = state.economy.startIdx; i < state.economy.startIdx + state.economy.count; ++i)
+    for (size_t i = begin; i < end; ++i)
     {
         auto& building = state.economy.buildings[i];
         building.color = color;
@@ -1,16 +1,59 @@
 #pragma once
 
 #include "GameState.hpp"
+#include <cstddef>
+#include <vector>
+
+class RoadNetwork;
 
 class GameManager
 {
 public:
 
+    /**
+     * @brief Range of cars or buildings updated by a node or a thread
+     */
+    struct Range
+    {
+        //! @brief First index
+        sf::Uint32 startIdx;
+        //! @brief Number of elements
+        sf::Uint32 count;
+    };
+
     /**
      * @brief Initialize the game state with default values
      * @param state [inout] The game state to initialize
+     * @param num_cars [in] Number of cars
+     * @param num_buildings [in] Number of buildings
+     * @param seed [in] Seed of the random city, 0 for a different city each
+     *        time
      */
-    static void createInitialState(GameState& state);
+    static void createInitialState(GameState& state, size_t num_cars = 4, size_t num_buildings = 8,
+                                   unsigned seed = 0);
+
+    /**
+     * @brief Split elements into contiguous ranges of almost equal sizes
+     * @details The first count % parts ranges get one more element. Used both
+     *          to distribute work among peers and among threads.
+     * @param count [in] Number of elements
+     * @param parts [in] Number of ranges
+     * @return At most parts non empty ranges covering [0, count)
+     */
+    static std::vector<Range> split(size_t count, size_t parts);
+
+    /**
+     * @brief Split elements into contiguous ranges proportional to weights
+     * @details Range i gets about count * weights[i] / sum(weights)
+     *          elements, the rounding remainder going to the largest
+     *          fractions. Ranges follow the order of the weights and may be
+     *          empty.
+     * @param count [in] Number of elements
+     * @param weights [in] Non negative weight of each range
+     * @return One range per weight covering [0, count), or an even split if
+     *         all weights are zero
+     */
+    static std::vector<Range> split(size_t count, const std::vector<double>& weights);
 
     /**
      * @brief Validate the game state data
@@ -26,4 +69,33 @@ public:
      * @param[in] color The color specified for each peer.
      */
     static void update(GameState& state, float dt, sf::Color color);
+
+    /**
+     * @brief Moves the cars [begin, end) toward their target
+     * @details Only writes the cars of the range, so disjoint ranges can be
+     *          updated concurrently. With a road network, cars drive from
+     *          building to building along the shortest path, else straight
+     *          to their target. Cars with a known target are moved 8 (AVX2)
+     *          or 4 (SSE2) at a time; only those reaching it look up their
+     *          route.
+     * @param[inout] state The game state to update
+     * @param[in] begin First car
+     * @param[in] end Past the last car
+     * @param[in] dt Time elapsed since last update in seconds
+     * @param[in] color The color specified for each peer.
+     * @param[in] roads Road network of the state, or nullptr.
+     */
+    static void updateTraffic(GameState& state, size_t begin, size_t end, float dt, sf::Color color,
+                              const RoadNetwork* roads = nullptr);
+
+    /**
+     * @brief Updates the buildings [begin, end)
+     * @details Only writes the buildings of the range, so disjoint ranges can
+     *          be updated concurrently.
+     * @param[inout] state The game state to update
+     * @param[in] begin First building
+     * @param[in] end Past the last building
+     * @param[in] color The color specified for each peer.
+     */
+    static void updateEconomy(GameState& state, size_t begin, size_t end, sf::Color color);
 };
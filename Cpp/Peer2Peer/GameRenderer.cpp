@@ -79,10 +79,11 @@ void GameRenderer::renderCars(const GameState& game_state)
     carShape.setOutlineColor(sf::Color::Black);
     carShape.setOutlineThickness(1.0f);
 
-    for (const auto& car : game_state.traffic.cars)
+    const auto& cars = game_state.traffic.cars;
+    for (size_t i = 0; i < cars.size(); ++i)
     {
-        carShape.setFillColor(car.color);
-        carShape.setPosition(car.position);
+        carShape.setFillColor(cars.color[i]);
+        carShape.setPosition(cars.position(i));
         m_window.draw(carShape);
     }
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Color.hpp>
+#include <cstddef>
+#include <limits>
 #include <vector>
 
 /**
@@ -21,11 +23,108 @@ struct GameState
         //! @brief Current speed in pixels per second
         float speed = 0.0f;
         //! @brief Index of the source building
-        int source_building_idx;
+        int source_building_idx = 0;
         //! @brief Index of the destination building
-        int destination_building_idx;
+        int destination_building_idx = 0;
+        //! @brief Index of the building the car is driving to along the
+        //! roads, or -1 to drive straight to the source or destination
+        int waypoint_building_idx = -1;
         //! @brief True if the car is returning to source
-        bool is_returning;
+        bool is_returning = false;
+    };
+
+    /**
+     * @brief All the cars of the traffic simulation, one array per field.
+     * @details The fields read each tick (position, speed and position of
+     *          the target) are contiguous so that cars are moved several at a
+     *          time with SIMD instructions; the others are only touched when a
+     *          car reaches its target. get() and set() convert from and to
+     *          Car for serialization.
+     */
+    struct Cars
+    {
+        //! @brief Current position
+        std::vector<float> x, y;
+        //! @brief Current speed in pixels per second
+        std::vector<float> speed;
+        //! @brief Position of the building the car is driving to, NaN when
+        //! it has to be looked up again (derived data, never serialized)
+        std::vector<float> target_x, target_y;
+        //! @brief Current color
+        std::vector<sf::Color> color;
+        //! @brief Index of the source building
+        std::vector<int> source_building_idx;
+        //! @brief Index of the destination building
+        std::vector<int> destination_building_idx;
+        //! @brief Index of the building the car is driving to along the
+        //! roads, or -1
+        std::vector<int> waypoint_building_idx;
+        //! @brief Non zero if the car is returning to source (not a
+        //! std::vector<bool>: threads write neighboring cars)
+        std::vector<sf::Uint8> is_returning;
+
+        //! @brief Number of cars
+        size_t size() const { return x.size(); }
+
+        //! @brief True if there is no car
+        bool empty() const { return x.empty(); }
+
+        //! @brief Removes all cars
+        void clear() { resize(0); }
+
+        //! @brief Adds or removes cars at the end, new cars are default Car
+        void resize(size_t count)
+        {
+            const Car car{};
+            x.resize(count, car.position.x);
+            y.resize(count, car.position.y);
+            speed.resize(count, car.speed);
+            target_x.resize(count, std::numeric_limits<float>::quiet_NaN());
+            target_y.resize(count, std::numeric_limits<float>::quiet_NaN());
+            color.resize(count, car.color);
+            source_building_idx.resize(count, car.source_building_idx);
+            destination_building_idx.resize(count, car.destination_building_idx);
+            waypoint_building_idx.resize(count, car.waypoint_building_idx);
+            is_returning.resize(count, car.is_returning);
+        }
+
+        //! @brief Adds a car at the end
+        void push_back(const Car& car)
+        {
+            resize(size() + 1);
+            set(size() - 1, car);
+        }
+
+        //! @brief Gets the position of a car
+        sf::Vector2f position(size_t i) const { return {x[i], y[i]}; }
+
+        //! @brief Gets a copy of a car
+        Car get(size_t i) const
+        {
+            Car car;
+            car.position = position(i);
+            car.color = color[i];
+            car.speed = speed[i];
+            car.source_building_idx = source_building_idx[i];
+            car.destination_building_idx = destination_building_idx[i];
+            car.waypoint_building_idx = waypoint_building_idx[i];
+            car.is_returning = (is_returning[i] != 0);
+            return car;
+        }
+
+        //! @brief Overwrites a car, its target will be looked up again
+        void set(size_t i, const Car& car)
+        {
+            x[i] = car.position.x;
+            y[i] = car.position.y;
+            speed[i] = car.speed;
+            target_x[i] = target_y[i] = std::numeric_limits<float>::quiet_NaN();
+            color[i] = car.color;
+            source_building_idx[i] = car.source_building_idx;
+            destination_building_idx[i] = car.destination_building_idx;
+            waypoint_building_idx[i] = car.waypoint_building_idx;
+            is_returning[i] = car.is_returning ? 1 : 0;
+        }
     };
 
     /**
@@ -59,8 +158,8 @@ struct GameState
      */
     struct Traffic
     {
-        //! @brief List of all cars in the simulation
-        std::vector<Car> cars;
+        //! @brief All cars in the simulation
+        Cars cars;
         //! @brief List of all roads
         std::vector<Road> roads;
         //! @brief Start index of the traffic update
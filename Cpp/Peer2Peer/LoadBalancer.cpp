@@ -0,0 +1,291 @@
+#include "LoadBalancer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+// ----------------------------------------------------------------------------
+void LoadBalancer::addPeer(const std::string& name)
+{
+    // Known peers keep their measures
+    m_changed |= m_peers.emplace(name, Peer{}).second;
+}
+
+// ----------------------------------------------------------------------------
+void LoadBalancer::removePeer(const std::string& name)
+{
+    m_changed |= (m_peers.erase(name) != 0);
+}
+
+// ----------------------------------------------------------------------------
+void LoadBalancer::onSent(sf::Uint32 tick)
+{
+    m_sent[tick % m_sent.size()] = {tick, m_time};
+}
+
+// ----------------------------------------------------------------------------
+void LoadBalancer::onAcknowledged(const std::string& name, sf::Uint32 tick)
+{
+    const auto& [sent_tick, sent_time] = m_sent[tick % m_sent.size()];
+    if (sent_tick == tick)
+    {
+        onRoundTrip(name, m_time - sent_time);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void LoadBalancer::onRoundTrip(const std::string& name, float seconds)
+{
+    auto it = m_peers.find(name);
+    if (it != m_peers.end())
+    {
+        it->second.round_trip = smooth(it->second.round_trip, std::max(seconds, 1e-6f));
+    }
+}
+
+// ----------------------------------------------------------------------------
+void LoadBalancer::onResponse(const std::string& name, size_t items, float seconds)
+{
+    auto it = m_peers.find(name);
+    if (it == m_peers.end())
+    {
+        return;
+    }
+
+    Peer& peer = it->second;
+    peer.silence = 0.0f;
+    if (peer.lagging)
+    {
+        std::cout << "Peer " << name << " answers again" << std::endl;
+        peer.lagging = false;
+        m_changed = true;
+    }
+    if ((items > 0) && (seconds > 0.0f))
+    {
+        peer.throughput = smooth(peer.throughput, float(items) / seconds);
+    }
+}
+
+// ----------------------------------------------------------------------------
+bool LoadBalancer::accept(const std::string& name, sf::Uint32 epoch,
+                          const GameManager::Range& range, bool traffic) const
+{
+    auto it = m_peers.find(name);
+    if ((it == m_peers.end()) || (epoch == 0) || (epoch != m_epoch))
+    {
+        return false;
+    }
+
+    const Assignment& assignment = it->second.assignment;
+    const GameManager::Range& assigned = traffic ? assignment.traffic : assignment.economy;
+    return (assignment.epoch == epoch) && (range.startIdx == assigned.startIdx) &&
+           (range.count == assigned.count);
+}
+
+// ----------------------------------------------------------------------------
+bool LoadBalancer::update(float deltaTime, size_t cars, size_t buildings)
+{
+    m_time += deltaTime;
+
+    // Peers holding a range must answer in time
+    for (auto& [name, peer] : m_peers)
+    {
+        peer.silence += deltaTime;
+        const bool busy = (peer.assignment.traffic.count + peer.assignment.economy.count) > 0;
+        const float expected = peer.round_trip +
+            ((peer.throughput > 0.0f) ? float(peer.assignment.traffic.count) / peer.throughput : 0.0f);
+        if (busy && !peer.lagging && (peer.silence > std::max(RESPONSE_TIMEOUT, 4.0f * expected)))
+        {
+            std::cout << "Peer " << name << " does not answer: reassigning its range" << std::endl;
+            peer.lagging = true;
+            m_changed = true;
+        }
+    }
+
+    const std::map<std::string, Estimate> estimates = estimate();
+    const std::map<std::string, double> shares = computeShares(estimates, cars);
+    bool drifted = false;
+    if (m_time - m_rebalanced_at >= REBALANCE_INTERVAL)
+    {
+        std::map<std::string, double> current;
+        for (const auto& [name, share] : shares)
+        {
+            current[name] = m_peers.at(name).share;
+            drifted |= std::abs(share - current[name]) > REBALANCE_THRESHOLD * std::max(current[name], 1e-3);
+        }
+
+        // Hysteresis: when round trips dwarf the compute, their jitter moves
+        // the shares a lot without changing when the answers come
+        drifted = drifted && (expectedAnswer(estimates, shares, cars) <
+                              (1.0 - REBALANCE_GAIN) * expectedAnswer(estimates, current, cars));
+    }
+
+    if (!m_changed && !drifted && (cars == m_cars) && (buildings == m_buildings))
+    {
+        return false;
+    }
+    rebalance(shares, cars, buildings);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+LoadBalancer::Assignment LoadBalancer::getAssignment(const std::string& name) const
+{
+    auto it = m_peers.find(name);
+    if (it == m_peers.end())
+    {
+        Assignment none;
+        none.epoch = m_epoch;
+        return none;
+    }
+    return it->second.assignment;
+}
+
+// ----------------------------------------------------------------------------
+std::string LoadBalancer::getStatusString() const
+{
+    std::ostringstream status;
+    status << "epoch " << m_epoch;
+    for (const auto& [name, peer] : m_peers)
+    {
+        status << " | " << name << ": " << peer.assignment.traffic.count << " cars, rtt "
+               << peer.round_trip * 1000.0f << " ms, " << peer.throughput << " cars/s"
+               << (peer.lagging ? " (lagging)" : "");
+    }
+    return status.str();
+}
+
+// ----------------------------------------------------------------------------
+std::map<std::string, LoadBalancer::Estimate> LoadBalancer::estimate() const
+{
+    // Peers without measures yet are assumed average
+    float known_throughput = 0.0f, known_round_trip = 0.0f;
+    size_t throughputs = 0, round_trips = 0;
+    for (const auto& [name, peer] : m_peers)
+    {
+        if (peer.lagging)
+            continue;
+        if (peer.throughput > 0.0f)
+        {
+            known_throughput += peer.throughput;
+            ++throughputs;
+        }
+        if (peer.round_trip > 0.0f)
+        {
+            known_round_trip += peer.round_trip;
+            ++round_trips;
+        }
+    }
+    const double default_throughput = throughputs ? double(known_throughput) / double(throughputs) : 1.0;
+    const double default_round_trip = round_trips ? double(known_round_trip) / double(round_trips) : 0.0;
+
+    std::map<std::string, Estimate> estimates;
+    for (const auto& [name, peer] : m_peers)
+    {
+        if (!peer.lagging)
+        {
+            estimates[name] = {
+                (peer.throughput > 0.0f) ? double(peer.throughput) : default_throughput,
+                (peer.round_trip > 0.0f) ? double(peer.round_trip) : default_round_trip};
+        }
+    }
+    return estimates;
+}
+
+// ----------------------------------------------------------------------------
+std::map<std::string, double> LoadBalancer::computeShares(const std::map<std::string, Estimate>& estimates,
+                                                          size_t cars)
+{
+    struct Candidate { std::string name; double throughput, round_trip; };
+    std::vector<Candidate> candidates;
+    double speed = 0.0;
+    for (const auto& [name, estimate] : estimates)
+    {
+        candidates.push_back({name, estimate.throughput, estimate.round_trip});
+        speed += estimate.throughput;
+    }
+
+    // All peers should answer at the same time T: peer i gets
+    // throughput_i * (T - round_trip_i) cars. Peers whose round trip leaves
+    // them less than their minimum share keep it, and the others split the
+    // rest.
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+    {
+        return a.round_trip < b.round_trip;
+    });
+    const double total = double(std::max<size_t>(cars, 1));
+    double remaining = total;
+    std::map<std::string, double> shares;
+    while (!candidates.empty())
+    {
+        double filling = 0.0, latency = 0.0;
+        for (const auto& candidate : candidates)
+        {
+            filling += candidate.throughput;
+            latency += candidate.throughput * candidate.round_trip;
+        }
+        const double finish = (remaining + latency) / filling;
+        const Candidate& last = candidates.back();
+        const double minimum = MIN_SHARE * total * last.throughput / speed;
+        if (last.throughput * (finish - last.round_trip) >= minimum)
+        {
+            for (const auto& candidate : candidates)
+            {
+                shares[candidate.name] = candidate.throughput * (finish - candidate.round_trip) / total;
+            }
+            break;
+        }
+        shares[last.name] = minimum / total;
+        remaining -= minimum;
+        candidates.pop_back();
+    }
+    return shares;
+}
+
+// ----------------------------------------------------------------------------
+double LoadBalancer::expectedAnswer(const std::map<std::string, Estimate>& estimates,
+                                    const std::map<std::string, double>& shares, size_t cars)
+{
+    double answer = 0.0;
+    for (const auto& [name, share] : shares)
+    {
+        auto it = estimates.find(name);
+        if ((it != estimates.end()) && (share > 0.0))
+        {
+            const Estimate& estimate = it->second;
+            answer = std::max(answer, estimate.round_trip + share * double(cars) / estimate.throughput);
+        }
+    }
+    return answer;
+}
+
+// ----------------------------------------------------------------------------
+void LoadBalancer::rebalance(const std::map<std::string, double>& shares, size_t cars, size_t buildings)
+{
+    ++m_epoch;
+    m_rebalanced_at = m_time;
+    m_changed = false;
+    m_cars = cars;
+    m_buildings = buildings;
+
+    // Contiguous ranges in the order of the peers, so they cannot overlap
+    std::vector<double> weights;
+    for (const auto& [name, peer] : m_peers)
+    {
+        auto it = shares.find(name);
+        weights.push_back((it != shares.end()) ? it->second : 0.0);
+    }
+    const auto traffic = GameManager::split(cars, weights);
+    const auto economy = GameManager::split(buildings, weights);
+
+    size_t i = 0;
+    for (auto& [name, peer] : m_peers)
+    {
+        peer.share = weights[i];
+        peer.silence = 0.0f;
+        peer.assignment.epoch = m_epoch;
+        peer.assignment.traffic = traffic[i];
+        peer.assignment.economy = economy[i];
+        ++i;
+    }
+}
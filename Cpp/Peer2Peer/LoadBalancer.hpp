@@ -0,0 +1,225 @@
+#pragma once
+#include "GameManager.hpp"
+#include <array>
+#include <map>
+#include <string>
+
+/**
+ * @brief Host side scheduler of the traffic and economy ranges among peers.
+ * @details Each peer gets a share of the cars and buildings proportional to
+ *          its measured speed, minus what its round trip costs: shares are
+ *          chosen so that all peers are expected to answer at the same time
+ *          (round trip + items / throughput is equal for all), instead of
+ *          the slowest peer setting the pace. Every responsive peer keeps
+ *          at least MIN_SHARE of its share by throughput alone, so that it
+ *          is still measured, and the cars stay spread when round trips
+ *          dwarf the compute. Round trips are measured on the STATE_ACK of
+ *          the state synchronizations, throughputs on the time that peers
+ *          spent on their cars, sent back with TRAFFIC_UPDATED.
+ *
+ *          Every new assignment gets a new epoch. A response is merged only
+ *          if it carries the current epoch and the range assigned to its
+ *          peer, so ranges merged during an epoch never overlap and a late
+ *          answer for work given to someone else is dropped. A peer that
+ *          does not answer for RESPONSE_TIMEOUT loses its range, which is
+ *          split among the others until it answers again (evenly among all
+ *          peers if none answers). Measures alone start a new epoch only if
+ *          the answers are then expected noticeably sooner, so that the
+ *          jitter of the round trips does not discard in-flight responses.
+ */
+class LoadBalancer
+{
+public:
+
+    //! @brief Weight of a new measure in the moving averages
+    static constexpr float SMOOTHING = 0.25f;
+    //! @brief Seconds without response before the range of a peer is
+    //! reassigned, unless 4 times its expected round trip + compute is longer
+    static constexpr float RESPONSE_TIMEOUT = 0.5f;
+    //! @brief Minimum seconds between two rebalancings on measures alone
+    static constexpr float REBALANCE_INTERVAL = 1.0f;
+    //! @brief Relative change of a share triggering a rebalancing
+    static constexpr float REBALANCE_THRESHOLD = 0.1f;
+    //! @brief Relative gain of the expected answer time required to
+    //! rebalance on measures alone
+    static constexpr double REBALANCE_GAIN = 0.1;
+    //! @brief Minimum share of a responsive peer, relative to its share
+    //! proportional to throughput alone
+    static constexpr double MIN_SHARE = 0.5;
+
+    /**
+     * @brief Ranges given to a peer for an epoch
+     */
+    struct Assignment
+    {
+        //! @brief Epoch of the assignment (0: none)
+        sf::Uint32 epoch = 0;
+        //! @brief Cars to update
+        GameManager::Range traffic{0, 0};
+        //! @brief Buildings to update
+        GameManager::Range economy{0, 0};
+    };
+
+    /**
+     * @brief Adds a peer, which gets a share at the next update().
+     * @param[in] name Name of the peer
+     */
+    void addPeer(const std::string& name);
+
+    /**
+     * @brief Removes a peer, whose range is reassigned at the next update().
+     * @param[in] name Name of the peer
+     */
+    void removePeer(const std::string& name);
+
+    /**
+     * @brief Remembers when a state synchronization was sent.
+     * @param[in] tick Tick of the synchronization
+     */
+    void onSent(sf::Uint32 tick);
+
+    /**
+     * @brief Measures the round trip of a peer from its acknowledgement.
+     * @param[in] name Name of the peer
+     * @param[in] tick Acknowledged tick
+     */
+    void onAcknowledged(const std::string& name, sf::Uint32 tick);
+
+    /**
+     * @brief Measures a round trip.
+     * @param[in] name Name of the peer
+     * @param[in] seconds Duration of the round trip
+     */
+    void onRoundTrip(const std::string& name, float seconds);
+
+    /**
+     * @brief Measures the throughput of a peer from one of its responses.
+     * @details Any response proves the peer is alive, even for an older
+     *          epoch.
+     * @param[in] name Name of the peer
+     * @param[in] items Number of cars it updated (0: alive only)
+     * @param[in] seconds Time it spent on them, round trip excluded
+     */
+    void onResponse(const std::string& name, size_t items, float seconds);
+
+    /**
+     * @brief Checks if a response can be merged in the game state.
+     * @param[in] name Name of the peer
+     * @param[in] epoch Epoch of the response
+     * @param[in] range Range of the response
+     * @param[in] traffic true for cars, false for buildings
+     * @return true if the range is the one assigned to the peer for the
+     *         current epoch.
+     */
+    bool accept(const std::string& name, sf::Uint32 epoch,
+                const GameManager::Range& range, bool traffic) const;
+
+    /**
+     * @brief Detects timeouts and rebalances the ranges when needed.
+     * @param[in] deltaTime Time elapsed since last update in seconds
+     * @param[in] cars Number of cars
+     * @param[in] buildings Number of buildings
+     * @return true if a new epoch started: the assignments must be sent.
+     */
+    bool update(float deltaTime, size_t cars, size_t buildings);
+
+    /**
+     * @brief Gets the ranges of a peer.
+     * @param[in] name Name of the peer
+     * @return The assignment, with empty ranges for an unknown or lagging
+     *         peer.
+     */
+    Assignment getAssignment(const std::string& name) const;
+
+    /**
+     * @brief Gets the current epoch.
+     * @return Epoch of the last assignments (0: none).
+     */
+    sf::Uint32 getEpoch() const
+    {
+        return m_epoch;
+    }
+
+    /**
+     * @brief Continues the epochs of a former host.
+     * @details Called on a node promoted to host, so that the late responses
+     *          to the former host are never taken for current ones.
+     * @param[in] epoch Last epoch assigned by the former host
+     */
+    void continueEpochs(sf::Uint32 epoch)
+    {
+        m_epoch = (epoch > m_epoch) ? epoch : m_epoch;
+    }
+
+    /**
+     * @brief Gets a one line summary of the peers, for the logs.
+     * @return Share, round trip and throughput of each peer.
+     */
+    std::string getStatusString() const;
+
+private:
+
+    //! @brief Measures and ranges of a peer
+    struct Peer
+    {
+        //! @brief Smoothed round trip in seconds (0: unknown)
+        float round_trip = 0.0f;
+        //! @brief Smoothed cars updated per second (0: unknown)
+        float throughput = 0.0f;
+        //! @brief Seconds since the last response
+        float silence = 0.0f;
+        //! @brief True if the peer timed out and has no range
+        bool lagging = false;
+        //! @brief Share of the cars when the ranges were assigned
+        double share = 0.0;
+        //! @brief Current ranges
+        Assignment assignment;
+    };
+
+    //! @brief Measures of a responsive peer, or the average of the others
+    //! for those not measured yet
+    struct Estimate
+    {
+        //! @brief Cars updated per second
+        double throughput;
+        //! @brief Round trip in seconds
+        double round_trip;
+    };
+
+    //! @brief Estimates the responsive peers
+    std::map<std::string, Estimate> estimate() const;
+
+    //! @brief Computes the share of the cars of each responsive peer
+    static std::map<std::string, double> computeShares(const std::map<std::string, Estimate>& estimates,
+                                                       size_t cars);
+
+    //! @brief Time until the last responsive peer answers with the given shares
+    static double expectedAnswer(const std::map<std::string, Estimate>& estimates,
+                                 const std::map<std::string, double>& shares, size_t cars);
+
+    //! @brief Starts a new epoch with the given shares
+    void rebalance(const std::map<std::string, double>& shares, size_t cars, size_t buildings);
+
+    //! @brief Moving average of a measure
+    static float smooth(float average, float measure)
+    {
+        return (average <= 0.0f) ? measure : average + SMOOTHING * (measure - average);
+    }
+
+private:
+
+    //! @brief Peers by name
+    std::map<std::string, Peer> m_peers;
+    //! @brief Time since the creation
+    float m_time = 0.0f;
+    //! @brief Time of the last rebalancing
+    float m_rebalanced_at = 0.0f;
+    //! @brief Send time of the last ticks, by tick modulo the size
+    std::array<std::pair<sf::Uint32, float>, 64> m_sent{};
+    //! @brief Current epoch (0: never assigned)
+    sf::Uint32 m_epoch = 0;
+    //! @brief Sizes of the state at the last rebalancing
+    size_t m_cars = 0, m_buildings = 0;
+    //! @brief True if peers joined, left, timed out or came back
+    bool m_changed = false;
+};
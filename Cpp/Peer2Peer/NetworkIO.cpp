@@ -0,0 +1,283 @@
+#include "NetworkIO.hpp"
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#  include <arpa/inet.h>
+#  include <cerrno>
+#  include <netinet/in.h>
+#  include <sys/epoll.h>
+#  include <sys/eventfd.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+//! @brief Larger than any UDP datagram
+static constexpr size_t MAX_DATAGRAM_SIZE = 65536;
+
+// ----------------------------------------------------------------------------
+static int bindSocket(unsigned short port)
+{
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // Same options as sf::UdpSocket: broadcast allowed
+    int enable = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// ----------------------------------------------------------------------------
+static sf::Socket::Status sendTo(int fd, sf::Packet& packet, const sf::IpAddress& address, unsigned short port)
+{
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    to.sin_addr.s_addr = htonl(address.toInteger());
+    if (::sendto(fd, packet.getData(), packet.getDataSize(), 0,
+                 reinterpret_cast<const sockaddr*>(&to), sizeof(to)) >= 0)
+    {
+        return sf::Socket::Done;
+    }
+    return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? sf::Socket::NotReady : sf::Socket::Error;
+}
+
+// ----------------------------------------------------------------------------
+static void closeSocket(int& fd)
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+// ----------------------------------------------------------------------------
+NetworkIO::NetworkIO(unsigned short game_port, unsigned short discovery_port)
+{
+    m_game_fd = bindSocket(game_port);
+    if (m_game_fd < 0)
+    {
+        throw std::runtime_error("Failed to bind socket to port " +
+                                 std::to_string(game_port));
+    }
+    m_discovery_fd = bindSocket(discovery_port);
+    if (m_discovery_fd < 0)
+    {
+        closeSocket(m_game_fd);
+        throw std::runtime_error("Failed to bind socket to discovery port");
+    }
+
+    m_epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    bool registered = (m_epoll_fd >= 0) && (m_wake_fd >= 0);
+    for (int fd : {m_game_fd, m_discovery_fd, m_wake_fd})
+    {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        registered = registered && (::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0);
+    }
+    if (!registered)
+    {
+        for (int* fd : {&m_game_fd, &m_discovery_fd, &m_epoll_fd, &m_wake_fd})
+        {
+            closeSocket(*fd);
+        }
+        throw std::runtime_error("Failed to create the network I/O thread");
+    }
+
+    m_buffers.resize(BATCH_SIZE * MAX_DATAGRAM_SIZE);
+    m_thread = std::thread(&NetworkIO::run, this);
+}
+
+// ----------------------------------------------------------------------------
+NetworkIO::~NetworkIO()
+{
+    m_running = false;
+    const sf::Uint64 one = 1;
+    if (::write(m_wake_fd, &one, sizeof(one)) < 0)
+    {
+        // The thread still stops at the next datagram
+    }
+    m_thread.join();
+    for (int* fd : {&m_game_fd, &m_discovery_fd, &m_epoll_fd, &m_wake_fd})
+    {
+        closeSocket(*fd);
+    }
+}
+
+// ----------------------------------------------------------------------------
+sf::Socket::Status NetworkIO::send(sf::Packet& packet, const sf::IpAddress& address, unsigned short port)
+{
+    return sendTo(m_game_fd, packet, address, port);
+}
+
+// ----------------------------------------------------------------------------
+sf::Socket::Status NetworkIO::sendDiscovery(sf::Packet& packet, const sf::IpAddress& address, unsigned short port)
+{
+    return sendTo(m_discovery_fd, packet, address, port);
+}
+
+// ----------------------------------------------------------------------------
+unsigned short NetworkIO::getPort() const
+{
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (::getsockname(m_game_fd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
+
+// ----------------------------------------------------------------------------
+void NetworkIO::run()
+{
+    // One receive buffer and sender address per datagram of a batch
+    std::vector<mmsghdr> messages(BATCH_SIZE);
+    std::vector<iovec> buffers(BATCH_SIZE);
+    std::vector<sockaddr_in> senders(BATCH_SIZE);
+    for (size_t i = 0; i < BATCH_SIZE; ++i)
+    {
+        buffers[i] = {&m_buffers[i * MAX_DATAGRAM_SIZE], MAX_DATAGRAM_SIZE};
+        messages[i].msg_hdr = {};
+        messages[i].msg_hdr.msg_name = &senders[i];
+        messages[i].msg_hdr.msg_iov = &buffers[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    epoll_event events[3];
+    while (m_running)
+    {
+        const int ready = ::epoll_wait(m_epoll_fd, events, 3, -1);
+        for (int e = 0; e < ready; ++e)
+        {
+            const int fd = events[e].data.fd;
+            if (fd == m_wake_fd)
+            {
+                continue;
+            }
+
+            // Drain the socket by batches
+            int received;
+            do
+            {
+                for (auto& message : messages)
+                {
+                    message.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                }
+                received = ::recvmmsg(fd, messages.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+                for (int i = 0; i < received; ++i)
+                {
+                    push(buffers[size_t(i)].iov_base, messages[size_t(i)].msg_len,
+                         sf::IpAddress(ntohl(senders[size_t(i)].sin_addr.s_addr)),
+                         ntohs(senders[size_t(i)].sin_port), fd == m_discovery_fd);
+                }
+            } while (received == int(BATCH_SIZE));
+        }
+    }
+}
+
+#else
+
+// ----------------------------------------------------------------------------
+NetworkIO::NetworkIO(unsigned short game_port, unsigned short discovery_port)
+{
+    if (m_game_socket.bind(game_port) != sf::Socket::Done)
+    {
+        throw std::runtime_error("Failed to bind socket to port " +
+                                 std::to_string(game_port));
+    }
+    if (m_discovery_socket.bind(discovery_port) != sf::Socket::Done)
+    {
+        throw std::runtime_error("Failed to bind socket to discovery port");
+    }
+    m_selector.add(m_game_socket);
+    m_selector.add(m_discovery_socket);
+    m_thread = std::thread(&NetworkIO::run, this);
+}
+
+// ----------------------------------------------------------------------------
+NetworkIO::~NetworkIO()
+{
+    m_running = false; // The selector times out regularly
+    m_thread.join();
+}
+
+// ----------------------------------------------------------------------------
+sf::Socket::Status NetworkIO::send(sf::Packet& packet, const sf::IpAddress& address, unsigned short port)
+{
+    return m_game_socket.send(packet, address, port);
+}
+
+// ----------------------------------------------------------------------------
+sf::Socket::Status NetworkIO::sendDiscovery(sf::Packet& packet, const sf::IpAddress& address, unsigned short port)
+{
+    return m_discovery_socket.send(packet, address, port);
+}
+
+// ----------------------------------------------------------------------------
+unsigned short NetworkIO::getPort() const
+{
+    return m_game_socket.getLocalPort();
+}
+
+// ----------------------------------------------------------------------------
+void NetworkIO::run()
+{
+    sf::Packet packet;
+    sf::IpAddress address;
+    unsigned short port;
+    while (m_running)
+    {
+        if (!m_selector.wait(sf::milliseconds(100)))
+        {
+            continue;
+        }
+        for (auto* socket : {&m_game_socket, &m_discovery_socket})
+        {
+            if (m_selector.isReady(*socket) &&
+                (socket->receive(packet, address, port) == sf::Socket::Done))
+            {
+                push(packet.getData(), packet.getDataSize(), address, port,
+                     socket == &m_discovery_socket);
+            }
+        }
+    }
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+void NetworkIO::push(const void* data, size_t size, const sf::IpAddress& address,
+                     unsigned short port, bool discovery)
+{
+    Datagram* datagram = m_queue.prepare();
+    if (datagram == nullptr)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // The packet of the slot keeps its capacity: no allocation once warm
+    datagram->address = address;
+    datagram->port = port;
+    datagram->discovery = discovery;
+    datagram->packet.clear();
+    datagram->packet.append(data, size);
+    m_queue.commit();
+    m_received.fetch_add(1, std::memory_order_relaxed);
+}
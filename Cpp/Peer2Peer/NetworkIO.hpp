@@ -0,0 +1,159 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Network I/O thread of a NetworkNode.
+ * @details Owns the game and discovery UDP sockets. A dedicated thread waits
+ *          on both sockets (epoll and recvmmsg on Linux, sf::SocketSelector
+ *          elsewhere), receives the datagrams by batches and hands them to
+ *          the simulation thread through a lock-free SPSC queue, so the frame
+ *          loop never polls the sockets. Datagrams are dropped when the queue
+ *          is full, as the kernel would do. Sending is done directly by the
+ *          caller.
+ */
+class NetworkIO
+{
+public:
+
+    //! @brief Number of datagrams waiting for the simulation thread
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+    //! @brief Maximum number of datagrams received by a single system call
+    static constexpr size_t BATCH_SIZE = 64;
+
+    /**
+     * @brief A received datagram.
+     */
+    struct Datagram
+    {
+        //! @brief Address of the sender
+        sf::IpAddress address;
+        //! @brief Port of the sender
+        unsigned short port = 0;
+        //! @brief True if received on the discovery socket
+        bool discovery = false;
+        //! @brief Content, starting with the message type
+        sf::Packet packet;
+    };
+
+    /**
+     * @brief Binds the sockets and starts the I/O thread.
+     * @param[in] game_port Port of the game socket.
+     * @param[in] discovery_port Port of the discovery socket
+     *            (sf::Socket::AnyPort for any).
+     * @throw std::runtime_error if a socket cannot be bound.
+     */
+    NetworkIO(unsigned short game_port, unsigned short discovery_port);
+
+    /**
+     * @brief Stops the I/O thread and closes the sockets.
+     */
+    ~NetworkIO();
+
+    NetworkIO(const NetworkIO&) = delete;
+    NetworkIO& operator=(const NetworkIO&) = delete;
+
+    /**
+     * @brief Sends a packet from the game socket.
+     * @param[in] packet Packet to send.
+     * @param[in] address Address of the receiver.
+     * @param[in] port Port of the receiver.
+     * @return sf::Socket::Done on success.
+     */
+    sf::Socket::Status send(sf::Packet& packet, const sf::IpAddress& address, unsigned short port);
+
+    /**
+     * @brief Sends a packet from the discovery socket (broadcast allowed).
+     * @param[in] packet Packet to send.
+     * @param[in] address Address of the receiver.
+     * @param[in] port Port of the receiver.
+     * @return sf::Socket::Done on success.
+     */
+    sf::Socket::Status sendDiscovery(sf::Packet& packet, const sf::IpAddress& address, unsigned short port);
+
+    /**
+     * @brief Gets the oldest received datagram, to process in place.
+     * @return The datagram or nullptr if none is waiting.
+     */
+    Datagram* front()
+    {
+        return m_queue.front();
+    }
+
+    /**
+     * @brief Releases the datagram returned by front().
+     */
+    void pop()
+    {
+        m_queue.pop();
+    }
+
+    /**
+     * @brief Gets the port of the game socket.
+     * @return Port number.
+     */
+    unsigned short getPort() const;
+
+    /**
+     * @brief Gets the number of datagrams received since the creation.
+     * @return Number of datagrams.
+     */
+    sf::Uint64 getReceivedCount() const
+    {
+        return m_received.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the number of datagrams dropped because the simulation
+     *        thread did not keep up.
+     * @return Number of datagrams.
+     */
+    sf::Uint64 getDroppedCount() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    //! @brief Body of the I/O thread
+    void run();
+
+    //! @brief Queues a received datagram, or drops it if the queue is full
+    void push(const void* data, size_t size, const sf::IpAddress& address,
+              unsigned short port, bool discovery);
+
+private:
+
+#if defined(__linux__)
+    //! @brief Game socket
+    int m_game_fd = -1;
+    //! @brief Discovery socket
+    int m_discovery_fd = -1;
+    //! @brief Waits on both sockets and m_wake_fd
+    int m_epoll_fd = -1;
+    //! @brief Written to wake the I/O thread up when stopping
+    int m_wake_fd = -1;
+    //! @brief Receive buffers of a batch
+    std::vector<char> m_buffers;
+#else
+    //! @brief Game socket
+    sf::UdpSocket m_game_socket;
+    //! @brief Discovery socket
+    sf::UdpSocket m_discovery_socket;
+    //! @brief Waits on both sockets
+    sf::SocketSelector m_selector;
+#endif
+    //! @brief Datagrams for the simulation thread
+    SpscQueue<Datagram> m_queue{QUEUE_CAPACITY};
+    //! @brief Number of datagrams received
+    std::atomic<sf::Uint64> m_received{0};
+    //! @brief Number of datagrams dropped
+    std::atomic<sf::Uint64> m_dropped{0};
+    //! @brief Cleared to stop the I/O thread
+    std::atomic<bool> m_running{true};
+    //! @brief I/O thread, started last
+    std::thread m_thread;
+};
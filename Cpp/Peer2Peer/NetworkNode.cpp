@@ -1,32 +1,23 @@
 #include "NetworkNode.hpp"
 #include "NetworkProtocol.hpp"
-#include "Serialization.hpp"
 #include <SFML/Graphics/Color.hpp>
 #include <cstdlib>
 
+static_assert(StateSync::CHUNK_SIZE + NetworkProtocol::HEADER_SIZE + ReliableChannel::HEADER_SIZE +
+              ReliableChannel::MESSAGE_HEADER_SIZE <= ReliableChannel::MTU,
+              "A chunk of a delta must fit in a datagram");
+
 // ----------------------------------------------------------------------------
-NetworkNode::NetworkNode(unsigned short port, bool hosting) : m_is_host(hosting)
+NetworkNode::NetworkNode(unsigned short port, bool hosting)
+    // Discovery socket for finding peers. Client starts with a random port.
+    : m_io(std::make_unique<NetworkIO>(
+          port, hosting ? DISCOVERY_PORT : static_cast<unsigned short>(sf::Socket::AnyPort))),
+      m_stranger(m_packets),
+      m_is_host(hosting)
 {
     std::cout << (hosting ? "Starting host on port "
                           : "Starting client on port ")
               << port << " and discovery port " << DISCOVERY_PORT << std::endl;
-
-    // Game communication socket.
-    if (m_game_socket.bind(port) != sf::Socket::Done)
-    {
-        throw std::runtime_error("Failed to bind socket to port " +
-                                 std::to_string(port));
-    }
-    m_game_socket.setBlocking(false);
-
-    // Discovery socket for finding peers. Client starts with a random port.
-    unsigned short discovery_port = (m_is_host)
-        ? DISCOVERY_PORT : static_cast<unsigned short>(sf::Socket::AnyPort);
-    if (m_discovery_socket.bind(discovery_port) != sf::Socket::Done)
-    {
-        throw std::runtime_error("Failed to bind socket to discovery port");
-    }
-    m_discovery_socket.setBlocking(false);
 }
 
 // ----------------------------------------------------------------------------
@@ -35,25 +26,18 @@ void NetworkNode::update(float deltaTime, GameState& state, sf::Color color)
     //std::cout << "==================================" << std::endl;
     // Discovery channel
     updatePeerDiscovery(deltaTime);
-    receiveDiscoveryPackets();
+    receivePackets(state);
     checkPeerTimeouts(deltaTime);
 
-    // Distribute workload (host only)
-    if (m_is_host && m_peers_updated)
+    // Distribute workload (host only) when peers come and go, time out or
+    // their measured speeds drift
+    if (m_is_host && m_balancer.update(deltaTime, state.traffic.cars.size(),
+                                       state.economy.buildings.size()))
     {
-        if (hasAvailableNodes())
-        {
-            std::cout << "Distributing traffic load" << std::endl;
-            distributeTrafficLoad(state);
-            std::cout << "Distributing economy calculations" << std::endl;
-            distributeEconomyCalculations(state);
-        }
-        m_peers_updated = false;
+        std::cout << "Distributing work: " << m_balancer.getStatusString() << std::endl;
+        distributeWork();
     }
 
-    // Game channel
-    receiveGamePackets(state);
-
     // Client->Host: Clients send their game states to the host
     if (!m_is_host)
     {
@@ -65,6 +49,10 @@ void NetworkNode::update(float deltaTime, GameState& state, sf::Color color)
     {
         synchronizeClientGameStates(state);
     }
+
+    // Everything queued for a peer this frame leaves in as few datagrams as
+    // possible
+    flushChannels(deltaTime);
 }
 
 // ----------------------------------------------------------------------------
@@ -72,16 +60,27 @@ void NetworkNode::updateGameStateFromClient(float deltaTime, GameState& state, s
 {
     //std::cout << "Updating client state" << std::endl;
 
-    // Update local state
-    GameManager::update(state, deltaTime, color);
+    // Update local state by fixed steps. The host balances the cars on the
+    // time of their kernels alone: the rest of the step does not depend on
+    // our range.
+    if (m_engine.advance(state, deltaTime, color) == 0)
+    {
+        return;
+    }
+    const float compute_time = m_engine.getTrafficTime();
 
-    // Send updated state to the host
+    // Send our ranges to the host, even empty: answering is how the host
+    // knows we are still able to take work
     for (const auto& [name, peer] : m_peers)
     {
         if (peer.is_active && name == "host")
         {
-            sf::Packet packet = NetworkProtocol::createPlayerStatePacket(state);
-            if (m_game_socket.send(packet, peer.address, peer.port) != sf::Socket::Done)
+            auto traffic = m_packets.acquire();
+            auto economy = m_packets.acquire();
+            NetworkProtocol::createTrafficUpdatedPacket(*traffic, state, m_epoch, compute_time);
+            NetworkProtocol::createEconomyUpdatedPacket(*economy, state, m_epoch, compute_time);
+            if (!sendMessage(peer.address, peer.port, *traffic, false) ||
+                !sendMessage(peer.address, peer.port, *economy, false))
             {
                 std::cerr << "Failed to send state update to host" << std::endl;
             }
@@ -102,17 +101,28 @@ void NetworkNode::synchronizeClientGameStates(const GameState& state)
         return;
     }
 
-    // Prepare synchronization packet
-    sf::Packet packet = NetworkProtocol::createStateSyncPacket(state);
+    // Snapshot the state: it becomes the base of the next deltas once acked
+    StateSync::capture(state, ++m_tick, m_snapshots.getSpare());
+    const StateSnapshot& snapshot = m_snapshots.pushSpare();
+    const bool keyframe = (m_tick % StateSync::KEYFRAME_INTERVAL) == 0;
+    m_balancer.onSent(m_tick); // Round trips are measured on the acks
 
-    // Broadcast to active peers
+    // Send to each active peer the changes since its last acknowledged
+    // snapshot, in chunks of one datagram each
+    auto packet = m_packets.acquire();
     for (auto const& [name, peer_info] : m_peers)
     {
-        if (m_game_socket.send(packet, peer_info.address, peer_info.port) !=
-            sf::Socket::Done)
+        StateSync::Chunks chunks;
+        chunks.current = &snapshot;
+        chunks.base = keyframe ? nullptr : m_snapshots.find(peer_info.acked_tick);
+        while (NetworkProtocol::createStateDeltaPacket(*packet, chunks))
         {
-            std::cerr << "Warning: Failed to send state to peer " << name
-                      << std::endl;
+            if (!sendMessage(peer_info.address, peer_info.port, *packet, false))
+            {
+                std::cerr << "Warning: Failed to send state to peer " << name
+                          << std::endl;
+                break;
+            }
         }
     }
 }
@@ -120,6 +130,14 @@ void NetworkNode::synchronizeClientGameStates(const GameState& state)
 // ----------------------------------------------------------------------------
 void NetworkNode::updatePeerDiscovery(float deltaTime)
 {
+    // Host heartbeat, also telling the clients whom to elect if it is lost
+    m_last_heartbeat += deltaTime;
+    if (m_is_host && (m_last_heartbeat >= HEARTBEAT_INTERVAL))
+    {
+        m_last_heartbeat = 0.0f;
+        sendPeerList();
+    }
+
     m_last_ping_sent += deltaTime;
 
     if (m_last_ping_sent >= PING_INTERVAL)
@@ -129,23 +147,26 @@ void NetworkNode::updatePeerDiscovery(float deltaTime)
         if (m_is_host)
         {
             // Host broadcasts its presence.
-            sf::Packet packet = NetworkProtocol::createDiscoveryPacket(m_game_socket.getLocalPort());
-            m_discovery_socket.send(packet, sf::IpAddress::Broadcast, DISCOVERY_PORT);
+            auto packet = m_packets.acquire();
+            NetworkProtocol::createDiscoveryPacket(*packet, m_io->getPort());
+            m_io->sendDiscovery(*packet, sf::IpAddress::Broadcast, DISCOVERY_PORT);
         }
         else if (m_peers.empty()) // Client without connection
         {
             // The client sends a ping to the discovery port of the host for its subscription.
-            sf::Packet packet = NetworkProtocol::createPingPacket(m_game_socket.getLocalPort());
-            m_discovery_socket.send(packet, sf::IpAddress::LocalHost, DISCOVERY_PORT);
+            auto packet = m_packets.acquire();
+            NetworkProtocol::createPingPacket(*packet, m_io->getPort());
+            m_io->sendDiscovery(*packet, sf::IpAddress::LocalHost, DISCOVERY_PORT);
         }
         else // Client connected
         {
             // Send regular pings to the host to keep it aware of the client's presence,
             // else the host will timeout the client.
-            sf::Packet packet = NetworkProtocol::createPingPacket(m_game_socket.getLocalPort()   );
+            auto packet = m_packets.acquire();
+            NetworkProtocol::createPingPacket(*packet, m_io->getPort());
             for (auto& [name, peer] : m_peers)
             {
-                if (m_game_socket.send(packet, peer.address, peer.port) != sf::Socket::Done)
+                if (!sendMessage(peer.address, peer.port, *packet, false))
                 {
                     std::cerr << "Failed to send ping to " << name << std::endl;
                 }
@@ -155,67 +176,103 @@ void NetworkNode::updatePeerDiscovery(float deltaTime)
 }
 
 // ----------------------------------------------------------------------------
-void NetworkNode::receiveDiscoveryPackets()
+void NetworkNode::receivePackets(GameState& state)
 {
-    sf::Packet discoveryPacket;
-    sf::IpAddress senderAddress;
-    unsigned short senderPort;
+    // Only what the I/O thread already received: the frame never waits
+    while (NetworkIO::Datagram* datagram = m_io->front())
+    {
+        if (datagram->discovery)
+        {
+            processDiscoveryPacket(*datagram);
+        }
+        else
+        {
+            receiveGameDatagram(*datagram, state);
+        }
+        m_io->pop();
+    }
+}
+
+// ----------------------------------------------------------------------------
+void NetworkNode::receiveGameDatagram(const NetworkIO::Datagram& datagram, GameState& state)
+{
+    // Unknown senders only send pings and heartbeats, read without keeping
+    // the state of their channel
+    auto channel = m_channels.find(peerKey(datagram.address, datagram.port));
+    if (channel != m_channels.end())
+    {
+        channel->second.receive(datagram.packet, m_messages);
+    }
+    else
+    {
+        m_stranger.reset();
+        m_stranger.receive(datagram.packet, m_messages);
+    }
+
+    // Processed once read: a message may change the peers and their channels
+    for (auto& message : m_messages)
+    {
+        processGamePacket(*message, datagram, state);
+    }
+    m_messages.clear();
+}
+
+// ----------------------------------------------------------------------------
+void NetworkNode::processDiscoveryPacket(NetworkIO::Datagram& datagram)
+{
+    sf::Packet& discoveryPacket = datagram.packet;
+    const sf::IpAddress& senderAddress = datagram.address;
     sf::Uint8 messageType;
 
-    while (true)
+    // Ignore packets from ourselves
+    if ((senderAddress == sf::IpAddress::LocalHost ||
+        senderAddress == sf::IpAddress::getLocalAddress()) &&
+        (m_is_host && datagram.port == DISCOVERY_PORT))
     {
-        sf::Socket::Status status = m_discovery_socket.receive(
-               discoveryPacket, senderAddress, senderPort);
+        return;
+    }
 
-        if (status == sf::Socket::Done)
-        {
-            // Ignore packets from ourselves
-            if ((senderAddress == sf::IpAddress::LocalHost ||
-                senderAddress == sf::IpAddress::getLocalAddress()) &&
-                (m_is_host && senderPort == DISCOVERY_PORT))
+    // Process the discovery packet
+    if (!(discoveryPacket >> messageType))
+    {
+        return;
+    }
+    switch (DiscoveryMessageType(messageType))
+    {
+        case DiscoveryMessageType::DISCOVERY:
+            if (!m_is_host)
             {
-                continue;
+                unsigned short hostPort;
+                if (!(discoveryPacket >> hostPort))
+                {
+                    break;
+                }
+                std::cout << "Client discovered host at port " << hostPort << std::endl;
+                addPeer("host", senderAddress, hostPort);
             }
-
-            // Process the discovery packet
-            discoveryPacket >> messageType;
-            switch (DiscoveryMessageType(messageType))
+            break;
+        case DiscoveryMessageType::PING:
+            if (m_is_host)
             {
-                case DiscoveryMessageType::DISCOVERY:
-                    if (!m_is_host)
-                    {
-                        unsigned short hostPort;
-                        discoveryPacket >> hostPort;
-                        std::cout << "Client discovered host at port " << hostPort << std::endl;
-                        addPeer("host", senderAddress, hostPort);
-                    }
-                    break;
-                case DiscoveryMessageType::PING:
-                    if (m_is_host)
-                    {
-                        // Remember that clientPort != senderPort since the client is using a
-                        // temporary port on the discovery socket
-                        unsigned short clientPort;
-                        discoveryPacket >> clientPort;
-                        std::cout << "Host received ping from client " << senderAddress
-                                << " port: " << clientPort << std::endl;
-
-                        std::string clientId = "client_" + std::to_string(clientPort);
-                        addPeer(clientId, senderAddress, clientPort);
-                    }
+                // Remember that clientPort != senderPort since the client is using a
+                // temporary port on the discovery socket
+                unsigned short clientPort;
+                if (!(discoveryPacket >> clientPort))
+                {
                     break;
-            }
+                }
+                std::cout << "Host received ping from client " << senderAddress
+                        << " port: " << clientPort << std::endl;
 
-        }
-        else if (status == sf::Socket::NotReady)
-        {
-            break; // No more messages to receive
-        }
-        else
-        {
-            handleNetworkError("receive", status);
+                std::string clientId = "client_" + std::to_string(clientPort);
+                addPeer(clientId, senderAddress, clientPort);
+
+                // Answer directly: the broadcast only reaches the discovery port
+                auto packet = m_packets.acquire();
+                NetworkProtocol::createDiscoveryPacket(*packet, m_io->getPort());
+                m_io->sendDiscovery(*packet, senderAddress, datagram.port);
+            }
             break;
-        }
     }
 }
 
@@ -223,17 +280,21 @@ void NetworkNode::receiveDiscoveryPackets()
 void NetworkNode::checkPeerTimeouts(float deltaTime)
 {
     bool found_inactive_peers = false;
+    sf::Uint64 lost_host = 0;
 
     for (auto& [name, peer] : m_peers)
     {
         if (peer.is_active)
         {
+            // The host sends heartbeats: it is given up much sooner
+            const bool host = !m_is_host && (name == "host");
             peer.last_ping += deltaTime;
-            if (peer.last_ping > PEER_TIMEOUT)
+            if (peer.last_ping > (host ? HOST_TIMEOUT : PEER_TIMEOUT))
             {
                 std::cout << "Peer " << name << " timed out" << std::endl;
                 peer.is_active = false;
                 found_inactive_peers = true;
+                lost_host = host ? peerKey(peer.address, peer.port) : lost_host;
             }
         }
     }
@@ -242,61 +303,110 @@ void NetworkNode::checkPeerTimeouts(float deltaTime)
     {
         removeInactivePeers();
     }
+    if (lost_host != 0)
+    {
+        electHost(lost_host);
+    }
 }
 
 // ----------------------------------------------------------------------------
-void NetworkNode::receiveGamePackets(GameState& state)
+void NetworkNode::processGamePacket(sf::Packet& packet, const NetworkIO::Datagram& datagram, GameState& state)
 {
-    sf::Packet packet;
-    sf::IpAddress sender;
-    unsigned short senderPort;
     sf::Uint8 messageType;
 
-    while (true)
+    // Update last ping time for the sending peer
+    PeerInfo* from = nullptr;
+    const std::string* from_name = nullptr;
+    auto index = m_peer_index.find(peerKey(datagram.address, datagram.port));
+    if (index != m_peer_index.end())
     {
-        sf::Socket::Status status =
-            m_game_socket.receive(packet, sender, senderPort);
+        auto it = m_peers.find(index->second);
+        if (it != m_peers.end())
+        {
+            it->second.last_ping = 0.0f;
+            it->second.is_active = true;
+            from = &it->second;
+            from_name = &it->first;
+        }
+    }
 
-        if (status == sf::Socket::Done)
+    // Process the game message
+    if (!(packet >> messageType))
+    {
+        return;
+    }
+    if (m_is_host && (from == nullptr) &&
+        (messageType == static_cast<sf::Uint8>(DiscoveryMessageType::PING)))
+    {
+        // Client following this host after an election, not known yet
+        unsigned short clientPort;
+        if (packet >> clientPort)
         {
-            // Update last ping time for the sending peer
-            for (auto& [name, peer] : m_peers)
-            {
-                if ((peer.address == sender) && (peer.port == senderPort))
-                {
-                    peer.last_ping = 0.0f;
-                    peer.is_active = true;
-                    break;
-                }
-            }
+            addPeer("client_" + std::to_string(clientPort), datagram.address, datagram.port);
+        }
+        return;
+    }
 
-            // Process the game message
-            packet >> messageType;
-            switch (GameMessageType(messageType))
+    switch (GameMessageType(messageType))
+    {
+        case GameMessageType::TRAFFIC_DISTRIBUTION:
+        {
+            std::cout << "Processing traffic update" << std::endl;
+            sf::Uint32 epoch = NetworkProtocol::processTrafficUpdate(packet, state);
+            m_epoch = (epoch != 0) ? epoch : m_epoch;
+            break;
+        }
+        case GameMessageType::ECONOMY_DISTRIBUTION:
+        {
+            std::cout << "Processing economy update" << std::endl;
+            sf::Uint32 epoch = NetworkProtocol::processEconomyUpdate(packet, state);
+            m_epoch = (epoch != 0) ? epoch : m_epoch;
+            break;
+        }
+        case GameMessageType::TRAFFIC_UPDATED:
+        case GameMessageType::ECONOMY_UPDATED:
+            if (m_is_host && (from_name != nullptr))
             {
-                case GameMessageType::TRAFFIC_DISTRIBUTION:
-                    std::cout << "Processing traffic update" << std::endl;
-                    NetworkProtocol::processTrafficUpdate(packet, state);
-                    break;
-                case GameMessageType::ECONOMY_DISTRIBUTION:
-                    std::cout << "Processing economy update" << std::endl;
-                    NetworkProtocol::processEconomyUpdate(packet, state);
-                    break;
-                case GameMessageType::STATE_SYNC:
-                    //std::cout << "Processing state sync" << std::endl;
-                    NetworkProtocol::processStateSync(packet, state);
-                    break;
+                mergeResponse(packet, *from_name,
+                              GameMessageType(messageType) == GameMessageType::TRAFFIC_UPDATED,
+                              state);
             }
-        }
-        else if (status == sf::Socket::NotReady)
+            break;
+        case GameMessageType::STATE_SYNC:
+            //std::cout << "Processing state sync" << std::endl;
+            NetworkProtocol::processStateSync(packet, state);
+            break;
+        case GameMessageType::STATE_DELTA:
         {
-            break; // No more messages to receive
+            // Only from our host: anybody else could overwrite the game
+            if (m_is_host || (from_name == nullptr) || (*from_name != "host"))
+            {
+                break;
+            }
+            sf::Uint32 tick = NetworkProtocol::processStateDelta(packet, m_snapshots, state);
+            if (tick != 0)
+            {
+                auto ack = m_packets.acquire();
+                NetworkProtocol::createStateAckPacket(*ack, tick);
+                sendMessage(datagram.address, datagram.port, *ack, false);
+            }
+            break;
         }
-        else
+        case GameMessageType::STATE_ACK:
         {
-            handleNetworkError("receive", status);
+            const sf::Uint32 tick = NetworkProtocol::processStateAck(packet);
+            if ((from != nullptr) && (tick > from->acked_tick))
+            {
+                from->acked_tick = tick;
+                m_balancer.onAcknowledged(*from_name, tick);
+            }
             break;
         }
+        case GameMessageType::PEER_LIST:
+            processPeerList(packet, {datagram.address, datagram.port});
+            break;
+        default:
+            break;
     }
 }
 
@@ -324,122 +434,281 @@ bool NetworkNode::hasAvailableNodes() const
 }
 
 // ----------------------------------------------------------------------------
-void NetworkNode::distributeTrafficLoad(const GameState& state)
+void NetworkNode::distributeWork()
 {
-    // Check active peer count
-    size_t active_peer_count = getActivePeerCount();
-    if (active_peer_count == 0)
+    for (const auto& [name, peer_info] : m_peers)
     {
-        std::cerr << "Warning: No active peers to distribute traffic calculations" << std::endl;
-        return;
+        if (peer_info.is_active)
+        {
+            sendAssignment(name);
+        }
     }
+}
 
-    // Verify car positions
-    if (state.traffic.cars.empty())
+// ----------------------------------------------------------------------------
+void NetworkNode::sendAssignment(const std::string& name)
+{
+    auto it = m_peers.find(name);
+    if (it == m_peers.end())
     {
-        std::cerr << "Warning: No cars to process" << std::endl;
         return;
     }
 
-    // Calculate cars per peer and distribute workload
-    size_t cars_per_peer = std::max(
-        size_t(1), state.traffic.cars.size() / active_peer_count);
+    // Lagging peers get empty ranges: their cars were given to others.
+    // Sent reliably: a client missing its range would work on a stale epoch.
+    const LoadBalancer::Assignment assignment = m_balancer.getAssignment(name);
+    auto packet = m_packets.acquire();
+    NetworkProtocol::createTrafficCalculationPacket(
+        *packet, assignment.epoch, assignment.traffic.startIdx, assignment.traffic.count);
+    sendMessage(it->second.address, it->second.port, *packet, true);
+    NetworkProtocol::createEconomyCalculationPacket(
+        *packet, assignment.epoch, assignment.economy.startIdx, assignment.economy.count);
+    sendMessage(it->second.address, it->second.port, *packet, true);
+}
 
-    size_t start_idx = 0;
-    for (auto const& [name, peer_info] : m_peers)
+// ----------------------------------------------------------------------------
+void NetworkNode::mergeResponse(sf::Packet& packet, const std::string& name, bool traffic, GameState& state)
+{
+    PacketReader reader(packet, NetworkProtocol::HEADER_SIZE);
+    NetworkProtocol::RangeUpdate update;
+    if (!NetworkProtocol::processRangeUpdate(reader, update))
     {
-        // Check bounds
-        size_t end_idx = std::min(start_idx + cars_per_peer,
-                                state.traffic.cars.size());
+        return;
+    }
 
-        if (start_idx >= end_idx)
+    // Any response proves the peer is alive, only traffic measures its speed
+    m_balancer.onResponse(name, traffic ? update.range.count : 0u,
+                          traffic ? update.compute_time : 0.0f);
+    if (m_balancer.accept(name, update.epoch, update.range, traffic))
+    {
+        if (traffic)
         {
-            break;
+            NetworkProtocol::processTrafficUpdated(reader, update.range, state);
         }
+        else
+        {
+            NetworkProtocol::processEconomyUpdated(reader, update.range, state);
+        }
+    }
+    else if (traffic && (update.epoch != m_balancer.getEpoch()))
+    {
+        // Work of an older epoch, maybe given to another peer since then: not
+        // merged. Resend the current ranges in case the client restarted and
+        // its channel with them.
+        sendAssignment(name);
+    }
+}
 
-        // Send calculation request
-        sf::Packet packet = NetworkProtocol::createTrafficCalculationPacket(
-            static_cast<sf::Uint32>(start_idx),
-            static_cast<sf::Uint32>(end_idx - start_idx));
-        m_game_socket.send(packet, peer_info.address, peer_info.port);
-        start_idx = end_idx;
+// ----------------------------------------------------------------------------
+void NetworkNode::addPeer(const std::string& id,
+                          const sf::IpAddress& address,
+                          unsigned short port)
+{
+    std::cout << "addPeer " << id << ", address " << address << ", port "
+              << port << std::endl;
+    const sf::Uint64 key = peerKey(address, port);
+    auto it = m_peers.find(id);
+    if (it != m_peers.end())
+    {
+        const sf::Uint64 old_key = peerKey(it->second.address, it->second.port);
+        m_peer_index.erase(old_key);
+        if (old_key != key)
+        {
+            m_channels.erase(old_key);
+        }
+    }
+    m_peers[id] = {address, port, true, 0.0f};
+    m_peer_index[key] = id;
+    m_channels.try_emplace(key, m_packets); // Kept if already connected
+    if (m_is_host)
+    {
+        m_balancer.addPeer(id);
     }
 }
 
 // ----------------------------------------------------------------------------
-void NetworkNode::distributeEconomyCalculations(const GameState& state)
+void NetworkNode::removeInactivePeers()
 {
-    // Check active peer count
-    size_t active_peer_count = 0;
-    for (const auto& [name, peer_info] : m_peers)
+    auto it = m_peers.begin();
+    while (it != m_peers.end())
     {
-        if (peer_info.is_active)
+        if (!it->second.is_active)
+        {
+            m_balancer.removePeer(it->first);
+            m_peer_index.erase(peerKey(it->second.address, it->second.port));
+            m_channels.erase(peerKey(it->second.address, it->second.port));
+            it = m_peers.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+void NetworkNode::sendPeerList()
+{
+    m_members.clear();
+    for (const auto& [name, peer] : m_peers)
+    {
+        if (peer.is_active)
         {
-            active_peer_count++;
+            m_members.push_back({peer.address, peer.port});
         }
     }
 
-    if (active_peer_count == 0)
+    auto packet = m_packets.acquire();
+    for (sf::Uint32 i = 0; i < m_members.size(); ++i)
     {
-        std::cerr << "Warning: No active peers to distribute calculations"
-                  << std::endl;
+        NetworkProtocol::createPeerListPacket(*packet, m_members, i);
+        sendMessage(m_members[i].address, m_members[i].port, *packet, false);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void NetworkNode::processPeerList(const sf::Packet& packet, const NetworkProtocol::Member& sender)
+{
+    const sf::Uint64 sender_key = peerKey(sender.address, sender.port);
+    auto host = m_peers.find("host");
+
+    if (m_is_host)
+    {
+        // Two hosts after a split election: the lowest one wins. The first
+        // host does not know its own key and never steps down.
+        if ((m_self_key != 0) && (sender_key < m_self_key))
+        {
+            std::cout << "Stepping down for host " << sender.address << ":"
+                      << sender.port << std::endl;
+            follow(sender);
+        }
         return;
     }
+    const sf::Uint64 host_key = (host != m_peers.end())
+        ? peerKey(host->second.address, host->second.port) : 0;
+    if ((host_key == 0) || (sender_key < host_key))
+    {
+        follow(sender);
+    }
+    else if (sender_key != host_key)
+    {
+        return; // Host losing a split election: ignored
+    }
+
+    sf::Uint32 self = NetworkProtocol::NOT_A_MEMBER;
+    if (NetworkProtocol::processPeerList(packet, m_members, self))
+    {
+        m_self_key = (self != NetworkProtocol::NOT_A_MEMBER)
+            ? peerKey(m_members[self].address, m_members[self].port) : 0;
+    }
+}
 
-    // Verify vector size
-    if (state.economy.buildings.empty())
+// ----------------------------------------------------------------------------
+void NetworkNode::electHost(sf::Uint64 lost)
+{
+    // A member elected but lost as well is not elected again
+    m_members.erase(std::remove_if(m_members.begin(), m_members.end(),
+                                   [lost](const NetworkProtocol::Member& member)
+                                   { return peerKey(member.address, member.port) == lost; }),
+                    m_members.end());
+    if ((m_self_key == 0) || m_members.empty())
     {
-        std::cerr << "Warning: No buildings to process" << std::endl;
+        std::cout << "Host lost, searching for a new one" << std::endl;
         return;
     }
 
-    // Calculate buildings per peer and distribute workload
-    size_t buildings_per_peer = std::max(
-        size_t(1), state.economy.buildings.size() / active_peer_count);
+    auto winner = std::min_element(m_members.begin(), m_members.end(),
+                                   [](const NetworkProtocol::Member& a, const NetworkProtocol::Member& b)
+                                   { return peerKey(a.address, a.port) < peerKey(b.address, b.port); });
+    if (peerKey(winner->address, winner->port) == m_self_key)
+    {
+        promote();
+    }
+    else
+    {
+        follow(*winner);
+    }
+}
 
-    size_t start_idx = 0;
-    for (auto const& [name, peer_info] : m_peers)
+// ----------------------------------------------------------------------------
+void NetworkNode::promote()
+{
+    std::cout << "Elected host of " << m_members.size() - 1 << " peers" << std::endl;
+    m_is_host = true;
+    m_balancer = LoadBalancer();
+    m_balancer.continueEpochs(m_epoch);
+
+    // The clients may still hold snapshots of the former host: new ticks
+    // start after them and the first delta of each client is a keyframe
+    m_tick = m_snapshots.getLatestTick() + StateSync::KEYFRAME_INTERVAL;
+
+    // Take the discovery port over, freed if the former host is gone
+    const unsigned short port = m_io->getPort();
+    m_io.reset();
+    try
+    {
+        m_io = std::make_unique<NetworkIO>(port, DISCOVERY_PORT);
+    }
+    catch (const std::exception& e)
     {
-        // Check bounds
-        size_t end_idx = std::min(start_idx + buildings_per_peer,
-                                    state.economy.buildings.size());
+        std::cerr << "Warning: " << e.what() << ", new clients will not find this host" << std::endl;
+        m_io = std::make_unique<NetworkIO>(port, static_cast<unsigned short>(sf::Socket::AnyPort));
+    }
 
-        if (start_idx >= end_idx)
+    // The other members become the clients, without waiting for their pings
+    for (const auto& member : m_members)
+    {
+        if (peerKey(member.address, member.port) != m_self_key)
         {
-            break;
+            addPeer("client_" + std::to_string(member.port), member.address, member.port);
         }
+    }
+    sendPeerList();
+}
+
+// ----------------------------------------------------------------------------
+void NetworkNode::follow(const NetworkProtocol::Member& host)
+{
+    std::cout << "Following host " << host.address << ":" << host.port << std::endl;
 
-        // Send calculation request
-        sf::Packet packet = NetworkProtocol::createEconomyCalculationPacket(start_idx, end_idx - start_idx);
-        m_game_socket.send(packet, peer_info.address, peer_info.port);
-        start_idx = end_idx;
+    // Forget the former host, or our clients if we were one
+    for (const auto& [name, peer] : m_peers)
+    {
+        m_balancer.removePeer(name);
     }
+    m_peers.clear();
+    m_peer_index.clear();
+    m_channels.clear();
+    m_is_host = false;
+
+    // Its ticks are not ours: the next keyframe starts the history over
+    m_snapshots.clear();
+
+    // Ping it with the next flush: it knows us from the list of members or
+    // from the ping
+    addPeer("host", host.address, host.port);
+    auto packet = m_packets.acquire();
+    NetworkProtocol::createPingPacket(*packet, m_io->getPort());
+    sendMessage(host.address, host.port, *packet, false);
 }
 
 // ----------------------------------------------------------------------------
-void NetworkNode::addPeer(const std::string& id,
-                          const sf::IpAddress& address,
-                          unsigned short port)
+bool NetworkNode::sendMessage(const sf::IpAddress& address, unsigned short port,
+                              const sf::Packet& packet, bool reliable)
 {
-    std::cout << "addPeer " << id << ", address " << address << ", port "
-              << port << std::endl;
-    m_peers[id] = {address, port, true, 0.0f};
-    m_peers_updated = true;
+    auto channel = m_channels.find(peerKey(address, port));
+    return (channel != m_channels.end()) && channel->second.send(packet, reliable);
 }
 
 // ----------------------------------------------------------------------------
-void NetworkNode::removeInactivePeers()
+void NetworkNode::flushChannels(float deltaTime)
 {
-    auto it = m_peers.begin();
-    while (it != m_peers.end())
+    for (const auto& [name, peer] : m_peers)
     {
-        if (!it->second.is_active)
+        auto channel = m_channels.find(peerKey(peer.address, peer.port));
+        if (channel != m_channels.end())
         {
-            it = m_peers.erase(it);
-        }
-        else
-        {
-            ++it;
+            channel->second.flush(deltaTime, *m_io, peer.address, peer.port);
         }
     }
 }
@@ -459,7 +728,7 @@ size_t NetworkNode::getActivePeerCount() const
 // ----------------------------------------------------------------------------
 unsigned short NetworkNode::getPort() const
 {
-    return m_game_socket.getLocalPort();
+    return m_io->getPort();
 }
 
 // ----------------------------------------------------------------------------
@@ -474,6 +743,29 @@ std::string NetworkNode::getNetworkStatusString() const
     return "Searching for host...";
 }
 
+// ----------------------------------------------------------------------------
+bool NetworkNode::isHost() const
+{
+    return m_is_host;
+}
+
+// ----------------------------------------------------------------------------
+unsigned short NetworkNode::getHostPort() const
+{
+    if (m_is_host)
+    {
+        return m_io->getPort();
+    }
+    auto it = m_peers.find("host");
+    return (it != m_peers.end()) ? it->second.port : 0;
+}
+
+// ----------------------------------------------------------------------------
+sf::Uint32 NetworkNode::getSnapshotTick() const
+{
+    return m_snapshots.getLatestTick();
+}
+
 // ----------------------------------------------------------------------------
 void NetworkNode::handleNetworkError(const std::string& operation,
                                      sf::Socket::Status status)
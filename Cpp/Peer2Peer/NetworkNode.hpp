@@ -6,9 +6,17 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <unordered_map>
 
 #include "GameManager.hpp"
 #include "GameState.hpp"
+#include "LoadBalancer.hpp"
+#include "NetworkProtocol.hpp"
+#include "NetworkIO.hpp"
+#include "PacketPool.hpp"
+#include "ReliableChannel.hpp"
+#include "SimulationEngine.hpp"
+#include "StateSync.hpp"
 
 /**
  * @brief Handles peer-to-peer networking and game state synchronization
@@ -20,6 +28,11 @@ public:
     static constexpr unsigned short DISCOVERY_PORT = 45678;
     static constexpr float PING_INTERVAL = 1.0f;
     static constexpr float PEER_TIMEOUT = 5.0f;
+    //! @brief Seconds between two PEER_LIST heartbeats of the host
+    static constexpr float HEARTBEAT_INTERVAL = 0.1f;
+    //! @brief Seconds without any packet of the host before electing a new
+    //! one
+    static constexpr float HOST_TIMEOUT = 0.5f;
 
     /**
      * @brief Constructor for NetworkNode
@@ -59,6 +72,26 @@ public:
      */
     std::string getNetworkStatusString() const;
 
+    /**
+     * @brief Checks if this node is the host, from the start or elected
+     * @return true if this node is the host
+     */
+    bool isHost() const;
+
+    /**
+     * @brief Gets the game port of the host
+     * @return The port of this node if it is the host, of its host else, or
+     *         0 if not connected
+     */
+    unsigned short getHostPort() const;
+
+    /**
+     * @brief Gets the tick of the last snapshot sent (host) or received
+     *        (client)
+     * @return The tick, or 0 if none
+     */
+    sf::Uint32 getSnapshotTick() const;
+
 private:
 
     /**
@@ -77,6 +110,8 @@ private:
 
     /**
      * @brief Synchronizes game state with all peers
+     * @details Sends to each peer the changes since the last snapshot it
+     *          acknowledged, or a keyframe.
      * @param state [in] Current game state to synchronize
      */
     void synchronizeClientGameStates(const GameState& state);
@@ -106,32 +141,115 @@ private:
                             sf::Socket::Status status);
 
     /**
-     * @brief Receives and queues incoming network messages
+     * @brief Processes the datagrams queued by the I/O thread
+     * @param state [inout] Game state to update
+     */
+    void receivePackets(GameState& state);
+
+    /**
+     * @brief Processes a packet received on the discovery socket
+     * @param datagram [inout] Received datagram
+     */
+    void processDiscoveryPacket(NetworkIO::Datagram& datagram);
+
+    /**
+     * @brief Reads a datagram received on the game socket with the channel
+     *        of its sender, and processes its messages
+     * @param datagram [in] Received datagram
+     * @param state [inout] Game state to update
+     */
+    void receiveGameDatagram(const NetworkIO::Datagram& datagram, GameState& state);
+
+    /**
+     * @brief Processes a message received on the game socket
+     * @param packet [inout] Message, starting with its type
+     * @param datagram [in] Datagram holding the message
+     * @param state [inout] Game state to update
+     */
+    void processGamePacket(sf::Packet& packet, const NetworkIO::Datagram& datagram, GameState& state);
+
+    /**
+     * @brief Queues a message on the channel of a peer, sent by the next
+     *        flushChannels()
+     * @param address [in] Address of the peer
+     * @param port [in] Game port of the peer
+     * @param packet [in] Message, copied
+     * @param reliable [in] true to send it again until acknowledged
+     * @return false if the peer is unknown or the message cannot be queued
+     */
+    bool sendMessage(const sf::IpAddress& address, unsigned short port,
+                     const sf::Packet& packet, bool reliable);
+
+    /**
+     * @brief Sends the messages queued for each peer, coalesced into
+     *        datagrams, once per frame
+     * @param deltaTime [in] Time elapsed since last update
      */
-    void receiveGamePackets(GameState& state);
+    void flushChannels(float deltaTime);
 
     /**
-     * @brief Processes discovery packets
+     * @brief Sends to each peer its cars and buildings for the current epoch
+     *        of the load balancer
      */
-    void receiveDiscoveryPackets();
+    void distributeWork();
 
     /**
-     * @brief Distributes economy calculations among peers
-     * @param state [in] Current game state to process
+     * @brief Sends to a peer its cars and buildings for the current epoch
+     * @param name [in] Name of the peer
      */
-    void distributeEconomyCalculations(const GameState& state);
+    void sendAssignment(const std::string& name);
 
     /**
-     * @brief Distributes traffic simulation load among peers
-     * @param state [in] Current game state to process
+     * @brief Merges a TRAFFIC_UPDATED or ECONOMY_UPDATED response (host)
+     * @param packet [in] Packet starting with its message type
+     * @param name [in] Name of the sending peer
+     * @param traffic [in] true for TRAFFIC_UPDATED
+     * @param state [inout] Game state to update
      */
-    void distributeTrafficLoad(const GameState& state);
+    void mergeResponse(sf::Packet& packet, const std::string& name, bool traffic, GameState& state);
 
     /**
      * @brief Removes all inactive peers from the peer list
      */
     void removeInactivePeers();
 
+    /**
+     * @brief Sends to each client the members of the network (host)
+     */
+    void sendPeerList();
+
+    /**
+     * @brief Processes a PEER_LIST heartbeat
+     * @details Clients keep the list of their host. Between two hosts, the
+     *          lowest (address, port) wins: the other one and its clients
+     *          follow it.
+     * @param packet [in] Message
+     * @param sender [in] Address and game port of the sender
+     */
+    void processPeerList(const sf::Packet& packet, const NetworkProtocol::Member& sender);
+
+    /**
+     * @brief Elects the next host after the host was lost (client)
+     * @details Every survivor holds the same list of members, received from
+     *          the host, and picks the lowest (address, port) in it: all agree
+     *          without exchanging messages.
+     * @param lost [in] Key of the lost host
+     */
+    void electHost(sf::Uint64 lost);
+
+    /**
+     * @brief Becomes the host of the members of the last PEER_LIST
+     * @details The game state goes on from the last snapshot received, the
+     *          epochs and ticks from the ones of the former host.
+     */
+    void promote();
+
+    /**
+     * @brief Becomes a client of another host
+     * @param host [in] Address and game port of the host
+     */
+    void follow(const NetworkProtocol::Member& host);
+
 private:
 
     //! @brief Information about a peer in the network
@@ -141,18 +259,48 @@ private:
         unsigned short port;   //!< Port number of the peer
         bool is_active;        //!< Whether the peer is currently active
         float last_ping;       //!< Time since last ping received
+        sf::Uint32 acked_tick = 0; //!< Last snapshot acknowledged (0: none)
     };
 
-    //! @brief Main communication socket
-    sf::UdpSocket m_game_socket;
-    //! @brief Discovery broadcast socket
-    sf::UdpSocket m_discovery_socket;
+    //! @brief Key of a peer in m_peer_index
+    static sf::Uint64 peerKey(const sf::IpAddress& address, unsigned short port)
+    {
+        return (sf::Uint64(address.toInteger()) << 16) | port;
+    }
+
+    //! @brief Game and discovery sockets, received on their own thread.
+    //! Rebound when promoted to host, to take the discovery port over.
+    std::unique_ptr<NetworkIO> m_io;
+    //! @brief Packets reused by all the messages sent
+    PacketPool m_packets;
     //! @brief Connected peers
     std::map<std::string, PeerInfo> m_peers;
-    //! @brief Whether the peer list has been updated
-    bool m_peers_updated = true;
+    //! @brief Name of the peer at each (address, port)
+    std::unordered_map<sf::Uint64, std::string> m_peer_index;
+    //! @brief Messages to and from each peer, by (address, port)
+    std::unordered_map<sf::Uint64, ReliableChannel> m_channels;
+    //! @brief Reads the datagrams of unknown senders, reset for each one
+    ReliableChannel m_stranger;
+    //! @brief Messages of the datagram being processed
+    std::vector<PacketPool::Handle> m_messages;
     //! @brief Whether this is a host node
     bool m_is_host;
     //! @brief Time since last ping
     float m_last_ping_sent = 0.0f;
+    //! @brief Number of state synchronizations sent (host)
+    sf::Uint32 m_tick = 0;
+    //! @brief Snapshots sent (host) or received (client) serving as delta bases
+    SnapshotHistory m_snapshots;
+    //! @brief Simulation of the ranges assigned to this node
+    SimulationEngine m_engine;
+    //! @brief Ranges of the peers, by measured speed (host)
+    LoadBalancer m_balancer;
+    //! @brief Epoch of the ranges assigned to this node (client)
+    sf::Uint32 m_epoch = 0;
+    //! @brief Time since the last PEER_LIST sent (host)
+    float m_last_heartbeat = 0.0f;
+    //! @brief Clients of the host, from the last PEER_LIST (client)
+    std::vector<NetworkProtocol::Member> m_members;
+    //! @brief Key of this node in m_members, 0 if unknown
+    sf::Uint64 m_self_key = 0;
 };
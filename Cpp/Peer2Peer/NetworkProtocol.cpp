@@ -1,113 +1,182 @@
 #include "NetworkProtocol.hpp"
-#include "Serialization.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 // ----------------------------------------------------------------------------
-sf::Packet NetworkProtocol::createDiscoveryPacket(unsigned short port)
+void NetworkProtocol::createDiscoveryPacket(sf::Packet& packet, unsigned short port)
 {
-    sf::Packet packet;
+    packet.clear();
     packet << static_cast<sf::Uint8>(DiscoveryMessageType::DISCOVERY);
     packet << port;
-    return packet;
 }
 
 // ----------------------------------------------------------------------------
-sf::Packet NetworkProtocol::createPingPacket(unsigned short port)
+void NetworkProtocol::createPingPacket(sf::Packet& packet, unsigned short port)
 {
-    sf::Packet packet;
+    packet.clear();
     packet << static_cast<sf::Uint8>(DiscoveryMessageType::PING);
     packet << port;
-    return packet;
 }
 
 // ----------------------------------------------------------------------------
-sf::Packet NetworkProtocol::createEconomyCalculationPacket(sf::Uint32 startIdx, sf::Uint32 count)
+void NetworkProtocol::createEconomyCalculationPacket(sf::Packet& packet, sf::Uint32 epoch, sf::Uint32 startIdx, sf::Uint32 count)
 {
-    std::cout << "Creating economy calculation packet startIdx: " << startIdx << " count: " << count << std::endl;
-    sf::Packet packet;
-    packet << static_cast<sf::Uint8>(GameMessageType::ECONOMY_DISTRIBUTION);
-    packet << startIdx;
-    packet << count;
-    return packet;
+    std::cout << "Creating economy calculation packet epoch: " << epoch << " startIdx: " << startIdx << " count: " << count << std::endl;
+    packet.clear();
+    PacketWriter(packet).write(static_cast<sf::Uint8>(GameMessageType::ECONOMY_DISTRIBUTION))
+                        .write(epoch).write(startIdx).write(count);
 }
 
 // ----------------------------------------------------------------------------
-sf::Packet NetworkProtocol::createTrafficCalculationPacket(sf::Uint32 zoneStartIdx, sf::Uint32 zoneCount)
+void NetworkProtocol::createTrafficCalculationPacket(sf::Packet& packet, sf::Uint32 epoch, sf::Uint32 zoneStartIdx, sf::Uint32 zoneCount)
 {
-    std::cout << "Creating traffic calculation packet startIdx: " << zoneStartIdx << " count: " << zoneCount << std::endl;
-    sf::Packet packet;
-    packet << static_cast<sf::Uint8>(GameMessageType::TRAFFIC_DISTRIBUTION);
-    packet << zoneStartIdx;
-    packet << zoneCount;
-    return packet;
+    std::cout << "Creating traffic calculation packet epoch: " << epoch << " startIdx: " << zoneStartIdx << " count: " << zoneCount << std::endl;
+    packet.clear();
+    PacketWriter(packet).write(static_cast<sf::Uint8>(GameMessageType::TRAFFIC_DISTRIBUTION))
+                        .write(epoch).write(zoneStartIdx).write(zoneCount);
 }
 
 // ----------------------------------------------------------------------------
-sf::Packet NetworkProtocol::createStateSyncPacket(const GameState& state)
+void NetworkProtocol::createStateSyncPacket(sf::Packet& packet, const GameState& state)
 {
-    sf::Packet packet;
-    packet << static_cast<sf::Uint8>(GameMessageType::STATE_SYNC);
-    packet << state.traffic << state.economy;
-    return packet;
+    packet.clear();
+    PacketWriter writer(packet);
+    writer.write(static_cast<sf::Uint8>(GameMessageType::STATE_SYNC));
+    writeState(writer, state);
 }
 
 // ----------------------------------------------------------------------------
 void NetworkProtocol::processStateSync(sf::Packet& packet, GameState& state)
 {
-    packet >> state.traffic >> state.economy;
+    PacketReader reader(packet, HEADER_SIZE);
+    if (!readState(reader, state))
+    {
+        std::cerr << "Warning: State sync packet is truncated" << std::endl;
+    }
 }
 
 // ----------------------------------------------------------------------------
-void NetworkProtocol::processTrafficUpdate(sf::Packet& packet, GameState& state)
+bool NetworkProtocol::createStateDeltaPacket(sf::Packet& packet, StateSync::Chunks& chunks)
 {
-    sf::Uint32 startIdx, count;
-    packet >> startIdx >> count;
-    state.traffic.startIdx = startIdx;
-    state.traffic.count = count;
+    packet.clear();
+    if (chunks.done)
+    {
+        return false;
+    }
+    PacketWriter writer(packet);
+    writer.write(static_cast<sf::Uint8>(GameMessageType::STATE_DELTA));
+    return StateSync::encode(writer, chunks);
+}
+
+// ----------------------------------------------------------------------------
+void NetworkProtocol::createStateAckPacket(sf::Packet& packet, sf::Uint32 tick)
+{
+    packet.clear();
+    PacketWriter(packet).write(static_cast<sf::Uint8>(GameMessageType::STATE_ACK))
+                        .write(tick);
+}
 
-    std::cout << "Processing traffic update packet startIdx: " << startIdx << " count: " << count << std::endl;
+// ----------------------------------------------------------------------------
+sf::Uint32 NetworkProtocol::processStateAck(const sf::Packet& packet)
+{
+    PacketReader reader(packet, HEADER_SIZE);
+    sf::Uint32 tick = 0;
+    return reader.read(tick) ? tick : 0;
+}
 
-    // Verify bounds
-    if (startIdx + count > state.traffic.cars.size())
+// ----------------------------------------------------------------------------
+void NetworkProtocol::createPeerListPacket(sf::Packet& packet, const std::vector<Member>& members, sf::Uint32 self)
+{
+    packet.clear();
+    PacketWriter writer(packet);
+    writer.write(static_cast<sf::Uint8>(GameMessageType::PEER_LIST))
+          .write(self).write(static_cast<sf::Uint32>(members.size()));
+    for (const auto& member : members)
     {
-        std::cerr << "Warning: Traffic update packet contains invalid range" << std::endl;
-        return;
+        writer.write(member.address.toInteger()).write(static_cast<sf::Uint16>(member.port));
+    }
+}
+
+// ----------------------------------------------------------------------------
+bool NetworkProtocol::processPeerList(const sf::Packet& packet, std::vector<Member>& members, sf::Uint32& self)
+{
+    constexpr size_t MEMBER_SIZE = sizeof(sf::Uint32) + sizeof(sf::Uint16);
+    PacketReader reader(packet, HEADER_SIZE);
+    sf::Uint32 count = 0;
+    if (!reader.read(self) || !reader.read(count) || (count > reader.getRemaining() / MEMBER_SIZE))
+    {
+        return false;
     }
 
-    // Update car positions
-    for (sf::Uint32 i = 0; i < count; ++i)
+    members.resize(count);
+    for (auto& member : members)
     {
-        packet >> state.traffic.cars[startIdx + i];
-        packet >> state.traffic.roads[startIdx + i];
+        sf::Uint32 address = 0;
+        sf::Uint16 port = 0;
+        reader.read(address);
+        reader.read(port);
+        member.address = sf::IpAddress(address);
+        member.port = port;
     }
+    self = (self < count) ? self : NOT_A_MEMBER;
+    return static_cast<bool>(reader);
 }
 
 // ----------------------------------------------------------------------------
-void NetworkProtocol::processEconomyUpdate(sf::Packet& packet, GameState& state)
+sf::Uint32 NetworkProtocol::processStateDelta(const sf::Packet& packet, SnapshotHistory& history, GameState& state)
 {
-    sf::Uint32 startIdx, count;
-    packet >> startIdx >> count;
-    state.economy.startIdx = startIdx;
-    state.economy.count = count;
+    // Rebuilt in the spare snapshot of the history: no allocation once warm
+    PacketReader reader(packet, HEADER_SIZE);
+    return StateSync::decode(reader, history, state);
+}
+
+// ----------------------------------------------------------------------------
+sf::Uint32 NetworkProtocol::processTrafficUpdate(sf::Packet& packet, GameState& state)
+{
+    PacketReader reader(packet, HEADER_SIZE);
+    sf::Uint32 epoch, startIdx, count;
+    if (!reader.read(epoch) || !reader.read(startIdx) || !reader.read(count))
+    {
+        return 0;
+    }
 
-    std::cout << "Processing economy update packet startIdx: " << startIdx << " count: " << count << std::endl;
+    std::cout << "Processing traffic update packet epoch: " << epoch << " startIdx: " << startIdx << " count: " << count << std::endl;
 
     // Verify bounds
-    if (startIdx + count > state.economy.buildings.size())
+    if (sf::Uint64(startIdx) + count > state.traffic.cars.size())
     {
-        std::cerr << "Warning: Economy update packet contains invalid range" << std::endl;
-        return;
+        std::cerr << "Warning: Traffic update packet contains invalid range" << std::endl;
+        return 0;
+    }
+
+    state.traffic.startIdx = startIdx;
+    state.traffic.count = count;
+    return epoch;
+}
+
+// ----------------------------------------------------------------------------
+sf::Uint32 NetworkProtocol::processEconomyUpdate(sf::Packet& packet, GameState& state)
+{
+    PacketReader reader(packet, HEADER_SIZE);
+    sf::Uint32 epoch, startIdx, count;
+    if (!reader.read(epoch) || !reader.read(startIdx) || !reader.read(count))
+    {
+        return 0;
     }
 
-    // Update building incomes
-    for (sf::Uint32 i = 0; i < count; ++i)
+    std::cout << "Processing economy update packet epoch: " << epoch << " startIdx: " << startIdx << " count: " << count << std::endl;
+
+    // Verify bounds
+    if (sf::Uint64(startIdx) + count > state.economy.buildings.size())
     {
-        packet >> state.economy.buildings[startIdx + i];
+        std::cerr << "Warning: Economy update packet contains invalid range" << std::endl;
+        return 0;
     }
 
-    // Update total money
-    packet >> state.economy.money >> state.economy.tax_rate;
+    state.economy.startIdx = startIdx;
+    state.economy.count = count;
+    return epoch;
 }
 
 // ----------------------------------------------------------------------------
@@ -115,7 +184,8 @@ void NetworkProtocol::processClientStateUpdate(sf::Packet& packet, GameState& st
 {
     // Extract client state from packet
     GameState clientState;
-    packet >> clientState.traffic >> clientState.economy;
+    PacketReader reader(packet, HEADER_SIZE);
+    readState(reader, clientState);
 
     // Merge client state with global state
     // Note: Here we could add a validation or conflict resolution logic
@@ -124,39 +194,62 @@ void NetworkProtocol::processClientStateUpdate(sf::Packet& packet, GameState& st
 }
 
 // ----------------------------------------------------------------------------
-sf::Packet NetworkProtocol::createPlayerStatePacket(const GameState& state, sf::Uint32 startIdx, sf::Uint32 count)
+void NetworkProtocol::createTrafficUpdatedPacket(sf::Packet& packet, const GameState& state, sf::Uint32 epoch, float compute_time)
 {
-    sf::Packet packet;
-    packet << static_cast<sf::Uint8>(GameMessageType::PLAYER_STATE);
-    packet << startIdx << count;
+    const size_t cars = state.traffic.cars.size();
+    const size_t begin = std::min<size_t>(state.traffic.startIdx, cars);
+    const size_t end = std::min<size_t>(begin + state.traffic.count, cars);
+
+    packet.clear();
+    PacketWriter writer(packet);
+    writer.write(static_cast<sf::Uint8>(GameMessageType::TRAFFIC_UPDATED))
+          .write(epoch).write(static_cast<sf::Uint32>(begin))
+          .write(static_cast<sf::Uint32>(end - begin)).write(compute_time);
+    writeCars(writer, state.traffic.cars, begin, end);
+}
 
-    // Send player states for the specified range
-    for (sf::Uint32 i = 0; i < count; ++i)
-    {
-        if (startIdx + i < state.traffic.cars.size())
-        {
-            packet << state.traffic.cars[startIdx + i];
-        }
-    }
-    return packet;
+// ----------------------------------------------------------------------------
+void NetworkProtocol::createEconomyUpdatedPacket(sf::Packet& packet, const GameState& state, sf::Uint32 epoch, float compute_time)
+{
+    const size_t buildings = state.economy.buildings.size();
+    const size_t begin = std::min<size_t>(state.economy.startIdx, buildings);
+    const size_t end = std::min<size_t>(begin + state.economy.count, buildings);
+
+    packet.clear();
+    PacketWriter writer(packet);
+    writer.write(static_cast<sf::Uint8>(GameMessageType::ECONOMY_UPDATED))
+          .write(epoch).write(static_cast<sf::Uint32>(begin))
+          .write(static_cast<sf::Uint32>(end - begin)).write(compute_time);
+    writeBuildings(writer, state.economy.buildings, begin, end);
 }
 
 // ----------------------------------------------------------------------------
-void NetworkProtocol::processPlayerStateUpdate(sf::Packet& packet, GameState& state)
+bool NetworkProtocol::processRangeUpdate(PacketReader& reader, RangeUpdate& update)
 {
-    sf::Uint32 startIdx, count;
-    packet >> startIdx >> count;
+    return reader.read(update.epoch) && reader.read(update.range.startIdx) &&
+           reader.read(update.range.count) && reader.read(update.compute_time);
+}
 
-    // Verify bounds
-    if (startIdx + count > state.players.size())
+// ----------------------------------------------------------------------------
+bool NetworkProtocol::processTrafficUpdated(PacketReader& reader, const GameManager::Range& range, GameState& state)
+{
+    if (sf::Uint64(range.startIdx) + range.count > state.traffic.cars.size())
     {
-        std::cerr << "Warning: Player state update packet contains invalid range" << std::endl;
-        return;
+        std::cerr << "Warning: Traffic updated packet contains invalid range" << std::endl;
+        return false;
     }
 
-    // Update player states
-    for (sf::Uint32 i = 0; i < count; ++i)
+    return readCars(reader, state.traffic.cars, range.startIdx, range.count);
+}
+
+// ----------------------------------------------------------------------------
+bool NetworkProtocol::processEconomyUpdated(PacketReader& reader, const GameManager::Range& range, GameState& state)
+{
+    if (sf::Uint64(range.startIdx) + range.count > state.economy.buildings.size())
     {
-        packet >> state.players[startIdx + i];
+        std::cerr << "Warning: Economy updated packet contains invalid range" << std::endl;
+        return false;
     }
-}
\ No newline at end of file
+
+    return readBuildings(reader, state.economy.buildings, range.startIdx, range.count);
+}
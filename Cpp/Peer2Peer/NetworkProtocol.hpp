@@ -1,6 +1,9 @@
 #pragma once
 #include <SFML/Network.hpp>
+#include "GameManager.hpp"
 #include "GameState.hpp"
+#include "Serialization.hpp"
+#include "StateSync.hpp"
 #include <iostream>
 
 /**
@@ -19,65 +22,113 @@ enum class DiscoveryMessageType : sf::Uint8
  */
 enum class GameMessageType : sf::Uint8
 {
-    // Host->Client: Request traffic calculation for a subset of cars.
-    // Client->Host: Response with updated car positions.
+    // Host->Client: Request traffic calculation for a subset of cars, for an
+    // epoch of the load balancing.
     TRAFFIC_DISTRIBUTION = 0,
-    // Host->Client: Request economic calculation for a subset of buildings.
-    // Client->Host: Response with updated building incomes.
+    // Host->Client: Request economic calculation for a subset of buildings,
+    // for an epoch of the load balancing.
     ECONOMY_DISTRIBUTION,
     // Host->All Clients: Full game state broadcast.
     // Sent periodically to ensure all clients are synchronized
     STATE_SYNC,
-    // Client->Host: Response to TRAFFIC_DISTRIBUTION with updated player states
+    // Client->Host: Response to TRAFFIC_DISTRIBUTION with the updated cars
+    // and the time spent on them
     TRAFFIC_UPDATED,
-    // Client->Host: Response to ECONOMY_DISTRIBUTION with updated player states
+    // Client->Host: Response to ECONOMY_DISTRIBUTION with the updated
+    // buildings
     ECONOMY_UPDATED,
+    // Host->Client: Entities changed since the last snapshot acknowledged by
+    // the client, or a keyframe.
+    STATE_DELTA,
+    // Client->Host: Acknowledges a STATE_DELTA snapshot, which becomes the
+    // base of the next deltas sent to this client.
+    STATE_ACK,
+    // Host->Client: Members of the network, sent as a heartbeat. The clients
+    // elect the next host from it when the host is lost.
+    PEER_LIST,
 };
 
 /**
  * @brief Handles network protocol serialization and deserialization.
+ * @details Packets are written into a packet given by the caller, usually
+ *          taken from a PacketPool, after clearing it. Game messages have a
+ *          fixed little-endian layout (see PacketWriter), read in place into
+ *          the game state; STATE_DELTA adds variable-length integers for
+ *          counts and indices (see StateSync).
  */
 class NetworkProtocol
 {
 public:
+
+    //! @brief Bytes before the content of a message: its type
+    static constexpr size_t HEADER_SIZE = sizeof(sf::Uint8);
+
+    /**
+     * @brief Header of TRAFFIC_UPDATED and ECONOMY_UPDATED.
+     */
+    struct RangeUpdate
+    {
+        //! @brief Epoch of the assignment the client worked on
+        sf::Uint32 epoch = 0;
+        //! @brief Cars or buildings updated
+        GameManager::Range range{0, 0};
+        //! @brief Seconds the client spent on the cars of a simulation step
+        float compute_time = 0.0f;
+    };
+
+    /**
+     * @brief Member of the network, as seen by the host.
+     */
+    struct Member
+    {
+        //! @brief Address of the member
+        sf::IpAddress address;
+        //! @brief Game port of the member
+        unsigned short port = 0;
+    };
+
+    //! @brief Index of the receiver in a PEER_LIST when it is not a member
+    static constexpr sf::Uint32 NOT_A_MEMBER = 0xFFFFFFFF;
     /**
      * @brief Creates a discovery broadcast packet.
      * @details Sent by host every PING_INTERVAL to broadcast its presence.
      *          Contains host's port number for direct communication.
+     * @param[out] packet Packet to write, cleared first.
      * @param[in] port Host's listening port.
-     * @return Packet ready to be broadcast.
      */
-    static sf::Packet createDiscoveryPacket(unsigned short port);
+    static void createDiscoveryPacket(sf::Packet& packet, unsigned short port);
 
     /**
      * @brief Creates a ping packet
      * @details Used in two scenarios:
      *          1. By connected clients to maintain connection with host
      *          2. By unconnected clients broadcasting to discovery port
+     * @param[out] packet Packet to write, cleared first.
      * @param[in] port Client's listening port.
-     * @return Ping packet
      */
-    static sf::Packet createPingPacket(unsigned short port);
+    static void createPingPacket(sf::Packet& packet, unsigned short port);
 
     /**
      * @brief Creates an economy calculation request.
      * @details Host divides economic calculations among connected clients.
      *          Each client processes a subset of buildings.
+     * @param[out] packet Packet to write, cleared first.
+     * @param[in] epoch Epoch of the assignment.
      * @param[in] startIdx First building index to process.
      * @param[in] count Number of buildings to process.
-     * @return Packet containing calculation request.
      */
-    static sf::Packet createEconomyCalculationPacket(sf::Uint32 startIdx, sf::Uint32 count);
+    static void createEconomyCalculationPacket(sf::Packet& packet, sf::Uint32 epoch, sf::Uint32 startIdx, sf::Uint32 count);
 
     /**
      * @brief Creates a traffic calculation request.
      * @details Host divides traffic simulation among connected clients.
      *          Each client processes movement for a subset of cars.
+     * @param[out] packet Packet to write, cleared first.
+     * @param[in] epoch Epoch of the assignment.
      * @param[in] startIdx First car index to process.
      * @param[in] count Number of cars to process.
-     * @return Packet containing calculation request.
      */
-    static sf::Packet createTrafficCalculationPacket(sf::Uint32 startIdx, sf::Uint32 count);
+    static void createTrafficCalculationPacket(sf::Packet& packet, sf::Uint32 epoch, sf::Uint32 startIdx, sf::Uint32 count);
 
     /**
      * @brief Creates a full state synchronization packet.
@@ -86,10 +137,67 @@ public:
      *          Contains:
      *          - All car positions and speeds.
      *          - Current money amount.
+     * @param[out] packet Packet to write, cleared first.
      * @param[in] state Current game state to broadcast.
-     * @return Packet containing complete game state.
      */
-    static sf::Packet createStateSyncPacket(const GameState& state);
+    static void createStateSyncPacket(sf::Packet& packet, const GameState& state);
+
+    /**
+     * @brief Creates the next chunk of a delta state synchronization.
+     * @details Contains the entities of a range of the snapshot that changed
+     *          since the base snapshot, with quantized positions, in at most
+     *          StateSync::CHUNK_SIZE bytes. See StateSync.
+     * @param[out] packet Packet to write, cleared first.
+     * @param[inout] chunks Delta to send, moved to its next chunk.
+     * @return false, the packet being left empty, once all the chunks are
+     *         written.
+     */
+    static bool createStateDeltaPacket(sf::Packet& packet, StateSync::Chunks& chunks);
+
+    /**
+     * @brief Creates the acknowledgement of a delta state synchronization.
+     * @param[out] packet Packet to write, cleared first.
+     * @param[in] tick Tick of the received snapshot.
+     */
+    static void createStateAckPacket(sf::Packet& packet, sf::Uint32 tick);
+
+    /**
+     * @brief Processes the acknowledgement of a delta state synchronization.
+     * @param[in] packet Packet containing the acknowledgement.
+     * @return The acknowledged tick, or 0 if the packet is malformed.
+     */
+    static sf::Uint32 processStateAck(const sf::Packet& packet);
+
+    /**
+     * @brief Creates the list of the members of the network.
+     * @param[out] packet Packet to write, cleared first.
+     * @param[in] members Clients of the host.
+     * @param[in] self Index of the receiver in members, or NOT_A_MEMBER.
+     */
+    static void createPeerListPacket(sf::Packet& packet, const std::vector<Member>& members, sf::Uint32 self);
+
+    /**
+     * @brief Processes the list of the members of the network.
+     * @param[in] packet Packet containing the list.
+     * @param[out] members Clients of the host.
+     * @param[out] self Index of this node in members, or NOT_A_MEMBER.
+     * @return false if the packet is malformed.
+     */
+    static bool processPeerList(const sf::Packet& packet, std::vector<Member>& members, sf::Uint32& self);
+
+    /**
+     * @brief Processes a chunk of a delta state synchronization packet.
+     * @details The entities of the chunk are written to the game state at
+     *          once. See StateSync::decode().
+     * @param[in] packet Packet containing the chunk.
+     * @param[inout] history Snapshots already received, and the snapshot
+     *               being rebuilt. The new snapshot is added once complete.
+     * @param[in] state Game state to update.
+     * @return The tick of the new snapshot to acknowledge once its last chunk
+     *         is read, else 0 (chunks missing, unknown base or malformed
+     *         chunk).
+     */
+    static sf::Uint32 processStateDelta(const sf::Packet& packet, SnapshotHistory& history, GameState& state);
 
     /**
      * @brief Processes a state synchronization packet.
@@ -99,18 +207,22 @@ public:
     static void processStateSync(sf::Packet& packet, GameState& state);
 
     /**
-     * @brief Processes a traffic update packet.
-     * @param[in] packet Packet containing the traffic update.
+     * @brief Processes a traffic calculation request.
+     * @details Sets the range of cars simulated by this client.
+     * @param[in] packet Packet containing the request.
      * @param[in] state Game state to update.
+     * @return The epoch of the assignment, or 0 if the range is invalid.
      */
-    static void processTrafficUpdate(sf::Packet& packet, GameState& state);
+    static sf::Uint32 processTrafficUpdate(sf::Packet& packet, GameState& state);
 
     /**
-     * @brief Processes an economy update packet.
-     * @param[in] packet Packet containing the economy update.
+     * @brief Processes an economy calculation request.
+     * @details Sets the range of buildings simulated by this client.
+     * @param[in] packet Packet containing the request.
      * @param[in] state Game state to update.
+     * @return The epoch of the assignment, or 0 if the range is invalid.
      */
-    static void processEconomyUpdate(sf::Packet& packet, GameState& state);
+    static sf::Uint32 processEconomyUpdate(sf::Packet& packet, GameState& state);
 
     /**
      * @brief Processes a client state update packet.
@@ -120,20 +232,51 @@ public:
     static void processClientStateUpdate(sf::Packet& packet, GameState& state);
 
     /**
-     * @brief Creates a player state update packet.
-     * @details Host divides player state updates among connected clients.
-     *          Each client processes a subset of players.
-     * @param[in] state Current game state containing player information.
-     * @param[in] startIdx First player index to process.
-     * @param[in] count Number of players to process.
-     * @return Packet containing player state update request.
+     * @brief Creates the response to a traffic calculation request.
+     * @param[out] packet Packet to write, cleared first.
+     * @param[in] state Game state holding the cars of the client range.
+     * @param[in] epoch Epoch of the assignment.
+     * @param[in] compute_time Seconds spent on the cars of the last simulation step.
+     */
+    static void createTrafficUpdatedPacket(sf::Packet& packet, const GameState& state, sf::Uint32 epoch, float compute_time);
+
+    /**
+     * @brief Creates the response to an economy calculation request.
+     * @param[out] packet Packet to write, cleared first.
+     * @param[in] state Game state holding the buildings of the client range.
+     * @param[in] epoch Epoch of the assignment.
+     * @param[in] compute_time Seconds spent on the cars of the last simulation step.
+     */
+    static void createEconomyUpdatedPacket(sf::Packet& packet, const GameState& state, sf::Uint32 epoch, float compute_time);
+
+    /**
+     * @brief Reads the header of a TRAFFIC_UPDATED or ECONOMY_UPDATED packet.
+     * @details The host decides from the header whether the content is
+     *          merged, read by the same reader.
+     * @param[inout] reader Reader of the response, after the message type.
+     * @param[out] update Epoch, range and compute time of the response.
+     * @return false if the packet is malformed.
+     */
+    static bool processRangeUpdate(PacketReader& reader, RangeUpdate& update);
+
+    /**
+     * @brief Merges the cars of a TRAFFIC_UPDATED packet, after its header.
+     * @details The cars are copied from the packet straight into their
+     *          arrays; nothing is merged if the packet is truncated.
+     * @param[inout] reader Reader of the response, after its header.
+     * @param[in] range Range read in the header.
+     * @param[in] state Game state to update.
+     * @return false if the range is invalid or the packet is malformed.
      */
-    static sf::Packet createPlayerStatePacket(const GameState& state, sf::Uint32 startIdx, sf::Uint32 count);
+    static bool processTrafficUpdated(PacketReader& reader, const GameManager::Range& range, GameState& state);
 
     /**
-     * @brief Processes a player state update packet.
-     * @param[in] packet Packet containing the player state update.
+     * @brief Merges the buildings of an ECONOMY_UPDATED packet, after its
+     *        header.
+     * @param[inout] reader Reader of the response, after its header.
+     * @param[in] range Range read in the header.
      * @param[in] state Game state to update.
+     * @return false if the range is invalid or the packet is malformed.
      */
-    static void processPlayerStateUpdate(sf::Packet& packet, GameState& state);
+    static bool processEconomyUpdated(PacketReader& reader, const GameManager::Range& range, GameState& state);
 };
@@ -0,0 +1,27 @@
+#include "PacketPool.hpp"
+
+// ----------------------------------------------------------------------------
+PacketPool::Handle PacketPool::acquire()
+{
+    if (m_free.empty())
+    {
+        return Handle(*this, std::make_unique<sf::Packet>());
+    }
+
+    std::unique_ptr<sf::Packet> packet = std::move(m_free.back());
+    m_free.pop_back();
+    packet->clear(); // Keeps the capacity
+    return Handle(*this, std::move(packet));
+}
+
+// ----------------------------------------------------------------------------
+size_t PacketPool::getFreeCount() const
+{
+    return m_free.size();
+}
+
+// ----------------------------------------------------------------------------
+void PacketPool::release(std::unique_ptr<sf::Packet> packet)
+{
+    m_free.push_back(std::move(packet));
+}
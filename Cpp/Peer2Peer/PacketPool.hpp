@@ -0,0 +1,71 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Packets reused from one message to the next.
+ * @details A packet keeps the capacity of the largest message it held, so
+ *          once the pool is warm, encoding a message does not allocate.
+ *          acquire() gives a cleared packet that goes back to the pool when
+ *          its handle is destroyed. Not thread safe: one pool per thread.
+ */
+class PacketPool
+{
+public:
+
+    /**
+     * @brief Packet borrowed from the pool, given back on destruction.
+     */
+    class Handle
+    {
+    public:
+
+        Handle(PacketPool& pool, std::unique_ptr<sf::Packet> packet)
+            : m_pool(&pool), m_packet(std::move(packet))
+        {}
+
+        Handle(Handle&&) = default;
+        Handle& operator=(Handle&&) = delete;
+
+        ~Handle()
+        {
+            if (m_packet != nullptr)
+            {
+                m_pool->release(std::move(m_packet));
+            }
+        }
+
+        sf::Packet& operator*() const { return *m_packet; }
+        sf::Packet* operator->() const { return m_packet.get(); }
+
+    private:
+
+        //! @brief Pool to give the packet back to
+        PacketPool* m_pool;
+        //! @brief Borrowed packet
+        std::unique_ptr<sf::Packet> m_packet;
+    };
+
+    /**
+     * @brief Borrows a packet.
+     * @return An empty packet, allocated only if none is free.
+     */
+    Handle acquire();
+
+    /**
+     * @brief Gets the number of packets waiting in the pool.
+     * @return Number of free packets.
+     */
+    size_t getFreeCount() const;
+
+private:
+
+    //! @brief Gives a packet back to the pool
+    void release(std::unique_ptr<sf::Packet> packet);
+
+private:
+
+    //! @brief Free packets, with their capacity
+    std::vector<std::unique_ptr<sf::Packet>> m_free;
+};
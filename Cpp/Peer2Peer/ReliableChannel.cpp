@@ -0,0 +1,315 @@
+#include "ReliableChannel.hpp"
+#include "NetworkIO.hpp"
+#include <algorithm>
+#include <random>
+
+// ----------------------------------------------------------------------------
+//! @brief Compares sequence numbers that wrap around
+static bool isNewer(sf::Uint16 a, sf::Uint16 b)
+{
+    const sf::Uint16 distance = static_cast<sf::Uint16>(a - b);
+    return (distance != 0) && (distance < 0x8000);
+}
+
+// ----------------------------------------------------------------------------
+ReliableChannel::ReliableChannel(PacketPool& pool)
+    : m_pool(pool), m_session(std::random_device{}()), m_sent(SENT_WINDOW)
+{}
+
+// ----------------------------------------------------------------------------
+bool ReliableChannel::send(const sf::Packet& message, bool reliable)
+{
+    if (message.getDataSize() > MAX_MESSAGE_SIZE)
+    {
+        return false;
+    }
+    if (!reliable)
+    {
+        m_unreliable.push_back(copy(message.getData(), message.getDataSize()));
+        return true;
+    }
+    if (m_pending.size() >= MAX_PENDING)
+    {
+        return false;
+    }
+    m_pending.push_back({m_next_id++, copy(message.getData(), message.getDataSize()), -1.0f, false});
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+size_t ReliableChannel::flush(float deltaTime, NetworkIO& io, const sf::IpAddress& address, unsigned short port)
+{
+    m_time += deltaTime;
+    const float timeout = std::max(MIN_RESEND_TIMEOUT, 2.0f * m_round_trip);
+    size_t count = 0;
+    auto datagram = m_pool.acquire();
+    Sent* sent = nullptr;
+
+    auto transmit = [&]()
+    {
+        io.send(*datagram, address, port);
+        datagram->clear();
+        sent = nullptr;
+        ++count;
+    };
+    auto append = [&](const sf::Packet& message, bool reliable, sf::Uint16 id)
+    {
+        // A message larger than the MTU goes alone in its datagram
+        const size_t size = MESSAGE_HEADER_SIZE + message.getDataSize();
+        if ((sent != nullptr) && (datagram->getDataSize() + size > MTU))
+        {
+            transmit();
+        }
+        if (sent == nullptr)
+        {
+            sent = &beginDatagram(*datagram);
+        }
+        PacketWriter(*datagram).write(static_cast<sf::Uint8>(reliable ? 1 : 0)).write(id)
+                               .write(static_cast<sf::Uint16>(message.getDataSize()));
+        datagram->append(message.getData(), message.getDataSize());
+        if (reliable)
+        {
+            sent->reliable.push_back(id);
+        }
+    };
+
+    // Reliable messages first, new or not acknowledged in time: only them,
+    // not the whole datagram they were lost with
+    for (auto& pending : m_pending)
+    {
+        if (pending.acked || ((pending.sent_time >= 0.0f) && (m_time - pending.sent_time < timeout)))
+        {
+            continue;
+        }
+        m_resent_count += (pending.sent_time >= 0.0f) ? 1u : 0u;
+        pending.sent_time = m_time;
+        append(*pending.message, true, pending.id);
+    }
+    for (const auto& message : m_unreliable)
+    {
+        append(*message, false, 0);
+    }
+    m_unreliable.clear();
+
+    // Acks only, so that a peer sending more than it receives is acknowledged
+    if ((sent == nullptr) && m_ack_owed)
+    {
+        sent = &beginDatagram(*datagram);
+    }
+    if (sent != nullptr)
+    {
+        transmit();
+    }
+    m_sent_count += count;
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+bool ReliableChannel::receive(const sf::Packet& datagram, std::vector<PacketPool::Handle>& messages)
+{
+    PacketReader reader(datagram);
+    if (!receiveHeader(reader))
+    {
+        return false;
+    }
+
+    while (reader.getRemaining() > 0)
+    {
+        sf::Uint8 reliable = 0;
+        sf::Uint16 id = 0, size = 0;
+        reader.read(reliable);
+        reader.read(id);
+        reader.read(size);
+        const char* data = reader.readBytes(size);
+        if (data == nullptr)
+        {
+            return false;
+        }
+        if (reliable == 0)
+        {
+            messages.push_back(copy(data, size));
+            continue;
+        }
+
+        // In order: the expected message and the ones received before it,
+        // or held until the missing ones are sent again
+        const sf::Uint16 ahead = static_cast<sf::Uint16>(id - m_expected_id);
+        if (ahead == 0)
+        {
+            messages.push_back(copy(data, size));
+            ++m_expected_id;
+            for (auto it = m_early.find(m_expected_id); it != m_early.end(); it = m_early.find(m_expected_id))
+            {
+                messages.push_back(std::move(it->second));
+                m_early.erase(it);
+                ++m_expected_id;
+            }
+        }
+        else if ((ahead < RECEIVE_WINDOW) && (m_early.find(id) == m_early.end()))
+        {
+            m_early.emplace(id, copy(data, size));
+        }
+        // Else delivered already
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool ReliableChannel::receiveHeader(PacketReader& reader)
+{
+    sf::Uint32 session = 0, ack_bits = 0;
+    sf::Uint16 sequence = 0, ack = 0;
+    reader.read(session);
+    reader.read(sequence);
+    reader.read(ack);
+    reader.read(ack_bits);
+    if (!reader)
+    {
+        return false;
+    }
+
+    // Sequence numbers received, acknowledged by the next datagrams sent
+    if (m_connected && (session != m_remote_session))
+    {
+        reset(); // The peer restarted
+    }
+    if (!m_connected)
+    {
+        m_connected = true;
+        m_remote_session = session;
+        m_remote_sequence = sequence;
+        m_ack_bits = 0;
+    }
+    else if (isNewer(sequence, m_remote_sequence))
+    {
+        const sf::Uint16 shift = static_cast<sf::Uint16>(sequence - m_remote_sequence);
+        m_ack_bits = (shift <= 32)
+            ? static_cast<sf::Uint32>(((sf::Uint64(m_ack_bits) << 1) | 1u) << (shift - 1)) : 0u;
+        m_remote_sequence = sequence;
+    }
+    else
+    {
+        // Duplicate, or too old to be acknowledged: the peer sends its
+        // reliable messages again
+        const sf::Uint16 distance = static_cast<sf::Uint16>(m_remote_sequence - sequence);
+        const sf::Uint32 bit = (distance - 1u < 32u) ? (1u << (distance - 1u)) : 0u;
+        if ((bit == 0) || ((m_ack_bits & bit) != 0))
+        {
+            return false;
+        }
+        m_ack_bits |= bit;
+    }
+    m_ack_owed = true;
+
+    // Datagrams of ours received by the peer
+    acknowledge(ack);
+    for (sf::Uint16 i = 0; i < 32; ++i)
+    {
+        if ((ack_bits >> i) & 1u)
+        {
+            acknowledge(static_cast<sf::Uint16>(ack - 1 - i));
+        }
+    }
+    while (!m_pending.empty() && m_pending.front().acked)
+    {
+        m_pending.pop_front();
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+void ReliableChannel::acknowledge(sf::Uint16 sequence)
+{
+    Sent& sent = m_sent[sequence % SENT_WINDOW];
+    if (!sent.waiting || (sent.sequence != sequence))
+    {
+        return;
+    }
+    sent.waiting = false;
+
+    const float measure = std::max(m_time - sent.time, 1e-6f);
+    m_round_trip = (m_round_trip <= 0.0f) ? measure : m_round_trip + SMOOTHING * (measure - m_round_trip);
+
+    // Pending messages are sorted by number, from the oldest not acknowledged
+    for (sf::Uint16 id : sent.reliable)
+    {
+        const size_t index = static_cast<sf::Uint16>(id - (m_pending.empty() ? id : m_pending.front().id));
+        if (index < m_pending.size())
+        {
+            m_pending[index].acked = true;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+ReliableChannel::Sent& ReliableChannel::beginDatagram(sf::Packet& datagram)
+{
+    Sent& sent = m_sent[m_sequence % SENT_WINDOW];
+    sent.sequence = m_sequence;
+    sent.time = m_time;
+    sent.waiting = true;
+    sent.reliable.clear();
+
+    PacketWriter(datagram).write(m_session).write(m_sequence)
+                          .write(m_remote_sequence).write(m_connected ? m_ack_bits : 0u);
+    ++m_sequence;
+    m_ack_owed = false;
+    return sent;
+}
+
+// ----------------------------------------------------------------------------
+PacketPool::Handle ReliableChannel::copy(const void* data, size_t size)
+{
+    auto packet = m_pool.acquire();
+    packet->append(data, size);
+    return packet;
+}
+
+// ----------------------------------------------------------------------------
+void ReliableChannel::reset()
+{
+    m_round_trip = 0.0f;
+    m_sequence = 1;
+    for (auto& sent : m_sent)
+    {
+        sent.waiting = false;
+    }
+    m_next_id = 0;
+    for (auto& pending : m_pending)
+    {
+        pending.id = m_next_id++;
+        pending.sent_time = -1.0f;
+        pending.acked = false;
+    }
+
+    m_connected = false;
+    m_remote_sequence = 0;
+    m_ack_bits = 0;
+    m_ack_owed = false;
+    m_expected_id = 0;
+    m_early.clear();
+}
+
+// ----------------------------------------------------------------------------
+float ReliableChannel::getRoundTripTime() const
+{
+    return m_round_trip;
+}
+
+// ----------------------------------------------------------------------------
+sf::Uint64 ReliableChannel::getSentCount() const
+{
+    return m_sent_count;
+}
+
+// ----------------------------------------------------------------------------
+sf::Uint64 ReliableChannel::getResentCount() const
+{
+    return m_resent_count;
+}
+
+// ----------------------------------------------------------------------------
+size_t ReliableChannel::getPendingCount() const
+{
+    return m_pending.size();
+}
@@ -0,0 +1,220 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include "PacketPool.hpp"
+#include "Serialization.hpp"
+#include <deque>
+#include <map>
+#include <vector>
+
+class NetworkIO;
+
+/**
+ * @brief Batched, and optionally reliable and ordered, messages to a peer
+ *        over UDP.
+ * @details Messages given to send() wait for flush(), called once per frame,
+ *          which coalesces them into datagrams of at most MTU bytes (a larger
+ *          message goes alone in its own datagram). Each datagram has a
+ *          sequence number and acknowledges the datagrams received from the
+ *          peer: the latest sequence number plus a bitfield of the 32 before
+ *          it, so an ack lost with its datagram is repeated by the next ones.
+ *
+ *          Reliable messages are numbered. A reliable message whose datagram
+ *          is not acknowledged in time is sent again in a later datagram, on
+ *          its own: the other messages of the lost datagram are not. The
+ *          receiver delivers reliable messages once and in order, holding
+ *          the ones received early. Unreliable messages are sent once and
+ *          delivered as they arrive, for data superseded every tick.
+ *
+ *          Layout of a datagram (little-endian):
+ *          - u32 session, drawn at random by the sender channel
+ *          - u16 sequence, u16 ack, u32 ack bits
+ *          - per message: u8 reliable, u16 id, u16 size, then the message
+ *
+ *          A new session means the peer restarted its channel: both
+ *          directions start over, and the reliable messages not acknowledged
+ *          are numbered and sent again.
+ */
+class ReliableChannel
+{
+public:
+
+    //! @brief Maximum size of a datagram holding several messages
+    static constexpr size_t MTU = 1200;
+    //! @brief Bytes before the first message of a datagram
+    static constexpr size_t HEADER_SIZE = 2 * sizeof(sf::Uint32) + 2 * sizeof(sf::Uint16);
+    //! @brief Bytes before each message
+    static constexpr size_t MESSAGE_HEADER_SIZE = sizeof(sf::Uint8) + 2 * sizeof(sf::Uint16);
+    //! @brief Largest message, alone in a UDP datagram
+    static constexpr size_t MAX_MESSAGE_SIZE = 65507 - HEADER_SIZE - MESSAGE_HEADER_SIZE;
+    //! @brief Reliable messages not acknowledged yet, beyond which send()
+    //! refuses new ones
+    static constexpr size_t MAX_PENDING = 1024;
+    //! @brief Seconds before sending a reliable message again, at least
+    //! (twice the round trip otherwise)
+    static constexpr float MIN_RESEND_TIMEOUT = 0.03f;
+    //! @brief Weight of a new round trip measure
+    static constexpr float SMOOTHING = 0.25f;
+
+    /**
+     * @brief Creates a channel with a new session.
+     * @param[in] pool Packets holding the messages, which must outlive the
+     *            channel.
+     */
+    explicit ReliableChannel(PacketPool& pool);
+
+    ReliableChannel(const ReliableChannel&) = delete;
+    ReliableChannel& operator=(const ReliableChannel&) = delete;
+
+    /**
+     * @brief Queues a message until the next flush().
+     * @param[in] message Message starting with its type, copied.
+     * @param[in] reliable true to send it again until acknowledged.
+     * @return false if the message is too large, or too many reliable
+     *         messages are not acknowledged.
+     */
+    bool send(const sf::Packet& message, bool reliable);
+
+    /**
+     * @brief Sends the queued messages and the reliable messages to send
+     *        again, coalesced into datagrams.
+     * @details A datagram with acks only is sent if datagrams were received
+     *          since the last one sent and nothing else is to be sent.
+     * @param[in] deltaTime Seconds since the last flush.
+     * @param[in] io Socket to send from.
+     * @param[in] address Address of the peer.
+     * @param[in] port Game port of the peer.
+     * @return Number of datagrams sent.
+     */
+    size_t flush(float deltaTime, NetworkIO& io, const sf::IpAddress& address, unsigned short port);
+
+    /**
+     * @brief Reads a received datagram.
+     * @param[in] datagram Datagram sent by the channel of the peer.
+     * @param[inout] messages Messages to process, in order, appended as
+     *               packets of the pool starting with their type.
+     * @return false if the datagram is malformed, a duplicate, or too old
+     *         for its acks to be tracked.
+     */
+    bool receive(const sf::Packet& datagram, std::vector<PacketPool::Handle>& messages);
+
+    /**
+     * @brief Starts over as after a restart of the peer, keeping the
+     *        session: the reliable messages not acknowledged are numbered
+     *        and sent again.
+     */
+    void reset();
+
+    /**
+     * @brief Gets the smoothed round trip of the datagrams.
+     * @return Seconds, 0 until the first ack.
+     */
+    float getRoundTripTime() const;
+
+    /**
+     * @brief Gets the number of datagrams sent.
+     * @return Number of datagrams.
+     */
+    sf::Uint64 getSentCount() const;
+
+    /**
+     * @brief Gets the number of reliable messages sent again.
+     * @return Number of messages.
+     */
+    sf::Uint64 getResentCount() const;
+
+    /**
+     * @brief Gets the number of reliable messages not acknowledged yet.
+     * @return Number of messages.
+     */
+    size_t getPendingCount() const;
+
+private:
+
+    //! @brief Reliable message waiting for its ack
+    struct Pending
+    {
+        //! @brief Number of the message
+        sf::Uint16 id;
+        //! @brief Copy of the message
+        PacketPool::Handle message;
+        //! @brief Time of the last send, negative if never sent
+        float sent_time;
+        //! @brief Set by the ack of a datagram holding it
+        bool acked;
+    };
+
+    //! @brief Datagram sent, waiting for its ack
+    struct Sent
+    {
+        //! @brief Sequence number of the datagram
+        sf::Uint16 sequence = 0;
+        //! @brief Time of the send
+        float time = 0.0f;
+        //! @brief False for a free slot or once acknowledged
+        bool waiting = false;
+        //! @brief Reliable messages in the datagram
+        std::vector<sf::Uint16> reliable;
+    };
+
+    //! @brief Writes the header of a new datagram and records it
+    Sent& beginDatagram(sf::Packet& datagram);
+
+    //! @brief Reads the header of a received datagram, updating the acks
+    //! in both directions
+    bool receiveHeader(PacketReader& reader);
+
+    //! @brief Handles the ack of a datagram sent
+    void acknowledge(sf::Uint16 sequence);
+
+    //! @brief Copies a message into a packet of the pool
+    PacketPool::Handle copy(const void* data, size_t size);
+
+private:
+
+    //! @brief Number of datagrams remembered for their acks
+    static constexpr size_t SENT_WINDOW = 256;
+    //! @brief Reliable messages received early, at most, beyond which they
+    //! are dropped (and sent again by the peer)
+    static constexpr size_t RECEIVE_WINDOW = 1024;
+
+    //! @brief Packets of the messages
+    PacketPool& m_pool;
+    //! @brief Session of this channel
+    sf::Uint32 m_session;
+    //! @brief Time, advanced by flush()
+    float m_time = 0.0f;
+    //! @brief Smoothed round trip, 0 until the first ack
+    float m_round_trip = 0.0f;
+
+    //! @brief Sequence number of the next datagram sent, from 1: a peer
+    //! that received nothing yet acknowledges 0
+    sf::Uint16 m_sequence = 1;
+    //! @brief Number of the next reliable message sent
+    sf::Uint16 m_next_id = 0;
+    //! @brief Unreliable messages of the next flush
+    std::vector<PacketPool::Handle> m_unreliable;
+    //! @brief Reliable messages not acknowledged, by number
+    std::deque<Pending> m_pending;
+    //! @brief Datagrams sent, by sequence number modulo SENT_WINDOW
+    std::vector<Sent> m_sent;
+
+    //! @brief True once a datagram of the peer was received
+    bool m_connected = false;
+    //! @brief Session of the peer
+    sf::Uint32 m_remote_session = 0;
+    //! @brief Latest sequence number received
+    sf::Uint16 m_remote_sequence = 0;
+    //! @brief Bit i set if m_remote_sequence - 1 - i was received
+    sf::Uint32 m_ack_bits = 0;
+    //! @brief True if datagrams were received since the last one sent
+    bool m_ack_owed = false;
+    //! @brief Number of the next reliable message to deliver
+    sf::Uint16 m_expected_id = 0;
+    //! @brief Reliable messages received before the expected one
+    std::map<sf::Uint16, PacketPool::Handle> m_early;
+
+    //! @brief Number of datagrams sent
+    sf::Uint64 m_sent_count = 0;
+    //! @brief Number of reliable messages sent again
+    sf::Uint64 m_resent_count = 0;
+};
@@ -0,0 +1,187 @@
+#include "RoadNetwork.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <queue>
+
+// ----------------------------------------------------------------------------
+static float distance(sf::Vector2f a, sf::Vector2f b)
+{
+    const sf::Vector2f d = b - a;
+    return std::sqrt(d.x * d.x + d.y * d.y);
+}
+
+// ----------------------------------------------------------------------------
+void RoadNetwork::rebuild(const GameState& state)
+{
+    const auto& buildings = state.economy.buildings;
+    const auto& roads = state.traffic.roads;
+    const int count = static_cast<int>(buildings.size());
+
+    m_road_count = roads.size();
+    m_positions.resize(buildings.size());
+    for (size_t i = 0; i < buildings.size(); ++i)
+    {
+        m_positions[i] = buildings[i].position;
+    }
+
+    // Count the neighbors of each building, then fill them (two-way roads)
+    auto valid = [count](const GameState::Road& road)
+    {
+        return road.building1_idx >= 0 && road.building1_idx < count &&
+               road.building2_idx >= 0 && road.building2_idx < count;
+    };
+    m_offsets.assign(buildings.size() + 1, 0);
+    for (const auto& road : roads)
+    {
+        if (valid(road))
+        {
+            ++m_offsets[size_t(road.building1_idx) + 1];
+            ++m_offsets[size_t(road.building2_idx) + 1];
+        }
+    }
+    for (size_t i = 1; i < m_offsets.size(); ++i)
+    {
+        m_offsets[i] += m_offsets[i - 1];
+    }
+
+    m_neighbors.resize(m_offsets.back());
+    m_lengths.resize(m_offsets.back());
+    std::vector<size_t> next(m_offsets.begin(), m_offsets.end() - 1);
+    for (const auto& road : roads)
+    {
+        if (valid(road))
+        {
+            const float length = distance(m_positions[size_t(road.building1_idx)],
+                                          m_positions[size_t(road.building2_idx)]);
+            m_neighbors[next[size_t(road.building1_idx)]] = road.building2_idx;
+            m_lengths[next[size_t(road.building1_idx)]++] = length;
+            m_neighbors[next[size_t(road.building2_idx)]] = road.building1_idx;
+            m_lengths[next[size_t(road.building2_idx)]++] = length;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_next_hops.clear();
+}
+
+// ----------------------------------------------------------------------------
+bool RoadNetwork::isStale(const GameState& state) const
+{
+    return (m_road_count != state.traffic.roads.size()) ||
+           (m_positions.size() != state.economy.buildings.size());
+}
+
+// ----------------------------------------------------------------------------
+int RoadNetwork::nextHop(int from, int to) const
+{
+    const int count = static_cast<int>(m_positions.size());
+    if ((from < 0) || (from >= count) || (to < 0) || (to >= count))
+    {
+        return -1;
+    }
+    if (from == to)
+    {
+        return to;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_next_hops.find(key(from, to));
+        if (it != m_next_hops.end())
+        {
+            return it->second;
+        }
+    }
+    return search(from, to);
+}
+
+// ----------------------------------------------------------------------------
+std::vector<int> RoadNetwork::path(int from, int to) const
+{
+    std::vector<int> buildings;
+    int current = from;
+    while ((current != -1) && (buildings.size() <= m_positions.size()))
+    {
+        buildings.push_back(current);
+        if (current == to)
+        {
+            return buildings;
+        }
+        current = nextHop(current, to);
+    }
+    return {};
+}
+
+// ----------------------------------------------------------------------------
+size_t RoadNetwork::getCachedCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_next_hops.size();
+}
+
+// ----------------------------------------------------------------------------
+int RoadNetwork::search(int from, int to) const
+{
+    // A* with the straight line distance as heuristic (never overestimates)
+    using Item = std::pair<float, int>; // (estimated length, building)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    std::unordered_map<int, float> lengths;
+    std::unordered_map<int, int> previous;
+
+    const sf::Vector2f goal = m_positions[size_t(to)];
+    lengths[from] = 0.0f;
+    open.push({distance(m_positions[size_t(from)], goal), from});
+    bool found = false;
+    while (!open.empty())
+    {
+        const int current = open.top().second;
+        const float estimate = open.top().first;
+        open.pop();
+        if (current == to)
+        {
+            found = true;
+            break;
+        }
+
+        const float length = lengths[current];
+        if (estimate > length + distance(m_positions[size_t(current)], goal) + 1e-3f)
+        {
+            continue; // Outdated entry
+        }
+        for (size_t i = m_offsets[size_t(current)]; i < m_offsets[size_t(current) + 1]; ++i)
+        {
+            const int neighbor = m_neighbors[i];
+            const float candidate = length + m_lengths[i];
+            auto it = lengths.find(neighbor);
+            if ((it == lengths.end()) || (candidate < it->second))
+            {
+                lengths[neighbor] = candidate;
+                previous[neighbor] = current;
+                open.push({candidate + distance(m_positions[size_t(neighbor)], goal), neighbor});
+            }
+        }
+    }
+
+    // Cache the next hop of every building of the path
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (m_next_hops.size() >= MAX_CACHED_HOPS)
+    {
+        m_next_hops.clear();
+    }
+    if (!found)
+    {
+        m_next_hops[key(from, to)] = -1;
+        return -1;
+    }
+
+    int hop = to;
+    for (int current = to; current != from;)
+    {
+        const int before = previous[current];
+        m_next_hops[key(before, to)] = current;
+        hop = current;
+        current = before;
+    }
+    return hop;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "GameState.hpp"
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Graph of the roads, with cached shortest paths between buildings.
+ * @details Buildings are the nodes and roads the (two-way) edges, weighted by
+ *          the distance between their buildings. Paths are searched with A*
+ *          on demand and every building of a found path remembers its next
+ *          hop toward the destination, so cars going to the same place share
+ *          the search. nextHop() can be called concurrently.
+ */
+class RoadNetwork
+{
+public:
+
+    //! @brief Maximum number of cached next hops before the cache is cleared
+    static constexpr size_t MAX_CACHED_HOPS = 1u << 20;
+
+    /**
+     * @brief Builds the graph from the roads and the building positions.
+     * @details Clears the cached paths.
+     * @param state [in] Game state holding the roads and buildings
+     */
+    void rebuild(const GameState& state);
+
+    /**
+     * @brief Checks if roads or buildings were added or removed since the
+     *        last rebuild.
+     * @param state [in] Game state holding the roads and buildings
+     * @return true if rebuild() should be called.
+     */
+    bool isStale(const GameState& state) const;
+
+    /**
+     * @brief Gets the next building on the shortest path.
+     * @param from [in] Current building
+     * @param to [in] Destination building
+     * @return The building after from, to if from == to, or -1 if to cannot
+     *         be reached.
+     */
+    int nextHop(int from, int to) const;
+
+    /**
+     * @brief Gets the shortest path.
+     * @param from [in] Start building
+     * @param to [in] Destination building
+     * @return The buildings from start to destination, empty if to cannot be
+     *         reached.
+     */
+    std::vector<int> path(int from, int to) const;
+
+    /**
+     * @brief Gets the number of cached next hops.
+     * @return Number of cached next hops.
+     */
+    size_t getCachedCount() const;
+
+private:
+
+    //! @brief Key of a (building, destination) pair in the cache
+    static sf::Uint64 key(int from, int to)
+    {
+        return (sf::Uint64(sf::Uint32(from)) << 32) | sf::Uint32(to);
+    }
+
+    //! @brief Searches the shortest path and caches its next hops
+    int search(int from, int to) const;
+
+private:
+
+    //! @brief Number of roads at the last rebuild
+    size_t m_road_count = 0;
+    //! @brief Position of each building
+    std::vector<sf::Vector2f> m_positions;
+    //! @brief Neighbors of building i are m_neighbors[m_offsets[i]..m_offsets[i + 1]]
+    std::vector<size_t> m_offsets;
+    //! @brief Neighbors of all buildings
+    std::vector<int> m_neighbors;
+    //! @brief Length of the road to each neighbor
+    std::vector<float> m_lengths;
+    //! @brief Next hop of each (building, destination) pair already searched
+    mutable std::unordered_map<sf::Uint64, int> m_next_hops;
+    //! @brief Protects m_next_hops
+    mutable std::shared_mutex m_mutex;
+};
@@ -2,160 +2,362 @@
 
 #include "GameState.hpp"
 #include <SFML/Network.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const size_t& value)
-{
-    return packet << static_cast<sf::Uint32>(value);
-}
+//! @brief True when the memory layout of numbers is the wire layout
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+static constexpr bool LITTLE_ENDIAN_HOST = false;
+#else
+static constexpr bool LITTLE_ENDIAN_HOST = true;
+#endif
 
 // ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, size_t& value)
+//! @brief Converts a value between the host and the little-endian wire order
+//! (the conversion is its own inverse)
+template<class T>
+inline T swapToLittleEndian(T value)
 {
-    sf::Uint32 v;
-    packet >> v;
-    value = static_cast<size_t>(v);
-    return packet;
+    if constexpr (LITTLE_ENDIAN_HOST || (sizeof(T) == 1) || std::is_same_v<T, sf::Color>)
+    {
+        return value;
+    }
+    else
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        std::reverse(bytes, bytes + sizeof(T));
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
 }
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const sf::Color& color)
+/**
+ * @brief Appends values to a packet with a fixed layout: little-endian, no
+ *        padding, no size prefix.
+ * @details Only fixed-width numbers and sf::Color are accepted. An array is
+ *          appended with a single copy on little-endian hosts, which are all
+ *          the targets of the game, and value by value elsewhere. A packet
+ *          keeps its capacity when cleared, so once it has grown to the size
+ *          of the message, writing does not allocate (see PacketPool).
+ */
+class PacketWriter
 {
-    return packet << color.r << color.g << color.b << color.a;
-}
+public:
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, sf::Color& color)
-{
-    packet >> color.r >> color.g >> color.b >> color.a;
-    return packet;
-}
+    /**
+     * @brief Writes at the end of a packet.
+     * @param[inout] packet Packet to append to.
+     */
+    explicit PacketWriter(sf::Packet& packet)
+        : m_packet(packet)
+    {}
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const GameState::Car& car)
-{
-    return packet << car.position.x << car.position.y 
-           << car.speed
-           << car.color
-           << car.source_building_idx 
-           << car.destination_building_idx
-           << car.is_returning;
-}
+    /**
+     * @brief Appends a value.
+     * @param[in] value Value to append.
+     * @return This writer.
+     */
+    template<class T>
+    PacketWriter& write(T value)
+    {
+        return write(&value, 1);
+    }
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, GameState::Car& car)
-{
-    return packet >> car.position.x >> car.position.y 
-           >> car.speed
-           >> car.color
-           >> car.source_building_idx 
-           >> car.destination_building_idx
-           >> car.is_returning;
-}
+    /**
+     * @brief Appends an array of values.
+     * @param[in] values First value.
+     * @param[in] count Number of values.
+     * @return This writer.
+     */
+    template<class T>
+    PacketWriter& write(const T* values, size_t count)
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_same_v<T, sf::Color>,
+                      "Only numbers and colors have a fixed layout");
+        static_assert(!std::is_same_v<T, size_t> && !std::is_same_v<T, bool>,
+                      "size_t and bool have no fixed size: use sf::Uint32 or sf::Uint8");
+        if constexpr (LITTLE_ENDIAN_HOST || (sizeof(T) == 1) || std::is_same_v<T, sf::Color>)
+        {
+            m_packet.append(values, count * sizeof(T));
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const T value = swapToLittleEndian(values[i]);
+                m_packet.append(&value, sizeof(T));
+            }
+        }
+        return *this;
+    }
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const GameState::Building& building)
-{
-    return packet << building.position.x << building.position.y 
-           << building.color
-           << building.income;
-}
+private:
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, GameState::Building& building)
+    //! @brief Packet being written
+    sf::Packet& m_packet;
+};
+
+/**
+ * @brief Reads the values written by PacketWriter, straight from the
+ *        received data into their destination.
+ * @details There is no intermediate object: an array is copied in a single
+ *          memcpy from the packet to where it belongs in the game state. Once
+ *          a read fails (not enough data), all the next ones fail.
+ */
+class PacketReader
 {
-    return packet >> building.position.x >> building.position.y 
-           >> building.color
-           >> building.income;
-}
+public:
+
+    /**
+     * @brief Reads a packet from the given byte.
+     * @param[in] packet Packet to read, which must outlive the reader.
+     * @param[in] position Bytes to skip, e.g. the message type.
+     */
+    explicit PacketReader(const sf::Packet& packet, size_t position = 0)
+        : m_data(static_cast<const char*>(packet.getData())),
+          m_size(packet.getDataSize()),
+          m_position(std::min(position, packet.getDataSize()))
+    {}
+
+    /**
+     * @brief Reads a value.
+     * @param[out] value Value read.
+     * @return false if the packet is too short.
+     */
+    template<class T>
+    bool read(T& value)
+    {
+        return read(&value, 1);
+    }
+
+    /**
+     * @brief Reads an array of values.
+     * @param[out] values Where to write the first value.
+     * @param[in] count Number of values.
+     * @return false if the packet is too short.
+     */
+    template<class T>
+    bool read(T* values, size_t count)
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_same_v<T, sf::Color>,
+                      "Only numbers and colors have a fixed layout");
+        static_assert(!std::is_same_v<T, size_t> && !std::is_same_v<T, bool>,
+                      "size_t and bool have no fixed size: use sf::Uint32 or sf::Uint8");
+        if (!m_valid || (count > getRemaining() / sizeof(T)))
+        {
+            m_valid = false;
+            return false;
+        }
+        if (count != 0)
+        {
+            std::memcpy(values, m_data + m_position, count * sizeof(T));
+        }
+        if constexpr (!LITTLE_ENDIAN_HOST && (sizeof(T) > 1) && !std::is_same_v<T, sf::Color>)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                values[i] = swapToLittleEndian(values[i]);
+            }
+        }
+        m_position += count * sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief Skips bytes and gives them in place, e.g. a nested message.
+     * @param[in] size Number of bytes.
+     * @return The first byte, valid as long as the packet, or nullptr if the
+     *         packet is too short.
+     */
+    const char* readBytes(size_t size)
+    {
+        if (!m_valid || (size > getRemaining()))
+        {
+            m_valid = false;
+            return nullptr;
+        }
+        const char* bytes = m_data + m_position;
+        m_position += size;
+        return bytes;
+    }
+
+    /**
+     * @brief Gets the number of bytes not read yet.
+     * @return Number of bytes.
+     */
+    size_t getRemaining() const
+    {
+        return m_size - m_position;
+    }
+
+    /**
+     * @brief Checks that all reads succeeded.
+     * @return false if a read went past the end of the packet.
+     */
+    explicit operator bool() const
+    {
+        return m_valid;
+    }
+
+private:
+
+    //! @brief Content of the packet
+    const char* m_data;
+    //! @brief Size of the packet
+    size_t m_size;
+    //! @brief Next byte to read
+    size_t m_position;
+    //! @brief Cleared by the first failed read
+    bool m_valid = true;
+};
+
+//! @brief Bytes of a car on the wire
+static constexpr size_t CAR_WIRE_SIZE = 3 * sizeof(float) + sizeof(sf::Color) +
+                                        3 * sizeof(sf::Int32) + sizeof(sf::Uint8);
+//! @brief Bytes of a building on the wire
+static constexpr size_t BUILDING_WIRE_SIZE = 3 * sizeof(float) + sizeof(sf::Color);
+//! @brief Bytes of a road on the wire
+static constexpr size_t ROAD_WIRE_SIZE = 2 * sizeof(sf::Int32) + sizeof(sf::Color);
+
+static_assert(sizeof(int) == sizeof(sf::Int32), "Building indices are sent as 32-bit integers");
 
 // ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const GameState::Road& road)
+//! @brief Writes the cars [begin, end), one array per field (the layout of
+//! GameState::Cars): each field is a single copy
+inline void writeCars(PacketWriter& writer, const GameState::Cars& cars, size_t begin, size_t end)
 {
-    return packet << road.building1_idx << road.building2_idx
-           << road.color;
+    const size_t count = end - begin;
+    writer.write(cars.x.data() + begin, count)
+          .write(cars.y.data() + begin, count)
+          .write(cars.speed.data() + begin, count)
+          .write(cars.color.data() + begin, count)
+          .write(cars.source_building_idx.data() + begin, count)
+          .write(cars.destination_building_idx.data() + begin, count)
+          .write(cars.waypoint_building_idx.data() + begin, count)
+          .write(cars.is_returning.data() + begin, count);
 }
 
 // ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, GameState::Road& road)
+//! @brief Reads the cars [begin, begin + count) in place, which must exist.
+//! Nothing is written if the packet is too short. Targets are looked up again.
+inline bool readCars(PacketReader& reader, GameState::Cars& cars, size_t begin, size_t count)
 {
-    return packet >> road.building1_idx >> road.building2_idx
-           >> road.color;
+    if (count > reader.getRemaining() / CAR_WIRE_SIZE)
+    {
+        return false;
+    }
+
+    reader.read(cars.x.data() + begin, count);
+    reader.read(cars.y.data() + begin, count);
+    reader.read(cars.speed.data() + begin, count);
+    reader.read(cars.color.data() + begin, count);
+    reader.read(cars.source_building_idx.data() + begin, count);
+    reader.read(cars.destination_building_idx.data() + begin, count);
+    reader.read(cars.waypoint_building_idx.data() + begin, count);
+    reader.read(cars.is_returning.data() + begin, count);
+    std::fill_n(cars.target_x.begin() + std::ptrdiff_t(begin), count,
+                std::numeric_limits<float>::quiet_NaN());
+    std::fill_n(cars.target_y.begin() + std::ptrdiff_t(begin), count,
+                std::numeric_limits<float>::quiet_NaN());
+    return static_cast<bool>(reader);
 }
 
 // ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const GameState::Traffic& traffic)
+//! @brief Writes the buildings [begin, end)
+inline void writeBuildings(PacketWriter& writer, const std::vector<GameState::Building>& buildings,
+                           size_t begin, size_t end)
 {
-    packet << traffic.cars.size();
-    for (const auto& car : traffic.cars)
-    {
-        packet << car;
-    }
-    
-    packet << traffic.roads.size();
-    for (const auto& road : traffic.roads)
+    for (size_t i = begin; i < end; ++i)
     {
-        packet << road;
+        const auto& building = buildings[i];
+        writer.write(building.position.x).write(building.position.y)
+              .write(building.color).write(building.income);
     }
-    return packet;
 }
 
 // ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, GameState::Traffic& traffic)
+//! @brief Reads the buildings [begin, begin + count) in place, which must
+//! exist. Nothing is written if the packet is too short.
+inline bool readBuildings(PacketReader& reader, std::vector<GameState::Building>& buildings,
+                          size_t begin, size_t count)
 {
-    size_t count;
-    packet >> count;
-    traffic.cars.resize(count);
-    for (auto& car : traffic.cars)
+    if (count > reader.getRemaining() / BUILDING_WIRE_SIZE)
     {
-        packet >> car;
+        return false;
     }
-    
-    packet >> count;
-    traffic.roads.resize(count);
-    for (auto& road : traffic.roads)
+
+    for (size_t i = begin; i < begin + count; ++i)
     {
-        packet >> road;
+        auto& building = buildings[i];
+        reader.read(building.position.x);
+        reader.read(building.position.y);
+        reader.read(building.color);
+        reader.read(building.income);
     }
-    return packet;
+    return static_cast<bool>(reader);
 }
 
 // ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const GameState::Economy& economy)
+//! @brief Writes the whole game state, counts first
+inline void writeState(PacketWriter& writer, const GameState& state)
 {
-    packet << economy.buildings.size();
-    for (const auto& building : economy.buildings)
+    const auto& cars = state.traffic.cars;
+    const auto& roads = state.traffic.roads;
+    const auto& buildings = state.economy.buildings;
+
+    writer.write(static_cast<sf::Uint32>(cars.size()));
+    writeCars(writer, cars, 0, cars.size());
+    writer.write(static_cast<sf::Uint32>(roads.size()));
+    for (const auto& road : roads)
     {
-        packet << building;
+        writer.write(road.building1_idx).write(road.building2_idx).write(road.color);
     }
-    packet << economy.money << economy.tax_rate;
-    return packet;
+    writer.write(static_cast<sf::Uint32>(buildings.size()));
+    writeBuildings(writer, buildings, 0, buildings.size());
+    writer.write(state.economy.money).write(state.economy.tax_rate);
 }
 
 // ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, GameState::Economy& economy)
+//! @brief Reads the whole game state. The vectors are only resized, so
+//! receiving a state of the same size does not allocate. The ranges of the
+//! traffic and economy updates are kept.
+inline bool readState(PacketReader& reader, GameState& state)
 {
-    size_t count;
-    packet >> count;
-    economy.buildings.resize(count);
-    for (auto& building : economy.buildings)
+    auto& cars = state.traffic.cars;
+    auto& roads = state.traffic.roads;
+    auto& buildings = state.economy.buildings;
+
+    // Counts are checked against the packet size before resizing
+    sf::Uint32 count = 0;
+    if (!reader.read(count) || (count > reader.getRemaining() / CAR_WIRE_SIZE))
     {
-        packet >> building;
+        return false;
     }
-    packet >> economy.money >> economy.tax_rate;
-    return packet;
-}
+    cars.resize(count);
+    readCars(reader, cars, 0, count);
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator<<(sf::Packet& packet, const GameState& state)
-{
-    packet << state.traffic << state.economy;
-    return packet;
-}
+    if (!reader.read(count) || (count > reader.getRemaining() / ROAD_WIRE_SIZE))
+    {
+        return false;
+    }
+    roads.resize(count);
+    for (auto& road : roads)
+    {
+        reader.read(road.building1_idx);
+        reader.read(road.building2_idx);
+        reader.read(road.color);
+    }
 
-// ----------------------------------------------------------------------------
-inline sf::Packet& operator>>(sf::Packet& packet, GameState& state)
-{
-    packet >> state.traffic >> state.economy;
-    return packet;
-}
\ No newline at end of file
+    if (!reader.read(count) || (count > reader.getRemaining() / BUILDING_WIRE_SIZE))
+    {
+        return false;
+    }
+    buildings.resize(count);
+    readBuildings(reader, buildings, 0, count);
+    reader.read(state.economy.money);
+    reader.read(state.economy.tax_rate);
+    return static_cast<bool>(reader);
+}
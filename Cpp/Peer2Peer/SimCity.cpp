@@ -1,9 +1,33 @@
 #include "Client.hpp"
 #include "Host.hpp"
+#include "SimulationEngine.hpp"
+#include <chrono>
 #include <iostream>
 #include <thread>
 
-// g++ --std=c++17 -Wall -Wextra -Wshadow *.cpp -o SimCity `pkg-config --cflags --libs sfml-graphics sfml-network`
+// ----------------------------------------------------------------------------
+//! @brief Runs the simulation without window nor network and prints the tick rate
+static void runHeadless(size_t cars, size_t ticks)
+{
+    GameState state;
+    GameManager::createInitialState(state, cars, std::max<size_t>(8, cars / 8));
+    state.traffic.count = static_cast<sf::Uint32>(state.traffic.cars.size());
+    state.economy.count = static_cast<sf::Uint32>(state.economy.buildings.size());
+
+    SimulationEngine engine;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ticks; ++i)
+    {
+        engine.step(state, sf::Color::Green);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << engine.getTick() << " ticks of " << cars << " cars on "
+              << engine.getThreadCount() << " threads: "
+              << double(ticks) / elapsed.count() << " ticks/s" << std::endl;
+}
+
+// g++ --std=c++17 -pthread -Wall -Wextra -Wshadow *.cpp -o SimCity `pkg-config --cflags --libs sfml-graphics sfml-network`
 int main(int argc, char* argv[])
 {
     try
@@ -11,11 +35,20 @@ int main(int argc, char* argv[])
         if (argc < 2)
         {
             std::cerr << "Usage: " << argv[0] << " [host|client] [port]"
+                      << std::endl
+                      << "       " << argv[0] << " headless [cars] [ticks]"
                       << std::endl;
             return 1;
         }
 
         std::string mode = argv[1];
+        if (mode == "headless")
+        {
+            runHeadless((argc > 2) ? std::stoul(argv[2]) : 1000000u,
+                        (argc > 3) ? std::stoul(argv[3]) : 600u);
+            return 0;
+        }
+
         unsigned short port =
             (argc > 2) ? static_cast<unsigned short>(std::stoi(argv[2]))
                        : 45000;
@@ -0,0 +1,59 @@
+#include "SimulationEngine.hpp"
+#include <SFML/System/Clock.hpp>
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+SimulationEngine::SimulationEngine(size_t threads)
+    : m_pool(threads)
+{}
+
+// ----------------------------------------------------------------------------
+size_t SimulationEngine::advance(GameState& state, float elapsed, sf::Color color)
+{
+    m_accumulator += elapsed;
+
+    size_t steps = 0;
+    while ((m_accumulator >= FIXED_DT) && (steps < MAX_STEPS))
+    {
+        step(state, color);
+        m_accumulator -= FIXED_DT;
+        ++steps;
+    }
+
+    // Too late: drop the time that cannot be caught up
+    if (steps == MAX_STEPS)
+    {
+        m_accumulator = std::min(m_accumulator, FIXED_DT);
+    }
+    return steps;
+}
+
+// ----------------------------------------------------------------------------
+void SimulationEngine::step(GameState& state, sf::Color color)
+{
+    if (m_roads.isStale(state))
+    {
+        m_roads.rebuild(state);
+    }
+
+    const size_t cars = state.traffic.cars.size();
+    const size_t car_begin = std::min<size_t>(state.traffic.startIdx, cars);
+    const size_t car_end = std::min<size_t>(car_begin + state.traffic.count, cars);
+    sf::Clock clock;
+    m_pool.parallelFor(car_begin, car_end, TRAFFIC_GRAIN, [&](size_t begin, size_t end)
+    {
+        GameManager::updateTraffic(state, begin, end, FIXED_DT, color, &m_roads);
+    });
+    m_traffic_time = clock.getElapsedTime().asSeconds();
+
+    const size_t buildings = state.economy.buildings.size();
+    const size_t building_begin = std::min<size_t>(state.economy.startIdx, buildings);
+    const size_t building_end = std::min<size_t>(building_begin + state.economy.count, buildings);
+    m_pool.parallelFor(building_begin, building_end, ECONOMY_GRAIN, [&](size_t begin, size_t end)
+    {
+        GameManager::updateEconomy(state, begin, end, color);
+    });
+
+    m_grid_stale = true;
+    ++m_tick;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "GameManager.hpp"
+#include "GameState.hpp"
+#include "RoadNetwork.hpp"
+#include "SpatialGrid.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Headless simulation of the traffic and the economy.
+ * @details Advances the game state by fixed time steps, whatever the frame
+ *          rate, and splits the cars and buildings assigned to this node
+ *          (GameState::Traffic::startIdx/count and the economy ones) into
+ *          chunks updated in parallel by the GameManager range kernels. It
+ *          does not need any window. Cars follow the roads. The spatial grid
+ *          of the cars and buildings is only brought up to date when queried,
+ *          so that steps without queries do not pay for it.
+ */
+class SimulationEngine
+{
+public:
+
+    //! @brief Duration of a simulation step in seconds
+    static constexpr float FIXED_DT = 1.0f / 60.0f;
+    //! @brief Maximum number of steps per advance, to catch up after a stall
+    //! without spiraling
+    static constexpr size_t MAX_STEPS = 5;
+    //! @brief Number of cars per task
+    static constexpr size_t TRAFFIC_GRAIN = 16384;
+    //! @brief Number of buildings per task
+    static constexpr size_t ECONOMY_GRAIN = 65536;
+
+    /**
+     * @brief Constructor
+     * @param threads [in] Number of threads updating the simulation
+     */
+    explicit SimulationEngine(size_t threads = std::thread::hardware_concurrency());
+
+    /**
+     * @brief Runs as many fixed steps as fit in the elapsed time.
+     * @param[inout] state The game state to update
+     * @param[in] elapsed Time elapsed since last call in seconds
+     * @param[in] color The color specified for each peer.
+     * @return Number of steps done.
+     */
+    size_t advance(GameState& state, float elapsed, sf::Color color);
+
+    /**
+     * @brief Runs one fixed step.
+     * @param[inout] state The game state to update
+     * @param[in] color The color specified for each peer.
+     */
+    void step(GameState& state, sf::Color color);
+
+    /**
+     * @brief Gets the number of steps done since the creation.
+     * @return Number of steps.
+     */
+    sf::Uint64 getTick() const
+    {
+        return m_tick;
+    }
+
+    /**
+     * @brief Gets the time spent on the cars by the last step, the grain of
+     *        the load balancing among peers.
+     * @return Seconds of the traffic kernels.
+     */
+    float getTrafficTime() const
+    {
+        return m_traffic_time;
+    }
+
+    /**
+     * @brief Gets the spatial index of the cars and buildings, brought up to
+     *        date with the given state if a step was done since last query.
+     * @param[in] state The game state stepped by this engine.
+     * @return The grid.
+     */
+    const SpatialGrid& getGrid(const GameState& state)
+    {
+        if (m_grid_stale)
+        {
+            m_grid.update(state);
+            m_grid_stale = false;
+        }
+        return m_grid;
+    }
+
+    /**
+     * @brief Gets the road network followed by the cars.
+     * @return The road network.
+     */
+    const RoadNetwork& getRoads() const
+    {
+        return m_roads;
+    }
+
+    /**
+     * @brief Gets the number of threads updating the simulation.
+     * @return Number of threads.
+     */
+    size_t getThreadCount() const
+    {
+        return m_pool.size();
+    }
+
+private:
+
+    //! @brief Threads running the kernels
+    ThreadPool m_pool;
+    //! @brief Shortest paths between buildings
+    RoadNetwork m_roads;
+    //! @brief Cars and buildings by cell
+    SpatialGrid m_grid;
+    //! @brief Steps were done since the last grid update
+    bool m_grid_stale = true;
+    //! @brief Time not simulated yet
+    float m_accumulator = 0.0f;
+    //! @brief Number of steps done
+    sf::Uint64 m_tick = 0;
+    //! @brief Seconds spent on the cars by the last step
+    float m_traffic_time = 0.0f;
+};
@@ -0,0 +1,117 @@
+#include "SpatialGrid.hpp"
+#include <algorithm>
+#include <limits>
+
+// ----------------------------------------------------------------------------
+SpatialGrid::SpatialGrid(float cell_size)
+    : m_inverse_cell_size(1.0f / cell_size)
+{}
+
+// ----------------------------------------------------------------------------
+template<class Position>
+void SpatialGrid::fill(Layer& layer, size_t count, Position&& position)
+{
+    // About two buckets per entry, power of two for the mask
+    size_t bucket_count = 1024;
+    while (bucket_count < 2 * count)
+    {
+        bucket_count *= 2;
+    }
+
+    layer.buckets.assign(bucket_count, {});
+    layer.cells.resize(count);
+    layer.slots.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        insert(layer, static_cast<sf::Uint32>(i), cellOf(position(i)));
+    }
+}
+
+// ----------------------------------------------------------------------------
+void SpatialGrid::insert(Layer& layer, sf::Uint32 index, sf::Uint64 cell)
+{
+    auto& bucket = layer.buckets[bucketOf(cell, layer.buckets.size())];
+    layer.cells[index] = cell;
+    layer.slots[index] = static_cast<sf::Uint32>(bucket.size());
+    bucket.push_back(index);
+}
+
+// ----------------------------------------------------------------------------
+void SpatialGrid::erase(Layer& layer, sf::Uint32 index)
+{
+    // Swap with the last entry of the bucket
+    auto& bucket = layer.buckets[bucketOf(layer.cells[index], layer.buckets.size())];
+    const sf::Uint32 slot = layer.slots[index];
+    bucket[slot] = bucket.back();
+    layer.slots[bucket[slot]] = slot;
+    bucket.pop_back();
+}
+
+// ----------------------------------------------------------------------------
+void SpatialGrid::rebuild(const GameState& state)
+{
+    const auto& cars = state.traffic.cars;
+    const auto& buildings = state.economy.buildings;
+    fill(m_cars, cars.size(), [&cars](size_t i) { return cars.position(i); });
+    fill(m_buildings, buildings.size(), [&buildings](size_t i) { return buildings[i].position; });
+}
+
+// ----------------------------------------------------------------------------
+size_t SpatialGrid::update(const GameState& state)
+{
+    if ((m_cars.cells.size() != state.traffic.cars.size()) ||
+        (m_buildings.cells.size() != state.economy.buildings.size()))
+    {
+        rebuild(state);
+        return state.traffic.cars.size();
+    }
+
+    size_t moved = 0;
+    for (size_t i = 0; i < state.traffic.cars.size(); ++i)
+    {
+        const sf::Uint64 cell = cellOf(state.traffic.cars.position(i));
+        if (cell != m_cars.cells[i])
+        {
+            erase(m_cars, static_cast<sf::Uint32>(i));
+            insert(m_cars, static_cast<sf::Uint32>(i), cell);
+            ++moved;
+        }
+    }
+    return moved;
+}
+
+// ----------------------------------------------------------------------------
+void SpatialGrid::queryCars(const GameState& state, sf::Vector2f center, float radius,
+                            std::vector<sf::Uint32>& cars) const
+{
+    cars.clear();
+    const float radius2 = radius * radius;
+    forEachCar(center, radius, [&](sf::Uint32 index)
+    {
+        const sf::Vector2f d = state.traffic.cars.position(index) - center;
+        if (d.x * d.x + d.y * d.y <= radius2)
+        {
+            cars.push_back(index);
+        }
+    });
+}
+
+// ----------------------------------------------------------------------------
+int SpatialGrid::nearestBuilding(const GameState& state, sf::Vector2f position,
+                                 float max_distance) const
+{
+    int nearest = -1;
+    float best = max_distance * max_distance;
+    auto visit = [&](sf::Uint32 index)
+    {
+        const sf::Vector2f d = state.economy.buildings[index].position - position;
+        const float distance2 = d.x * d.x + d.y * d.y;
+        if (distance2 <= best)
+        {
+            best = distance2;
+            nearest = static_cast<int>(index);
+        }
+    };
+    forEach(m_buildings, position, max_distance, visit);
+    return nearest;
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include "GameState.hpp"
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Uniform grid over cars and buildings, stored as a spatial hash.
+ * @details The world is cut into square cells whose coordinates are hashed
+ *          into a fixed number of buckets, so the grid does not need to know
+ *          the bounds of the city. Each tick, update() only moves the cars
+ *          that changed cell.
+ */
+class SpatialGrid
+{
+public:
+
+    /**
+     * @brief Constructor
+     * @param cell_size [in] Side of a cell in pixels. Queries are fastest
+     *        when the radius is about the cell size.
+     */
+    explicit SpatialGrid(float cell_size = 16.0f);
+
+    /**
+     * @brief Inserts all cars and buildings.
+     * @param state [in] Game state to index
+     */
+    void rebuild(const GameState& state);
+
+    /**
+     * @brief Moves the cars that changed cell since the last update.
+     * @details Falls back to rebuild() when cars or buildings were added or
+     *          removed.
+     * @param state [in] Game state to index
+     * @return Number of cars that changed cell.
+     */
+    size_t update(const GameState& state);
+
+    /**
+     * @brief Calls fn(car index) for each car whose cell overlaps the square
+     *        around a position. Cars may be farther than the radius.
+     * @param center [in] Center of the query
+     * @param radius [in] Half side of the square
+     * @param fn [in] Function called once per candidate car
+     */
+    template<class Function>
+    void forEachCar(sf::Vector2f center, float radius, Function&& fn) const
+    {
+        forEach(m_cars, center, radius, fn);
+    }
+
+    /**
+     * @brief Finds the cars closer than a radius to a position.
+     * @param state [in] Game state indexed by the grid
+     * @param center [in] Center of the query
+     * @param radius [in] Maximal distance
+     * @param cars [out] Indices of the cars, in no particular order
+     */
+    void queryCars(const GameState& state, sf::Vector2f center, float radius,
+                   std::vector<sf::Uint32>& cars) const;
+
+    /**
+     * @brief Finds the closest building to a position.
+     * @param state [in] Game state indexed by the grid
+     * @param position [in] Position to look around
+     * @param max_distance [in] Maximal distance
+     * @return Index of the building, or -1 if none is closer than max_distance.
+     */
+    int nearestBuilding(const GameState& state, sf::Vector2f position,
+                        float max_distance) const;
+
+private:
+
+    //! @brief Entries of one kind (cars or buildings) hashed into buckets
+    struct Layer
+    {
+        //! @brief Indices of the entries by bucket
+        std::vector<std::vector<sf::Uint32>> buckets;
+        //! @brief Cell of each entry
+        std::vector<sf::Uint64> cells;
+        //! @brief Position of each entry in its bucket
+        std::vector<sf::Uint32> slots;
+    };
+
+    //! @brief Packs the coordinates of the cell containing a position
+    sf::Uint64 cellOf(sf::Vector2f position) const
+    {
+        return pack(static_cast<sf::Int32>(std::floor(position.x * m_inverse_cell_size)),
+                    static_cast<sf::Int32>(std::floor(position.y * m_inverse_cell_size)));
+    }
+
+    //! @brief Packs cell coordinates in a key
+    static sf::Uint64 pack(sf::Int32 x, sf::Int32 y)
+    {
+        return (sf::Uint64(sf::Uint32(x)) << 32) | sf::Uint32(y);
+    }
+
+    //! @brief Bucket of a cell
+    static size_t bucketOf(sf::Uint64 cell, size_t bucket_count)
+    {
+        return static_cast<size_t>((cell * 0x9E3779B97F4A7C15ull) >> 32) & (bucket_count - 1);
+    }
+
+    //! @brief Fills a layer with the positions of count entries
+    template<class Position>
+    void fill(Layer& layer, size_t count, Position&& position);
+
+    //! @brief Adds an entry to the bucket of its cell
+    static void insert(Layer& layer, sf::Uint32 index, sf::Uint64 cell);
+
+    //! @brief Removes an entry from the bucket of its cell
+    static void erase(Layer& layer, sf::Uint32 index);
+
+    //! @brief Visits the entries of the cells overlapping a square
+    template<class Function>
+    void forEach(const Layer& layer, sf::Vector2f center, float radius, Function& fn) const
+    {
+        if (layer.buckets.empty())
+        {
+            return;
+        }
+
+        const sf::Int32 x0 = static_cast<sf::Int32>(std::floor((center.x - radius) * m_inverse_cell_size));
+        const sf::Int32 x1 = static_cast<sf::Int32>(std::floor((center.x + radius) * m_inverse_cell_size));
+        const sf::Int32 y0 = static_cast<sf::Int32>(std::floor((center.y - radius) * m_inverse_cell_size));
+        const sf::Int32 y1 = static_cast<sf::Int32>(std::floor((center.y + radius) * m_inverse_cell_size));
+        for (sf::Int32 y = y0; y <= y1; ++y)
+        {
+            for (sf::Int32 x = x0; x <= x1; ++x)
+            {
+                // Other cells may share the bucket: skip their entries
+                const sf::Uint64 cell = pack(x, y);
+                for (sf::Uint32 index : layer.buckets[bucketOf(cell, layer.buckets.size())])
+                {
+                    if (layer.cells[index] == cell)
+                    {
+                        fn(index);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+
+    //! @brief 1 / side of a cell
+    float m_inverse_cell_size;
+    //! @brief Cars
+    Layer m_cars;
+    //! @brief Buildings
+    Layer m_buildings;
+};
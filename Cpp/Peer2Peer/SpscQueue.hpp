@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Lock-free bounded queue between one producer thread and one
+ *        consumer thread.
+ * @details Slots are allocated once and reused: the producer fills the slot
+ *          returned by prepare() in place and publishes it with commit(), the
+ *          consumer reads front() in place and releases it with pop(). Each
+ *          side caches the index of the other one, so the shared atomics are
+ *          only read when the queue looks full or empty.
+ */
+template<class T>
+class SpscQueue
+{
+public:
+
+    /**
+     * @brief Allocates the slots.
+     * @param[in] capacity Minimum number of slots, rounded up to a power of 2.
+     */
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Gets the slot to fill (producer).
+     * @return The slot, or nullptr if the queue is full.
+     */
+    T* prepare()
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cached_head > m_mask)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail - m_cached_head > m_mask)
+            {
+                return nullptr;
+            }
+        }
+        return &m_slots[tail & m_mask];
+    }
+
+    /**
+     * @brief Publishes the slot returned by prepare() (producer).
+     */
+    void commit()
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Gets the oldest published slot (consumer).
+     * @return The slot, or nullptr if the queue is empty.
+     */
+    T* front()
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cached_tail)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cached_tail)
+            {
+                return nullptr;
+            }
+        }
+        return &m_slots[head & m_mask];
+    }
+
+    /**
+     * @brief Releases the slot returned by front() (consumer).
+     */
+    void pop()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Gets the number of slots.
+     * @return Capacity of the queue.
+     */
+    size_t capacity() const
+    {
+        return m_slots.size();
+    }
+
+private:
+
+    //! @brief Slots, reused
+    std::vector<T> m_slots;
+    //! @brief Number of slots - 1
+    size_t m_mask;
+    //! @brief Next slot to read, written by the consumer
+    alignas(64) std::atomic<size_t> m_head{0};
+    //! @brief Last value of m_tail seen by the consumer
+    size_t m_cached_tail = 0;
+    //! @brief Next slot to write, written by the producer
+    alignas(64) std::atomic<size_t> m_tail{0};
+    //! @brief Last value of m_head seen by the producer
+    size_t m_cached_head = 0;
+};
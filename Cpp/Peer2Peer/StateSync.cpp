@@ -0,0 +1,819 @@
+#include "StateSync.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//! @brief Upper bound on entity counts read from a packet
+static constexpr sf::Uint32 MAX_ENTITIES = 1u << 24;
+//! @brief Fewest bytes of a changed entity: index gap and mask
+static constexpr size_t MIN_ENTRY_SIZE = 2;
+
+//! @brief Sections of a snapshot, in the order of the chunks: buildings
+//! first, so that the roads and cars of the next chunks find them in the game
+//! state
+enum Section : size_t
+{
+    SECTION_BUILDINGS,
+    SECTION_ROADS,
+    SECTION_CARS,
+    SECTIONS
+};
+
+static_assert(std::tuple_size<decltype(SnapshotAssembly::sizes)>::value == SECTIONS,
+              "One size per section");
+
+//! @brief Bytes of the header of a chunk
+static constexpr size_t CHUNK_HEADER_SIZE = 2 * sizeof(sf::Uint32) + 2 * sizeof(float) +
+                                            SECTIONS * sizeof(sf::Uint32) + 3 * sizeof(sf::Uint32);
+
+//! @brief Changed fields of a car, and its flags
+enum CarField : sf::Uint8
+{
+    CAR_POSITION = 1 << 0,
+    CAR_SPEED = 1 << 1,
+    CAR_COLOR = 1 << 2,
+    CAR_ROUTE = 1 << 3,
+    CAR_FLAGS = 1 << 6,      // is_returning changed (value in CAR_RETURNING)
+    CAR_RETURNING = 1 << 7,  // Value of is_returning, always sent
+    CAR_ALL = CAR_POSITION | CAR_SPEED | CAR_COLOR | CAR_ROUTE | CAR_FLAGS
+};
+
+//! @brief Changed fields of a road
+enum RoadField : sf::Uint8
+{
+    ROAD_ENDS = 1 << 0,
+    ROAD_COLOR = 1 << 1,
+    ROAD_ALL = ROAD_ENDS | ROAD_COLOR
+};
+
+//! @brief Changed fields of a building
+enum BuildingField : sf::Uint8
+{
+    BUILDING_POSITION = 1 << 0,
+    BUILDING_COLOR = 1 << 1,
+    BUILDING_INCOME = 1 << 2,
+    BUILDING_ALL = BUILDING_POSITION | BUILDING_COLOR | BUILDING_INCOME
+};
+
+// ----------------------------------------------------------------------------
+static sf::Int16 quantize(float value, float scale)
+{
+    const float scaled = std::round(value * scale);
+    return static_cast<sf::Int16>(std::clamp(scaled,
+        static_cast<float>(std::numeric_limits<sf::Int16>::min()),
+        static_cast<float>(std::numeric_limits<sf::Int16>::max())));
+}
+
+// ----------------------------------------------------------------------------
+static sf::Uint16 quantizeUnsigned(float value, float scale)
+{
+    const float scaled = std::round(value * scale);
+    return static_cast<sf::Uint16>(std::clamp(scaled, 0.0f,
+        static_cast<float>(std::numeric_limits<sf::Uint16>::max())));
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Writes an unsigned integer on 1 to 5 bytes (LEB128)
+static void writeVarint(PacketWriter& writer, sf::Uint32 value)
+{
+    while (value >= 0x80u)
+    {
+        writer.write(static_cast<sf::Uint8>(value | 0x80u));
+        value >>= 7;
+    }
+    writer.write(static_cast<sf::Uint8>(value));
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Bytes written by writeVarint()
+static size_t varintSize(sf::Uint32 value)
+{
+    size_t size = 1;
+    while (value >= 0x80u)
+    {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+// ----------------------------------------------------------------------------
+static bool readVarint(PacketReader& reader, sf::Uint32& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7)
+    {
+        sf::Uint8 byte;
+        if (!reader.read(byte))
+        {
+            return false;
+        }
+        value |= static_cast<sf::Uint32>(byte & 0x7Fu) << shift;
+        if ((byte & 0x80u) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+static sf::Uint8 diff(const StateSnapshot::Car& car, const StateSnapshot::Car* base)
+{
+    sf::Uint8 mask = CAR_ALL;
+    if (base != nullptr)
+    {
+        mask = 0;
+        if (car.x != base->x || car.y != base->y) mask |= CAR_POSITION;
+        if (car.speed != base->speed) mask |= CAR_SPEED;
+        if (car.color != base->color) mask |= CAR_COLOR;
+        if (car.source_building_idx != base->source_building_idx ||
+            car.destination_building_idx != base->destination_building_idx ||
+            car.waypoint_building_idx != base->waypoint_building_idx) mask |= CAR_ROUTE;
+        if (car.is_returning != base->is_returning) mask |= CAR_FLAGS;
+        if (mask == 0)
+        {
+            return 0;
+        }
+    }
+    return car.is_returning ? static_cast<sf::Uint8>(mask | CAR_RETURNING) : mask;
+}
+
+// ----------------------------------------------------------------------------
+static sf::Uint8 diff(const GameState::Road& road, const GameState::Road* base)
+{
+    if (base == nullptr)
+    {
+        return ROAD_ALL;
+    }
+    sf::Uint8 mask = 0;
+    if (road.building1_idx != base->building1_idx ||
+        road.building2_idx != base->building2_idx) mask |= ROAD_ENDS;
+    if (road.color != base->color) mask |= ROAD_COLOR;
+    return mask;
+}
+
+// ----------------------------------------------------------------------------
+static sf::Uint8 diff(const StateSnapshot::Building& building, const StateSnapshot::Building* base)
+{
+    if (base == nullptr)
+    {
+        return BUILDING_ALL;
+    }
+    sf::Uint8 mask = 0;
+    if (building.x != base->x || building.y != base->y) mask |= BUILDING_POSITION;
+    if (building.color != base->color) mask |= BUILDING_COLOR;
+    if (building.income != base->income) mask |= BUILDING_INCOME;
+    return mask;
+}
+
+// ----------------------------------------------------------------------------
+static void write(PacketWriter& writer, const StateSnapshot::Car& car, sf::Uint8 mask)
+{
+    if (mask & CAR_POSITION) writer.write(car.x).write(car.y);
+    if (mask & CAR_SPEED) writer.write(car.speed);
+    if (mask & CAR_COLOR) writer.write(car.color);
+    if (mask & CAR_ROUTE)
+    {
+        writeVarint(writer, static_cast<sf::Uint32>(car.source_building_idx));
+        writeVarint(writer, static_cast<sf::Uint32>(car.destination_building_idx));
+        writeVarint(writer, static_cast<sf::Uint32>(car.waypoint_building_idx + 1)); // -1 on one byte
+    }
+}
+
+// ----------------------------------------------------------------------------
+static void write(PacketWriter& writer, const GameState::Road& road, sf::Uint8 mask)
+{
+    if (mask & ROAD_ENDS)
+    {
+        writeVarint(writer, static_cast<sf::Uint32>(road.building1_idx));
+        writeVarint(writer, static_cast<sf::Uint32>(road.building2_idx));
+    }
+    if (mask & ROAD_COLOR) writer.write(road.color);
+}
+
+// ----------------------------------------------------------------------------
+static void write(PacketWriter& writer, const StateSnapshot::Building& building, sf::Uint8 mask)
+{
+    if (mask & BUILDING_POSITION) writer.write(building.x).write(building.y);
+    if (mask & BUILDING_COLOR) writer.write(building.color);
+    if (mask & BUILDING_INCOME) writer.write(building.income);
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Bytes written by write()
+static size_t fieldsSize(const StateSnapshot::Car& car, sf::Uint8 mask)
+{
+    size_t size = 0;
+    if (mask & CAR_POSITION) size += 2 * sizeof(sf::Int16);
+    if (mask & CAR_SPEED) size += sizeof(sf::Uint16);
+    if (mask & CAR_COLOR) size += sizeof(sf::Color);
+    if (mask & CAR_ROUTE)
+    {
+        size += varintSize(static_cast<sf::Uint32>(car.source_building_idx)) +
+                varintSize(static_cast<sf::Uint32>(car.destination_building_idx)) +
+                varintSize(static_cast<sf::Uint32>(car.waypoint_building_idx + 1));
+    }
+    return size;
+}
+
+// ----------------------------------------------------------------------------
+static size_t fieldsSize(const GameState::Road& road, sf::Uint8 mask)
+{
+    size_t size = 0;
+    if (mask & ROAD_ENDS)
+    {
+        size += varintSize(static_cast<sf::Uint32>(road.building1_idx)) +
+                varintSize(static_cast<sf::Uint32>(road.building2_idx));
+    }
+    if (mask & ROAD_COLOR) size += sizeof(sf::Color);
+    return size;
+}
+
+// ----------------------------------------------------------------------------
+static size_t fieldsSize(const StateSnapshot::Building&, sf::Uint8 mask)
+{
+    size_t size = 0;
+    if (mask & BUILDING_POSITION) size += 2 * sizeof(sf::Int16);
+    if (mask & BUILDING_COLOR) size += sizeof(sf::Color);
+    if (mask & BUILDING_INCOME) size += sizeof(float);
+    return size;
+}
+
+// ----------------------------------------------------------------------------
+static bool read(PacketReader& reader, StateSnapshot::Car& car, sf::Uint8 mask)
+{
+    if (mask & CAR_POSITION) { reader.read(car.x); reader.read(car.y); }
+    if (mask & CAR_SPEED) reader.read(car.speed);
+    if (mask & CAR_COLOR) reader.read(car.color);
+    if (mask & CAR_ROUTE)
+    {
+        sf::Uint32 source, destination, waypoint;
+        if (!readVarint(reader, source) || !readVarint(reader, destination) ||
+            !readVarint(reader, waypoint))
+        {
+            return false;
+        }
+        car.source_building_idx = static_cast<sf::Int32>(source);
+        car.destination_building_idx = static_cast<sf::Int32>(destination);
+        car.waypoint_building_idx = static_cast<sf::Int32>(waypoint) - 1;
+    }
+    car.is_returning = (mask & CAR_RETURNING) != 0;
+    return static_cast<bool>(reader);
+}
+
+// ----------------------------------------------------------------------------
+static bool read(PacketReader& reader, GameState::Road& road, sf::Uint8 mask)
+{
+    if (mask & ROAD_ENDS)
+    {
+        sf::Uint32 building1, building2;
+        if (!readVarint(reader, building1) || !readVarint(reader, building2))
+        {
+            return false;
+        }
+        road.building1_idx = static_cast<int>(building1);
+        road.building2_idx = static_cast<int>(building2);
+    }
+    if (mask & ROAD_COLOR) reader.read(road.color);
+    return static_cast<bool>(reader);
+}
+
+// ----------------------------------------------------------------------------
+static bool read(PacketReader& reader, StateSnapshot::Building& building, sf::Uint8 mask)
+{
+    if (mask & BUILDING_POSITION) { reader.read(building.x); reader.read(building.y); }
+    if (mask & BUILDING_COLOR) reader.read(building.color);
+    if (mask & BUILDING_INCOME) reader.read(building.income);
+    return static_cast<bool>(reader);
+}
+
+// ----------------------------------------------------------------------------
+static bool isBuilding(sf::Int32 index, size_t buildings)
+{
+    return (index >= 0) && (static_cast<size_t>(index) < buildings);
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Checks that an entity only refers to existing buildings
+static bool isValid(const StateSnapshot::Car& car, size_t buildings)
+{
+    return isBuilding(car.source_building_idx, buildings) &&
+           isBuilding(car.destination_building_idx, buildings) &&
+           ((car.waypoint_building_idx == -1) || isBuilding(car.waypoint_building_idx, buildings));
+}
+
+// ----------------------------------------------------------------------------
+static bool isValid(const GameState::Road& road, size_t buildings)
+{
+    return isBuilding(road.building1_idx, buildings) && isBuilding(road.building2_idx, buildings);
+}
+
+// ----------------------------------------------------------------------------
+template<typename Entity>
+static bool isValid(const std::vector<Entity>& entities, size_t begin, size_t end, size_t buildings)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (!isValid(entities[i], buildings))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Entities of each section of a snapshot
+static std::array<size_t, SECTIONS> sizesOf(const StateSnapshot& snapshot)
+{
+    return {snapshot.buildings.size(), snapshot.roads.size(), snapshot.cars.size()};
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Entities of each section of a game state
+static std::array<size_t, SECTIONS> sizesOf(const GameState& state)
+{
+    return {state.economy.buildings.size(), state.traffic.roads.size(), state.traffic.cars.size()};
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Finds the section of an entity counted over all sections, and its
+//! index in the section. The end of the snapshot is the end of the last one.
+static Section locate(const std::array<size_t, SECTIONS>& sizes, size_t& index)
+{
+    size_t section = 0;
+    while ((section + 1 < SECTIONS) && (index >= sizes[section]))
+    {
+        index -= sizes[section];
+        ++section;
+    }
+    return Section(section);
+}
+
+// ----------------------------------------------------------------------------
+template<typename Entity>
+static const Entity* baseOf(const std::vector<Entity>* base, size_t i)
+{
+    return ((base != nullptr) && (i < base->size())) ? &(*base)[i] : nullptr;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Finds the end of the chunk starting at an entity of a section: as
+//! many entities as the changed ones fit in a chunk, up to the end of the
+//! section. Entities past the base size are always sent in full.
+template<typename Entity>
+static size_t scanChunk(const std::vector<Entity>& current, const std::vector<Entity>* base,
+                        size_t begin, sf::Uint32& changed)
+{
+    size_t size = CHUNK_HEADER_SIZE;
+    size_t next = begin;
+    size_t end = begin;
+    changed = 0;
+    for (; end < current.size(); ++end)
+    {
+        const sf::Uint8 mask = diff(current[end], baseOf(base, end));
+        if (mask != 0)
+        {
+            const size_t entry = varintSize(static_cast<sf::Uint32>(end - next)) + sizeof(mask) +
+                                 fieldsSize(current[end], mask);
+            if (size + entry > StateSync::CHUNK_SIZE)
+            {
+                break;
+            }
+            size += entry;
+            ++changed;
+            next = end + 1;
+        }
+    }
+    return end;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Writes the index gap, mask and changed fields of each entity of
+//! [begin, end) differing from the base
+template<typename Entity>
+static void writeChunk(PacketWriter& writer, const std::vector<Entity>& current,
+                       const std::vector<Entity>* base, size_t begin, size_t end)
+{
+    size_t next = begin;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const sf::Uint8 mask = diff(current[i], baseOf(base, i));
+        if (mask != 0)
+        {
+            writeVarint(writer, static_cast<sf::Uint32>(i - next));
+            writer.write(mask);
+            write(writer, current[i], mask);
+            next = i + 1;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Reads the entities [begin, begin + count) of a section over the
+//! ones kept from the base. The counts are checked against the bytes left
+//! before anything is allocated: a changed entity takes at least its index
+//! gap and mask, and a chunk only adds the entities it sends, right after the
+//! ones already there.
+template<typename Entity>
+static bool readChunk(PacketReader& reader, std::vector<Entity>& entities, size_t base_size,
+                      size_t begin, size_t count, sf::Uint32 changed)
+{
+    const size_t end = begin + count;
+    const size_t added = end - std::min(end, std::max(begin, base_size));
+    if ((begin > entities.size()) || (changed > count) || (added > changed) ||
+        (changed > reader.getRemaining() / MIN_ENTRY_SIZE))
+    {
+        return false;
+    }
+
+    entities.resize(std::max(entities.size(), end));
+    size_t next = begin;
+    size_t sent = 0;
+    for (sf::Uint32 i = 0; i < changed; ++i)
+    {
+        sf::Uint32 gap;
+        sf::Uint8 mask;
+        if (!readVarint(reader, gap) || !reader.read(mask) || (gap >= end - next))
+        {
+            return false;
+        }
+        next += gap;
+        if (!read(reader, entities[next], mask))
+        {
+            return false;
+        }
+        sent += (next >= base_size) ? 1u : 0u;
+        ++next;
+    }
+    return sent == added;
+}
+
+// ----------------------------------------------------------------------------
+static void restoreBuildings(const StateSnapshot& snapshot, size_t begin, size_t end, GameState& state)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        const auto& sample = snapshot.buildings[i];
+        auto& building = state.economy.buildings[i];
+        building.position = {sample.x / StateSync::POSITION_SCALE, sample.y / StateSync::POSITION_SCALE};
+        building.color = sample.color;
+        building.income = sample.income;
+    }
+}
+
+// ----------------------------------------------------------------------------
+static void restoreRoads(const StateSnapshot& snapshot, size_t begin, size_t end, GameState& state)
+{
+    std::copy(snapshot.roads.begin() + std::ptrdiff_t(begin), snapshot.roads.begin() + std::ptrdiff_t(end),
+              state.traffic.roads.begin() + std::ptrdiff_t(begin));
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Writes the cars [begin, end) but the ones this node simulates,
+//! which are ahead of the snapshot. The cached target of a car is only looked
+//! up again when its route changed.
+static void restoreCars(const StateSnapshot& snapshot, size_t begin, size_t end, GameState& state)
+{
+    auto& cars = state.traffic.cars;
+    const size_t own_begin = state.traffic.startIdx;
+    const size_t own_end = own_begin + state.traffic.count;
+    for (size_t i = begin; i < end; ++i)
+    {
+        if ((i >= own_begin) && (i < own_end))
+        {
+            continue;
+        }
+
+        const auto& sample = snapshot.cars[i];
+        cars.x[i] = sample.x / StateSync::POSITION_SCALE;
+        cars.y[i] = sample.y / StateSync::POSITION_SCALE;
+        cars.speed[i] = sample.speed / StateSync::SPEED_SCALE;
+        cars.color[i] = sample.color;
+        const sf::Uint8 returning = sample.is_returning ? 1 : 0;
+        if ((cars.source_building_idx[i] != sample.source_building_idx) ||
+            (cars.destination_building_idx[i] != sample.destination_building_idx) ||
+            (cars.waypoint_building_idx[i] != sample.waypoint_building_idx) ||
+            (cars.is_returning[i] != returning))
+        {
+            cars.target_x[i] = cars.target_y[i] = std::numeric_limits<float>::quiet_NaN();
+            cars.source_building_idx[i] = sample.source_building_idx;
+            cars.destination_building_idx[i] = sample.destination_building_idx;
+            cars.waypoint_building_idx[i] = sample.waypoint_building_idx;
+            cars.is_returning[i] = returning;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+StateSnapshot& SnapshotHistory::getSpare()
+{
+    return m_snapshots[(m_newest + 1) % m_snapshots.size()];
+}
+
+// ----------------------------------------------------------------------------
+const StateSnapshot& SnapshotHistory::pushSpare()
+{
+    // With CAPACITY snapshots stored, the slot after the new one is the
+    // oldest: it becomes the spare
+    m_newest = (m_newest + 1) % m_snapshots.size();
+    m_count = std::min(m_count + 1, CAPACITY);
+    m_assembly = SnapshotAssembly();
+    return m_snapshots[m_newest];
+}
+
+// ----------------------------------------------------------------------------
+SnapshotAssembly& SnapshotHistory::getAssembly()
+{
+    return m_assembly;
+}
+
+// ----------------------------------------------------------------------------
+const StateSnapshot* SnapshotHistory::find(sf::Uint32 tick) const
+{
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        const StateSnapshot& snapshot =
+            m_snapshots[(m_newest + m_snapshots.size() - i) % m_snapshots.size()];
+        if (snapshot.tick == tick)
+        {
+            return &snapshot;
+        }
+    }
+    return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+sf::Uint32 SnapshotHistory::getLatestTick() const
+{
+    return (m_count == 0) ? 0 : m_snapshots[m_newest].tick;
+}
+
+// ----------------------------------------------------------------------------
+void SnapshotHistory::clear()
+{
+    m_count = 0;
+    m_assembly = SnapshotAssembly();
+}
+
+// ----------------------------------------------------------------------------
+void StateSync::capture(const GameState& state, sf::Uint32 tick, StateSnapshot& snapshot)
+{
+    snapshot.tick = tick;
+
+    const auto& cars = state.traffic.cars;
+    snapshot.cars.resize(cars.size());
+    for (size_t i = 0; i < cars.size(); ++i)
+    {
+        auto& sample = snapshot.cars[i];
+        sample.x = quantize(cars.x[i], POSITION_SCALE);
+        sample.y = quantize(cars.y[i], POSITION_SCALE);
+        sample.speed = quantizeUnsigned(cars.speed[i], SPEED_SCALE);
+        sample.color = cars.color[i];
+        sample.source_building_idx = cars.source_building_idx[i];
+        sample.destination_building_idx = cars.destination_building_idx[i];
+        sample.waypoint_building_idx = cars.waypoint_building_idx[i];
+        sample.is_returning = (cars.is_returning[i] != 0);
+    }
+
+    snapshot.roads = state.traffic.roads;
+
+    snapshot.buildings.resize(state.economy.buildings.size());
+    for (size_t i = 0; i < state.economy.buildings.size(); ++i)
+    {
+        const auto& building = state.economy.buildings[i];
+        auto& sample = snapshot.buildings[i];
+        sample.x = quantize(building.position.x, POSITION_SCALE);
+        sample.y = quantize(building.position.y, POSITION_SCALE);
+        sample.color = building.color;
+        sample.income = building.income;
+    }
+
+    snapshot.money = state.economy.money;
+    snapshot.tax_rate = state.economy.tax_rate;
+}
+
+// ----------------------------------------------------------------------------
+void StateSync::restore(const StateSnapshot& snapshot, GameState& state)
+{
+    state.economy.buildings.resize(snapshot.buildings.size());
+    restoreBuildings(snapshot, 0, snapshot.buildings.size(), state);
+    state.traffic.roads.resize(snapshot.roads.size());
+    restoreRoads(snapshot, 0, snapshot.roads.size(), state);
+    state.traffic.cars.resize(snapshot.cars.size());
+    restoreCars(snapshot, 0, snapshot.cars.size(), state);
+
+    state.economy.money = snapshot.money;
+    state.economy.tax_rate = snapshot.tax_rate;
+}
+
+// ----------------------------------------------------------------------------
+bool StateSync::encode(PacketWriter& writer, Chunks& chunks)
+{
+    if (chunks.done)
+    {
+        return false;
+    }
+
+    // Entities of the chunk: as many as fit, in the section of the first one
+    const StateSnapshot& current = *chunks.current;
+    const StateSnapshot* base = chunks.base;
+    const auto sizes = sizesOf(current);
+    size_t begin = chunks.next;
+    const Section section = locate(sizes, begin);
+    const auto visit = [&](auto&& function)
+    {
+        switch (section)
+        {
+            case SECTION_BUILDINGS:
+                return function(current.buildings, (base != nullptr) ? &base->buildings : nullptr);
+            case SECTION_ROADS:
+                return function(current.roads, (base != nullptr) ? &base->roads : nullptr);
+            default:
+                return function(current.cars, (base != nullptr) ? &base->cars : nullptr);
+        }
+    };
+    sf::Uint32 changed = 0;
+    const size_t end = visit([begin, &changed](const auto& entities, const auto* base_entities)
+    {
+        return scanChunk(entities, base_entities, begin, changed);
+    });
+
+    writer.write(current.tick).write((base != nullptr) ? base->tick : sf::Uint32(0))
+          .write(current.money).write(current.tax_rate);
+    for (size_t size : sizes)
+    {
+        writer.write(static_cast<sf::Uint32>(size));
+    }
+    writer.write(static_cast<sf::Uint32>(chunks.next))
+          .write(static_cast<sf::Uint32>(end - begin))
+          .write(changed);
+    visit([&writer, begin, end](const auto& entities, const auto* base_entities)
+    {
+        writeChunk(writer, entities, base_entities, begin, end);
+    });
+
+    chunks.next += end - begin;
+    chunks.done = (chunks.next == sizes[SECTION_BUILDINGS] + sizes[SECTION_ROADS] + sizes[SECTION_CARS]);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+sf::Uint32 StateSync::decode(PacketReader& reader, SnapshotHistory& history,
+                             GameState& state)
+{
+    sf::Uint32 tick, base_tick, first, count, changed;
+    float money, tax_rate;
+    std::array<sf::Uint32, SECTIONS> counts;
+    if (!reader.read(tick) || !reader.read(base_tick) || !reader.read(money) ||
+        !reader.read(tax_rate) || !reader.read(counts.data(), counts.size()) ||
+        !reader.read(first) || !reader.read(count) || !reader.read(changed) || (tick == 0) ||
+        (*std::max_element(counts.begin(), counts.end()) > MAX_ENTITIES))
+    {
+        return 0;
+    }
+
+    // Chunks of an older snapshot come too late
+    SnapshotAssembly& assembly = history.getAssembly();
+    StateSnapshot& snapshot = history.getSpare();
+    if ((tick <= history.getLatestTick()) || (tick < assembly.tick))
+    {
+        return 0;
+    }
+    const std::array<size_t, SECTIONS> sizes{counts[0], counts[1], counts[2]};
+    if (tick != assembly.tick)
+    {
+        // First chunk read of the snapshot: start from the base, or from
+        // nothing for a keyframe, without the removed entities. Assigning
+        // keeps the storage of the spare snapshot: no allocation once warm.
+        if (base_tick == 0)
+        {
+            snapshot.cars.clear();
+            snapshot.roads.clear();
+            snapshot.buildings.clear();
+        }
+        else if (const StateSnapshot* base = history.find(base_tick))
+        {
+            snapshot = *base;
+        }
+        else
+        {
+            return 0;
+        }
+        snapshot.buildings.resize(std::min(snapshot.buildings.size(), sizes[SECTION_BUILDINGS]));
+        snapshot.roads.resize(std::min(snapshot.roads.size(), sizes[SECTION_ROADS]));
+        snapshot.cars.resize(std::min(snapshot.cars.size(), sizes[SECTION_CARS]));
+        snapshot.tick = tick;
+        snapshot.money = money;
+        snapshot.tax_rate = tax_rate;
+
+        assembly = SnapshotAssembly();
+        assembly.tick = tick;
+        assembly.base_tick = base_tick;
+        assembly.sizes = counts;
+        assembly.base_sizes = sizesOf(snapshot);
+    }
+    else if (assembly.broken || (base_tick != assembly.base_tick) || (counts != assembly.sizes))
+    {
+        return 0;
+    }
+
+    // Entities of the chunk, within one section
+    const size_t total = sizes[SECTION_BUILDINGS] + sizes[SECTION_ROADS] + sizes[SECTION_CARS];
+    size_t begin = first;
+    if ((first > total) || (count > total - first))
+    {
+        return 0;
+    }
+    const Section section = locate(sizes, begin);
+    const size_t end = begin + count;
+    const size_t buildings = sizes[SECTION_BUILDINGS];
+    if (end > sizes[section])
+    {
+        return 0;
+    }
+
+    bool valid = false;
+    switch (section)
+    {
+        case SECTION_BUILDINGS:
+            valid = readChunk(reader, snapshot.buildings, assembly.base_sizes[section], begin, count, changed);
+            break;
+        case SECTION_ROADS:
+            valid = readChunk(reader, snapshot.roads, assembly.base_sizes[section], begin, count, changed) &&
+                    isValid(snapshot.roads, begin, end, buildings);
+            break;
+        default:
+            valid = readChunk(reader, snapshot.cars, assembly.base_sizes[section], begin, count, changed) &&
+                    isValid(snapshot.cars, begin, end, buildings);
+            break;
+    }
+    if (!valid)
+    {
+        assembly.broken = true; // Partly read: the snapshot cannot be completed
+        return 0;
+    }
+    assembly.covered += count;
+
+    // Written to the game state at once, with the entities before it that
+    // the game state does not have yet, unless they refer to buildings it
+    // does not have yet. The buildings of the game state only grow here:
+    // its cars and roads may still refer to the last ones.
+    state.economy.money = money;
+    state.economy.tax_rate = tax_rate;
+    const bool has_buildings = (state.economy.buildings.size() >= buildings);
+    switch (section)
+    {
+        case SECTION_BUILDINGS:
+        {
+            auto& target = state.economy.buildings;
+            const size_t from = std::min(begin, target.size());
+            target.resize(std::max(target.size(), end));
+            restoreBuildings(snapshot, from, end, state);
+            break;
+        }
+        case SECTION_ROADS:
+        {
+            auto& target = state.traffic.roads;
+            const size_t from = std::min(begin, target.size());
+            if (has_buildings && isValid(snapshot.roads, from, end, buildings))
+            {
+                target.resize(std::max(target.size(), end));
+                restoreRoads(snapshot, from, end, state);
+            }
+            else
+            {
+                assembly.partial = true;
+            }
+            break;
+        }
+        default:
+        {
+            auto& target = state.traffic.cars;
+            const size_t from = std::min(begin, target.size());
+            if (has_buildings && isValid(snapshot.cars, from, end, buildings))
+            {
+                target.resize(std::max(target.size(), end));
+                restoreCars(snapshot, from, end, state);
+            }
+            else
+            {
+                assembly.partial = true;
+            }
+            break;
+        }
+    }
+    if (assembly.covered < total)
+    {
+        return 0;
+    }
+
+    // Last chunk: every range was checked when read. Removed entities, and
+    // the ones that could not be written yet, are written now.
+    if (assembly.partial || (sizesOf(state) != sizes))
+    {
+        restore(snapshot, state);
+    }
+    return history.pushSpare().tick;
+}
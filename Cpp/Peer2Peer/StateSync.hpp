@@ -0,0 +1,262 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include "GameState.hpp"
+#include "Serialization.hpp"
+#include <array>
+#include <vector>
+
+/**
+ * @brief Quantized copy of the game state at a given tick.
+ * @details This is what the host sends and what the clients rebuild: deltas
+ *          are computed between two snapshots, never against the float state,
+ *          so that the host and its clients agree bit for bit.
+ */
+struct StateSnapshot
+{
+    /**
+     * @brief Quantized car
+     */
+    struct Car
+    {
+        //! @brief Position in 1/POSITION_SCALE pixels
+        sf::Int16 x = 0, y = 0;
+        //! @brief Speed in 1/SPEED_SCALE pixels per second
+        sf::Uint16 speed = 0;
+        //! @brief Current color
+        sf::Color color;
+        //! @brief Index of the source building
+        sf::Int32 source_building_idx = 0;
+        //! @brief Index of the destination building
+        sf::Int32 destination_building_idx = 0;
+        //! @brief Index of the next building on the road, or -1
+        sf::Int32 waypoint_building_idx = -1;
+        //! @brief True if the car is returning to source
+        bool is_returning = false;
+    };
+
+    /**
+     * @brief Quantized building
+     */
+    struct Building
+    {
+        //! @brief Position in 1/POSITION_SCALE pixels
+        sf::Int16 x = 0, y = 0;
+        //! @brief Current color
+        sf::Color color;
+        //! @brief Income generated by the building
+        float income = 0.0f;
+    };
+
+    //! @brief Tick of the host when the snapshot was taken (0: none)
+    sf::Uint32 tick = 0;
+    //! @brief All cars
+    std::vector<Car> cars;
+    //! @brief All roads (not quantized)
+    std::vector<GameState::Road> roads;
+    //! @brief All buildings
+    std::vector<Building> buildings;
+    //! @brief Current money amount
+    float money = 0.0f;
+    //! @brief Current tax rate
+    float tax_rate = 0.0f;
+};
+
+/**
+ * @brief Progress of a snapshot rebuilt from the chunks of a delta (client).
+ * @details Sections are counted in the order of the chunks: buildings, roads
+ *          then cars.
+ */
+struct SnapshotAssembly
+{
+    //! @brief Tick of the snapshot, 0 if none
+    sf::Uint32 tick = 0;
+    //! @brief Tick of its base, 0 for a keyframe
+    sf::Uint32 base_tick = 0;
+    //! @brief Entities of each section of the snapshot
+    std::array<sf::Uint32, 3> sizes{};
+    //! @brief Entities of each section kept from the base
+    std::array<size_t, 3> base_sizes{};
+    //! @brief Entities of the chunks read, over all sections
+    size_t covered = 0;
+    //! @brief True if a chunk could not be written to the game state when
+    //! read: the snapshot is restored as a whole with its last chunk
+    bool partial = false;
+    //! @brief True if a chunk was malformed: the next chunks of the snapshot
+    //! are dropped
+    bool broken = false;
+};
+
+/**
+ * @brief Last snapshots sent (host) or received (client), to serve as delta
+ * bases.
+ * @details The snapshots live in a ring with one spare slot, filled by
+ *          capture() or decode() before being pushed. The dropped snapshot
+ *          becomes the spare, so once the history is warm, storing a snapshot
+ *          reuses the vectors of an older one instead of allocating. On a
+ *          client, the spare is the snapshot being rebuilt from its chunks.
+ */
+class SnapshotHistory
+{
+public:
+
+    //! @brief Number of snapshots kept
+    static constexpr size_t CAPACITY = 32;
+
+    /**
+     * @brief Gets the storage of the next snapshot, to fill before
+     *        pushSpare().
+     * @details It is never one of the stored snapshots: find() results stay
+     *          valid while it is written.
+     * @return The spare snapshot, holding stale data.
+     */
+    StateSnapshot& getSpare();
+
+    /**
+     * @brief Stores the spare snapshot, dropping the oldest one when full.
+     * @details The assembly of the next spare starts over.
+     * @return The stored snapshot.
+     */
+    const StateSnapshot& pushSpare();
+
+    /**
+     * @brief Gets the progress of the spare snapshot rebuilt from chunks.
+     * @return The assembly, kept until pushSpare() or clear().
+     */
+    SnapshotAssembly& getAssembly();
+
+    /**
+     * @brief Finds the snapshot taken at the given tick.
+     * @param[in] tick Tick of the snapshot.
+     * @return The snapshot or nullptr if it is unknown or too old.
+     */
+    const StateSnapshot* find(sf::Uint32 tick) const;
+
+    /**
+     * @brief Gets the tick of the newest snapshot.
+     * @return The tick, or 0 if there is no snapshot.
+     */
+    sf::Uint32 getLatestTick() const;
+
+    /**
+     * @brief Forgets all snapshots, keeping their storage.
+     */
+    void clear();
+
+private:
+
+    //! @brief Stored snapshots and the spare one
+    std::array<StateSnapshot, CAPACITY + 1> m_snapshots;
+    //! @brief Slot of the newest snapshot
+    size_t m_newest = 0;
+    //! @brief Number of stored snapshots
+    size_t m_count = 0;
+    //! @brief Progress of the spare snapshot rebuilt from chunks
+    SnapshotAssembly m_assembly;
+};
+
+/**
+ * @brief Delta compression of the game state sent by the host.
+ * @details The host keeps, for each peer, the tick of the last snapshot the
+ *          peer acknowledged and only sends the entities that changed since
+ *          that snapshot. Positions are quantized on 16 bits and the changed
+ *          fields of an entity are bit-packed in a single byte. A keyframe
+ *          (delta against nothing) is sent when there is no usable base and
+ *          every KEYFRAME_INTERVAL ticks, so that a client which lost its
+ *          base recovers.
+ *
+ *          A delta is split into chunks of at most CHUNK_SIZE bytes, each
+ *          holding a range of entities of one section with the header of the
+ *          snapshot, so that a delta of any size fits in datagrams and a
+ *          lost datagram only loses its own entities. The client writes each
+ *          chunk to the game state when it reads it, and acknowledges the
+ *          snapshot once it has read all of its chunks.
+ *
+ *          Layout of a chunk (little-endian):
+ *          - u32 tick, u32 base tick (0 for a keyframe)
+ *          - f32 money, f32 tax rate
+ *          - u32 buildings, u32 roads, u32 cars of the snapshot
+ *          - u32 first entity, counted over buildings, roads then cars
+ *          - u32 entities in the chunk, u32 changed entities
+ *          - per changed entity: index gap (varint), mask, changed fields
+ */
+class StateSync
+{
+public:
+
+    //! @brief Ticks between two keyframes
+    static constexpr sf::Uint32 KEYFRAME_INTERVAL = 60;
+    //! @brief Positions are sent with a 1/8 pixel precision
+    static constexpr float POSITION_SCALE = 8.0f;
+    //! @brief Speeds are sent with a 1/16 pixel per second precision
+    static constexpr float SPEED_SCALE = 16.0f;
+    //! @brief Largest chunk of a delta: with the message and datagram
+    //! headers, a chunk fits in ReliableChannel::MTU
+    static constexpr size_t CHUNK_SIZE = 1180;
+
+    /**
+     * @brief Delta being written chunk by chunk by encode().
+     */
+    struct Chunks
+    {
+        //! @brief Snapshot to send
+        const StateSnapshot* current = nullptr;
+        //! @brief Snapshot known by the receiver, or nullptr for a keyframe
+        const StateSnapshot* base = nullptr;
+        //! @brief First entity of the next chunk, counted over all sections
+        size_t next = 0;
+        //! @brief True once the last chunk is written
+        bool done = false;
+    };
+
+    /**
+     * @brief Quantizes the game state.
+     * @param[in] state Game state to capture.
+     * @param[in] tick Tick of the host.
+     * @param[out] snapshot Snapshot to overwrite, usually the spare one of a
+     *             SnapshotHistory, whose storage is reused.
+     */
+    static void capture(const GameState& state, sf::Uint32 tick, StateSnapshot& snapshot);
+
+    /**
+     * @brief Writes a snapshot back to the game state.
+     * @details The ranges of the traffic and economy updates assigned to this
+     *          node are kept, and so are the cars of its traffic range. The
+     *          cached target of a car is kept unless its route changed.
+     * @param[in] snapshot Snapshot to restore.
+     * @param[out] state Game state to update.
+     */
+    static void restore(const StateSnapshot& snapshot, GameState& state);
+
+    /**
+     * @brief Writes the next chunk of the difference between two snapshots.
+     * @details The entities of the chunk are compared twice, to count then
+     *          to write the changed ones, rather than keeping their masks in
+     *          between.
+     * @param[inout] writer Writer of the packet to append to.
+     * @param[inout] chunks Delta to write, moved to its next chunk.
+     * @return false, writing nothing, once all the chunks are written.
+     */
+    static bool encode(PacketWriter& writer, Chunks& chunks);
+
+    /**
+     * @brief Reads a chunk of a delta and writes its entities to the game
+     *        state.
+     * @details The first chunk read of a snapshot starts it from its base,
+     *          in the spare snapshot of the history. Every count is checked
+     *          against the bytes of the chunk before anything is allocated,
+     *          and entities are added in order only. Chunks of a snapshot
+     *          older than the one being rebuilt are dropped. Entities
+     *          referring to buildings the game state does not have yet are
+     *          written with the last chunk.
+     * @param[inout] reader Reader of the packet, at the start of the chunk.
+     * @param[inout] history Snapshots already received, to find the base, and
+     *               the snapshot being rebuilt.
+     * @param[inout] state Game state to update.
+     * @return The tick of the snapshot once its last chunk is read, the
+     *         snapshot being stored in the history. 0 while chunks are
+     *         missing, or if the base is unknown, the chunk is malformed or a
+     *         car or road refers to a missing building.
+     */
+    static sf::Uint32 decode(PacketReader& reader, SnapshotHistory& history,
+                             GameState& state);
+};
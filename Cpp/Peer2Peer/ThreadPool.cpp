@@ -0,0 +1,97 @@
+#include "ThreadPool.hpp"
+
+// ----------------------------------------------------------------------------
+ThreadPool::ThreadPool(size_t threads)
+{
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 1; i < threads; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+// ----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+// ----------------------------------------------------------------------------
+void ThreadPool::push(size_t index, std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+
+    // Under the lock: a worker about to sleep cannot miss the new task
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+    m_pending.fetch_add(1, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------
+bool ThreadPool::runOne(size_t index)
+{
+    std::function<void()> task;
+
+    // Own queue first, newest task (still hot in cache)
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        if (!m_queues[index]->tasks.empty())
+        {
+            task = std::move(m_queues[index]->tasks.back());
+            m_queues[index]->tasks.pop_back();
+        }
+    }
+
+    // Else steal the oldest task of another thread
+    for (size_t i = 1; !task && (i < m_queues.size()); ++i)
+    {
+        Queue& victim = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+    {
+        return false;
+    }
+    m_pending.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+void ThreadPool::work(size_t index)
+{
+    while (true)
+    {
+        if (runOne(index))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake.wait(lock, [this]() { return m_stop || (m_pending.load() != 0); });
+        if (m_stop && (m_pending.load() == 0))
+        {
+            return;
+        }
+    }
+}
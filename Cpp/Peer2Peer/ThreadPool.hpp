@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool.
+ * @details Each worker owns a queue of tasks. A worker pops its newest task
+ *          first and, when its queue is empty, steals the oldest task of
+ *          another worker, so that workers finishing early take over the
+ *          chunks of slower ones.
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * @brief Starts the workers.
+     * @param[in] threads Number of threads doing the work, including the
+     *            caller of parallelFor (so threads - 1 workers are started).
+     */
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+
+    /**
+     * @brief Stops the workers once their queues are empty.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Gets the number of threads doing the work, including the caller.
+     * @return Number of threads.
+     */
+    size_t size() const
+    {
+        return m_queues.size();
+    }
+
+    /**
+     * @brief Calls fn(chunk_begin, chunk_end) on chunks of [begin, end) in
+     *        parallel and waits for all of them.
+     * @param[in] begin First index.
+     * @param[in] end Past the last index.
+     * @param[in] grain Maximum number of indices per chunk.
+     * @param[in] fn Function called on each chunk. Chunks are disjoint.
+     */
+    template<class Function>
+    void parallelFor(size_t begin, size_t end, size_t grain, Function&& fn)
+    {
+        if (begin >= end)
+        {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+
+        // Not worth waking the workers
+        if ((end - begin <= grain) || (size() == 1))
+        {
+            fn(begin, end);
+            return;
+        }
+
+        std::atomic<size_t> remaining((end - begin + grain - 1) / grain);
+        size_t worker = 0;
+        for (size_t first = begin; first < end; first += grain)
+        {
+            const size_t last = std::min(first + grain, end);
+            push(worker, [&fn, &remaining, first, last]()
+            {
+                fn(first, last);
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+            worker = (worker + 1) % size();
+        }
+        m_wake.notify_all();
+
+        // The caller works too, then waits for the chunks stolen by others
+        while (remaining.load(std::memory_order_acquire) != 0)
+        {
+            if (!runOne(0))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+
+    //! @brief Tasks of one thread
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    /**
+     * @brief Queues a task for the given thread.
+     */
+    void push(size_t index, std::function<void()> task);
+
+    /**
+     * @brief Runs a task of the given thread, or steals one from another.
+     * @return false if all queues were empty.
+     */
+    bool runOne(size_t index);
+
+    /**
+     * @brief Loop of the worker threads.
+     */
+    void work(size_t index);
+
+private:
+
+    //! @brief One queue per thread, the caller of parallelFor uses the first
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    //! @brief Workers
+    std::vector<std::thread> m_threads;
+    //! @brief Number of queued tasks
+    std::atomic<size_t> m_pending{0};
+    //! @brief Set to stop the workers
+    std::atomic<bool> m_stop{false};
+    //! @brief Wakes up workers when tasks are queued
+    std::condition_variable m_wake;
+    //! @brief Protects m_wake
+    std::mutex m_wake_mutex;
+};
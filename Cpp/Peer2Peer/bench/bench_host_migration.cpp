@@ -0,0 +1,281 @@
+#include "NetworkNode.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// Host migration between processes on the loopback interface. One host and
+// N clients run NetworkNode at 60 Hz, each in its own process. Once every
+// client has the game state, the host process is killed (SIGKILL) and the
+// survivors report through a pipe when they elect or follow a new host and
+// when they get the state from it again. Failover times are given in ticks
+// of 1/60 s from the kill, with the cars simulated by each client before and
+// after. The bench fails if the survivors do not agree on a new host in
+// time, or if the new host does not spread the cars over its clients (each
+// one gets at least a quarter of an even share). Uses the discovery port of
+// the game.
+//
+// ./bench_host_migration
+// ----------------------------------------------------------------------------
+
+static constexpr unsigned short HOST_PORT = 46000;
+static constexpr size_t CARS = 10000;
+static constexpr double TICK = 1.0 / 60.0;
+static constexpr double WARMUP = 2.0;
+static constexpr double AFTER_KILL = 4.0;
+
+using Clock = std::chrono::steady_clock;
+
+// ----------------------------------------------------------------------------
+static double now()
+{
+    return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Body of a node process: never returns
+[[noreturn]] static void runNode(unsigned short port, bool hosting, int report)
+{
+    // The logs of NetworkNode are not wanted
+    int null = ::open("/dev/null", O_WRONLY);
+    ::dup2(null, STDOUT_FILENO);
+    ::dup2(null, STDERR_FILENO);
+
+    auto send = [report, port](const char* event, long value)
+    {
+        char line[128];
+        const int size = std::snprintf(line, sizeof(line), "%u %s %ld %.6f\n",
+                                       unsigned(port), event, value, now());
+        if (::write(report, line, size_t(size)) < 0)
+        {
+            std::_Exit(1);
+        }
+    };
+
+    GameState state;
+    if (hosting)
+    {
+        GameManager::createInitialState(state, CARS, CARS / 8);
+    }
+    NetworkNode node(port, hosting);
+    const sf::Color color(static_cast<sf::Uint8>(port * 37), 128, 200);
+
+    bool joined = false;
+    unsigned short host = 0;
+    sf::Uint32 host_changed_at = 0; // Last snapshot tick when the host changed
+    bool synced = true;
+    auto next = Clock::now();
+    for (long tick = 0;; ++tick)
+    {
+        node.update(float(TICK), state, color);
+
+        const sf::Uint32 snapshot = node.getSnapshotTick();
+        if (!joined && (snapshot != 0))
+        {
+            joined = true;
+            send("joined", long(snapshot));
+        }
+        if (node.getHostPort() != host)
+        {
+            host = node.getHostPort();
+            host_changed_at = snapshot;
+            synced = false;
+            send(node.isHost() ? "elected" : "host", long(host));
+        }
+        if (!synced && (snapshot > host_changed_at))
+        {
+            synced = true;
+            send("synced", long(snapshot));
+        }
+        if ((tick % 30) == 0)
+        {
+            send(node.isHost() ? "peers" : "range",
+                 node.isHost() ? long(node.getActivePeerCount()) : long(state.traffic.count));
+        }
+
+        next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(TICK));
+        std::this_thread::sleep_until(next);
+    }
+}
+
+//! @brief Events reported by a node
+struct Report
+{
+    bool joined = false;
+    double host_at = -1.0, synced_at = -1.0;
+    unsigned short host = 0;
+    bool elected = false;
+    long before = 0;     //!< Last range before the kill (client)
+    long last_value = 0; //!< Last range (client) or peer count (host)
+};
+
+// ----------------------------------------------------------------------------
+//! @brief Reads the complete lines of the pipe until the deadline
+static void collect(int pipe, double deadline, double kill_time, std::map<unsigned, Report>& reports)
+{
+    static std::string buffer;
+    while (now() < deadline)
+    {
+        pollfd fd{pipe, POLLIN, 0};
+        if (::poll(&fd, 1, 10) <= 0)
+        {
+            continue;
+        }
+        char data[4096];
+        const ssize_t size = ::read(pipe, data, sizeof(data));
+        if (size <= 0)
+        {
+            continue;
+        }
+        buffer.append(data, size_t(size));
+
+        size_t end;
+        while ((end = buffer.find('\n')) != std::string::npos)
+        {
+            unsigned port;
+            char event[32];
+            long value;
+            double time;
+            if (std::sscanf(buffer.c_str(), "%u %31s %ld %lf", &port, event, &value, &time) == 4)
+            {
+                Report& report = reports[port];
+                const bool after_kill = (kill_time > 0.0) && (time >= kill_time);
+                if (std::strcmp(event, "joined") == 0)
+                {
+                    report.joined = true;
+                }
+                else if (after_kill && ((std::strcmp(event, "host") == 0) || (std::strcmp(event, "elected") == 0)))
+                {
+                    report.host = static_cast<unsigned short>(value);
+                    report.elected = (event[0] == 'e');
+                    report.host_at = time;
+                    report.synced_at = -1.0;
+                }
+                else if (after_kill && (std::strcmp(event, "synced") == 0) && (report.synced_at < 0.0))
+                {
+                    report.synced_at = time;
+                }
+                else if ((std::strcmp(event, "peers") == 0) || (std::strcmp(event, "range") == 0))
+                {
+                    report.last_value = value;
+                    report.before = after_kill ? report.before : value;
+                }
+            }
+            buffer.erase(0, end + 1);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Runs a host and the given number of clients, kills the host
+//! @return true if the cars are spread over the clients of the new host
+static bool trial(size_t clients)
+{
+    int fds[2];
+    if (::pipe(fds) != 0)
+    {
+        std::perror("pipe");
+        return false;
+    }
+
+    std::vector<pid_t> pids;
+    for (size_t i = 0; i <= clients; ++i)
+    {
+        const pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            ::close(fds[0]);
+            runNode(static_cast<unsigned short>(HOST_PORT + i), i == 0, fds[1]);
+        }
+        pids.push_back(pid);
+        if (i == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Host first
+        }
+    }
+    ::close(fds[1]);
+
+    // Wait until every client got the state, then a bit more
+    std::map<unsigned, Report> reports;
+    const double start = now();
+    size_t joined = 0;
+    while ((joined < clients) && (now() < start + 15.0))
+    {
+        collect(fds[0], now() + 0.1, -1.0, reports);
+        joined = 0;
+        for (size_t i = 1; i <= clients; ++i)
+        {
+            joined += reports[unsigned(HOST_PORT + i)].joined ? 1 : 0;
+        }
+    }
+    collect(fds[0], now() + WARMUP, -1.0, reports);
+
+    const double kill_time = now();
+    ::kill(pids[0], SIGKILL);
+    collect(fds[0], kill_time + AFTER_KILL, kill_time, reports);
+
+    for (pid_t pid : pids)
+    {
+        ::kill(pid, SIGKILL);
+        ::waitpid(pid, nullptr, 0);
+    }
+    ::close(fds[0]);
+
+    // One line per survivor
+    std::printf("\n%zu clients (%zu joined), host %u killed\n", clients, joined, unsigned(HOST_PORT));
+    std::printf("%6s %12s %10s %12s %12s %14s\n", "port", "cars before", "new host", "role",
+                "host ticks", "synced ticks");
+    double failover = 0.0;
+    std::map<unsigned short, size_t> votes;
+    long smallest = long(CARS);
+    for (size_t i = 1; i <= clients; ++i)
+    {
+        const Report& report = reports[unsigned(HOST_PORT + i)];
+        const double host_ticks = (report.host_at >= 0.0) ? (report.host_at - kill_time) / TICK : -1.0;
+        const double synced_ticks = (report.synced_at >= 0.0) ? (report.synced_at - kill_time) / TICK : -1.0;
+        failover = ((synced_ticks < 0.0) || (failover < 0.0)) ? -1.0 : std::max(failover, synced_ticks);
+        ++votes[report.host];
+        smallest = report.elected ? smallest : std::min(smallest, report.last_value);
+
+        char role[32];
+        std::snprintf(role, sizeof(role), report.elected ? "host/%ld" : "cars %ld", report.last_value);
+        std::printf("%6u %12ld %10u %12s %12.1f %14.1f\n", unsigned(HOST_PORT + i), report.before,
+                    unsigned(report.host), role, host_ticks, synced_ticks);
+    }
+    if (failover < 0.0)
+    {
+        std::printf("failover: not completed in %.0f ticks\n", AFTER_KILL / TICK);
+        return false;
+    }
+    std::printf("failover: %.1f ticks, %s\n", failover,
+                (votes.size() == 1) ? "all survivors agree on the new host" : "survivors DISAGREE");
+
+    // The new host does not simulate: its clients share the cars
+    const long survivors = long(clients) - 1;
+    const bool spread = (survivors <= 0) || (smallest * survivors * 4 >= long(CARS));
+    std::printf("ranges: smallest %ld cars over %ld clients, %s\n", smallest, survivors,
+                spread ? "spread" : "NOT SPREAD");
+    return (votes.size() == 1) && spread;
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    std::signal(SIGPIPE, SIG_IGN);
+    bool ok = true;
+    for (size_t clients : {2u, 4u})
+    {
+        ok &= trial(clients);
+    }
+    return ok ? 0 : 1;
+}
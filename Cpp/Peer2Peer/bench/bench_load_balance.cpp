@@ -0,0 +1,254 @@
+#include "LoadBalancer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Simulated peers with artificial latency and speed, to test the
+// LoadBalancer without network. Each peer simulates its range continuously
+// and answers after each step, like NetworkNode does. The host counts how
+// many times per second every car has been merged (full updates), with an
+// even split of the cars and with the LoadBalancer. One peer stops answering
+// for a while. Then peers whose compute is negligible next to their jittered
+// round trips must keep spread shares, without new epochs: the bench fails
+// otherwise.
+//
+// ./bench_load_balance
+// ----------------------------------------------------------------------------
+
+static constexpr double DT = 0.001;
+static constexpr double DURATION = 12.0;
+
+//! @brief A simulated client
+struct SimPeer
+{
+    std::string name;
+    double speed;      //!< Cars per second
+    double round_trip; //!< Seconds
+    double down_from, down_to; //!< Does not answer during [from, to)
+
+    sf::Uint32 epoch = 0;
+    GameManager::Range range{0, 0};
+    double step_end = 0.0;
+    float step_time = 0.0f;
+};
+
+//! @brief A message in flight
+struct Message
+{
+    double arrival;
+    size_t peer;
+    sf::Uint32 epoch;
+    GameManager::Range range;
+    float compute_time;
+};
+
+//! @brief Result of one run
+struct Run
+{
+    std::vector<int> updates_per_second;
+    std::vector<std::string> shares;
+    size_t overlaps = 0;
+    sf::Uint32 epochs = 0;
+    size_t min_range = ~size_t(0); //!< Smallest range of a peer after the first second
+};
+
+// ----------------------------------------------------------------------------
+static Run simulate(std::vector<SimPeer> peers, bool adaptive, size_t cars)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> jitter(0.9, 1.1);
+
+    LoadBalancer balancer;
+    for (const auto& peer : peers)
+    {
+        balancer.addPeer(peer.name);
+    }
+    const auto even = GameManager::split(cars, peers.size());
+
+    std::deque<Message> to_peers, to_host;
+    std::vector<char> merged(cars, 0);
+    std::vector<sf::Int32> owner(cars, -1); // Peer merging each car this epoch
+    sf::Uint32 owner_epoch = 0;
+    size_t merged_count = 0;
+
+    Run run;
+    run.updates_per_second.assign(size_t(DURATION), 0);
+    auto send = [&](double now)
+    {
+        for (size_t i = 0; i < peers.size(); ++i)
+        {
+            const auto assignment = balancer.getAssignment(peers[i].name);
+            to_peers.push_back({now + peers[i].round_trip / 2, i, assignment.epoch, assignment.traffic, 0.0f});
+        }
+    };
+    if (!adaptive)
+    {
+        for (size_t i = 0; i < peers.size(); ++i)
+        {
+            to_peers.push_back({peers[i].round_trip / 2, i, 1, even[i], 0.0f});
+        }
+    }
+
+    for (double now = 0.0; now < DURATION; now += DT)
+    {
+        if (adaptive && balancer.update(float(DT), cars, cars / 10))
+        {
+            send(now);
+        }
+
+        // Peers get their ranges, step and answer
+        while (!to_peers.empty() && (to_peers.front().arrival <= now))
+        {
+            const Message& message = to_peers.front();
+            SimPeer& peer = peers[message.peer];
+            if ((now < peer.down_from) || (now >= peer.down_to))
+            {
+                peer.epoch = message.epoch;
+                peer.range = message.range;
+            }
+            to_peers.pop_front();
+        }
+        for (size_t i = 0; i < peers.size(); ++i)
+        {
+            SimPeer& peer = peers[i];
+            const bool down = (now >= peer.down_from) && (now < peer.down_to);
+            if ((peer.epoch == 0) || down || (now < peer.step_end))
+            {
+                continue;
+            }
+            if (peer.step_end > 0.0)
+            {
+                to_host.push_back({now + peer.round_trip / 2 * jitter(gen), i, peer.epoch, peer.range, peer.step_time});
+            }
+            // Steps last at least a frame, the time reported is the compute
+            peer.step_time = float(peer.range.count / peer.speed * jitter(gen));
+            peer.step_end = now + std::max(DT, double(peer.step_time));
+        }
+
+        // Host merges the answers
+        std::sort(to_host.begin(), to_host.end(), [](const Message& a, const Message& b)
+        {
+            return a.arrival < b.arrival;
+        });
+        while (!to_host.empty() && (to_host.front().arrival <= now))
+        {
+            const Message message = to_host.front();
+            to_host.pop_front();
+            const std::string& name = peers[message.peer].name;
+            balancer.onRoundTrip(name, float(peers[message.peer].round_trip * jitter(gen)));
+            balancer.onResponse(name, message.range.count, message.compute_time);
+
+            const bool accepted = adaptive
+                ? balancer.accept(name, message.epoch, message.range, true)
+                : (message.range.startIdx == even[message.peer].startIdx);
+            if (!accepted)
+            {
+                continue;
+            }
+            if (message.epoch != owner_epoch)
+            {
+                std::fill(owner.begin(), owner.end(), -1);
+                owner_epoch = message.epoch;
+            }
+            for (size_t car = message.range.startIdx; car < size_t(message.range.startIdx) + message.range.count; ++car)
+            {
+                run.overlaps += (owner[car] != -1) && (owner[car] != sf::Int32(message.peer));
+                owner[car] = sf::Int32(message.peer);
+                if (!merged[car])
+                {
+                    merged[car] = 1;
+                    ++merged_count;
+                }
+            }
+            if (merged_count == cars)
+            {
+                ++run.updates_per_second[size_t(now)];
+                std::fill(merged.begin(), merged.end(), 0);
+                merged_count = 0;
+            }
+        }
+
+        // Shares at the end of each second
+        if (size_t(now + DT) != size_t(now))
+        {
+            std::string shares;
+            for (const auto& peer : peers)
+            {
+                const auto range = adaptive ? balancer.getAssignment(peer.name).traffic : even[&peer - &peers[0]];
+                shares += std::to_string(range.count * 100 / cars) + "% ";
+                run.min_range = (now >= 1.0) ? std::min<size_t>(run.min_range, range.count) : run.min_range;
+            }
+            run.shares.push_back(shares);
+        }
+    }
+    run.epochs = balancer.getEpoch();
+    return run;
+}
+
+// ----------------------------------------------------------------------------
+static void report(const std::vector<SimPeer>& peers, size_t cars)
+{
+    const Run even = simulate(peers, false, cars);
+    const Run adaptive = simulate(peers, true, cars);
+
+    std::printf("\nFull updates of %zu cars per second\n", cars);
+    std::printf("%6s %8s %10s   %s\n", "second", "even", "adaptive", "adaptive shares (fast medium slow flaky)");
+    int even_total = 0, adaptive_total = 0;
+    for (size_t second = 0; second < even.updates_per_second.size(); ++second)
+    {
+        std::printf("%6zu %8d %10d   %s\n", second, even.updates_per_second[second],
+                    adaptive.updates_per_second[second], adaptive.shares[second].c_str());
+        even_total += even.updates_per_second[second];
+        adaptive_total += adaptive.updates_per_second[second];
+    }
+    std::printf("total  %8d %10d\noverlapping merges: %zu (even), %zu (adaptive)\n",
+                even_total, adaptive_total, even.overlaps, adaptive.overlaps);
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Checks that compute negligible next to the round trips keeps the
+//! cars spread over all peers, on the first epoch
+static bool reportRoundTripBound(size_t cars)
+{
+    const std::vector<SimPeer> peers = {
+        {"a", 1.0e9, 0.010, 1e9, 1e9},
+        {"b", 1.0e9, 0.011, 1e9, 1e9},
+        {"c", 1.0e9, 0.012, 1e9, 1e9},
+    };
+    const Run run = simulate(peers, true, cars);
+
+    std::printf("\nShares of %zu cars, round trips of 10/11/12 ms +-10%%, compute < 1 us\n", cars);
+    std::printf("%6s   %s\n", "second", "shares (a b c)");
+    for (size_t second = 0; second < run.shares.size(); ++second)
+    {
+        std::printf("%6zu   %s\n", second, run.shares[second].c_str());
+    }
+
+    // Every peer keeps at least a quarter of an even share
+    const bool spread = run.min_range * peers.size() * 4 >= cars;
+    std::printf("epochs: %u, smallest range: %zu cars: %s\n", unsigned(run.epochs), run.min_range,
+                (spread && (run.epochs == 1)) ? "ok" : "FAILED");
+    return spread && (run.epochs == 1);
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    const std::vector<SimPeer> peers = {
+        {"fast", 4.0e6, 0.010, 1e9, 1e9},
+        {"medium", 2.0e6, 0.030, 1e9, 1e9},
+        {"slow", 0.5e6, 0.080, 1e9, 1e9},
+        {"flaky", 2.0e6, 0.020, 4.0, 8.0},
+    };
+    std::printf("Peers: fast (4M cars/s, 10 ms), medium (2M/s, 30 ms), slow (0.5M/s, 80 ms),\n"
+                "flaky (2M/s, 20 ms, silent from 4 to 8 s)\n");
+    for (size_t cars : {100000u, 1000000u})
+    {
+        report(peers, cars);
+    }
+    return reportRoundTripBound(1000) ? 0 : 1;
+}
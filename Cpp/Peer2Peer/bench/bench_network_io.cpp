@@ -0,0 +1,189 @@
+#include "NetworkIO.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// ----------------------------------------------------------------------------
+// Loopback UDP reception, as the frame loop of NetworkNode sees it: a sender
+// thread floods the game port while the frame loop runs 2 ms frames and, at
+// the start of each one, either polls a non-blocking sf::UdpSocket until
+// NotReady (previous NetworkNode) or drains the queue of the NetworkIO thread
+// (epoll + recvmmsg + SPSC queue). Reports the datagrams received and the
+// time the frame loop spends receiving. Then compares the lookup of the
+// sending peer by a scan of the peer map against the (address, port) index.
+//
+// ./bench_network_io
+// ----------------------------------------------------------------------------
+
+static constexpr unsigned short PORT = 47000;
+static constexpr double DURATION = 2.0;
+static constexpr double FRAME = 0.002;
+static constexpr size_t PAYLOAD = 64;
+
+using Clock = std::chrono::steady_clock;
+
+//! @brief Result of one run
+struct Run
+{
+    size_t sent = 0;
+    size_t received = 0;
+    double receive_time = 0.0; //!< Seconds spent receiving by the frame loop
+};
+
+// ----------------------------------------------------------------------------
+template<class Receive>
+static Run flood(unsigned short port, Receive&& receive)
+{
+    std::atomic<bool> running{true};
+    std::atomic<size_t> sent{0};
+    std::thread sender([&]
+    {
+        sf::UdpSocket socket;
+        sf::Packet packet;
+        packet.append(std::string(PAYLOAD, 'x').data(), PAYLOAD);
+        while (running)
+        {
+            if (socket.send(packet, sf::IpAddress::LocalHost, port) == sf::Socket::Done)
+            {
+                sent.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    Run run;
+    const auto start = Clock::now();
+    auto frame = start;
+    while (frame - start < std::chrono::duration<double>(DURATION))
+    {
+        const auto before = Clock::now();
+        run.received += receive();
+        run.receive_time += std::chrono::duration<double>(Clock::now() - before).count();
+
+        frame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FRAME));
+        std::this_thread::sleep_until(frame); // Simulation and rendering
+    }
+    running = false;
+    sender.join();
+    run.sent = sent;
+    return run;
+}
+
+// ----------------------------------------------------------------------------
+static void print(const char* name, const Run& run)
+{
+    std::printf("%-22s %10.0f %10.0f %9.1f%% %14.1f %11.0f\n", name,
+                double(run.sent) / DURATION, double(run.received) / DURATION,
+                100.0 * double(run.received) / double(run.sent),
+                1e6 * run.receive_time / (DURATION / FRAME),
+                (run.received != 0) ? 1e9 * run.receive_time / double(run.received) : 0.0);
+}
+
+// ----------------------------------------------------------------------------
+static void benchReception()
+{
+    std::printf("%-22s %10s %10s %10s %14s %11s\n", "receiver", "sent/s",
+                "received/s", "received", "us/frame", "ns/packet");
+
+    {
+        sf::UdpSocket socket;
+        socket.bind(PORT);
+        socket.setBlocking(false);
+        sf::Packet packet;
+        sf::IpAddress sender;
+        unsigned short port;
+        print("polling sf::UdpSocket", flood(PORT, [&]
+        {
+            size_t count = 0;
+            while (socket.receive(packet, sender, port) == sf::Socket::Done)
+            {
+                ++count;
+            }
+            return count;
+        }));
+    }
+
+    {
+        NetworkIO io(PORT + 1, sf::Socket::AnyPort);
+        Run run = flood(PORT + 1, [&]
+        {
+            size_t count = 0;
+            while (io.front() != nullptr)
+            {
+                io.pop();
+                ++count;
+            }
+            return count;
+        });
+        print("NetworkIO thread", run);
+        std::printf("  dropped by the full queue: %llu\n",
+                    static_cast<unsigned long long>(io.getDroppedCount()));
+    }
+}
+
+// ----------------------------------------------------------------------------
+static void benchLookup()
+{
+    struct PeerInfo
+    {
+        sf::IpAddress address;
+        unsigned short port;
+    };
+    auto key = [](const sf::IpAddress& address, unsigned short port)
+    {
+        return (sf::Uint64(address.toInteger()) << 16) | port;
+    };
+
+    std::printf("\n%6s %14s %14s\n", "peers", "scan ns", "index ns");
+    for (size_t peers : {4u, 16u, 64u, 256u})
+    {
+        std::map<std::string, PeerInfo> map;
+        std::unordered_map<sf::Uint64, std::string> index;
+        for (size_t i = 0; i < peers; ++i)
+        {
+            const unsigned short port = static_cast<unsigned short>(50000 + i);
+            map["client_" + std::to_string(port)] = {sf::IpAddress::LocalHost, port};
+            index[key(sf::IpAddress::LocalHost, port)] = "client_" + std::to_string(port);
+        }
+
+        constexpr size_t LOOKUPS = 1000000;
+        size_t found = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < LOOKUPS; ++i)
+        {
+            const unsigned short port = static_cast<unsigned short>(50000 + (i * 7919) % peers);
+            for (const auto& [name, peer] : map)
+            {
+                if ((peer.address == sf::IpAddress::LocalHost) && (peer.port == port))
+                {
+                    found += name.size();
+                    break;
+                }
+            }
+        }
+        const double scan = std::chrono::duration<double>(Clock::now() - start).count();
+
+        start = Clock::now();
+        for (size_t i = 0; i < LOOKUPS; ++i)
+        {
+            const unsigned short port = static_cast<unsigned short>(50000 + (i * 7919) % peers);
+            auto it = index.find(key(sf::IpAddress::LocalHost, port));
+            found += (it != index.end()) ? it->second.size() : 0;
+        }
+        const double hashed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::printf("%6zu %14.1f %14.1f%s\n", peers, 1e9 * scan / LOOKUPS,
+                    1e9 * hashed / LOOKUPS, (found == 0) ? " (not found)" : "");
+    }
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    benchReception();
+    benchLookup();
+    return 0;
+}
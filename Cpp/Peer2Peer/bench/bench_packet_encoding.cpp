@@ -0,0 +1,318 @@
+#include "GameManager.hpp"
+#include "NetworkProtocol.hpp"
+#include "PacketPool.hpp"
+#include "StateSync.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// ----------------------------------------------------------------------------
+// Heap allocations, bytes and time of a full STATE_SYNC of 100k cars: the
+// former encoding (a new sf::Packet per message, every field appended in
+// network order, cars converted one by one) against the pooled packet and
+// the fixed-layout little-endian writer and reader of Serialization.hpp.
+// Then the same for the STATE_DELTA the host actually sends every tick:
+// capture into the snapshot history, delta against the acknowledged
+// snapshot, rebuild and restore on the client. Every call to operator new of
+// the process is counted.
+//
+// ./bench_packet_encoding
+// ----------------------------------------------------------------------------
+
+static constexpr size_t CARS = 100000;
+static constexpr int SYNCS = 50;
+
+static size_t g_allocations = 0;
+
+// ----------------------------------------------------------------------------
+void* operator new(size_t size)
+{
+    ++g_allocations;
+    if (void* memory = std::malloc(size != 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// ----------------------------------------------------------------------------
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+// ----------------------------------------------------------------------------
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// ----------------------------------------------------------------------------
+//! @brief The former Serialization.hpp: one operator per field
+static sf::Packet& operator<<(sf::Packet& packet, const sf::Color& color)
+{
+    return packet << color.r << color.g << color.b << color.a;
+}
+
+static sf::Packet& operator>>(sf::Packet& packet, sf::Color& color)
+{
+    return packet >> color.r >> color.g >> color.b >> color.a;
+}
+
+// ----------------------------------------------------------------------------
+static sf::Packet legacyEncode(const GameState& state)
+{
+    sf::Packet packet;
+    packet << static_cast<sf::Uint8>(GameMessageType::STATE_SYNC);
+    packet << static_cast<sf::Uint32>(state.traffic.cars.size());
+    for (size_t i = 0; i < state.traffic.cars.size(); ++i)
+    {
+        const GameState::Car car = state.traffic.cars.get(i);
+        packet << car.position.x << car.position.y << car.speed << car.color
+               << car.source_building_idx << car.destination_building_idx
+               << car.waypoint_building_idx << car.is_returning;
+    }
+    packet << static_cast<sf::Uint32>(state.traffic.roads.size());
+    for (const auto& road : state.traffic.roads)
+    {
+        packet << road.building1_idx << road.building2_idx << road.color;
+    }
+    packet << static_cast<sf::Uint32>(state.economy.buildings.size());
+    for (const auto& building : state.economy.buildings)
+    {
+        packet << building.position.x << building.position.y << building.color << building.income;
+    }
+    packet << state.economy.money << state.economy.tax_rate;
+    return packet;
+}
+
+// ----------------------------------------------------------------------------
+static void legacyDecode(sf::Packet& packet, GameState& state)
+{
+    sf::Uint8 type = 0;
+    sf::Uint32 count = 0;
+    packet >> type >> count;
+    state.traffic.cars.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        GameState::Car car;
+        packet >> car.position.x >> car.position.y >> car.speed >> car.color
+               >> car.source_building_idx >> car.destination_building_idx
+               >> car.waypoint_building_idx >> car.is_returning;
+        state.traffic.cars.set(i, car);
+    }
+    packet >> count;
+    state.traffic.roads.resize(count);
+    for (auto& road : state.traffic.roads)
+    {
+        packet >> road.building1_idx >> road.building2_idx >> road.color;
+    }
+    packet >> count;
+    state.economy.buildings.resize(count);
+    for (auto& building : state.economy.buildings)
+    {
+        packet >> building.position.x >> building.position.y >> building.color >> building.income;
+    }
+    packet >> state.economy.money >> state.economy.tax_rate;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Same cars, buildings and money
+static bool same(const GameState& a, const GameState& b)
+{
+    if ((a.traffic.cars.size() != b.traffic.cars.size()) ||
+        (a.economy.buildings.size() != b.economy.buildings.size()) ||
+        (a.traffic.roads.size() != b.traffic.roads.size()) ||
+        (a.economy.money != b.economy.money))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.traffic.cars.size(); ++i)
+    {
+        const auto ca = a.traffic.cars.get(i), cb = b.traffic.cars.get(i);
+        if ((ca.position != cb.position) || (ca.speed != cb.speed) || (ca.color != cb.color) ||
+            (ca.waypoint_building_idx != cb.waypoint_building_idx) || (ca.is_returning != cb.is_returning))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! @brief Measures of one encoding
+struct Result
+{
+    double encode_allocations = 0, decode_allocations = 0;
+    double encode_us = 0, decode_us = 0;
+    size_t bytes = 0;
+    bool synced = false;
+};
+
+// ----------------------------------------------------------------------------
+template<class Encode, class Decode>
+static Result measure(const GameState& host, Encode&& encode, Decode&& decode)
+{
+    using Clock = std::chrono::steady_clock;
+    GameState client;
+    Result result;
+    for (int sync = -1; sync < SYNCS; ++sync) // The first sync warms up
+    {
+        size_t allocations = g_allocations;
+        auto start = Clock::now();
+        encode(host, [&](sf::Packet& packet)
+        {
+            const double encode_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            const size_t encode_allocations = g_allocations - allocations;
+            result.bytes = packet.getDataSize();
+
+            allocations = g_allocations;
+            start = Clock::now();
+            decode(packet, client);
+            if (sync >= 0)
+            {
+                result.encode_us += encode_us / SYNCS;
+                result.encode_allocations += double(encode_allocations) / SYNCS;
+                result.decode_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count() / SYNCS;
+                result.decode_allocations += double(g_allocations - allocations) / SYNCS;
+            }
+        });
+    }
+    result.synced = same(host, client);
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Same quantized cars in both snapshots, every field compared
+static bool same(const StateSnapshot& a, const StateSnapshot& b)
+{
+    if ((a.cars.size() != b.cars.size()) || (a.buildings.size() != b.buildings.size()) ||
+        (a.roads.size() != b.roads.size()) || (a.money != b.money))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.cars.size(); ++i)
+    {
+        const auto& ca = a.cars[i];
+        const auto& cb = b.cars[i];
+        if ((ca.x != cb.x) || (ca.y != cb.y) || (ca.speed != cb.speed) || (ca.color != cb.color) ||
+            (ca.source_building_idx != cb.source_building_idx) ||
+            (ca.destination_building_idx != cb.destination_building_idx) ||
+            (ca.waypoint_building_idx != cb.waypoint_building_idx) ||
+            (ca.is_returning != cb.is_returning))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief One STATE_DELTA per tick from the host, simulating every car, to a
+//! client acknowledging each of them, as NetworkNode does: the chunks of the
+//! delta are encoded into pooled packets, then decoded. The history is warmed
+//! up first: each of its slots allocates the first time it is filled.
+static Result measureDelta(GameState host, bool keyframes)
+{
+    using Clock = std::chrono::steady_clock;
+    static constexpr int WARMUP = static_cast<int>(SnapshotHistory::CAPACITY) + 2;
+
+    host.traffic.startIdx = host.economy.startIdx = 0;
+    host.traffic.count = static_cast<sf::Uint32>(host.traffic.cars.size());
+    host.economy.count = static_cast<sf::Uint32>(host.economy.buildings.size());
+
+    PacketPool pool;
+    std::vector<PacketPool::Handle> packets;
+    SnapshotHistory host_history, client_history;
+    GameState client;
+    sf::Uint32 acked_tick = 0;
+    Result result;
+    for (int tick = 1; tick <= WARMUP + SYNCS; ++tick)
+    {
+        GameManager::update(host, 1.0f / 60.0f, sf::Color::Green);
+        packets.clear();
+
+        size_t allocations = g_allocations;
+        auto start = Clock::now();
+        StateSync::capture(host, static_cast<sf::Uint32>(tick), host_history.getSpare());
+        StateSync::Chunks chunks;
+        chunks.current = &host_history.pushSpare();
+        chunks.base = keyframes ? nullptr : host_history.find(acked_tick);
+        packets.push_back(pool.acquire());
+        while (NetworkProtocol::createStateDeltaPacket(*packets.back(), chunks))
+        {
+            packets.push_back(pool.acquire());
+        }
+        const double encode_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        const size_t encode_allocations = g_allocations - allocations;
+
+        allocations = g_allocations;
+        start = Clock::now();
+        size_t bytes = 0;
+        for (const auto& packet : packets)
+        {
+            bytes += packet->getDataSize();
+            acked_tick = std::max(acked_tick, NetworkProtocol::processStateDelta(*packet, client_history, client));
+        }
+        if (tick > WARMUP)
+        {
+            result.bytes = bytes;
+            result.encode_us += encode_us / SYNCS;
+            result.encode_allocations += double(encode_allocations) / SYNCS;
+            result.decode_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count() / SYNCS;
+            result.decode_allocations += double(g_allocations - allocations) / SYNCS;
+        }
+    }
+    const StateSnapshot* received = client_history.find(acked_tick);
+    result.synced = (acked_tick == WARMUP + SYNCS) && (received != nullptr) &&
+                    same(*received, *host_history.find(acked_tick));
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+static void print(const char* name, const Result& result)
+{
+    std::printf("%-22s %10zu %12.1f %12.1f %10.0f %10.0f %7s\n", name, result.bytes,
+                result.encode_allocations, result.decode_allocations,
+                result.encode_us, result.decode_us, result.synced ? "yes" : "no");
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    GameState host;
+    GameManager::createInitialState(host, CARS, CARS / 8);
+    for (int i = 0; i < 30; ++i)
+    {
+        GameManager::update(host, 1.0f / 60.0f, sf::Color::Green);
+    }
+
+    std::printf("STATE_SYNC of %zu cars, %zu buildings, average of %d syncs\n",
+                host.traffic.cars.size(), host.economy.buildings.size(), SYNCS);
+    std::printf("%-22s %10s %12s %12s %10s %10s %7s\n", "encoding", "bytes",
+                "encode allocs", "decode allocs", "encode us", "decode us", "synced");
+
+    print("sf::Packet per field", measure(host,
+        [](const GameState& state, auto&& send)
+        {
+            sf::Packet packet = legacyEncode(state);
+            send(packet);
+        },
+        [](sf::Packet& packet, GameState& state) { legacyDecode(packet, state); }));
+
+    PacketPool pool;
+    print("pooled fixed layout", measure(host,
+        [&pool](const GameState& state, auto&& send)
+        {
+            auto packet = pool.acquire();
+            NetworkProtocol::createStateSyncPacket(*packet, state);
+            send(*packet);
+        },
+        [](sf::Packet& packet, GameState& state) { NetworkProtocol::processStateSync(packet, state); }));
+
+    std::printf("\nSTATE_DELTA, one per tick, average of %d ticks\n", SYNCS);
+    print("pooled keyframe", measureDelta(host, true));
+    print("pooled delta", measureDelta(host, false));
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include "NetworkIO.hpp"
+#include "ReliableChannel.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <thread>
+
+// ----------------------------------------------------------------------------
+// A host and a client exchanging the messages of a game tick at 60 Hz
+// through a local UDP proxy that delays every datagram by 10 ms and drops a
+// share of them. Each tick the host sends a delta (400 bytes) and, every
+// other tick, a traffic and an economy assignment (the critical messages);
+// the client answers with its cars (600 bytes), its buildings (100 bytes)
+// and a state ack. Compares one datagram per message, as NetworkNode sent
+// them before, with a ReliableChannel per side: datagrams per tick, share
+// of assignments delivered, in order without gaps or not, their latency,
+// and the share of the other messages delivered.
+//
+// ./bench_reliable_channel
+// ----------------------------------------------------------------------------
+
+static constexpr unsigned short HOST_PORT = 47100;
+static constexpr unsigned short CLIENT_PORT = 47101;
+//! @brief Proxy ports: the host sends to the first, the client to the second
+static constexpr unsigned short PROXY_PORT = 47102;
+static constexpr double DELAY = 0.010;
+static constexpr float TICK = 1.0f / 60.0f;
+static constexpr int TICKS = 180;
+//! @brief Ticks after the last message, for the reliable ones to arrive
+static constexpr int DRAIN_TICKS = 60;
+
+using Clock = std::chrono::steady_clock;
+
+// ----------------------------------------------------------------------------
+//! @brief Forwards datagrams between the host and the client, delayed, some
+//! dropped
+class Proxy
+{
+public:
+
+    explicit Proxy(double loss)
+        : m_loss(loss)
+    {
+        m_client_side.bind(PROXY_PORT + 1);
+        m_host_side.bind(PROXY_PORT);
+        m_client_side.setBlocking(false);
+        m_host_side.setBlocking(false);
+        m_thread = std::thread([this] { run(); });
+    }
+
+    ~Proxy()
+    {
+        m_running = false;
+        m_thread.join();
+    }
+
+private:
+
+    struct Delayed
+    {
+        Clock::time_point time;
+        bool to_client;
+        sf::Packet packet;
+    };
+
+    void run()
+    {
+        std::mt19937 gen(42);
+        std::bernoulli_distribution drop(m_loss);
+        std::deque<Delayed> queue;
+        sf::Packet packet;
+        sf::IpAddress sender;
+        unsigned short port = 0;
+        while (m_running)
+        {
+            // Host -> host side -> client side -> client, and back
+            const auto due = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(DELAY));
+            while (m_host_side.receive(packet, sender, port) == sf::Socket::Done)
+            {
+                if (!drop(gen))
+                {
+                    queue.push_back({due, true, packet});
+                }
+            }
+            while (m_client_side.receive(packet, sender, port) == sf::Socket::Done)
+            {
+                if (!drop(gen))
+                {
+                    queue.push_back({due, false, packet});
+                }
+            }
+            while (!queue.empty() && (queue.front().time <= Clock::now()))
+            {
+                Delayed& delayed = queue.front();
+                if (delayed.to_client)
+                {
+                    m_client_side.send(delayed.packet, sf::IpAddress::LocalHost, CLIENT_PORT);
+                }
+                else
+                {
+                    m_host_side.send(delayed.packet, sf::IpAddress::LocalHost, HOST_PORT);
+                }
+                queue.pop_front();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    double m_loss;
+    //! @brief Seen by the host as the client
+    sf::UdpSocket m_host_side;
+    //! @brief Seen by the client as the host
+    sf::UdpSocket m_client_side;
+    std::atomic<bool> m_running{true};
+    std::thread m_thread;
+};
+
+//! @brief Kind of a message, its first byte
+enum Kind : sf::Uint8 { ASSIGNMENT, DELTA, CARS, BUILDINGS, ACK };
+
+//! @brief Result of one run
+struct Run
+{
+    size_t datagrams = 0;
+    size_t assignments = 0;
+    size_t assignments_received = 0;
+    bool in_order = true;
+    double latency_sum = 0.0;
+    double latency_max = 0.0;
+    size_t others = 0;
+    size_t others_received = 0;
+    sf::Uint64 resent = 0;
+};
+
+// ----------------------------------------------------------------------------
+static void makeMessage(sf::Packet& packet, Kind kind, sf::Uint32 index, size_t size)
+{
+    static const char padding[1024] = {};
+    packet.clear();
+    PacketWriter(packet).write(static_cast<sf::Uint8>(kind)).write(index);
+    packet.append(padding, size - packet.getDataSize());
+}
+
+// ----------------------------------------------------------------------------
+static Run play(double loss, bool channels)
+{
+    Proxy proxy(loss);
+    NetworkIO host_io(HOST_PORT, sf::Socket::AnyPort);
+    NetworkIO client_io(CLIENT_PORT, sf::Socket::AnyPort);
+    PacketPool pool;
+    ReliableChannel host(pool), client(pool);
+    std::vector<PacketPool::Handle> messages;
+    sf::Packet packet;
+
+    Run run;
+    std::vector<Clock::time_point> sent_at;
+    std::vector<bool> received;
+    sf::Uint32 last = 0, others = 0;
+
+    // Sends from one side: queued on its channel, or a datagram each
+    auto send = [&](bool from_host, Kind kind, size_t size)
+    {
+        const sf::Uint32 index = (kind == ASSIGNMENT) ? sf::Uint32(sent_at.size()) : others++;
+        makeMessage(packet, kind, index, size);
+        if (kind == ASSIGNMENT)
+        {
+            sent_at.push_back(Clock::now());
+            received.push_back(false);
+        }
+        if (channels)
+        {
+            (from_host ? host : client).send(packet, kind == ASSIGNMENT);
+        }
+        else
+        {
+            (from_host ? host_io : client_io).send(packet, sf::IpAddress::LocalHost,
+                                                   from_host ? PROXY_PORT : PROXY_PORT + 1);
+            ++run.datagrams;
+        }
+    };
+
+    auto process = [&](sf::Packet& message)
+    {
+        PacketReader reader(message);
+        sf::Uint8 kind = 0;
+        sf::Uint32 index = 0;
+        reader.read(kind);
+        reader.read(index);
+        if (kind != ASSIGNMENT)
+        {
+            ++run.others_received;
+        }
+        else if ((index < received.size()) && !received[index])
+        {
+            received[index] = true;
+            ++run.assignments_received;
+            run.in_order = run.in_order && ((index == 0) || (index == last + 1));
+            last = index;
+            const double latency = std::chrono::duration<double>(Clock::now() - sent_at[index]).count();
+            run.latency_sum += latency;
+            run.latency_max = std::max(run.latency_max, latency);
+        }
+    };
+
+    auto receive = [&](NetworkIO& io, ReliableChannel& channel)
+    {
+        while (NetworkIO::Datagram* datagram = io.front())
+        {
+            if (channels)
+            {
+                channel.receive(datagram->packet, messages);
+                for (auto& message : messages)
+                {
+                    process(*message);
+                }
+                messages.clear();
+            }
+            else
+            {
+                process(datagram->packet);
+            }
+            io.pop();
+        }
+    };
+
+    auto frame = Clock::now();
+    for (int tick = 0; tick < TICKS + DRAIN_TICKS; ++tick)
+    {
+        receive(host_io, host);
+        receive(client_io, client);
+        if (tick < TICKS)
+        {
+            send(true, DELTA, 400);
+            if (tick % 2 == 0)
+            {
+                send(true, ASSIGNMENT, 13);
+                send(true, ASSIGNMENT, 13);
+            }
+            send(false, CARS, 600);
+            send(false, BUILDINGS, 100);
+            send(false, ACK, 5);
+        }
+        if (channels)
+        {
+            const size_t datagrams = host.flush(TICK, host_io, sf::IpAddress::LocalHost, PROXY_PORT) +
+                                     client.flush(TICK, client_io, sf::IpAddress::LocalHost, PROXY_PORT + 1);
+            run.datagrams += (tick < TICKS) ? datagrams : 0;
+        }
+        frame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(TICK));
+        std::this_thread::sleep_until(frame);
+    }
+
+    run.assignments = sent_at.size();
+    run.others = others;
+    run.resent = host.getResentCount();
+    return run;
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    std::printf("%5s %-24s %14s %12s %9s %11s %11s %8s %8s\n", "loss", "sender",
+                "datagrams/tick", "assignments", "in order", "latency ms", "max ms",
+                "resent", "others");
+    for (double loss : {0.0, 0.05, 0.2})
+    {
+        for (bool channels : {false, true})
+        {
+            const Run run = play(loss, channels);
+            std::printf("%4.0f%% %-24s %14.2f %11.1f%% %9s %11.1f %11.1f %8llu %7.1f%%\n",
+                        100.0 * loss, channels ? "ReliableChannel" : "datagram per message",
+                        double(run.datagrams) / TICKS,
+                        100.0 * double(run.assignments_received) / double(run.assignments),
+                        run.in_order ? "yes" : "no",
+                        (run.assignments_received != 0) ? 1e3 * run.latency_sum / double(run.assignments_received) : 0.0,
+                        1e3 * run.latency_max, static_cast<unsigned long long>(run.resent),
+                        100.0 * double(run.others_received) / double(run.others));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "SimulationEngine.hpp"
+#include <chrono>
+#include <cstdio>
+
+// ----------------------------------------------------------------------------
+// Ticks per second of the SimulationEngine against the number of cars and of
+// threads. The whole city is simulated by this node.
+//
+// ./bench_simulation
+// ----------------------------------------------------------------------------
+
+//! @brief Simulated time of each measure in ticks
+static constexpr size_t TICKS = 120;
+
+// ----------------------------------------------------------------------------
+static double ticksPerSecond(GameState& state, size_t threads)
+{
+    SimulationEngine engine(threads);
+    engine.step(state, sf::Color::Green); // Warm up
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TICKS; ++i)
+    {
+        engine.step(state, sf::Color::Green);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(TICKS) / elapsed.count();
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%10s %8s %12s %10s\n", "cars", "threads", "ticks/s", "speedup");
+    for (size_t cars : {10000u, 100000u, 1000000u})
+    {
+        GameState state;
+        GameManager::createInitialState(state, cars, cars / 8);
+        state.traffic.count = static_cast<sf::Uint32>(state.traffic.cars.size());
+        state.economy.count = static_cast<sf::Uint32>(state.economy.buildings.size());
+
+        double serial = 0.0;
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            const double rate = ticksPerSecond(state, threads);
+            serial = (threads == 1) ? rate : serial;
+            std::printf("%10zu %8zu %12.1f %9.2fx\n", cars, threads, rate, rate / serial);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "GameManager.hpp"
+#include "RoadNetwork.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+// ----------------------------------------------------------------------------
+// Time per tick of GameManager::updateTraffic on the structure of arrays
+// against the former array of GameState::Car, on the same seeded city. Fails
+// if a car drifts by more than TOLERANCE between the two: they round
+// differently, so a car at the arrival distance of a building in one may
+// arrive a tick later in the other, which the seed of the city avoids.
+//
+// ./bench_soa
+// ----------------------------------------------------------------------------
+
+static constexpr float DT = 1.0f / 60.0f;
+static constexpr int TICKS = 60;
+static constexpr unsigned SEED = 42;
+static constexpr float TOLERANCE = 0.004f;
+
+// ----------------------------------------------------------------------------
+//! @brief updateTraffic() as it was on std::vector<GameState::Car>
+static void updateTrafficAoS(std::vector<GameState::Car>& cars, const GameState& state,
+                             float dt, sf::Color color, const RoadNetwork* roads)
+{
+    const int building_count = static_cast<int>(state.economy.buildings.size());
+    for (auto& car : cars)
+    {
+        car.color = color;
+
+        const int origin_idx = car.is_returning ? car.destination_building_idx : car.source_building_idx;
+        const int final_idx = car.is_returning ? car.source_building_idx : car.destination_building_idx;
+        if (roads == nullptr)
+        {
+            car.waypoint_building_idx = -1;
+        }
+        else if ((car.waypoint_building_idx < 0) || (car.waypoint_building_idx >= building_count))
+        {
+            car.waypoint_building_idx = roads->nextHop(origin_idx, final_idx);
+        }
+        const int target_idx = (car.waypoint_building_idx >= 0) ? car.waypoint_building_idx : final_idx;
+        sf::Vector2f target_pos = state.economy.buildings[size_t(target_idx)].position;
+
+        sf::Vector2f direction = target_pos - car.position;
+        float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        if (distance < 5.0f)
+        {
+            if (target_idx == final_idx)
+            {
+                car.is_returning = !car.is_returning;
+                car.waypoint_building_idx = (roads != nullptr) ? roads->nextHop(final_idx, origin_idx) : -1;
+            }
+            else
+            {
+                car.waypoint_building_idx = roads->nextHop(target_idx, final_idx);
+            }
+        }
+        else
+        {
+            direction /= distance;
+            car.position += direction * car.speed * dt;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+template<class Function>
+static double millisecondsPerTick(Function&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < TICKS; ++tick)
+    {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / TICKS;
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+#if defined(__AVX2__)
+    std::printf("SIMD: AVX2\n");
+#elif defined(__SSE2__)
+    std::printf("SIMD: SSE2\n");
+#else
+    std::printf("SIMD: none\n");
+#endif
+    std::printf("%10s %8s %10s %10s %9s %14s\n", "cars", "roads", "AoS ms", "SoA ms",
+                "speedup", "max drift px");
+    bool same = true;
+    for (size_t count : {10000u, 100000u, 1000000u})
+    {
+        for (bool with_roads : {false, true})
+        {
+            GameState state;
+            GameManager::createInitialState(state, count, count / 8, SEED);
+            RoadNetwork roads;
+            roads.rebuild(state);
+            const RoadNetwork* network = with_roads ? &roads : nullptr;
+
+            std::vector<GameState::Car> cars(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                cars[i] = state.traffic.cars.get(i);
+            }
+
+            const double aos = millisecondsPerTick([&]()
+            {
+                updateTrafficAoS(cars, state, DT, sf::Color::Green, network);
+            });
+            const double soa = millisecondsPerTick([&]()
+            {
+                GameManager::updateTraffic(state, 0, count, DT, sf::Color::Green, network);
+            });
+
+            // Both layouts ran the same ticks: cars must be at the same place
+            // up to rounding
+            float drift = 0.0f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const sf::Vector2f d = state.traffic.cars.position(i) - cars[i].position;
+                drift = std::max(drift, std::max(std::abs(d.x), std::abs(d.y)));
+            }
+            std::printf("%10zu %8s %10.3f %10.3f %8.2fx %14.5f\n", count, with_roads ? "yes" : "no",
+                        aos, soa, aos / soa, drift);
+            same = same && (drift <= TOLERANCE);
+        }
+    }
+    if (!same)
+    {
+        std::printf("Drift above %.3f px\n", TOLERANCE);
+    }
+    return same ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#include "SimulationEngine.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// ----------------------------------------------------------------------------
+// Neighbor queries on the SpatialGrid against the number of cars, compared to
+// a linear scan, plus the cost of keeping the grid up to date each tick and
+// of the cached road paths.
+//
+// ./bench_spatial
+// ----------------------------------------------------------------------------
+
+static constexpr size_t QUERIES = 10000;
+static constexpr float RADIUS = 8.0f;
+
+// ----------------------------------------------------------------------------
+template<class Function>
+static double seconds(Function&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    std::printf("%9s %11s %12s %12s %12s %13s %9s\n", "cars", "rebuild ms",
+                "update ms", "moved/tick", "grid q/s", "linear q/s", "matches");
+    for (size_t cars : {10000u, 100000u, 1000000u})
+    {
+        GameState state;
+        GameManager::createInitialState(state, cars, cars / 8);
+        state.traffic.count = static_cast<sf::Uint32>(state.traffic.cars.size());
+        state.economy.count = static_cast<sf::Uint32>(state.economy.buildings.size());
+
+        SimulationEngine engine(1);
+        for (int i = 0; i < 30; ++i) // Cars leave their source building
+        {
+            engine.step(state, sf::Color::Green);
+        }
+
+        // Full rebuild versus incremental update after one tick
+        SpatialGrid grid;
+        const double rebuild = seconds([&]() { grid.rebuild(state); });
+        engine.step(state, sf::Color::Green);
+        size_t moved = 0;
+        const double update = seconds([&]() { moved = grid.update(state); });
+
+        // Queries around random cars
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<size_t> pick(0, cars - 1);
+        std::vector<sf::Vector2f> centers(QUERIES);
+        for (auto& center : centers)
+        {
+            center = state.traffic.cars.position(pick(gen));
+        }
+
+        size_t grid_found = 0;
+        std::vector<sf::Uint32> found;
+        const double grid_time = seconds([&]()
+        {
+            for (const auto& center : centers)
+            {
+                grid.queryCars(state, center, RADIUS, found);
+                grid_found += found.size();
+            }
+        });
+
+        // Linear scan on a subset of the queries (too slow on all of them)
+        const size_t linear_queries = std::max<size_t>(10, QUERIES * 10000 / cars / 10);
+        size_t linear_found = 0, subset_found = 0;
+        const double linear_time = seconds([&]()
+        {
+            for (size_t q = 0; q < linear_queries; ++q)
+            {
+                const auto& all = state.traffic.cars;
+                for (size_t i = 0; i < all.size(); ++i)
+                {
+                    const sf::Vector2f d = all.position(i) - centers[q];
+                    linear_found += (d.x * d.x + d.y * d.y <= RADIUS * RADIUS) ? 1 : 0;
+                }
+            }
+        });
+        for (size_t q = 0; q < linear_queries; ++q)
+        {
+            grid.queryCars(state, centers[q], RADIUS, found);
+            subset_found += found.size();
+        }
+
+        std::printf("%9zu %11.2f %12.2f %12zu %12.0f %13.0f %9s\n", cars,
+                    rebuild * 1e3, update * 1e3, moved, QUERIES / grid_time,
+                    linear_queries / linear_time,
+                    (subset_found == linear_found) ? "yes" : "no");
+        (void) grid_found;
+    }
+
+    // Road paths: first search versus cached
+    GameState city;
+    GameManager::createInitialState(city, 0, 1000);
+    RoadNetwork roads;
+    roads.rebuild(city);
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> building(0, 999);
+    std::vector<std::pair<int, int>> trips(1000);
+    for (auto& trip : trips)
+    {
+        trip = {building(gen), building(gen)};
+    }
+    size_t hops = 0;
+    const double first = seconds([&]() { for (auto [from, to] : trips) hops += roads.path(from, to).size(); });
+    const double cached = seconds([&]() { for (auto [from, to] : trips) hops += roads.path(from, to).size(); });
+    std::printf("\n%zu paths on %zu buildings: %.2f ms searched, %.2f ms cached (%zu hops cached)\n",
+                trips.size(), city.economy.buildings.size(), first * 1e3, cached * 1e3,
+                roads.getCachedCount());
+    return 0;
+}
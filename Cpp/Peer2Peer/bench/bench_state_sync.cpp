@@ -0,0 +1,260 @@
+#include "GameManager.hpp"
+#include "NetworkProtocol.hpp"
+#include "StateSync.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+// ----------------------------------------------------------------------------
+// Bytes per tick sent by the host to one client, full STATE_SYNC versus
+// STATE_DELTA, against the number of entities. The network is replaced by an
+// in-memory loopback link dropping a given ratio of the datagrams in both
+// directions (deltas and acks), and the datagrams too large for UDP. The last
+// tick, a keyframe, is lossless: the client must then hold the host snapshot,
+// every field of every entity.
+//
+// ./bench_state_sync
+// ----------------------------------------------------------------------------
+
+static constexpr int TICKS = 600;
+static constexpr float DT = 1.0f / 60.0f;
+
+// ----------------------------------------------------------------------------
+//! @brief Stand-in for a UDP socket pair on the loopback interface
+class LoopbackLink
+{
+public:
+
+    //! @brief Largest UDP payload over IPv4
+    static constexpr size_t MAX_DATAGRAM_SIZE = 65507;
+
+    LoopbackLink(double loss, unsigned seed) : m_loss(loss), m_gen(seed) {}
+
+    //! @brief Sends a datagram, which may be lost
+    void send(const sf::Packet& packet)
+    {
+        m_bytes += packet.getDataSize();
+        if ((packet.getDataSize() <= MAX_DATAGRAM_SIZE) && (m_drop(m_gen) >= m_loss))
+        {
+            sf::Packet copy;
+            copy.append(packet.getData(), packet.getDataSize());
+            m_queue.push_back(std::move(copy));
+        }
+    }
+
+    //! @brief Receives the next datagram, if any
+    bool receive(sf::Packet& packet)
+    {
+        if (m_queue.empty())
+        {
+            return false;
+        }
+        packet = std::move(m_queue.front());
+        m_queue.pop_front();
+        return true;
+    }
+
+    //! @brief Bytes sent on the link
+    size_t bytes() const { return m_bytes; }
+
+    //! @brief Changes the ratio of lost datagrams
+    void setLoss(double loss) { m_loss = loss; }
+
+private:
+
+    double m_loss;
+    std::mt19937 m_gen;
+    std::uniform_real_distribution<double> m_drop{0.0, 1.0};
+    std::deque<sf::Packet> m_queue;
+    size_t m_bytes = 0;
+};
+
+// ----------------------------------------------------------------------------
+//! @brief City of the given number of cars, with one building per 8 cars
+static GameState createCity(size_t cars)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> pos_x(100.0f, 790.0f);
+    std::uniform_real_distribution<float> pos_y(10.0f, 590.0f);
+    std::uniform_real_distribution<float> speed(20.0f, 40.0f);
+
+    GameState state;
+    const int buildings = static_cast<int>(std::max<size_t>(2, cars / 8));
+    for (int i = 0; i < buildings; ++i)
+    {
+        GameState::Building building;
+        building.position = {pos_x(gen), pos_y(gen)};
+        building.color = sf::Color(100, 100, 100, 255);
+        building.income = 100.0f;
+        state.economy.buildings.push_back(building);
+
+        GameState::Road road;
+        road.building1_idx = i;
+        road.building2_idx = (i + 1) % buildings;
+        road.color = sf::Color(100, 100, 100, 255);
+        state.traffic.roads.push_back(road);
+    }
+
+    for (size_t i = 0; i < cars; ++i)
+    {
+        const auto& road = state.traffic.roads[i % state.traffic.roads.size()];
+        GameState::Car car;
+        car.source_building_idx = road.building1_idx;
+        car.destination_building_idx = road.building2_idx;
+        car.position = state.economy.buildings[car.source_building_idx].position;
+        car.speed = speed(gen);
+        car.is_returning = false;
+        state.traffic.cars.push_back(car);
+    }
+
+    state.economy.money = 10000.0f;
+    state.economy.tax_rate = 0.1f;
+    state.traffic.count = static_cast<sf::Uint32>(cars);
+    state.economy.count = static_cast<sf::Uint32>(buildings);
+    return state;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Average bytes per tick of the full state synchronization
+static double fullSyncBytes(size_t cars)
+{
+    GameState state = createCity(cars);
+    size_t bytes = 0;
+    for (int tick = 0; tick < TICKS; ++tick)
+    {
+        GameManager::update(state, DT, sf::Color::Green);
+        sf::Packet packet;
+        NetworkProtocol::createStateSyncPacket(packet, state);
+        bytes += packet.getDataSize();
+    }
+    return double(bytes) / TICKS;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Compares every field of two snapshots, but their ticks
+static bool same(const StateSnapshot& a, const StateSnapshot& b)
+{
+    if ((a.cars.size() != b.cars.size()) || (a.roads.size() != b.roads.size()) ||
+        (a.buildings.size() != b.buildings.size()) || (a.money != b.money) ||
+        (a.tax_rate != b.tax_rate))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.cars.size(); ++i)
+    {
+        const auto& x = a.cars[i];
+        const auto& y = b.cars[i];
+        if ((x.x != y.x) || (x.y != y.y) || (x.speed != y.speed) || (x.color != y.color) ||
+            (x.source_building_idx != y.source_building_idx) ||
+            (x.destination_building_idx != y.destination_building_idx) ||
+            (x.waypoint_building_idx != y.waypoint_building_idx) || (x.is_returning != y.is_returning))
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < a.roads.size(); ++i)
+    {
+        const auto& x = a.roads[i];
+        const auto& y = b.roads[i];
+        if ((x.building1_idx != y.building1_idx) || (x.building2_idx != y.building2_idx) ||
+            (x.color != y.color))
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < a.buildings.size(); ++i)
+    {
+        const auto& x = a.buildings[i];
+        const auto& y = b.buildings[i];
+        if ((x.x != y.x) || (x.y != y.y) || (x.color != y.color) || (x.income != y.income))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+//! @brief Average bytes per tick of the delta synchronization, the ratio of
+//! snapshots acknowledged, and whether the client ends with the host snapshot
+//! in its history and in its game state
+static double deltaSyncBytes(size_t cars, double loss, double& acked, bool& consistent)
+{
+    GameState host = createCity(cars);
+    GameState client;
+    LoopbackLink downlink(loss, 1), uplink(loss, 2);
+    SnapshotHistory host_history, client_history;
+    sf::Uint32 acked_tick = 0;
+    size_t acks = 0;
+
+    for (sf::Uint32 tick = 1; tick <= TICKS; ++tick)
+    {
+        GameManager::update(host, DT, sf::Color::Green);
+        if (tick == TICKS)
+        {
+            downlink.setLoss(0.0);
+        }
+
+        // Host: delta against the last acknowledged snapshot, in chunks
+        StateSync::capture(host, tick, host_history.getSpare());
+        StateSync::Chunks chunks;
+        chunks.current = &host_history.pushSpare();
+        const bool keyframe = (tick % StateSync::KEYFRAME_INTERVAL) == 0;
+        chunks.base = keyframe ? nullptr : host_history.find(acked_tick);
+        sf::Packet delta;
+        while (NetworkProtocol::createStateDeltaPacket(delta, chunks))
+        {
+            downlink.send(delta);
+        }
+
+        // Client: rebuild and acknowledge
+        sf::Packet packet;
+        while (downlink.receive(packet))
+        {
+            const sf::Uint32 received = NetworkProtocol::processStateDelta(packet, client_history, client);
+            if (received != 0)
+            {
+                sf::Packet ack;
+                NetworkProtocol::createStateAckPacket(ack, received);
+                uplink.send(ack);
+                ++acks;
+            }
+        }
+
+        // Host: acknowledgements
+        while (uplink.receive(packet))
+        {
+            acked_tick = std::max(acked_tick, NetworkProtocol::processStateAck(packet));
+        }
+    }
+
+    const StateSnapshot* last = client_history.find(TICKS);
+    StateSnapshot expected, restored;
+    StateSync::capture(host, TICKS, expected);
+    StateSync::capture(client, TICKS, restored);
+    consistent = (last != nullptr) && same(*last, expected) && same(restored, expected);
+    acked = double(acks) / TICKS;
+    return double(downlink.bytes()) / TICKS;
+}
+
+// ----------------------------------------------------------------------------
+int main()
+{
+    std::printf("%10s %14s %14s %8s %14s %8s %8s\n", "cars", "full B/tick",
+                "delta B/tick", "ratio", "5% loss", "acked", "synced");
+    bool synced = true;
+    for (size_t cars : {100u, 1000u, 10000u, 100000u})
+    {
+        bool lossless = false, lossy = false;
+        double acked = 0.0, acked_lossy = 0.0;
+        const double full = fullSyncBytes(cars);
+        const double delta = deltaSyncBytes(cars, 0.0, acked, lossless);
+        const double delta_lossy = deltaSyncBytes(cars, 0.05, acked_lossy, lossy);
+        std::printf("%10zu %14.0f %14.0f %7.2fx %14.0f %7.0f%% %8s\n", cars, full,
+                    delta, full / delta, delta_lossy, 100.0 * acked_lossy,
+                    (lossless && lossy) ? "yes" : "no");
+        synced = synced && lossless && lossy;
+    }
+    return synced ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#! /bin/bash
+# Headless benchmarks: no window is opened.
+
+cd "$(dirname "$0")"
+FLAGS="--std=c++17 -O2 -march=native -ffp-contract=off -Wall -Wextra -Wshadow -I.."
+LIBS=`pkg-config --cflags --libs sfml-graphics sfml-network`
+
+g++ $FLAGS bench_state_sync.cpp ../NetworkProtocol.cpp ../StateSync.cpp ../GameManager.cpp ../RoadNetwork.cpp -o bench_state_sync $LIBS
+g++ $FLAGS bench_soa.cpp ../GameManager.cpp ../RoadNetwork.cpp -o bench_soa $LIBS
+g++ $FLAGS bench_load_balance.cpp ../LoadBalancer.cpp ../GameManager.cpp ../RoadNetwork.cpp -o bench_load_balance $LIBS
+g++ $FLAGS -pthread bench_simulation.cpp ../SimulationEngine.cpp ../ThreadPool.cpp ../GameManager.cpp ../RoadNetwork.cpp ../SpatialGrid.cpp -o bench_simulation $LIBS
+g++ $FLAGS -pthread bench_spatial.cpp ../SimulationEngine.cpp ../ThreadPool.cpp ../GameManager.cpp ../RoadNetwork.cpp ../SpatialGrid.cpp -o bench_spatial $LIBS
+g++ $FLAGS -pthread bench_network_io.cpp ../NetworkIO.cpp -o bench_network_io $LIBS
+g++ $FLAGS bench_packet_encoding.cpp ../NetworkProtocol.cpp ../StateSync.cpp ../PacketPool.cpp ../GameManager.cpp ../RoadNetwork.cpp -o bench_packet_encoding $LIBS
+g++ $FLAGS -pthread bench_reliable_channel.cpp ../ReliableChannel.cpp ../NetworkIO.cpp ../PacketPool.cpp -o bench_reliable_channel $LIBS
+g++ $FLAGS -pthread bench_host_migration.cpp ../NetworkNode.cpp ../NetworkIO.cpp ../NetworkProtocol.cpp ../StateSync.cpp ../PacketPool.cpp ../ReliableChannel.cpp ../LoadBalancer.cpp ../SimulationEngine.cpp ../ThreadPool.cpp ../GameManager.cpp ../RoadNetwork.cpp ../SpatialGrid.cpp -o bench_host_migration $LIBS
+
+#./bench_state_sync
+#./bench_soa
+#./bench_simulation
+#./bench_spatial
+#./bench_load_balance
+#./bench_network_io
+#./bench_packet_encoding
+#./bench_reliable_channel
+#./bench_host_migration
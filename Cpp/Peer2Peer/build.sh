@@ -1,6 +1,6 @@
 #! /bin/bash
 
-g++ --std=c++17 -Wall -Wextra -Wshadow *.cpp -o SimCity `pkg-config --cflags --libs sfml-graphics sfml-network`
+g++ --std=c++17 -pthread -ffp-contract=off -Wall -Wextra -Wshadow *.cpp -o SimCity `pkg-config --cflags --libs sfml-graphics sfml-network`
 
 #./SimCity host 45000
 #./SimCity client 45001
\ No newline at end of file
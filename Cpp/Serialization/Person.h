@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Serialization.h"
+
+// ============================================================================
+//! \brief Example structure demonstrating serialization capabilities,
+//! stored as a versioned record.
+// ============================================================================
+class Person
+{
+public:
+    //! \brief Version of the record written by operator<<
+    static constexpr uint16_t VERSION = 1;
+
+    // ------------------------------------------------------------------------
+    //! \brief Default constructor
+    // ------------------------------------------------------------------------
+    Person() = default;
+
+    // ------------------------------------------------------------------------
+    //! \brief Constructor with parameters
+    // ------------------------------------------------------------------------
+    Person(const std::string& p_name, int p_age, const std::vector<std::string>& p_hobbies)
+        : m_name(p_name), m_age(p_age), m_hobbies(p_hobbies) {}
+
+    // ------------------------------------------------------------------------
+    //! \brief Get the name
+    // ------------------------------------------------------------------------
+    std::string const& name() const { return m_name; }
+
+    // ------------------------------------------------------------------------
+    //! \brief Get the age
+    // ------------------------------------------------------------------------
+    int age() const { return m_age; }
+
+    // ------------------------------------------------------------------------
+    //! \brief Get the hobbies
+    // ------------------------------------------------------------------------
+    std::vector<std::string> const& hobbies() const { return m_hobbies; }
+
+    // ------------------------------------------------------------------------
+    //! \brief Serialization operators, for any encoding
+    // ------------------------------------------------------------------------
+    template <typename Encoding>
+    friend BasicSerializer<Encoding>& operator<<(BasicSerializer<Encoding>& p_serializer, const Person& p_person)
+    {
+        typename BasicSerializer<Encoding>::Record record(p_serializer, Person::VERSION);
+        p_serializer << p_person.m_name << p_person.m_age << p_person.m_hobbies;
+        return p_serializer;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Deserialization operators, for any encoding
+    // ------------------------------------------------------------------------
+    template <typename Encoding>
+    friend BasicDeserializer<Encoding>& operator>>(BasicDeserializer<Encoding>& p_deserializer, Person& p_person)
+    {
+        // Fields added by newer versions are skipped at the end of the record
+        typename BasicDeserializer<Encoding>::Record record(p_deserializer);
+        p_deserializer >> p_person.m_name >> p_person.m_age >> p_person.m_hobbies;
+        return p_deserializer;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Utility function to print person info
+    // ------------------------------------------------------------------------
+    void print() const
+    {
+        std::cout << "Name: " << m_name << std::endl;
+        std::cout << "Age: " << m_age << std::endl;
+        std::cout << "Hobbies: ";
+        for (size_t i = 0; i < m_hobbies.size(); ++i)
+        {
+            std::cout << m_hobbies[i];
+            if (i < m_hobbies.size() - 1) std::cout << ", ";
+        }
+        std::cout << std::endl;
+    }
+
+private:
+    std::string m_name;
+    int m_age = 0;
+    std::vector<std::string> m_hobbies;
+};
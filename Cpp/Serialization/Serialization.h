@@ -2,8 +2,10 @@
 
 #include <cstdint>
 #include <cstring>
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <iostream>
 #include <map>
@@ -12,33 +14,507 @@
 namespace serialization
 {
     using Container = std::vector<uint8_t>;
+
+    //! \brief First bytes of every container
+    static constexpr char MAGIC[4] = {'S', 'R', 'L', 'Z'};
+    //! \brief Version of the layout written by Serializer. A Deserializer
+    //! rejects newer versions.
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    //! \brief Bytes of the header: the magic, then the format version and the
+    //! flags of the encoding, both little-endian whatever the encoding
+    static constexpr size_t HEADER_SIZE = sizeof(MAGIC) + 2u * sizeof(uint16_t);
+
+    // ========================================================================
+    //! \brief Why a Deserializer stopped reading. The first error is kept.
+    // ========================================================================
+    enum class Error : uint8_t
+    {
+        //! \brief All reads succeeded
+        None,
+        //! \brief The container does not start with a valid header
+        BadHeader,
+        //! \brief The container was written by a newer format version
+        UnsupportedVersion,
+        //! \brief The container was written with another encoding
+        WrongEncoding,
+        //! \brief A read went past the end of the container or of a record
+        Truncated,
+        //! \brief A value is out of its range, e.g. a bool other than 0 or 1
+        BadValue
+    };
+
+    // ------------------------------------------------------------------------
+    //! \brief Name of an error, for messages.
+    // ------------------------------------------------------------------------
+    inline const char* to_string(Error p_error)
+    {
+        switch (p_error)
+        {
+            case Error::None: return "none";
+            case Error::BadHeader: return "bad header";
+            case Error::UnsupportedVersion: return "unsupported version";
+            case Error::WrongEncoding: return "wrong encoding";
+            case Error::Truncated: return "truncated";
+            case Error::BadValue: return "bad value";
+        }
+        return "unknown";
+    }
+
+    // ========================================================================
+    //! \brief Read-only view on consecutive elements, pointing into the
+    //! container of a Deserializer (std::span<const T> is C++20).
+    // ========================================================================
+    template <typename T>
+    class Span
+    {
+    public:
+        Span() = default;
+        Span(T const* p_data, size_t p_size) : m_data(p_data), m_size(p_size) {}
+
+        T const* data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0u; }
+        T const* begin() const { return m_data; }
+        T const* end() const { return m_data + m_size; }
+        T const& operator[](size_t p_index) const { return m_data[p_index]; }
+
+    private:
+        T const* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    // ------------------------------------------------------------------------
+    //! \brief Whether a std::vector<T> is stored as a single block of bytes,
+    //! aligned on alignof(T), instead of element by element. Specialize it to
+    //! false for a trivially copyable type having its own operator<<.
+    // ------------------------------------------------------------------------
+    template <typename T>
+    struct is_bulk : std::bool_constant<std::is_trivially_copyable<T>::value &&
+                                        !std::is_same<T, bool>::value> {};
+    template <>
+    struct is_bulk<std::string_view> : std::false_type {};
+    template <typename T>
+    struct is_bulk<Span<T>> : std::false_type {};
+
+    // ------------------------------------------------------------------------
+    //! \brief Whether a trivially copyable type is stored by the encoding:
+    //! integers, enumerations and floating points, but bool. Other types are
+    //! copied as they are in memory.
+    // ------------------------------------------------------------------------
+    template <typename T>
+    struct is_number : std::bool_constant<(std::is_arithmetic<T>::value || std::is_enum<T>::value) &&
+                                          !std::is_same<T, bool>::value> {};
+
+    //! \brief True when numbers are little-endian in memory
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    static constexpr bool LITTLE_ENDIAN_HOST = false;
+#else
+    static constexpr bool LITTLE_ENDIAN_HOST = true;
+#endif
+
+    // ------------------------------------------------------------------------
+    //! \brief Reverse the bytes of a value.
+    // ------------------------------------------------------------------------
+    template <typename T>
+    inline T swap_bytes(T p_value)
+    {
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &p_value, sizeof(T));
+        std::reverse(bytes, bytes + sizeof(T));
+        std::memcpy(&p_value, bytes, sizeof(T));
+        return p_value;
+    }
+
+    // ========================================================================
+    //! \brief Encoding storing numbers with their size in memory, as they are
+    //! or little-endian. Base of Raw and LittleEndian.
+    //!
+    //! An encoding is a policy of BasicSerializer and BasicDeserializer:
+    //! - FLAGS: stored in the header, checked by the deserializer;
+    //! - size_type: type of the sizes of strings and containers;
+    //! - ALIGNED: whether bulk vectors are padded to be viewed in place;
+    //! - is_fixed_width<T>(): whether all the T take sizeof(T) bytes, so
+    //!   that a std::vector<T> is stored as a single block;
+    //! - is_verbatim<T>(): whether the T are stored as they are in memory on
+    //!   this host, so that the block is copied at once or viewed;
+    //! - write() and read(): store and read a number;
+    //! - reserve_record_size() and write_record_size(): store the size of a
+    //!   record, known once its fields are stored.
+    // ========================================================================
+    template <bool t_little_endian>
+    struct FixedWidth
+    {
+        static constexpr bool ALIGNED = true;
+
+        template <typename T>
+        static constexpr bool is_fixed_width()
+        {
+            return true;
+        }
+
+        template <typename T>
+        static constexpr bool is_verbatim()
+        {
+            return !t_little_endian || LITTLE_ENDIAN_HOST || !is_number<T>::value || (sizeof(T) == 1u);
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Store a number at the end of the container.
+        // --------------------------------------------------------------------
+        template <typename T>
+        static void write(Container& p_container, T p_value)
+        {
+            if constexpr (!is_verbatim<T>())
+            {
+                p_value = swap_bytes(p_value);
+            }
+            size_t container_size = p_container.size();
+            p_container.resize(container_size + sizeof(T));
+            std::memcpy(p_container.data() + container_size, &p_value, sizeof(T));
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Read a number.
+        //! \param p_data The first byte of the number.
+        //! \param p_size The number of bytes which can be read.
+        //! \param p_used The number of bytes read, set on success.
+        //! \param p_value The number read.
+        //! \return Error::None or why the number cannot be read.
+        // --------------------------------------------------------------------
+        template <typename T>
+        static Error read(uint8_t const* p_data, size_t p_size, size_t& p_used, T& p_value)
+        {
+            if (sizeof(T) > p_size)
+            {
+                return Error::Truncated;
+            }
+            std::memcpy(&p_value, p_data, sizeof(T));
+            if constexpr (!is_verbatim<T>())
+            {
+                p_value = swap_bytes(p_value);
+            }
+            p_used = sizeof(T);
+            return Error::None;
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Make room for the size of a record, as a uint64_t.
+        //! \return Where the size goes.
+        // --------------------------------------------------------------------
+        static size_t reserve_record_size(Container& p_container)
+        {
+            size_t offset = p_container.size();
+            p_container.resize(offset + sizeof(uint64_t), 0u);
+            return offset;
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Store the size of a record in the room made for it.
+        // --------------------------------------------------------------------
+        static void write_record_size(Container& p_container, size_t p_offset, uint64_t p_size)
+        {
+            if constexpr (!is_verbatim<uint64_t>())
+            {
+                p_size = swap_bytes(p_size);
+            }
+            std::memcpy(p_container.data() + p_offset, &p_size, sizeof(p_size));
+        }
+    };
+
+    // ========================================================================
+    //! \brief Encoding storing numbers and sizes as they are in memory: the
+    //! fastest, but only readable by hosts of the same byte order and size of
+    //! size_t.
+    // ========================================================================
+    struct Raw : FixedWidth<false>
+    {
+        static constexpr uint16_t FLAGS = 0;
+        using size_type = size_t;
+    };
+
+    // ========================================================================
+    //! \brief Encoding storing numbers little-endian with their size in
+    //! memory, and sizes as uint64_t: readable by any host. As fast as Raw on
+    //! little-endian hosts. Other trivially copyable types are still copied
+    //! as they are in memory: give them operators to share them.
+    // ========================================================================
+    struct LittleEndian : FixedWidth<true>
+    {
+        static constexpr uint16_t FLAGS = 1;
+        using size_type = uint64_t;
+    };
+
+    // ========================================================================
+    //! \brief Encoding storing integers and sizes as LEB128 varints (7 bits
+    //! per byte, from the lowest ones, the high bit set on all the bytes but
+    //! the last), signed integers zigzag-mapped first so that small negative
+    //! numbers are short too. Bytes and floating points are stored as by
+    //! LittleEndian. Readable by any host, and the most compact for small
+    //! numbers and sizes.
+    //!
+    //! The size of a record is a varint inserted before its fields once they
+    //! are stored, which moves them: bulk vectors are not padded, so only
+    //! vectors of bytes can be viewed in place.
+    // ========================================================================
+    struct Varint
+    {
+        static constexpr uint16_t FLAGS = 2;
+        using size_type = uint64_t;
+        static constexpr bool ALIGNED = false;
+
+        template <typename T>
+        static constexpr bool is_varint()
+        {
+            return is_number<T>::value && !std::is_floating_point<T>::value && (sizeof(T) > 1u);
+        }
+
+        template <typename T>
+        static constexpr bool is_fixed_width()
+        {
+            return !is_varint<T>();
+        }
+
+        template <typename T>
+        static constexpr bool is_verbatim()
+        {
+            return !is_varint<T>() && LittleEndian::is_verbatim<T>();
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Store a number at the end of the container.
+        // --------------------------------------------------------------------
+        template <typename T>
+        static void write(Container& p_container, T p_value)
+        {
+            if constexpr (!is_varint<T>())
+            {
+                LittleEndian::write(p_container, p_value);
+            }
+            else
+            {
+                uint8_t bytes[MAX_BYTES];
+                size_t count = encode(zigzag(p_value), bytes);
+                p_container.insert(p_container.end(), bytes, bytes + count);
+            }
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Read a number.
+        //! \param p_data The first byte of the number.
+        //! \param p_size The number of bytes which can be read.
+        //! \param p_used The number of bytes read, set on success.
+        //! \param p_value The number read.
+        //! \return Error::None or why the number cannot be read: a varint
+        //! longer than the type allows is a bad value.
+        // --------------------------------------------------------------------
+        template <typename T>
+        static Error read(uint8_t const* p_data, size_t p_size, size_t& p_used, T& p_value)
+        {
+            if constexpr (!is_varint<T>())
+            {
+                return LittleEndian::read(p_data, p_size, p_used, p_value);
+            }
+            else
+            {
+                using Bits = decltype(zigzag(p_value));
+                constexpr unsigned BITS = 8u * sizeof(Bits);
+
+                // Small numbers and sizes take a single byte
+                if ((p_size != 0u) && (p_data[0] < 0x80u))
+                {
+                    p_used = 1u;
+                    p_value = unzigzag<T>(Bits(p_data[0]));
+                    return Error::None;
+                }
+
+                Bits bits = 0u;
+                for (size_t i = 0u; i < p_size; ++i)
+                {
+                    const unsigned shift = unsigned(7u * i);
+                    const unsigned payload = p_data[i] & 0x7Fu;
+                    if ((shift >= BITS) || ((shift + 7u > BITS) && ((payload >> (BITS - shift)) != 0u)))
+                    {
+                        return Error::BadValue;
+                    }
+                    bits = Bits(bits | Bits(Bits(payload) << shift));
+                    if ((p_data[i] & 0x80u) == 0u)
+                    {
+                        p_used = i + 1u;
+                        p_value = unzigzag<T>(bits);
+                        return Error::None;
+                    }
+                }
+                return Error::Truncated;
+            }
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Nothing to reserve: the size is inserted once known.
+        //! \return Where the size goes.
+        // --------------------------------------------------------------------
+        static size_t reserve_record_size(Container& p_container)
+        {
+            return p_container.size();
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Insert the size of a record before its fields.
+        // --------------------------------------------------------------------
+        static void write_record_size(Container& p_container, size_t p_offset, uint64_t p_size)
+        {
+            uint8_t bytes[MAX_BYTES];
+            size_t count = encode(p_size, bytes);
+            p_container.insert(p_container.begin() + std::ptrdiff_t(p_offset), bytes, bytes + count);
+        }
+
+    private:
+
+        //! \brief Bytes of the longest varint, a 64-bit one
+        static constexpr size_t MAX_BYTES = 10u;
+
+        // --------------------------------------------------------------------
+        //! \brief Bits of an integer or enumeration as unsigned, signed ones
+        //! zigzag-mapped: 0, -1, 1, -2... become 0, 1, 2, 3...
+        // --------------------------------------------------------------------
+        template <typename T>
+        static auto zigzag(T p_value)
+        {
+            using Integer = typename std::conditional_t<std::is_enum<T>::value,
+                std::underlying_type<T>, std::common_type<T>>::type;
+            using Bits = std::make_unsigned_t<Integer>;
+            Integer value = Integer(p_value);
+            if constexpr (std::is_signed<Integer>::value)
+            {
+                // Shifting a negative value right fills it with ones
+                return Bits(Bits(Bits(value) << 1u) ^ Bits(value >> (8u * sizeof(Integer) - 1u)));
+            }
+            else
+            {
+                return Bits(value);
+            }
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Inverse of zigzag().
+        // --------------------------------------------------------------------
+        template <typename T, typename Bits>
+        static T unzigzag(Bits p_bits)
+        {
+            using Integer = typename std::conditional_t<std::is_enum<T>::value,
+                std::underlying_type<T>, std::common_type<T>>::type;
+            if constexpr (std::is_signed<Integer>::value)
+            {
+                return T(Integer(Bits(Bits(p_bits >> 1u) ^ Bits(Bits(0u) - Bits(p_bits & 1u)))));
+            }
+            else
+            {
+                return T(p_bits);
+            }
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Write the varint of an unsigned integer.
+        //! \return The number of bytes written, at most MAX_BYTES.
+        // --------------------------------------------------------------------
+        template <typename Bits>
+        static size_t encode(Bits p_bits, uint8_t* p_bytes)
+        {
+            size_t count = 0u;
+            while (p_bits >= 0x80u)
+            {
+                p_bytes[count++] = uint8_t(p_bits | 0x80u);
+                p_bits = Bits(p_bits >> 7u);
+            }
+            p_bytes[count++] = uint8_t(p_bits);
+            return count;
+        }
+    };
 }
 
 // ============================================================================
 //! \brief Class helping to serialize data into a dynamic container of bytes.
 //! Supports trivially copyable types, std::string, and std::vector.
+//! The container starts with a header (see serialization::HEADER_SIZE).
+//! Numbers and sizes are stored by the encoding (serialization::Raw,
+//! LittleEndian or Varint): data is only readable by a BasicDeserializer of
+//! the same encoding.
 // ============================================================================
-class Serializer
+template <typename Encoding = serialization::Raw>
+class BasicSerializer
 {
 public:
 
+    // ========================================================================
+    //! \brief Store the fields written during its lifetime as a record: a
+    //! version tag and the size of the fields, written by the destructor.
+    //! A reader knowing an older version skips the fields it does not know,
+    //! appended at the end of the record by newer versions.
+    // ========================================================================
+    class Record
+    {
+    public:
+        // --------------------------------------------------------------------
+        //! \brief Start the record.
+        //! \param p_serializer The serializer object, which shall outlive the
+        //! record.
+        //! \param p_version The version of the fields of the record.
+        // --------------------------------------------------------------------
+        Record(BasicSerializer& p_serializer, uint16_t p_version)
+            : m_serializer(p_serializer)
+        {
+            m_serializer << p_version;
+            m_size_offset = Encoding::reserve_record_size(m_serializer.m_container);
+            m_fields_offset = m_serializer.m_container.size();
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief End the record: store the size of its fields.
+        // --------------------------------------------------------------------
+        ~Record()
+        {
+            uint64_t size = m_serializer.m_container.size() - m_fields_offset;
+            Encoding::write_record_size(m_serializer.m_container, m_size_offset, size);
+        }
+
+        Record(Record const&) = delete;
+        Record& operator=(Record const&) = delete;
+
+    private:
+        BasicSerializer& m_serializer;
+        size_t m_size_offset;
+        size_t m_fields_offset;
+    };
+
+    // ------------------------------------------------------------------------
+    //! \brief Default constructor: the container holds the header.
+    // ------------------------------------------------------------------------
+    BasicSerializer()
+    {
+        write_header();
+    }
+
     // ------------------------------------------------------------------------
     //! \brief Serialize: Store trivially copyable data inside the container.
+    //! Numbers are stored by the encoding, other types as they are in memory.
+    //! Other types need their own operator<<, which may be a template on the
+    //! encoding: this one is only a candidate for trivially copyable types.
     //! \param p_serializer The serializer object.
     //! \param p_data The data to be stored.
     //! \return The serializer object.
     // ------------------------------------------------------------------------
-    template <typename DataType>
-    friend Serializer& operator<<(Serializer& p_serializer, DataType const& p_data)
+    template <typename DataType, typename = std::enable_if_t<std::is_trivially_copyable<DataType>::value>>
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, DataType const& p_data)
     {
-        // Check that the type of the data being pushed is trivially copyable
-        static_assert(
-            std::is_trivially_copyable<DataType>::value,
-            "Type must be trivially copyable for direct serialization");
-
-        size_t container_size = p_serializer.m_container.size();
-        p_serializer.m_container.resize(container_size + sizeof(DataType));
-        std::memcpy(p_serializer.m_container.data() + container_size, &p_data, sizeof(DataType));
+        if constexpr (serialization::is_number<DataType>::value)
+        {
+            Encoding::write(p_serializer.m_container, p_data);
+        }
+        else
+        {
+            size_t container_size = p_serializer.m_container.size();
+            p_serializer.m_container.resize(container_size + sizeof(DataType));
+            std::memcpy(p_serializer.m_container.data() + container_size, &p_data, sizeof(DataType));
+        }
         return p_serializer;
     }
 
@@ -48,11 +524,23 @@ public:
     //! \param p_string The string to be stored.
     //! \return The serializer object.
     // ------------------------------------------------------------------------
-    friend Serializer& operator<<(Serializer& p_serializer, std::string const& p_string)
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, std::string const& p_string)
+    {
+        return p_serializer << std::string_view(p_string);
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Serialize: Store std::string_view inside the container, as a
+    //! std::string.
+    //! \param p_serializer The serializer object.
+    //! \param p_string The string to be stored.
+    //! \return The serializer object.
+    // ------------------------------------------------------------------------
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, std::string_view p_string)
     {
         // First serialize the size of the string
         size_t string_size = p_string.size();
-        p_serializer << string_size;
+        p_serializer << typename Encoding::size_type(string_size);
 
         // Then serialize the string data
         size_t container_size = p_serializer.m_container.size();
@@ -68,16 +556,61 @@ public:
     //! \return The serializer object.
     // ------------------------------------------------------------------------
     template <typename T>
-    friend Serializer& operator<<(Serializer& p_serializer, std::vector<T> const& p_vector)
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, std::vector<T> const& p_vector)
+    {
+        if constexpr (serialization::is_bulk<T>::value && Encoding::template is_fixed_width<T>())
+        {
+            return p_serializer << serialization::Span<T>(p_vector.data(), p_vector.size());
+        }
+        else
+        {
+            // First serialize the size of the vector
+            size_t vector_size = p_vector.size();
+            p_serializer << typename Encoding::size_type(vector_size);
+
+            // Then serialize each element
+            for (const auto& element : p_vector)
+            {
+                p_serializer << element;
+            }
+            return p_serializer;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Serialize: Store trivially copyable elements inside the
+    //! container, as a std::vector: the size, padding up to alignof(T) if the
+    //! encoding is aligned, then all the elements in a single copy (one by
+    //! one if the encoding changes their bytes on this host).
+    //! \param p_serializer The serializer object.
+    //! \param p_span The elements to be stored.
+    //! \return The serializer object.
+    // ------------------------------------------------------------------------
+    template <typename T>
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, serialization::Span<T> const& p_span)
     {
-        // First serialize the size of the vector
-        size_t vector_size = p_vector.size();
-        p_serializer << vector_size;
+        static_assert(serialization::is_bulk<T>::value && Encoding::template is_fixed_width<T>(),
+                      "Elements must be trivially copyable and of fixed width to be stored in a single block");
+
+        p_serializer << typename Encoding::size_type(p_span.size());
+        p_serializer.align(alignof(T));
 
-        // Then serialize each element
-        for (const auto& element : p_vector)
+        if constexpr (Encoding::template is_verbatim<T>())
         {
-            p_serializer << element;
+            size_t container_size = p_serializer.m_container.size();
+            size_t bytes = p_span.size() * sizeof(T);
+            p_serializer.m_container.resize(container_size + bytes);
+            if (bytes != 0u)
+            {
+                std::memcpy(p_serializer.m_container.data() + container_size, p_span.data(), bytes);
+            }
+        }
+        else
+        {
+            for (const T& element : p_span)
+            {
+                Encoding::write(p_serializer.m_container, element);
+            }
         }
         return p_serializer;
     }
@@ -89,11 +622,11 @@ public:
     //! \return The serializer object.
     // ------------------------------------------------------------------------
     template <typename KeyType, typename ValueType>
-    friend Serializer& operator<<(Serializer& p_serializer, std::map<KeyType, ValueType> const& p_map)
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, std::map<KeyType, ValueType> const& p_map)
     {
         // First serialize the size of the map
         size_t map_size = p_map.size();
-        p_serializer << map_size;
+        p_serializer << typename Encoding::size_type(map_size);
 
         // Then serialize each key-value pair
         for (const auto& pair : p_map)
@@ -110,7 +643,7 @@ public:
     //! \return The serializer object.
     // ------------------------------------------------------------------------
     template <typename T>
-    friend Serializer& operator<<(Serializer& p_serializer, std::unique_ptr<T> const& p_unique_ptr)
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, std::unique_ptr<T> const& p_unique_ptr)
     {
         // First serialize whether the pointer is null
         bool is_null = (p_unique_ptr == nullptr);
@@ -131,7 +664,7 @@ public:
     //! \return The serializer object.
     // ------------------------------------------------------------------------
     template <typename T>
-    friend Serializer& operator<<(Serializer& p_serializer, std::shared_ptr<T> const& p_shared_ptr)
+    friend BasicSerializer& operator<<(BasicSerializer& p_serializer, std::shared_ptr<T> const& p_shared_ptr)
     {
         // First serialize whether the pointer is null
         bool is_null = (p_shared_ptr == nullptr);
@@ -146,11 +679,12 @@ public:
     }
 
     // ------------------------------------------------------------------------
-    //! \brief Clear the container.
+    //! \brief Clear the container, but its header.
     // ------------------------------------------------------------------------
     inline void clear()
     {
         m_container.clear();
+        write_header();
     }
 
     // ------------------------------------------------------------------------
@@ -161,6 +695,33 @@ public:
         return m_container;
     }
 
+private:
+
+    // ------------------------------------------------------------------------
+    //! \brief Store the magic, the format version, and the flags of the
+    //! encoding.
+    // ------------------------------------------------------------------------
+    inline void write_header()
+    {
+        m_container.insert(m_container.end(), serialization::MAGIC,
+                           serialization::MAGIC + sizeof(serialization::MAGIC));
+        serialization::LittleEndian::write(m_container, serialization::FORMAT_VERSION);
+        serialization::LittleEndian::write(m_container, Encoding::FLAGS);
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Pad with zeros up to a multiple of the given alignment, so that
+    //! the elements stored next can be viewed in place by the Deserializer.
+    // ------------------------------------------------------------------------
+    inline void align(size_t p_alignment)
+    {
+        if constexpr (Encoding::ALIGNED)
+        {
+            size_t container_size = m_container.size();
+            m_container.resize((container_size + p_alignment - 1u) / p_alignment * p_alignment, 0u);
+        }
+    }
+
 private:
     serialization::Container m_container;
 };
@@ -168,36 +729,155 @@ private:
 // ============================================================================
 //! \brief Class helping to deserialize data from a dynamic container of bytes.
 //! Supports trivially copyable types, std::string, and std::vector.
+//! std::string_view and serialization::Span<T> point into the container
+//! instead of copying: they are valid as long as the container is neither
+//! destroyed nor modified.
+//!
+//! Reads are checked against the end of the container (or of the current
+//! record) with a single comparison. The first failed read sets the error and
+//! makes all the next ones fail, so that a whole message can be read and
+//! checked once at the end. The values read after the error are left
+//! unchanged or empty.
 // ============================================================================
-class Deserializer
+template <typename Encoding = serialization::Raw>
+class BasicDeserializer
 {
 public:
+
+    // ========================================================================
+    //! \brief Read a record stored by BasicSerializer::Record during its
+    //! lifetime: the reads are bounded by the record, and the destructor
+    //! skips the fields not read, appended by newer versions.
+    // ========================================================================
+    class Record
+    {
+    public:
+        // --------------------------------------------------------------------
+        //! \brief Start reading the record.
+        //! \param p_deserializer The deserializer object, which shall outlive
+        //! the record.
+        // --------------------------------------------------------------------
+        explicit Record(BasicDeserializer& p_deserializer)
+            : m_deserializer(p_deserializer), m_outer_end(p_deserializer.m_end)
+        {
+            uint64_t size = 0;
+            m_deserializer >> m_version >> size;
+            if (m_deserializer.check(size))
+            {
+                m_deserializer.m_end = m_deserializer.m_offset + size_t(size);
+            }
+        }
+
+        // --------------------------------------------------------------------
+        //! \brief Skip to the end of the record.
+        // --------------------------------------------------------------------
+        ~Record()
+        {
+            m_deserializer.m_offset = m_deserializer ? m_deserializer.m_end : m_outer_end;
+            m_deserializer.m_end = m_outer_end;
+        }
+
+        Record(Record const&) = delete;
+        Record& operator=(Record const&) = delete;
+
+        // --------------------------------------------------------------------
+        //! \brief Get the version of the fields stored, which may be older or
+        //! newer than the one of the reader.
+        // --------------------------------------------------------------------
+        inline uint16_t version() const
+        {
+            return m_version;
+        }
+
+    private:
+        BasicDeserializer& m_deserializer;
+        size_t m_outer_end;
+        uint16_t m_version = 0;
+    };
+
     // ------------------------------------------------------------------------
     //! \brief Default constructor. Give the container in which this class shall
-    //! store bytes.
+    //! store bytes. Its header is checked: see error().
     //! \param p_container The container in which this class shall store bytes.
     //! \note the container shall not be destroyed while this class is using it.
     // ------------------------------------------------------------------------
-    Deserializer(const serialization::Container& p_container)
-        : m_container(p_container)
-    {}
+    BasicDeserializer(const serialization::Container& p_container)
+        : m_container(p_container), m_end(p_container.size())
+    {
+        read_header();
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Views would outlive a temporary container.
+    // ------------------------------------------------------------------------
+    BasicDeserializer(serialization::Container&&) = delete;
+
+    // ------------------------------------------------------------------------
+    //! \brief Get the first error met, or Error::None.
+    // ------------------------------------------------------------------------
+    inline serialization::Error error() const
+    {
+        return m_error;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Whether all the reads succeeded.
+    // ------------------------------------------------------------------------
+    explicit operator bool() const
+    {
+        return m_error == serialization::Error::None;
+    }
 
     // ------------------------------------------------------------------------
     //! \brief Deserialize: Read trivially copyable data from the container.
+    //! Other types need their own operator>>, see BasicSerializer.
     //! \param p_deserializer The deserializer object.
     //! \param p_data The data to be read.
     //! \return The deserializer object.
     // ------------------------------------------------------------------------
-    template <typename DataType>
-    friend Deserializer& operator>>(Deserializer& p_deserializer, DataType& p_data)
+    template <typename DataType, typename = std::enable_if_t<std::is_trivially_copyable<DataType>::value>>
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, DataType& p_data)
     {
-        static_assert(
-            std::is_trivially_copyable<DataType>::value,
-            "Type must be trivially copyable for direct deserialization");
+        if constexpr (serialization::is_number<DataType>::value)
+        {
+            size_t used = 0;
+            serialization::Error error = Encoding::read(
+                p_deserializer.m_container.data() + p_deserializer.m_offset,
+                p_deserializer.m_end - p_deserializer.m_offset, used, p_data);
+            if (error == serialization::Error::None)
+            {
+                p_deserializer.m_offset += used;
+            }
+            else
+            {
+                p_deserializer.fail(error);
+            }
+        }
+        else if (p_deserializer.check(sizeof(DataType)))
+        {
+            std::memcpy(&p_data, p_deserializer.m_container.data() +
+                p_deserializer.m_offset, sizeof(DataType));
+            p_deserializer.m_offset += sizeof(DataType);
+        }
+        return p_deserializer;
+    }
 
-        std::memcpy(&p_data, p_deserializer.m_container.data() +
-            p_deserializer.m_offset, sizeof(DataType));
-        p_deserializer.m_offset += sizeof(DataType);
+    // ------------------------------------------------------------------------
+    //! \brief Deserialize: Read bool from the container, which shall be 0 or
+    //! 1 (any other byte is not a valid bool).
+    //! \param p_deserializer The deserializer object.
+    //! \param p_bool The bool to be read.
+    //! \return The deserializer object.
+    // ------------------------------------------------------------------------
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, bool& p_bool)
+    {
+        uint8_t byte = 0;
+        p_deserializer >> byte;
+        if (byte > 1u)
+        {
+            p_deserializer.fail(serialization::Error::BadValue);
+        }
+        p_bool = (byte == 1u);
         return p_deserializer;
     }
 
@@ -207,17 +887,11 @@ public:
     //! \param p_string The string to be read.
     //! \return The deserializer object.
     // ------------------------------------------------------------------------
-    friend Deserializer& operator>>(Deserializer& p_deserializer, std::string& p_string)
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, std::string& p_string)
     {
-        // First deserialize the size of the string
-        size_t str_size;
-        p_deserializer >> str_size;
-
-        // Then deserialize the string data
-        const char* data_ptr = reinterpret_cast<const char*>(
-            p_deserializer.m_container.data() + p_deserializer.m_offset);
-        p_string.assign(data_ptr, str_size);
-        p_deserializer.m_offset += str_size;
+        std::string_view view;
+        p_deserializer >> view;
+        p_string.assign(view.data(), view.size());
         return p_deserializer;
     }
 
@@ -228,17 +902,114 @@ public:
     //! \return The deserializer object.
     // ------------------------------------------------------------------------
     template <typename T>
-    friend Deserializer& operator>>(Deserializer& p_deserializer, std::vector<T>& p_vector)
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, std::vector<T>& p_vector)
+    {
+        if constexpr (serialization::is_bulk<T>::value && Encoding::template is_fixed_width<T>())
+        {
+            // All the elements in a single block
+            typename Encoding::size_type vector_size = 0;
+            p_deserializer >> vector_size;
+            p_deserializer.align(alignof(T));
+            if (!p_deserializer.check(vector_size, sizeof(T)))
+            {
+                vector_size = 0u;
+            }
+            p_vector.resize(size_t(vector_size));
+
+            uint8_t const* data = p_deserializer.m_container.data() + p_deserializer.m_offset;
+            if constexpr (Encoding::template is_verbatim<T>())
+            {
+                if (vector_size != 0u)
+                {
+                    std::memcpy(p_vector.data(), data, p_vector.size() * sizeof(T));
+                }
+            }
+            else
+            {
+                // Checked by the size of the block
+                size_t used = 0;
+                for (size_t i = 0; i < p_vector.size(); ++i)
+                {
+                    Encoding::read(data + i * sizeof(T), sizeof(T), used, p_vector[i]);
+                }
+            }
+            p_deserializer.m_offset += p_vector.size() * sizeof(T);
+        }
+        else
+        {
+            // First deserialize the size of the vector. Each element takes a
+            // byte at least: a corrupt size cannot allocate more than that.
+            typename Encoding::size_type vector_size = 0;
+            p_deserializer >> vector_size;
+            p_vector.resize(p_deserializer.check(vector_size) ? size_t(vector_size) : 0u);
+
+            // Then deserialize each element in order
+            for (size_t i = 0; (i < p_vector.size()) && p_deserializer; ++i)
+            {
+                p_deserializer >> p_vector[i];
+            }
+        }
+        return p_deserializer;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Deserialize: View a std::string of the container, without copy.
+    //! \param p_deserializer The deserializer object.
+    //! \param p_string The view on the string, valid as long as the container.
+    //! \return The deserializer object.
+    // ------------------------------------------------------------------------
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, std::string_view& p_string)
+    {
+        typename Encoding::size_type str_size = 0;
+        p_deserializer >> str_size;
+
+        if (p_deserializer.check(str_size))
+        {
+            p_string = std::string_view(reinterpret_cast<const char*>(
+                p_deserializer.m_container.data() + p_deserializer.m_offset), size_t(str_size));
+            p_deserializer.m_offset += size_t(str_size);
+        }
+        else
+        {
+            p_string = std::string_view();
+        }
+        return p_deserializer;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Deserialize: View a std::vector of trivially copyable elements
+    //! of the container, without copy.
+    //! \param p_deserializer The deserializer object.
+    //! \param p_span The view on the elements, valid as long as the container.
+    //! \return The deserializer object.
+    // ------------------------------------------------------------------------
+    template <typename T>
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, serialization::Span<T>& p_span)
     {
-        // First deserialize the size of the vector
-        size_t vector_size;
+        static_assert(serialization::is_bulk<T>::value,
+                      "Only vectors of trivially copyable elements can be viewed");
+        static_assert(Encoding::template is_verbatim<T>(),
+                      "The encoding changes the bytes of this type on this host");
+        static_assert(Encoding::ALIGNED || (alignof(T) == 1u),
+                      "The encoding does not align vectors: only bytes can be viewed");
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                      "The container is not aligned enough for this type");
+
+        typename Encoding::size_type vector_size = 0;
         p_deserializer >> vector_size;
 
-        // Then deserialize each element in order
-        p_vector.resize(vector_size);
-        for (size_t i = 0; i < vector_size; ++i)
+        // Elements are aligned from the start of the container, which is
+        // aligned for any type by its allocator
+        p_deserializer.align(alignof(T));
+        if (p_deserializer.check(vector_size, sizeof(T)))
         {
-            p_deserializer >> p_vector[i];
+            p_span = serialization::Span<T>(reinterpret_cast<T const*>(
+                p_deserializer.m_container.data() + p_deserializer.m_offset), size_t(vector_size));
+            p_deserializer.m_offset += size_t(vector_size) * sizeof(T);
+        }
+        else
+        {
+            p_span = serialization::Span<T>();
         }
         return p_deserializer;
     }
@@ -250,20 +1021,28 @@ public:
     //! \return The deserializer object.
     // ------------------------------------------------------------------------
     template <typename KeyType, typename ValueType>
-    friend Deserializer& operator>>(Deserializer& p_deserializer, std::map<KeyType, ValueType>& p_map)
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, std::map<KeyType, ValueType>& p_map)
     {
-        // First deserialize the size of the map
-        size_t map_size;
+        // First deserialize the size of the map: each pair takes a byte at
+        // least
+        typename Encoding::size_type map_size = 0;
         p_deserializer >> map_size;
+        if (!p_deserializer.check(map_size))
+        {
+            map_size = 0u;
+        }
 
         // Clear the map and deserialize each key-value pair
         p_map.clear();
-        for (size_t i = 0; i < map_size; ++i)
+        for (size_t i = 0; (i < map_size) && p_deserializer; ++i)
         {
-            KeyType key;
-            ValueType value;
+            KeyType key{};
+            ValueType value{};
             p_deserializer >> key >> value;
-            p_map[key] = value;
+            if (p_deserializer)
+            {
+                p_map[key] = value;
+            }
         }
         return p_deserializer;
     }
@@ -275,14 +1054,14 @@ public:
     //! \return The deserializer object.
     // ------------------------------------------------------------------------
     template <typename T>
-    friend Deserializer& operator>>(Deserializer& p_deserializer, std::unique_ptr<T>& p_unique_ptr)
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, std::unique_ptr<T>& p_unique_ptr)
     {
         // First deserialize whether the pointer is null
-        bool is_null;
+        bool is_null = true;
         p_deserializer >> is_null;
 
         // If null, reset the unique_ptr
-        if (is_null)
+        if (is_null || !p_deserializer)
         {
             p_unique_ptr.reset();
         }
@@ -302,14 +1081,14 @@ public:
     //! \return The deserializer object.
     // ------------------------------------------------------------------------
     template <typename T>
-    friend Deserializer& operator>>(Deserializer& p_deserializer, std::shared_ptr<T>& p_shared_ptr)
+    friend BasicDeserializer& operator>>(BasicDeserializer& p_deserializer, std::shared_ptr<T>& p_shared_ptr)
     {
         // First deserialize whether the pointer is null
-        bool is_null;
+        bool is_null = true;
         p_deserializer >> is_null;
 
         // If null, reset the shared_ptr
-        if (is_null)
+        if (is_null || !p_deserializer)
         {
             p_shared_ptr.reset();
         }
@@ -322,7 +1101,105 @@ public:
         return p_deserializer;
     }
 
+private:
+
+    // ------------------------------------------------------------------------
+    //! \brief Check the magic, the format version and the encoding.
+    // ------------------------------------------------------------------------
+    inline void read_header()
+    {
+        if (m_end < serialization::HEADER_SIZE)
+        {
+            fail(serialization::Error::BadHeader);
+            return;
+        }
+        uint16_t version = 0;
+        uint16_t flags = 0;
+        size_t used = 0;
+        uint8_t const* data = m_container.data();
+        serialization::LittleEndian::read(data + sizeof(serialization::MAGIC), sizeof(version), used, version);
+        serialization::LittleEndian::read(data + sizeof(serialization::MAGIC) + sizeof(version),
+                                          sizeof(flags), used, flags);
+        m_offset = serialization::HEADER_SIZE;
+        if (std::memcmp(data, serialization::MAGIC, sizeof(serialization::MAGIC)) != 0)
+        {
+            fail(serialization::Error::BadHeader);
+        }
+        else if (version > serialization::FORMAT_VERSION)
+        {
+            fail(serialization::Error::UnsupportedVersion);
+        }
+        else if (flags != Encoding::FLAGS)
+        {
+            fail(serialization::Error::WrongEncoding);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Whether the given number of bytes can be read, else fail. The
+    //! only branch of the reads of fixed-width data.
+    // ------------------------------------------------------------------------
+    inline bool check(uint64_t p_bytes)
+    {
+        if (p_bytes <= m_end - m_offset)
+        {
+            return true;
+        }
+        fail(serialization::Error::Truncated);
+        return false;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Whether the given number of elements can be read, else fail,
+    //! without overflowing their size in bytes.
+    // ------------------------------------------------------------------------
+    inline bool check(uint64_t p_count, size_t p_element_size)
+    {
+        if (p_count <= (m_end - m_offset) / p_element_size)
+        {
+            return true;
+        }
+        fail(serialization::Error::Truncated);
+        return false;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Keep the first error and make all the next reads fail: nothing
+    //! is left to read.
+    // ------------------------------------------------------------------------
+    inline void fail(serialization::Error p_error)
+    {
+        if (m_error == serialization::Error::None)
+        {
+            m_error = p_error;
+        }
+        m_offset = m_end;
+    }
+
+    // ------------------------------------------------------------------------
+    //! \brief Skip the padding added by BasicSerializer::align().
+    // ------------------------------------------------------------------------
+    inline void align(size_t p_alignment)
+    {
+        if constexpr (Encoding::ALIGNED)
+        {
+            size_t padding = (p_alignment - m_offset % p_alignment) % p_alignment;
+            if (check(padding))
+            {
+                m_offset += padding;
+            }
+        }
+    }
+
 private:
     const serialization::Container& m_container;
+    //! \brief Next byte to read
     size_t m_offset = 0;
-};
\ No newline at end of file
+    //! \brief End of the container, or of the record being read
+    size_t m_end;
+    serialization::Error m_error = serialization::Error::None;
+};
+
+//! \brief Serializer and Deserializer storing numbers as they are in memory
+using Serializer = BasicSerializer<serialization::Raw>;
+using Deserializer = BasicDeserializer<serialization::Raw>;
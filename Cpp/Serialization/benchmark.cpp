@@ -0,0 +1,282 @@
+#include "Person.h"
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+
+// ============================================================================
+//! \brief Float stored element by element, as every std::vector was before
+//! the bulk copy: gives the former deserialization path on the same bytes.
+// ============================================================================
+struct Sample
+{
+    float value;
+};
+
+namespace serialization
+{
+    template <>
+    struct is_bulk<Sample> : std::false_type {};
+}
+
+//! \brief 64 MiB blob: the floats after it need no padding, so they are read
+//! the same way element by element and in bulk
+static constexpr size_t BLOB_SIZE = 64u * 1024u * 1024u;
+static constexpr size_t SAMPLES = 9u * 1024u * 1024u;
+//! \brief Fields of 14 bytes read one by one, and Person records per encoding
+static constexpr size_t FIELDS = 4u * 1024u * 1024u;
+static constexpr size_t PEOPLE = 500000u;
+static constexpr int RUNS = 5;
+
+// ----------------------------------------------------------------------------
+//! \brief Best time in milliseconds of a function over RUNS runs.
+// ----------------------------------------------------------------------------
+template <typename Function>
+static double best_ms(Function&& p_function)
+{
+    double best = 1e300;
+    for (int run = 0; run < RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        p_function();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------------------
+//! \brief Print a line of the result table.
+// ----------------------------------------------------------------------------
+static void print(const char* p_name, size_t p_bytes, double p_extract, double p_read, double p_checksum)
+{
+    // A view costs no copy: its throughput is meaningless
+    char throughput[32] = "-";
+    if (p_extract >= 0.01)
+    {
+        std::snprintf(throughput, sizeof(throughput), "%.1f", double(p_bytes) / p_extract / 1e6);
+    }
+    std::printf("%-32s %12.3f %10s %16.2f %14.0f\n", p_name, p_extract, throughput,
+                p_read, p_checksum);
+}
+
+// ----------------------------------------------------------------------------
+//! \brief Deserialize a 100 MiB message (a blob and an array of floats),
+//! copying it out of the container or viewing it in place, and read it once.
+// ----------------------------------------------------------------------------
+static void bench_views()
+{
+    std::string blob(BLOB_SIZE, '\0');
+    for (size_t i = 0; i < blob.size(); ++i)
+    {
+        blob[i] = char(i * 31u);
+    }
+    std::vector<float> samples(SAMPLES);
+    std::iota(samples.begin(), samples.end(), 0.0f);
+
+    Serializer serializer;
+    serializer << blob << samples;
+    serialization::Container data = serializer.data();
+    std::printf("Message: %.1f MiB\n\n", double(data.size()) / (1024.0 * 1024.0));
+
+    std::printf("%-32s %12s %10s %16s %14s\n", "extraction", "extract ms", "GB/s",
+                "extract+read ms", "checksum");
+
+    const size_t samples_offset = serialization::HEADER_SIZE + sizeof(size_t) + BLOB_SIZE;
+
+    // Blob: copy into a std::string or view it
+    {
+        std::string copy;
+        const double extract = best_ms([&] { Deserializer d(data); d >> copy; });
+        double checksum = 0.0;
+        const double read = best_ms([&]
+        {
+            Deserializer d(data);
+            d >> copy;
+            checksum = double(std::accumulate(copy.begin(), copy.end(), 0u));
+        });
+        print("std::string (copy)", BLOB_SIZE, extract, read, checksum);
+    }
+    {
+        std::string_view view;
+        const double extract = best_ms([&] { Deserializer d(data); d >> view; });
+        double checksum = 0.0;
+        const double read = best_ms([&]
+        {
+            Deserializer d(data);
+            d >> view;
+            checksum = double(std::accumulate(view.begin(), view.end(), 0u));
+        });
+        print("std::string_view", BLOB_SIZE, extract, read, checksum);
+    }
+
+    // Floats: element by element, single copy, or view
+    auto skip_blob = [&](Deserializer& d)
+    {
+        std::string_view skipped;
+        d >> skipped;
+    };
+    {
+        std::vector<Sample> copy;
+        const double extract = best_ms([&] { Deserializer d(data); skip_blob(d); d >> copy; });
+        double checksum = 0.0;
+        const double read = best_ms([&]
+        {
+            Deserializer d(data);
+            skip_blob(d);
+            d >> copy;
+            checksum = 0.0;
+            for (const Sample& sample : copy)
+            {
+                checksum += double(sample.value);
+            }
+        });
+        print("std::vector<float> per element", SAMPLES * sizeof(float), extract, read, checksum);
+    }
+    {
+        std::vector<float> copy;
+        const double extract = best_ms([&] { Deserializer d(data); skip_blob(d); d >> copy; });
+        double checksum = 0.0;
+        const double read = best_ms([&]
+        {
+            Deserializer d(data);
+            skip_blob(d);
+            d >> copy;
+            checksum = std::accumulate(copy.begin(), copy.end(), 0.0);
+        });
+        print("std::vector<float> memcpy", SAMPLES * sizeof(float), extract, read, checksum);
+    }
+    {
+        serialization::Span<float> view;
+        const double extract = best_ms([&] { Deserializer d(data); skip_blob(d); d >> view; });
+        double checksum = 0.0;
+        const double read = best_ms([&]
+        {
+            Deserializer d(data);
+            skip_blob(d);
+            d >> view;
+            checksum = std::accumulate(view.begin(), view.end(), 0.0);
+        });
+        print("serialization::Span<float>", SAMPLES * sizeof(float), extract, read, checksum);
+        std::printf("\nSpan points into the container: %s\n",
+                    (reinterpret_cast<const uint8_t*>(view.data()) == data.data() + samples_offset + sizeof(size_t))
+                    ? "yes" : "no");
+    }
+}
+
+// ----------------------------------------------------------------------------
+//! \brief Throughput of the checked reads: small fields read one by one,
+//! against the same reads without bounds check (the former Deserializer).
+// ----------------------------------------------------------------------------
+static void bench_checked_reads()
+{
+    Serializer serializer;
+    for (size_t i = 0; i < FIELDS; ++i)
+    {
+        serializer << uint32_t(i) << double(i) * 0.5 << uint16_t(i);
+    }
+    serialization::Container data = serializer.data();
+    const size_t bytes = data.size() - serialization::HEADER_SIZE;
+
+    std::printf("\n%-32s %12s %10s %16s\n", "reads", "ms", "GB/s", "checksum");
+
+    // Reference: memcpy at the offset, nothing checked
+    {
+        double checksum = 0.0;
+        const double ms = best_ms([&]
+        {
+            const uint8_t* bytes_read = data.data();
+            size_t offset = serialization::HEADER_SIZE;
+            uint32_t id = 0;
+            double value = 0.0;
+            uint16_t flags = 0;
+            checksum = 0.0;
+            for (size_t i = 0; i < FIELDS; ++i)
+            {
+                std::memcpy(&id, bytes_read + offset, sizeof(id));
+                offset += sizeof(id);
+                std::memcpy(&value, bytes_read + offset, sizeof(value));
+                offset += sizeof(value);
+                std::memcpy(&flags, bytes_read + offset, sizeof(flags));
+                offset += sizeof(flags);
+                checksum += double(id) + value + double(flags);
+            }
+        });
+        std::printf("%-32s %12.2f %10.2f %16.0f\n", "fields unchecked", ms, double(bytes) / ms / 1e6, checksum);
+    }
+    {
+        double checksum = 0.0;
+        bool valid = false;
+        const double ms = best_ms([&]
+        {
+            Deserializer d(data);
+            uint32_t id = 0;
+            double value = 0.0;
+            uint16_t flags = 0;
+            checksum = 0.0;
+            for (size_t i = 0; i < FIELDS; ++i)
+            {
+                d >> id >> value >> flags;
+                checksum += double(id) + value + double(flags);
+            }
+            valid = bool(d);
+        });
+        std::printf("%-32s %12.2f %10.2f %16.0f%s\n", "fields checked", ms, double(bytes) / ms / 1e6,
+                    checksum, valid ? "" : " (error)");
+    }
+}
+
+// ----------------------------------------------------------------------------
+//! \brief Size and speed of Person records in an encoding.
+// ----------------------------------------------------------------------------
+template <typename Encoding>
+static void bench_records(const char* p_name, const std::vector<Person>& p_people)
+{
+    BasicSerializer<Encoding> serializer;
+    const double write_ms = best_ms([&] { serializer.clear(); serializer << p_people; });
+    serialization::Container data = serializer.data();
+
+    std::vector<Person> read;
+    bool valid = false;
+    const double read_ms = best_ms([&]
+    {
+        BasicDeserializer<Encoding> d(data);
+        d >> read;
+        valid = bool(d) && (read.size() == p_people.size());
+    });
+    std::printf("%-32s %14.1f %10.2f %10.2f %14.1f%s\n", p_name,
+                double(data.size() - serialization::HEADER_SIZE) / double(p_people.size()),
+                write_ms, read_ms, double(p_people.size()) / read_ms / 1e3, valid ? "" : " (error)");
+}
+
+// ----------------------------------------------------------------------------
+//! \brief Person records (version tag and size, name, age and hobbies) in
+//! each encoding.
+// ----------------------------------------------------------------------------
+static void bench_encodings()
+{
+    std::vector<Person> people;
+    people.reserve(PEOPLE);
+    for (size_t i = 0; i < PEOPLE; ++i)
+    {
+        people.emplace_back("Person " + std::to_string(i), int(i % 100u),
+                            std::vector<std::string>{"lecture", "musique", "sport"});
+    }
+
+    std::printf("\n%-32s %14s %10s %10s %14s\n", "encoding", "bytes/record", "write ms",
+                "read ms", "M records/s");
+    bench_records<serialization::Raw>("Raw", people);
+    bench_records<serialization::LittleEndian>("LittleEndian", people);
+    bench_records<serialization::Varint>("Varint", people);
+}
+
+// ============================================================================
+//! \brief Deserialization benchmarks.
+//! g++ -std=c++17 -Wall -Wextra -O2 -o benchmark benchmark.cpp
+// ============================================================================
+int main()
+{
+    bench_views();
+    bench_checked_reads();
+    bench_encodings();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include "Person.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// ----------------------------------------------------------------------------
+//! \brief Deserialize arbitrary bytes as every supported type.
+// ----------------------------------------------------------------------------
+template <typename Encoding>
+static void deserialize(const serialization::Container& p_data)
+{
+    BasicDeserializer<Encoding> deserializer(p_data);
+
+    Person person;
+    std::vector<Person> people;
+    std::map<std::string, std::vector<int>> teams;
+    std::unique_ptr<Person> unique_person;
+    std::shared_ptr<std::map<int, std::string>> shared_map;
+    std::vector<double> weights;
+    std::string_view name;
+    serialization::Span<uint8_t> bytes;
+    bool flag = false;
+
+    deserializer >> person >> people >> teams >> unique_person >> shared_map
+                 >> weights >> name >> bytes >> flag;
+
+    // Views shall stay inside the container
+    const uint8_t* end = p_data.data() + p_data.size();
+    if ((!name.empty() && (reinterpret_cast<const uint8_t*>(name.data() + name.size()) > end)) ||
+        (!bytes.empty() && (bytes.end() > end)))
+    {
+        std::abort();
+    }
+}
+
+// ============================================================================
+//! \brief Fuzz target: deserialize arbitrary bytes as every supported type,
+//! in every encoding. Any input shall be read or rejected with an error,
+//! never read outside of the container nor allocate more than its size
+//! allows.
+//! With libFuzzer:
+//! clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined -o fuzz fuzz.cpp
+//! ./fuzz -max_len=4096
+//! Without it, random corruptions of valid messages:
+//! g++ -std=c++17 -g -O1 -fsanitize=address,undefined -DSTANDALONE_FUZZ -o fuzz fuzz.cpp
+//! ./fuzz [iterations]
+// ============================================================================
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* p_data, size_t p_size)
+{
+    serialization::Container data(p_data, p_data + p_size);
+
+    // The header gives the encoding: make each one read every input
+    if (p_size >= serialization::HEADER_SIZE)
+    {
+        data[serialization::HEADER_SIZE - 2u] = uint8_t(serialization::Raw::FLAGS);
+        deserialize<serialization::Raw>(data);
+        data[serialization::HEADER_SIZE - 2u] = uint8_t(serialization::LittleEndian::FLAGS);
+        deserialize<serialization::LittleEndian>(data);
+        data[serialization::HEADER_SIZE - 2u] = uint8_t(serialization::Varint::FLAGS);
+        deserialize<serialization::Varint>(data);
+    }
+    else
+    {
+        deserialize<serialization::Raw>(data);
+    }
+    return 0;
+}
+
+#ifdef STANDALONE_FUZZ
+
+// ----------------------------------------------------------------------------
+//! \brief Valid message holding every type read by the fuzz target.
+// ----------------------------------------------------------------------------
+template <typename Encoding>
+static serialization::Container seed()
+{
+    BasicSerializer<Encoding> serializer;
+    serializer << Person("Jean Dupont", 30, {"lecture", "musique"})
+               << std::vector<Person>{Person("Alice Martin", 25, {"voyage"}), Person()}
+               << std::map<std::string, std::vector<int>>{{"A", {1, 2}}, {"B", {}}}
+               << std::unique_ptr<Person>(new Person("Marie Curie", 45, {"science"}))
+               << std::make_shared<std::map<int, std::string>>(std::map<int, std::string>{{1, "un"}})
+               << std::vector<double>{0.5, 0.25}
+               << std::string("Ada")
+               << std::vector<uint8_t>{3, 1, 4}
+               << true;
+    return serializer.data();
+}
+
+// ----------------------------------------------------------------------------
+//! \brief Truncate a seed of each encoding, flip bits, overwrite bytes, and
+//! write huge lengths, many times. Sanitizers report any invalid access.
+// ----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    const long iterations = (argc > 1) ? std::atol(argv[1]) : 200000;
+    const serialization::Container seeds[] = {
+        seed<serialization::Raw>(), seed<serialization::LittleEndian>(), seed<serialization::Varint>()
+    };
+    std::mt19937_64 random(42);
+
+    for (const auto& valid : seeds)
+    {
+        LLVMFuzzerTestOneInput(valid.data(), valid.size());
+    }
+    for (long i = 0; i < iterations; ++i)
+    {
+        serialization::Container data = seeds[i % 3];
+        const int mutations = 1 + int(random() % 4u);
+        for (int m = 0; m < mutations; ++m)
+        {
+            const size_t position = random() % data.size();
+            switch (random() % 4u)
+            {
+                case 0: data.resize(position); break;
+                case 1: data[position] ^= uint8_t(1u << (random() % 8u)); break;
+                case 2: data[position] = uint8_t(random()); break;
+                default:
+                {
+                    const uint64_t length = random() >> (random() % 64u);
+                    const size_t bytes = std::min(sizeof(length), data.size() - position);
+                    std::memcpy(data.data() + position, &length, bytes);
+                    break;
+                }
+            }
+            if (data.empty())
+            {
+                break;
+            }
+        }
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    std::printf("%ld inputs deserialized\n", iterations + 3);
+    return EXIT_SUCCESS;
+}
+
+#endif
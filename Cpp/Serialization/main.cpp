@@ -1,76 +1,5 @@
-#include "Serialization.h"
-
-// ============================================================================
-//! \brief Example structure demonstrating serialization capabilities
-// ============================================================================
-class Person
-{
-public:
-    // ------------------------------------------------------------------------
-    //! \brief Default constructor
-    // ------------------------------------------------------------------------
-    Person() = default;
-
-    // ------------------------------------------------------------------------
-    //! \brief Constructor with parameters
-    // ------------------------------------------------------------------------
-    Person(const std::string& p_name, int p_age, const std::vector<std::string>& p_hobbies)
-        : m_name(p_name), m_age(p_age), m_hobbies(p_hobbies) {}
-
-    // ------------------------------------------------------------------------
-    //! \brief Get the name
-    // ------------------------------------------------------------------------
-    std::string const& name() const { return m_name; }
-
-    // ------------------------------------------------------------------------
-    //! \brief Get the age
-    // ------------------------------------------------------------------------
-    int age() const { return m_age; }
-
-    // ------------------------------------------------------------------------
-    //! \brief Get the hobbies
-    // ------------------------------------------------------------------------
-    std::vector<std::string> const& hobbies() const { return m_hobbies; }
-
-    // ------------------------------------------------------------------------
-    //! \brief Serialization operators
-    // ------------------------------------------------------------------------
-    friend Serializer& operator<<(Serializer& p_serializer, const Person& p_person)
-    {
-        p_serializer << p_person.m_name << p_person.m_age << p_person.m_hobbies;
-        return p_serializer;
-    }
-
-    // ------------------------------------------------------------------------
-    //! \brief Deserialization operators
-    // ------------------------------------------------------------------------
-    friend Deserializer& operator>>(Deserializer& p_deserializer, Person& p_person)
-    {
-        p_deserializer >> p_person.m_name >> p_person.m_age >> p_person.m_hobbies;
-        return p_deserializer;
-    }
-
-    // ------------------------------------------------------------------------
-    //! \brief Utility function to print person info
-    // ------------------------------------------------------------------------
-    void print() const
-    {
-        std::cout << "Name: " << m_name << std::endl;
-        std::cout << "Age: " << m_age << std::endl;
-        std::cout << "Hobbies: ";
-        for (size_t i = 0; i < m_hobbies.size(); ++i)
-        {
-            std::cout << m_hobbies[i];
-            if (i < m_hobbies.size() - 1) std::cout << ", ";
-        }
-        std::cout << std::endl;
-    }
-
-private:
-    std::string m_name;
-    int m_age;
-    std::vector<std::string> m_hobbies;
-};
+#include "Person.h"
+#include <algorithm>
 
 // ============================================================================
 //! \brief Example 1: Serialization of a single person
@@ -466,6 +395,246 @@ inline bool example_smart_pointers()
            shared_null_same && vector_same && map_same;
 }
 
+// ============================================================================
+//! \brief Example 5: Deserialization without copy
+// ============================================================================
+inline bool example_views()
+{
+    std::cout << "\n=== Deserialization views example ===" << std::endl;
+
+    // The odd size of the name shifts the next vectors, aligned by padding
+    std::string name = "Ada";
+    std::vector<int> measures = {3, 1, 4, 1, 5, 9, 2, 6};
+    std::vector<double> weights = {0.5, 0.25, 0.125};
+
+    Serializer serializer;
+    serializer << name << measures << weights;
+
+    std::cout << "Serialized views size: " << serializer.data().size() << " bytes" << std::endl;
+
+    // Views point into the container, which shall outlive them
+    serialization::Container data = serializer.data();
+    Deserializer deserializer(data);
+
+    std::string_view name_view;
+    serialization::Span<int> measures_view;
+    std::vector<double> deserialized_weights;
+    deserializer >> name_view >> measures_view >> deserialized_weights;
+
+    std::cout << "Name view: " << name_view << std::endl;
+    std::cout << "Measures view:";
+    for (int measure : measures_view)
+    {
+        std::cout << " " << measure;
+    }
+    std::cout << std::endl;
+
+    // Verify data integrity and that nothing was copied
+    auto in_container = [&data](const void* p_pointer)
+    {
+        const uint8_t* pointer = static_cast<const uint8_t*>(p_pointer);
+        return (pointer >= data.data()) && (pointer < data.data() + data.size());
+    };
+    bool name_same = (name_view == name) && in_container(name_view.data());
+    bool measures_same = std::equal(measures.begin(), measures.end(),
+                                    measures_view.begin(), measures_view.end()) &&
+                         in_container(measures_view.data());
+    bool weights_same = (weights == deserialized_weights);
+
+    std::cout << "\nViews data integrity check:" << std::endl;
+    std::cout << "  String view: " << (name_same ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  Span: " << (measures_same ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  Bulk vector: " << (weights_same ? "PASSED" : "FAILED") << std::endl;
+
+    return name_same && measures_same && weights_same;
+}
+
+// ============================================================================
+//! \brief Person as written by a newer program: version 2 appends an email
+//! to the fields of version 1.
+// ============================================================================
+struct PersonV2
+{
+    std::string name;
+    int age = 0;
+    std::vector<std::string> hobbies;
+    std::string email;
+
+    friend Serializer& operator<<(Serializer& p_serializer, const PersonV2& p_person)
+    {
+        Serializer::Record record(p_serializer, 2u);
+        p_serializer << p_person.name << p_person.age << p_person.hobbies << p_person.email;
+        return p_serializer;
+    }
+
+    friend Deserializer& operator>>(Deserializer& p_deserializer, PersonV2& p_person)
+    {
+        // A version 1 record has no email
+        Deserializer::Record record(p_deserializer);
+        p_deserializer >> p_person.name >> p_person.age >> p_person.hobbies;
+        p_person.email.clear();
+        if (record.version() >= 2u)
+        {
+            p_deserializer >> p_person.email;
+        }
+        return p_deserializer;
+    }
+};
+
+// ============================================================================
+//! \brief Example 6: Versioned records and corrupt data
+// ============================================================================
+inline bool example_versions()
+{
+    std::cout << "\n=== Versioned records example ===" << std::endl;
+
+    // A newer record read by the older program, then the other way round.
+    // The value after each record shows that the reader is at its end.
+    PersonV2 newer{"Grace Hopper", 85, {"compilateurs", "marine"}, "grace@navy.mil"};
+    Person older("Alan Turing", 41, {"course", "echecs"});
+    int sentinel = 1234;
+
+    Serializer serializer;
+    serializer << newer << sentinel << older << sentinel;
+
+    std::cout << "Serialized records size: " << serializer.data().size() << " bytes" << std::endl;
+
+    serialization::Container data = serializer.data();
+    Deserializer deserializer(data);
+
+    Person newer_read_by_v1;
+    PersonV2 older_read_by_v2;
+    int sentinel1 = 0, sentinel2 = 0;
+    deserializer >> newer_read_by_v1 >> sentinel1 >> older_read_by_v2 >> sentinel2;
+
+    std::cout << "Version 2 read as version 1:" << std::endl;
+    newer_read_by_v1.print();
+    std::cout << "Version 1 read as version 2: " << older_read_by_v2.name
+              << " (email: \"" << older_read_by_v2.email << "\")" << std::endl;
+
+    bool skipped = deserializer && (newer_read_by_v1.name() == newer.name) &&
+                   (newer_read_by_v1.hobbies() == newer.hobbies) && (sentinel1 == sentinel);
+    bool defaulted = deserializer && (older_read_by_v2.name == older.name()) &&
+                     older_read_by_v2.email.empty() && (sentinel2 == sentinel);
+
+    // Every truncation of the container is an error, never a read past it
+    bool truncated = true;
+    for (size_t size = 0; size < data.size(); ++size)
+    {
+        serialization::Container prefix(data.begin(), data.begin() + std::ptrdiff_t(size));
+        Deserializer partial(prefix);
+        Person person;
+        PersonV2 person2;
+        int value = 0;
+        partial >> person >> value >> person2 >> value;
+        truncated = truncated && !partial;
+    }
+
+    // A corrupt length, and data without a header
+    serialization::Container corrupt = data;
+    corrupt[serialization::HEADER_SIZE + sizeof(uint16_t) + sizeof(uint64_t) + 7u] = 0x7F;
+    Deserializer corrupt_deserializer(corrupt);
+    Person corrupt_person;
+    corrupt_deserializer >> corrupt_person;
+    std::cout << "Corrupt name length: " << serialization::to_string(corrupt_deserializer.error()) << std::endl;
+
+    serialization::Container headerless(data.begin() + serialization::HEADER_SIZE, data.end());
+    Deserializer headerless_deserializer(headerless);
+    std::cout << "Missing header: " << serialization::to_string(headerless_deserializer.error()) << std::endl;
+
+    bool rejected = (corrupt_deserializer.error() == serialization::Error::Truncated) &&
+                    (headerless_deserializer.error() == serialization::Error::BadHeader);
+
+    std::cout << "\nVersioned records integrity check:" << std::endl;
+    std::cout << "  Newer fields skipped: " << (skipped ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  Missing fields defaulted: " << (defaulted ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  Truncations rejected: " << (truncated ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  Corruptions rejected: " << (rejected ? "PASSED" : "FAILED") << std::endl;
+
+    return skipped && defaulted && truncated && rejected;
+}
+
+// ============================================================================
+//! \brief Data stored in any encoding, compared once read back
+// ============================================================================
+struct Sample
+{
+    enum class Kind : int16_t { Low = -2, High = 300 };
+
+    std::vector<Person> people;
+    std::vector<int64_t> offsets;
+    std::vector<double> weights;
+    std::map<std::string, uint32_t> scores;
+    std::unique_ptr<Person> leader;
+    Kind kind = Kind::Low;
+
+    template <typename Encoding>
+    bool round_trip(const char* p_name) const
+    {
+        BasicSerializer<Encoding> serializer;
+        serializer << people << offsets << weights << scores << leader << kind;
+
+        serialization::Container data = serializer.data();
+        BasicDeserializer<Encoding> deserializer(data);
+        Sample read;
+        deserializer >> read.people >> read.offsets >> read.weights >> read.scores >> read.leader >> read.kind;
+
+        bool same = deserializer && (read.people.size() == people.size()) &&
+                    (read.offsets == offsets) && (read.weights == weights) &&
+                    (read.scores == scores) && read.leader && (read.leader->name() == leader->name()) &&
+                    (read.kind == kind);
+        for (size_t i = 0; same && (i < people.size()); ++i)
+        {
+            same = (read.people[i].name() == people[i].name()) && (read.people[i].age() == people[i].age()) &&
+                   (read.people[i].hobbies() == people[i].hobbies());
+        }
+        std::cout << "  " << p_name << ": " << data.size() << " bytes, "
+                  << (same ? "PASSED" : "FAILED") << std::endl;
+        return same;
+    }
+};
+
+// ============================================================================
+//! \brief Example 7: Encodings of numbers and sizes
+// ============================================================================
+inline bool example_encodings()
+{
+    std::cout << "\n=== Encodings example ===" << std::endl;
+
+    Sample sample;
+    sample.people = {
+        Person("Alice Martin", 25, {"peinture", "voyage"}),
+        Person("Bob Durand", -35, {"cuisine", "jardinage", "photographie"})
+    };
+    sample.offsets = {0, -1, 1, 127, 128, -129, INT64_MIN, INT64_MAX};
+    sample.weights = {0.5, -0.25, 1e300};
+    sample.scores = {{"Alice", 95u}, {"Bob", 4000000000u}};
+    sample.leader.reset(new Person("Claire Dubois", 28, {"danse"}));
+    sample.kind = Sample::Kind::High;
+
+    std::cout << "Round trip:" << std::endl;
+    bool raw = sample.round_trip<serialization::Raw>("Raw");
+    bool little_endian = sample.round_trip<serialization::LittleEndian>("LittleEndian");
+    bool varint = sample.round_trip<serialization::Varint>("Varint");
+
+    // The encoding is in the header: data is not misread by another one
+    BasicSerializer<serialization::Varint> serializer;
+    serializer << sample.offsets;
+    Deserializer raw_deserializer(serializer.data());
+    std::vector<int64_t> offsets;
+    raw_deserializer >> offsets;
+    bool rejected = (raw_deserializer.error() == serialization::Error::WrongEncoding) && offsets.empty();
+    std::cout << "Varint data read as Raw: " << serialization::to_string(raw_deserializer.error()) << std::endl;
+
+    std::cout << "\nEncodings integrity check:" << std::endl;
+    std::cout << "  Raw: " << (raw ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  LittleEndian: " << (little_endian ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  Varint: " << (varint ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "  Wrong encoding rejected: " << (rejected ? "PASSED" : "FAILED") << std::endl;
+
+    return raw && little_endian && varint && rejected;
+}
+
 // ============================================================================
 //! \brief Main function
 //! g++ -std=c++17 -Wall -Wextra -O2 -o main main.cpp
@@ -488,6 +657,18 @@ int main()
     {
         return EXIT_FAILURE;
     }
+    if (!example_views())
+    {
+        return EXIT_FAILURE;
+    }
+    if (!example_versions())
+    {
+        return EXIT_FAILURE;
+    }
+    if (!example_encodings())
+    {
+        return EXIT_FAILURE;
+    }
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file